@@ -221,4 +221,12 @@
   sv_setnv($result, (double) vrna_md_defaults_sfact_get());
 }
 
+%typemap(varin) int threads {
+  vrna_md_defaults_threads(SvIV($input));
+}
+
+%typemap(varout) int threads {
+  sv_setiv($result, (IV) vrna_md_defaults_threads_get());
+}
+
 #endif
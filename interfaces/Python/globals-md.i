@@ -222,5 +222,13 @@
   $result = PyFloat_FromDouble(vrna_md_defaults_sfact_get());
 }
 
+%typemap(varin) int threads {
+  vrna_md_defaults_threads(PyInt_AsLong($input));
+}
+
+%typemap(varout) int threads {
+  $result = PyInt_FromLong(vrna_md_defaults_threads_get());
+}
+
 #endif
 
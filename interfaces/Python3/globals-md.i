@@ -222,5 +222,13 @@
   $result = PyFloat_FromDouble(vrna_md_defaults_sfact_get());
 }
 
+%typemap(varin) int threads {
+  vrna_md_defaults_threads((int)PyLong_AsLong($input));
+}
+
+%typemap(varout) int threads {
+  $result = PyLong_FromLong((long)vrna_md_defaults_threads_get());
+}
+
 #endif
 
@@ -157,9 +157,22 @@ typedef struct {} vrna_pbacktrack_mem_t;
   }
 
   %clear vrna_pbacktrack_mem_t *nr_memory;
+
+  void
+  pbacktrack_set_seed(unsigned long long seed)
+  {
+    vrna_pbacktrack_set_seed($self, seed);
+  }
+
+  void
+  pbacktrack_unset_seed(void)
+  {
+    vrna_pbacktrack_unset_seed($self);
+  }
 }
 
 %constant unsigned int PBACKTRACK_DEFAULT       = VRNA_PBACKTRACK_DEFAULT;
 %constant unsigned int PBACKTRACK_NON_REDUNDANT = VRNA_PBACKTRACK_NON_REDUNDANT;
+%constant unsigned int PBACKTRACK_NR_CONCURRENT = VRNA_PBACKTRACK_NR_CONCURRENT;
 
 %include  <ViennaRNA/boltzmann_sampling.h>
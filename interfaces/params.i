@@ -280,6 +280,12 @@ def __repr__(self):
   {
     vrna_exp_params_subst($self, par);
   }
+
+  int
+  set_temperature(double temperature)
+  {
+    return vrna_fold_compound_set_temperature($self, temperature);
+  }
 }
 
 
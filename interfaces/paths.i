@@ -295,6 +295,45 @@ std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::strin
       return v;
   }
 
+#ifdef SWIGPYTHON
+%feature("autodoc") path_findpath_saddle_batch;
+%feature("kwargs") path_findpath_saddle_batch;
+#endif
+
+  std::vector<std::vector<int> >
+  path_findpath_saddle_batch(std::vector<std::string>   structures,
+                             std::vector<unsigned int>  pairs = std::vector<unsigned int>(),
+                             int                        width = 1,
+                             int                        maxE = INT_MAX - 1,
+                             unsigned int               options = VRNA_PATH_BATCH_DEFAULT)
+  {
+      std::vector<std::vector<int> >  v;
+      std::vector<const char *>       vc;
+      int                             *M;
+      unsigned int                    i, n;
+
+      std::transform(structures.begin(), structures.end(), std::back_inserter(vc), convert_vecstring2veccharcp);
+      vc.push_back(NULL); /* mark end of structure list */
+      n = structures.size();
+
+      M = vrna_path_findpath_saddle_batch($self,
+                                          (const char **)&vc[0],
+                                          (pairs.size() > 1) ? &pairs[0] : NULL,
+                                          pairs.size() / 2,
+                                          width,
+                                          maxE,
+                                          options);
+
+      if (M) {
+        for (i = 0; i < n; i++)
+          v.push_back(std::vector<int>(M + i * n, M + (i + 1) * n));
+
+        free(M);
+      }
+
+      return v;
+  }
+
 #ifdef SWIGPYTHON
 %feature("autodoc") path_direct;
 %feature("kwargs") path_direct;
@@ -342,7 +381,11 @@ std::vector<vrna_path_t> my_get_path(std::string seq, std::string s1, std::strin
 
 %constant unsigned int PATH_TYPE_DOT_BRACKET  = VRNA_PATH_TYPE_DOT_BRACKET;
 %constant unsigned int PATH_TYPE_MOVES        = VRNA_PATH_TYPE_MOVES;
+%constant unsigned int PATH_BATCH_DEFAULT     = VRNA_PATH_BATCH_DEFAULT;
+%constant unsigned int PATH_BATCH_INDIRECT_UB = VRNA_PATH_BATCH_INDIRECT_UB;
 
 %include <ViennaRNA/landscape/paths.h>
+%ignore vrna_path_findpath_saddle_batch;
+
 %include <ViennaRNA/landscape/findpath.h>
 
@@ -9,12 +9,15 @@
 #ifndef BAUM_H
 #define BAUM_H
 
+#include "globals.h"
+
 /* used in main.c */
-extern void ini_or_reset_rl(void);
-extern void move_it(void);
-extern void clean_up_rl(void);
+extern void ini_start_stop(void);
+extern void ini_or_reset_rl(SimState *sim);
+extern void move_it(SimState *sim);
+extern void clean_up_rl(SimState *sim);
 
 /* used in nachbar.c */
-extern void update_tree(int i,int j);
+extern void update_tree(SimState *sim, int i,int j);
 
 #endif
@@ -32,15 +32,20 @@
 */
 
 /* PUBLIC FUNCTIONES */
-cache_entry *lookup_cache (char *x);
-int write_cache (cache_entry *x);
+cache_entry *lookup_cache (SimState *sim, char *x);
+int write_cache (SimState *sim, const char *structure, cache_entry *x);
 /*  void delete_cache (cache_entry *x); */
-void kill_cache();
-void initialize_cache();
+void kill_cache(SimState *sim);
+void initialize_cache(SimState *sim);
 
 /* PRIVATE FUNCTIONES */
 /*  static int cache_comp(cache_entry *x, cache_entry *y); */
-INLINE static unsigned cache_f (char *x);
+INLINE static unsigned cache_f (const char *x);
+static void free_entry(cache_entry *c);
+static void flush_cache(SimState *sim);
+#if HAVE_LIBRNA_API3
+static void intern_structure(SimState *sim, const char *structure, cache_entry *x);
+#endif
 
 /* #define CACHESIZE 67108864 -1 */ /* 2^26 -1   must be power of 2 -1 */
 /* #define CACHESIZE 33554432 -1 */ /* 2^25 -1   must be power of 2 -1 */
@@ -53,7 +58,6 @@ INLINE static unsigned cache_f (char *x);
 /* #define CACHESIZE    16384 -1 */ /* 2^14 -1   must be power of 2 -1 */
 /* #define CACHESIZE     4096 -1 */ /* 2^12 -1   must be power of 2 -1 */
 
-static cache_entry *cachetab[CACHESIZE+1];
 static char UNUSED rcsid[] ="$Id: cache.c,v 1.3 2006/10/04 12:45:12 xtof Exp $";
 unsigned long collisions=0;
 
@@ -69,8 +73,8 @@ char coeff[] = {
                 61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1};
 
 /* key must not be longer than 128 */
-INLINE static unsigned cache_f(char *x) { 
-  register char *s;
+INLINE static unsigned cache_f(const char *x) { 
+  register const char *s;
   register int i;
   register unsigned cache;
 
@@ -88,53 +92,110 @@ INLINE static unsigned cache_f(char *x) {
 
 
 /* returns NULL unless x is in the cache */
-cache_entry *lookup_cache (char *x) {
+cache_entry *lookup_cache (SimState *sim, char *x) {
   int cacheval;
   cache_entry *c;
 
   cacheval=cache_f(x);
-  if ((c=cachetab[cacheval]))
-    if (strcmp(c->structure,x)==0) return c;
+  if ((c=sim->cachetab[cacheval])) {
+    if (c->structure) {
+      if (strcmp(c->structure,x)==0) return c;
+    }
+#if HAVE_LIBRNA_API3
+    /* interned structures are identical iff their IDs are */
+    else if ((strlen(x) == sim->cachestore_len) &&
+	     (vrna_struct_store_find(sim->cachestore, x) == c->id)) return c;
+#endif
+  }
   
   return NULL;
 }
 
-/* returns 1 if x already was in the cache */
-int write_cache (cache_entry *x) {
+/* stores a copy of structure as key of x, returns 1 if x already was in the cache */
+int write_cache (SimState *sim, const char *structure, cache_entry *x) {
   int cacheval;
   cache_entry *c;
   
-  cacheval=cache_f(x->structure);
-  if ((c=cachetab[cacheval])) {
-    free(c->structure);
-    free(c->neighbors);
-    free(c->rates);
-    free(c->energies);
-    free(c);
-  }
-  cachetab[cacheval]=x;
+#if HAVE_LIBRNA_API3
+  if (GSV.cacheStore > 0) intern_structure(sim, structure, x);
+  else
+#endif
+  x->structure = strdup(structure);
+
+  cacheval=cache_f(structure);
+  if ((c=sim->cachetab[cacheval])) free_entry(c);
+  sim->cachetab[cacheval]=x;
   return 0;
 }
 
+/* every simulation state has its own cache, so no locking is required */
+void initialize_cache (SimState *sim) {
+  sim->cachetab = (cache_entry **)calloc(CACHESIZE+1, sizeof(cache_entry *));
+  if (sim->cachetab == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+}
+
 /**/
-void initialize_cache () { }
+void kill_cache (SimState *sim) {
+  if (sim->cachetab == NULL) return;
+
+  flush_cache(sim);
+  free(sim->cachetab);
+  sim->cachetab = NULL;
+#if HAVE_LIBRNA_API3
+  vrna_struct_store_free(sim->cachestore);
+  sim->cachestore = NULL;
+#endif
+}
 
 /**/
-void kill_cache () {
+static void free_entry(cache_entry *c) {
+  free(c->structure);
+  free(c->neighbors);
+  free(c->rates);
+  free(c->energies);
+  free(c);
+}
+
+/* remove all entries from the cache */
+static void flush_cache(SimState *sim) {
   int i;
-  
+
   for (i=0;i<CACHESIZE+1;i++) {
-    if ( cachetab[i] ) {
-      free (cachetab[i]->structure);
-      free (cachetab[i]->neighbors);
-      free (cachetab[i]->rates);
-      free (cachetab[i]->energies);
-      free (cachetab[i]);
+    if ( sim->cachetab[i] ) {
+      free_entry(sim->cachetab[i]);
+      sim->cachetab[i] = NULL;
     }
-    cachetab[i]=NULL;
   }
 }
 
+#if HAVE_LIBRNA_API3
+/*
+  The structure store never forgets a structure, not even one whose
+  cache entry has been replaced. To keep its size bounded, the cache
+  starts over with an empty store once the store is full, or the
+  chain has grown (--grow).
+*/
+static void intern_structure(SimState *sim, const char *structure, cache_entry *x) {
+  size_t n = strlen(structure);
+
+  if ((sim->cachestore == NULL) ||
+      (sim->cachestore_len != n) ||
+      (vrna_struct_store_size(sim->cachestore) >= (size_t)GSV.cacheStore)) {
+    flush_cache(sim);
+    vrna_struct_store_free(sim->cachestore);
+    sim->cachestore = vrna_struct_store_init(n, GSV.cacheStore);
+    sim->cachestore_len = n;
+  }
+
+  x->structure = NULL;
+  x->id = vrna_struct_store_insert(sim->cachestore, structure);
+  /* fall back to a plain copy for anything the store rejects */
+  if (x->id == VRNA_STRUCT_STORE_NONE) x->structure = strdup(structure);
+}
+#endif
+
 #if 0
 /**/
 static int cache_comp(cache_entry *x, cache_entry *y) {
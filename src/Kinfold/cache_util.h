@@ -15,8 +15,11 @@
 #define UNUSED
 #endif
 
-typedef struct {
-  char *structure;
+#include "globals.h"
+
+typedef struct _cache_entry {
+  char *structure;   /* NULL if the structure is interned (--cacheStore) */
+  unsigned int id;   /* ID of the interned structure */
   int top;           /* number of neighbors */
   int lmin;          /* is a local minimum ? */
   double flux;       /* sum of rates */
@@ -26,8 +29,9 @@ typedef struct {
   double *energies;
 } cache_entry;
 
-extern cache_entry *lookup_cache (char *x);
-extern int write_cache (cache_entry *x);
-void kill_cache(void);
+extern cache_entry *lookup_cache (SimState *sim, char *x);
+extern int write_cache (SimState *sim, const char *structure, cache_entry *x);
+void initialize_cache(SimState *sim);
+void kill_cache(SimState *sim);
 
 #endif
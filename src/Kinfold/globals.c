@@ -14,6 +14,10 @@
 #include <errno.h>
 #include <getopt.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #if HAVE_LIBRNA_API3
 #include <ViennaRNA/utils.h>
 #include <ViennaRNA/fold_vars.h>
@@ -100,8 +104,6 @@ void clean_up_globals(void) {
   free(GAV.farbe);
   free(GAV.farbe_full);
   free(GAV.startform);
-  free(GAV.currform);
-  free(GAV.prevform);
   for (i = 0; i < GSV.maxS; i++) free(GAV.stopform[i]);
   free(GAV.stopform);
   free(GAV.sE);
@@ -193,6 +195,11 @@ void log_prog_params(FILE *FP) {
 	     verbose(GTV.silent, NULL),
 	     verbose(GTV.lmin, NULL),
 	     GSV.cut);
+    if (GTV.jobs)
+      fprintf(FP, "#Parallel: jobs=%d (one random number stream per trajectory)\n",
+	      GSV.jobs);
+    if (GSV.cacheStore)
+      fprintf(FP, "#Cache: cacheStore=%d\n", GSV.cacheStore);
     fflush(FP);
 }
 
@@ -382,6 +389,33 @@ static void process_options_gg (int argc, char *argv[]) {
   GTV.lmin = args_info.lmin_flag;
   GTV.fpt  = args_info.fpt_flag;
   GTV.rect = args_info.rect_flag;
+
+  if (args_info.jobs_given) {
+    GTV.jobs = 1;
+#if defined(_OPENMP) && HAVE_LIBRNA_API3
+    GSV.jobs = (args_info.jobs_arg > 0) ? args_info.jobs_arg : omp_get_num_procs();
+#else
+    fprintf(stderr,
+            "WARNING: Kinfold was compiled without support for parallel trajectories,"
+            " using a single thread\n");
+    GSV.jobs = 1;
+#endif
+  }
+
+  if (args_info.cacheStore_given) {
+    if (args_info.cacheStore_arg < 0) {
+      fprintf(stderr, "Value of --cacheStore must be >= 0 >%d<\n",
+              args_info.cacheStore_arg);
+      exit(EXIT_FAILURE);
+    }
+#if HAVE_LIBRNA_API3
+    GSV.cacheStore = args_info.cacheStore_arg;
+#else
+    fprintf(stderr,
+            "WARNING: Kinfold was compiled without support for a structure store,"
+            " ignoring --cacheStore\n");
+#endif
+  }
   cmdline_parser_free(&args_info);
 }
 /**/
@@ -547,6 +581,7 @@ static void ini_gtoggles(void) {
   GTV.fpt = 1;
   GTV.rect = 0;
   GTV.mc = 0;
+  GTV.jobs = 0;
 }
 
 /**/
@@ -563,6 +598,8 @@ static void ini_gvars(void) {
   GSV.phi = 1.0;
   GSV.simTime = 0.0;
   GSV.glen = 15;
+  GSV.jobs = 1;
+  GSV.cacheStore = 0;
 }
 
 /**/
@@ -579,8 +616,6 @@ static void ini_garrays(void) {
   assert(GAV.stopform != NULL);
   GAV.farbe = NULL;
   GAV.startform = NULL;
-  GAV.currform = NULL;
-  GAV.prevform = NULL;
   GAV.phi_bounds[0] = 0.1;
   GAV.phi_bounds[1] = 0.1;
   GAV.phi_bounds[2] = 2.0;
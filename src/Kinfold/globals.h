@@ -20,6 +20,7 @@
 #if HAVE_LIBRNA_API3
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/data_structures.h>
+#include <ViennaRNA/datastructures/structure_store.h>
 #else
 #include <fold_vars.h>
 #include <params.h>
@@ -40,6 +41,8 @@ typedef struct _GlobVars {
   double time;
   double phi;
   double simTime;
+  int    jobs;      /* number of parallel threads */
+  int    cacheStore; /* max. number of interned cache structures (0 = off) */
 } GlobVars;
 
 typedef struct _GlobArrays {
@@ -50,8 +53,6 @@ typedef struct _GlobArrays {
   char *farbe_full;    /* full sequence (for chain growth simulation) */
   char *startform;     /* start structure */
   char **stopform;     /* stop structure(s) */
-  char *currform;      /* current structure */
-  char *prevform;      /* current structure of previous time step */
   float *sE;           /* energy(s) of stop structure(s) */
   double phi_bounds[3];   /* phi_min, phi_inc, phi_max */
   unsigned short subi[3]; /* seeds for random-number-generator */
@@ -82,8 +83,70 @@ typedef struct _GlobToogles {
   int rect;
   int mc;
   int verbose;
+  int jobs;     /* run trajectories in parallel with own random number streams */
 } GlobToggles;
 
+struct _baum;
+struct _cache_entry;
+
+/* state of a single simulation, i.e. one per thread */
+typedef struct _SimState {
+  int   len;            /* current chain length */
+  int   steps;
+  int   rect;           /* recurrence time toggle of current trajectory */
+  float startE;
+  float currE;
+  char  *farbe;         /* (growing) sequence */
+  char  *start;         /* start structure as read from input */
+  char  *startform;     /* start structure */
+  char  *currform;      /* current structure */
+  char  *prevform;      /* current structure of previous time step */
+  unsigned short subi[3];  /* seeds of current trajectory */
+  unsigned short xsubi[3]; /* state of random-number-generator */
+
+#if HAVE_LIBRNA_API3
+  vrna_fold_compound_t *vc;
+#endif
+
+  /* ringlist-tree (baum.c) */
+  short *pairList;
+  short *typeList;
+  short *aliasList;
+  struct _baum *rl;
+  struct _baum *wurzl;
+  char **ptype;
+
+  /* neighbour list (nachbar.c) */
+  double RT;            /* thermal energy in kcal/mol */
+  short  *neighbor_list;
+  float  *bmf;
+  double *energies;
+  int    lmin;
+  int    top;
+  int    is_from_cache;
+  double totalflux;
+  double Zeit;
+  double zeitInc;
+  double L, D, sumT, sumK, sumKK, sumD; /* laplace stuff */
+  char   *costr;
+  int    costr_size;
+
+  /* neighbourhood cache (cache.c) */
+  struct _cache_entry **cachetab;
+#if HAVE_LIBRNA_API3
+  vrna_struct_store_t cachestore; /* interned structures (--cacheStore) */
+  size_t cachestore_len;          /* length of the interned structures */
+#endif
+
+  /* output of current trajectory, if buffered (otherwise written directly) */
+  FILE   *logFP;        /* log-file, shared by all simulations */
+  int    buffered;
+  char   *out;
+  size_t out_len, out_size;
+  char   *log;
+  size_t log_len, log_size;
+} SimState;
+
 void decode_switches(int argc, char *argv[]);
 void clean_up_globals(void);
 void log_prog_params(FILE *FP);
@@ -12,8 +12,13 @@
 #include <string.h>
 #include <assert.h>
 #include <ctype.h>
+#include <stdint.h>
 #include <unistd.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #if HAVE_LIBRNA_API3
 #include <ViennaRNA/data_structures.h>
 #include <ViennaRNA/fold_vars.h> /* contains global variable cut_point */
@@ -32,18 +37,25 @@
 
 static char UNUSED rcsid[] ="$Id: main.c,v 1.5 2008/08/28 09:40:55 ivo Exp $";
 extern void  read_parameter_file(const char fname[]);
-extern void get_from_cache(cache_entry *c);
+extern void get_from_cache(SimState *sim, cache_entry *c);
 
 /* PRIVAT FUNCTIONS */
 static void ini_energy_model(void);
 static void read_data(void);
-static void clean_up(void);
+static void clean_up(FILE *logFP);
+static void run_simulations(FILE *logFP);
+static void simulate(SimState *sim);
+static void trajectory_seed(SimState *sim, int num);
+static SimState *ini_sim_state(FILE *logFP);
+static void free_sim_state(SimState *sim);
 
 /**/
 int main(int argc, char *argv[]) {
-  int i;
-  char * start, *tmp;
-  
+  FILE *logFP;
+#if HAVE_LIBRNA_API3
+  char *tmp;
+#endif
+
   /*
     process command-line optiones
   */
@@ -70,63 +82,204 @@ int main(int argc, char *argv[]) {
   free(tmp);
 #endif
 
+  /*
+    energies of start and stop structure(s), open log-file
+  */
+  ini_start_stop();
+  logFP = ini_simulation();
+
   /*
     perform GSV.num simulations
   */
-    
-  start = strdup(GAV.startform); /* remember startform for next run */
-  int rect; rect = GTV.rect; /* Backup and reset the recurrence time option for every simulation.  */
-  for (i = 0; i < GSV.num; i++) {
-    GTV.rect = rect;
-    /*
-      initialize or reset ringlist to start conditions
-    */
-    ini_or_reset_rl();
-    if (GSV.grow>0) {
-      if (strlen(GAV.farbe)>GSV.glen) {
-        start[GSV.glen] = '\0';
-        GAV.farbe[GSV.glen] = '\0';
-        strcpy(GAV.startform,start);
-        strcpy(GAV.currform,start);
-        GSV.len=GSV.glen;
-#if HAVE_LIBRNA_API3
-        GAV.vc->length = GSV.len;
+  run_simulations(logFP);
+  
+  /*
+    clean up memory
+  */
+  clean_up(logFP);
+  return(0);
+}
+
+/*
+  Each thread runs its trajectories on its own simulation state. In
+  parallel mode (--jobs), every trajectory draws from its own random
+  number stream and its output is buffered and written in order of
+  the trajectories, so the result does not depend on the number of
+  threads.
+*/
+static void run_simulations(FILE *logFP) {
+  int i, next = 0;
+  char **out = NULL, **log = NULL;
+
+  if (GTV.jobs) {
+    out = (char **)calloc(GSV.num, sizeof(char *));
+    log = (char **)calloc(GSV.num, sizeof(char *));
+    assert((out != NULL) && (log != NULL));
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(GSV.jobs) if (GSV.jobs > 1)
+#endif
+  {
+    SimState *sim = ini_sim_state(logFP);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
 #endif
+    for (i = 0; i < GSV.num; i++) {
+      if (GTV.jobs)
+        trajectory_seed(sim, i);
+
+      simulate(sim);
+
+      if (GTV.jobs) {
+#ifdef _OPENMP
+#pragma omp critical (kinfold_output)
+#endif
+        {
+          /* hand over buffers of this trajectory */
+          out[i] = (sim->out) ? sim->out : strdup("");
+          log[i] = sim->log;
+          sim->out = sim->log = NULL;
+          sim->out_len = sim->out_size = sim->log_len = sim->log_size = 0;
+
+          /* write all consecutive trajectories that are done */
+          for (; (next < GSV.num) && (out[next]); next++) {
+            write_output(logFP, out[next], log[next]);
+            free(out[next]);
+            free(log[next]);
+          }
+        }
       }
-      clean_up_rl();
-      ini_or_reset_rl();
     }
 
-    /*
-      perform simulation
-    */
-    for (GSV.steps = 1;; GSV.steps++) {
-      cache_entry *c;
-
-      /*
-	take neighbourhood of current structure from cache if there
-	else generate it from scratch
-      */
-      if ( (c = lookup_cache(GAV.currform)) ) get_from_cache(c);
-      else move_it();
-	
-      /*
-	select a structure from neighbourhood of current structure
-	and make it to the new current structure.
-	stop simulation if stop condition is met.
-      */
-      if ( sel_nb() > 0 ) break;
-
-      /* if (GSV.grow>0) grow_chain(); */
+    free_sim_state(sim);
+  }
+
+  free(out);
+  free(log);
+}
+
+/* perform a single simulation */
+static void simulate(SimState *sim) {
+  sim->rect = GTV.rect; /* reset the recurrence time option for every simulation. */
+
+  /*
+    initialize or reset ringlist to start conditions
+  */
+  ini_or_reset_rl(sim);
+  if (GSV.grow>0) {
+    if (strlen(sim->farbe)>GSV.glen) {
+      sim->start[GSV.glen] = '\0';
+      sim->farbe[GSV.glen] = '\0';
+      strcpy(sim->startform,sim->start);
+      strcpy(sim->currform,sim->start);
+      sim->len=GSV.glen;
+#if HAVE_LIBRNA_API3
+      sim->vc->length = sim->len;
+#endif
     }
+    clean_up_rl(sim);
+    ini_or_reset_rl(sim);
   }
-  
+
   /*
-    clean up memory
+    perform simulation
   */
-  free(start);
-  clean_up();
-  return(0);
+  for (sim->steps = 1;; sim->steps++) {
+    cache_entry *c;
+
+    /*
+      take neighbourhood of current structure from cache if there
+      else generate it from scratch
+    */
+    if ( (c = lookup_cache(sim, sim->currform)) ) get_from_cache(sim, c);
+    else move_it(sim);
+
+    /*
+      select a structure from neighbourhood of current structure
+      and make it to the new current structure.
+      stop simulation if stop condition is met.
+    */
+    if ( sel_nb(sim) > 0 ) break;
+
+    /* if (GSV.grow>0) grow_chain(); */
+  }
+}
+
+/*
+  derive the seed of trajectory num from the initial seed (SplitMix64),
+  such that each trajectory can be reproduced from the seed in the log-file
+*/
+static void trajectory_seed(SimState *sim, int num) {
+  uint64_t z;
+
+  z = ((uint64_t)GAV.subi[0] | ((uint64_t)GAV.subi[1] << 16) | ((uint64_t)GAV.subi[2] << 32))
+      + (uint64_t)(num + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+
+  sim->subi[0] = sim->xsubi[0] = (unsigned short)(z & 0xFFFF);
+  sim->subi[1] = sim->xsubi[1] = (unsigned short)((z >> 16) & 0xFFFF);
+  sim->subi[2] = sim->xsubi[2] = (unsigned short)((z >> 32) & 0xFFFF);
+}
+
+/* get a fresh simulation state */
+static SimState *ini_sim_state(FILE *logFP) {
+  SimState *sim;
+  int n;
+#if HAVE_LIBRNA_API3
+  char *tmp;
+#endif
+
+  sim = (SimState *)calloc(1, sizeof(SimState));
+  assert(sim != NULL);
+
+  n = strlen(GAV.farbe_full);
+  sim->len       = GSV.len;
+  sim->farbe     = strdup(GAV.farbe_full);
+  sim->start     = strdup(GAV.startform); /* remember startform for next run */
+  sim->startform = (char *)calloc(n + 2, sizeof(char));
+  sim->currform  = (char *)calloc(n + 2, sizeof(char));
+  sim->prevform  = (char *)calloc(n + 2, sizeof(char));
+  assert(sim->farbe && sim->start && sim->startform && sim->currform && sim->prevform);
+  strcpy(sim->startform, GAV.startform);
+
+  /* without --jobs, trajectories continue the random number stream */
+  memcpy(sim->subi, GAV.subi, sizeof(sim->subi));
+  memcpy(sim->xsubi, GAV.subi, sizeof(sim->xsubi));
+
+#if HAVE_LIBRNA_API3
+  /* own fold compound, since chain growth fakes its length */
+  tmp     = vrna_cut_point_insert(GAV.farbe_full, cut_point);
+  sim->vc = vrna_fold_compound(tmp, &(GAV.md), VRNA_OPTION_EVAL_ONLY);
+  free(tmp);
+#endif
+
+  sim->logFP    = logFP;
+  sim->buffered = GTV.jobs;
+
+  initialize_cache(sim);
+  ini_nbList(sim, n * n);
+
+  return sim;
+}
+
+/**/
+static void free_sim_state(SimState *sim) {
+  if (sim->wurzl) clean_up_rl(sim);
+  clean_up_nbList(sim);
+  kill_cache(sim);
+#if HAVE_LIBRNA_API3
+  vrna_fold_compound_free(sim->vc);
+#endif
+  free(sim->farbe);
+  free(sim->start);
+  free(sim->startform);
+  free(sim->currform);
+  free(sim->prevform);
+  free(sim);
 }
 
 /**/
@@ -183,10 +336,6 @@ static void read_data(void) {
   for (i = 0; i < len; i++) GAV.farbe[i] = toupper(GAV.farbe[i]);
   free (ctmp);
   /* allocate some global arrays */
-  GAV.currform = (char *)calloc(GSV.len +1, sizeof(char));
-  assert(GAV.currform != NULL);
-  GAV.prevform = (char *)calloc(GSV.len +1, sizeof(char));
-  assert(GAV.prevform != NULL);
   GAV.startform = (char *)calloc(GSV.len +1, sizeof(char));
   assert(GAV.startform != NULL);
 
@@ -254,9 +403,7 @@ static void read_data(void) {
 }
 
 /**/
-void clean_up(void) {
+void clean_up(FILE *logFP) {
+  clean_up_simulation(logFP);
   clean_up_globals();
-  clean_up_rl();
-  clean_up_nbList();
-  kill_cache();
 }
@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include "globals.h"
 #include "assert.h"
 
@@ -29,147 +31,162 @@
 
 static char UNUSED rcsid[]="$Id: nachbar.c,v 1.8 2008/06/03 21:55:11 ivo Exp $";
 
-/* arrays */
-static short *neighbor_list=NULL;
-static float *bmf=NULL; /* boltzmann weight of structure */
-static const char *costring(const char *str);
-
-/* globals for laplace stuff */
-static double L = 0.0;
-static double D = 0.0;
-static double sumT = 0.0;
-static double sumK = 0.0;
-static double sumKK = 0.0;
-static double sumD = 0.0;
-static double *energies=NULL; /* energies of neighbors */
-
-/* variables */
+static const char *costring(SimState *sim, const char *str);
+
+/*
+  all per-trajectory variables, i.e. the neighbour list, Boltzmann
+  weights, clock and laplace stuff, live in SimState
+*/
 /*  static double highestE = -1000.0; */
 /*  static double OhighestE = -1000.0; */
 /*  static char *highestS, *OhighestS; */
-static int lmin = 1;
-static int top = 0;
-static int is_from_cache = 0;
 /*  static double meanE = 0.0; */
-static double totalflux = 0.0;
-static double Zeit = 0.0;
-static double zeitInc = 0.0;
-static double _RT = 0.6;
 
 /* public functiones */
-void ini_nbList(int chords);
-void update_nbList(int i, int j, int iE);
-int sel_nb(void);
-void clean_up_nbList(void);
-extern void update_tree(int i, int j);
+FILE *ini_simulation(void);
+void clean_up_simulation(FILE *logFP);
+void write_output(FILE *logFP, const char *out, const char *log);
+void ini_nbList(SimState *sim, int chords);
+void update_nbList(SimState *sim, int i, int j, int iE);
+int sel_nb(SimState *sim);
+void clean_up_nbList(SimState *sim);
+extern void update_tree(SimState *sim, int i, int j);
 
 /* privat functiones */
-static void reset_nbList(void);
-static void grow_chain(void);
-static FILE *logFP=NULL;
+static void reset_nbList(SimState *sim);
+static void grow_chain(SimState *sim);
+static double sim_urn(SimState *sim);
+static void sim_printf(SimState *sim, const char *fmt, ...);
+static void sim_log(SimState *sim, const char *fmt, ...);
+static void append_output(char **buf, size_t *len, size_t *size,
+                          const char *fmt, va_list args);
+
+/* open the log-file shared by all simulations */
+FILE *ini_simulation(void) {
+  char logFN[256];
+  FILE *logFP;
+
+  logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
+  assert(logFP != NULL);
+
+  /* log initial condition */
+  log_prog_params(logFP);
+  log_start_stop(logFP);
+
+  return logFP;
+}
 
 /**/
-void ini_nbList(int chords) {
-  char logFN[256];
+void clean_up_simulation(FILE *logFP) {
+  fprintf(logFP,"\n");
+  fclose(logFP);
+}
+
+/* write buffered output of a trajectory */
+void write_output(FILE *logFP, const char *out, const char *log) {
+  if (out) {
+    fputs(out, stdout);
+    fflush(stdout);
+  }
+  if (log) {
+    fputs(log, logFP);
+    fflush(logFP);
+  }
+}
 
-  _RT = (((temperature + K0) * GASCONST) / 1000.0);
-  if (neighbor_list!=NULL) return;
+/**/
+void ini_nbList(SimState *sim, int chords) {
+
+  sim->RT = (((temperature + K0) * GASCONST) / 1000.0);
+
+  if (sim->neighbor_list!=NULL) return;
   /*
     list for move coding
     make room for 2*chords neighbors (safe bet)
   */
   if (chords == 0) chords = 1;
-  neighbor_list = (short *)calloc(4*chords, sizeof(short));
-  assert(neighbor_list != NULL);
+  sim->neighbor_list = (short *)calloc(4*chords, sizeof(short));
+  assert(sim->neighbor_list != NULL);
   /*
     list for Boltzmann-factors
   */
-  bmf = (float *)calloc(2*chords, sizeof(double));
-  assert(bmf != NULL);
+  sim->bmf = (float *)calloc(2*chords, sizeof(double));
+  assert(sim->bmf != NULL);
 
   /* list of neighbor energies */
-  energies = (double*)calloc(2*chords, sizeof(double));
-  assert(energies != NULL);
-  
-  /* open log-file */
-  logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
-  assert(logFP != NULL);
+  sim->energies = (double*)calloc(2*chords, sizeof(double));
+  assert(sim->energies != NULL);
 
-  /* log initial condition */
-  log_prog_params(logFP);
-  log_start_stop(logFP);
+  sim->lmin = 1;
 }
 
 /**/
-void update_nbList(int i, int j, int iE) {
+void update_nbList(SimState *sim, int i, int j, int iE) {
   double E, dE, p;
 
   E = (double)iE/100.;
-  neighbor_list[2*top] = (short )i;
-  neighbor_list[2*top+1] = (short )j;
+  sim->neighbor_list[2*sim->top] = (short )i;
+  sim->neighbor_list[2*sim->top+1] = (short )j;
   
   /* compute rates and some statistics */
   /*    meanE += E; */
-  dE = E-GSV.currE;
+  dE = E-sim->currE;
 
   /* laplace stuff */
-  energies[top] = E;
-  L += GSV.currE-E;
-  D++;
-  /* fprintf(stderr, ">>%g %g<<\n", L, D); */
+  sim->energies[sim->top] = E;
+  sim->L += sim->currE-E;
+  sim->D++;
+  /* fprintf(stderr, ">>%g %g<<\n", sim->L, sim->D); */
   
   if( GTV.mc ) {
     /* metropolis rule */
     if (dE < 0) p = 1;
-    else p = exp(-(dE / _RT*GSV.phi));
+    else p = exp(-(dE / sim->RT*GSV.phi));
   }
   else  /* kawasaki rule */
-    p = exp(-0.5 * (dE / _RT*GSV.phi));
+    p = exp(-0.5 * (dE / sim->RT*GSV.phi));
 
-  totalflux += p;
-  bmf[top++] = (float )p;
-  if (dE < 0) lmin = 0;
-  if ((dE == 0) && (lmin==1)) lmin = 2;
+  sim->totalflux += p;
+  sim->bmf[sim->top++] = (float )p;
+  if (dE < 0) sim->lmin = 0;
+  if ((dE == 0) && (sim->lmin==1)) sim->lmin = 2;
 }
 
 /**/
-void get_from_cache(cache_entry *c) {
-  top = c->top;
-  totalflux = c->flux;
-  GSV.currE = c->energy;
-  lmin = c->lmin;
-  memcpy(neighbor_list, c->neighbors, 2*top*sizeof(short));
-  memcpy(bmf, c->rates, top*sizeof(float));
-  memcpy(energies, c->energies, top*sizeof(double));
-  is_from_cache = 1;
+void get_from_cache(SimState *sim, cache_entry *c) {
+  sim->top = c->top;
+  sim->totalflux = c->flux;
+  sim->currE = c->energy;
+  sim->lmin = c->lmin;
+  memcpy(sim->neighbor_list, c->neighbors, 2*sim->top*sizeof(short));
+  memcpy(sim->bmf, c->rates, sim->top*sizeof(float));
+  memcpy(sim->energies, c->energies, sim->top*sizeof(double));
+  sim->is_from_cache = 1;
 }
 
 /**/
-void put_in_cache(void) {
+void put_in_cache(SimState *sim) {
   cache_entry *c;
 
   if ((c = (cache_entry *) malloc(sizeof(cache_entry)))==NULL) {
     fprintf(stderr, "out of memory\n"); exit(255);
   }
-/*    c->structure = strdup(GAV.currform); */
-  c->structure = (char *) calloc(GSV.len+1, sizeof(char));
-  strcpy(c->structure, GAV.currform);
-  c->neighbors = (short *) malloc(top*2*sizeof(short));
-  memcpy(c->neighbors,neighbor_list,top*2*sizeof(short));
-  c->rates = (float *) malloc(top*sizeof(float));
-  memcpy(c->rates, bmf, top*sizeof(float));
-  c->energies = (double*)malloc(top*sizeof(double));
-  memcpy(c->energies, energies, top*sizeof(double));
-  c->top = top;
-  c->lmin = lmin;
-  c->flux = totalflux;
-  c->energy = GSV.currE;
-  write_cache(c);
+  c->neighbors = (short *) malloc(sim->top*2*sizeof(short));
+  memcpy(c->neighbors,sim->neighbor_list,sim->top*2*sizeof(short));
+  c->rates = (float *) malloc(sim->top*sizeof(float));
+  memcpy(c->rates, sim->bmf, sim->top*sizeof(float));
+  c->energies = (double*)malloc(sim->top*sizeof(double));
+  memcpy(c->energies, sim->energies, sim->top*sizeof(double));
+  c->top = sim->top;
+  c->lmin = sim->lmin;
+  c->flux = sim->totalflux;
+  c->energy = sim->currE;
+  write_cache(sim, sim->currform, c);
 }
 
 /*============*/
 
-int sel_nb(void) {
+int sel_nb(SimState *sim) {
 
   char trans, **s;
   int next, i;
@@ -178,160 +195,160 @@ int sel_nb(void) {
 
   /* before we select a move, store current conformation in cache */
   /* ... unless it just came from there */
-  if ( !is_from_cache ) put_in_cache();
+  if ( !sim->is_from_cache ) put_in_cache(sim);
   else
     /* laplace stuff */
-    for (i=0; i<top; i++) {
-      L += (GSV.currE - energies[i]);
-      D++;
+    for (i=0; i<sim->top; i++) {
+      sim->L += (sim->currE - sim->energies[i]);
+      sim->D++;
     }
-  is_from_cache = 0;
+  sim->is_from_cache = 0;
 
   /* draw 2 different a random number */
-  schwelle = urn();
-  while ( zufall==0 ) zufall = urn();
+  schwelle = sim_urn(sim);
+  while ( zufall==0 ) zufall = sim_urn(sim);
 
   /* advance internal clock */
-  if (totalflux>0)
-    zeitInc = (log(1. / zufall) / totalflux);
+  if (sim->totalflux>0)
+    sim->zeitInc = (log(1. / zufall) / sim->totalflux);
   else {
-    if (GSV.grow>0) zeitInc=GSV.grow;
-    else zeitInc = GSV.time;
+    if (GSV.grow>0) sim->zeitInc=GSV.grow;
+    else sim->zeitInc = GSV.time;
   }
 
-  Zeit += zeitInc;
+  sim->Zeit += sim->zeitInc;
 
   /* laplace stuff */
-  sumK  += L*zeitInc;
-  sumKK += L*L*zeitInc;
-  sumD  += D*zeitInc;
+  sim->sumK  += sim->L*sim->zeitInc;
+  sim->sumKK += sim->L*sim->L*sim->zeitInc;
+  sim->sumD  += sim->D*sim->zeitInc;
   
-  if (GSV.grow>0 && GSV.len < strlen(GAV.farbe_full)) grow_chain();
+  if (GSV.grow>0 && sim->len < strlen(GAV.farbe_full)) grow_chain(sim);
 
   /* meanE /= (double)top; */
 
   /* normalize boltzmann weights */
-  schwelle *=totalflux;
+  schwelle *=sim->totalflux;
 
   /* and choose a neighbour structure next */
-  for (next = 0; next < top; next++) {
-    pegel += bmf[next];
+  for (next = 0; next < sim->top; next++) {
+    pegel += sim->bmf[next];
     if (pegel > schwelle) break;
   }
 
   /* in case of rounding errors */
-  if (next==top) next=top-1;
+  if (next==sim->top) next=sim->top-1;
 
   /*
     process termination contitiones
   */
   /* is current structure identical to a stop structure ?*/
   for (found_stop = 0, s = GAV.stopform; *s; s++) {
-    if (strcmp(*s, GAV.currform) == 0) {
+    if (strcmp(*s, sim->currform) == 0) {
       found_stop = (s - GAV.stopform) + 1;
       break;
     }
   }
 
   /* Recurrence time: Ignore when you observe the start structure for the first time. */
-  if ((found_stop > 0) && (GTV.rect == 1) && (strcmp(GAV.startform, GAV.currform) == 0)) {
-    GTV.rect = 0; found_stop = 0;
+  if ((found_stop > 0) && (sim->rect == 1) && (strcmp(sim->startform, sim->currform) == 0)) {
+    sim->rect = 0; found_stop = 0;
   }
 
-  if ( ((found_stop > 0) && (GTV.fpt == 1)) || (Zeit > GSV.time) ) {
+  if ( ((found_stop > 0) && (GTV.fpt == 1)) || (sim->Zeit > GSV.time) ) {
     /* met condition to stop simulation */
 
     /* laplace stuff */
     double K, KK, N, sigma;
-    K = sumK/Zeit;
-    KK = sumKK/Zeit;
-    N = sumD/Zeit;
+    K = sim->sumK/sim->Zeit;
+    KK = sim->sumKK/sim->Zeit;
+    N = sim->sumD/sim->Zeit;
     /* graph Laplacian is - Laplace-Beltrami operator */
     sigma = -1.0*sqrt((KK-K*K)/N)/(K/N);
     
     /* this goes to stdout */
     if ( !GTV.silent ) {
-      printf("%s  %6.2f %10.3f", costring(GAV.currform), GSV.currE, Zeit);
+      sim_printf(sim, "%s  %6.2f %10.3f", costring(sim, sim->currform), sim->currE, sim->Zeit);
 
       /* laplace stuff*/
-      if (GTV.phi) printf(" %8.3f %8.3f %3g", zeitInc, L, D); 
+      if (GTV.phi) sim_printf(sim, " %8.3f %8.3f %3g", sim->zeitInc, sim->L, sim->D); 
 
-      if (GTV.verbose) printf(" %4d _ %d", top, lmin);
-      if (found_stop) printf(" X%d\n", found_stop);/* found a stop structure */
-      else printf(" O\n"); /* time for simulation is exceeded */
+      if (GTV.verbose) sim_printf(sim, " %4d _ %d", sim->top, sim->lmin);
+      if (found_stop) sim_printf(sim, " X%d\n", found_stop);/* found a stop structure */
+      else sim_printf(sim, " O\n"); /* time for simulation is exceeded */
 
       /* laplace stuff */
-      if (GTV.phi) printf("Curvature fluctuation sigma = %7.5f\n", sigma);
+      if (GTV.phi) sim_printf(sim, "Curvature fluctuation sigma = %7.5f\n", sigma);
 
       fflush(stdout);
     }
 
     /* this goes to log */
-    fprintf(logFP, "(%5hu %5hu %5hu)", GAV.subi[0], GAV.subi[1], GAV.subi[2]);
+    sim_log(sim, "(%5hu %5hu %5hu)", sim->subi[0], sim->subi[1], sim->subi[2]);
     /* comment log steps of simulation as well !!! %6.2f  round */
     if ( found_stop ) {
-      fprintf(logFP," X%02d %12.3f", found_stop, Zeit);
+      sim_log(sim, " X%02d %12.3f", found_stop, sim->Zeit);
 
       /* laplace stuff */
-      if (GTV.phi) fprintf(logFP, " %3g %7.5f", GSV.phi, sigma);
+      if (GTV.phi) sim_log(sim, " %3g %7.5f", GSV.phi, sigma);
 
-      fprintf(logFP,"\n");
+      sim_log(sim, "\n");
     }
     else {
-      fprintf(logFP," O   %12.3f", Zeit);
+      sim_log(sim, " O   %12.3f", sim->Zeit);
 
       /* laplace stuff */
-      if (GTV.phi) fprintf(logFP, " %3g %7.5f", GSV.phi, sigma);      
+      if (GTV.phi) sim_log(sim, " %3g %7.5f", GSV.phi, sigma);      
 
-      fprintf(logFP," %d %s\n", lmin, costring(GAV.currform));
+      sim_log(sim, " %d %s\n", sim->lmin, costring(sim, sim->currform));
     }
-    fflush(logFP);
+    fflush(sim->logFP);
 
     /* set random number for next round */
-    GAV.subi[0] = xsubi[0];
-    GAV.subi[1] = xsubi[1];
-    GAV.subi[2] = xsubi[2];
+    sim->subi[0] = sim->xsubi[0];
+    sim->subi[1] = sim->xsubi[1];
+    sim->subi[2] = sim->xsubi[2];
     
-    Zeit = 0.0;
+    sim->Zeit = 0.0;
 
     /* reset laplace stuff for next trajectory */
-    sumT = 0.0;
-    sumK = 0.0;
-    sumKK = 0.0;
-    sumD = 0.0;
-    L = 0.0;
-    D = 0.0;
+    sim->sumT = 0.0;
+    sim->sumK = 0.0;
+    sim->sumKK = 0.0;
+    sim->sumD = 0.0;
+    sim->L = 0.0;
+    sim->D = 0.0;
     
     /*  highestE = OhighestE = -1000.0; */
-    reset_nbList();
-    costring(NULL);
+    reset_nbList(sim);
+    costring(sim, NULL);
     return(1);
   }
   else {
     /* continue simulation */
     int flag = 0;
-    if( (!GTV.silent) && (GSV.currE <= GSV.stopE+GSV.cut) ) {
+    if( (!GTV.silent) && (sim->currE <= GSV.stopE+GSV.cut) ) {
 
-      if (!GTV.lmin || (lmin==1 && strcmp(GAV.prevform, GAV.currform) != 0)) {
+      if (!GTV.lmin || (sim->lmin==1 && strcmp(sim->prevform, sim->currform) != 0)) {
 	char format[64];
 	flag = 1;
 	sprintf(format, "%%-%ds %%6.2f %%10.3f", strlen(GAV.farbe_full)+1);
-	printf(format, costring(GAV.currform), GSV.currE, Zeit);
+	sim_printf(sim, format, costring(sim, sim->currform), sim->currE, sim->Zeit);
       }
 
       /* laplace stuff */
       if (GTV.phi) {
-	printf(" %8.3f %8.3f %3g", zeitInc, L, D);
-	L = D = 0.0; /* reset L and D for next structure */
+	sim_printf(sim, " %8.3f %8.3f %3g", sim->zeitInc, sim->L, sim->D);
+	sim->L = sim->D = 0.0; /* reset L and D for next structure */
       }
 
       if ( flag && GTV.verbose ) {
 	int ii, jj;
 	if (next<0) trans='g'; /* growth */
 	else {
-	  ii = neighbor_list[2*next];
-	  jj = neighbor_list[2*next+1];
-	  if (abs(ii) < GSV.len) {
+	  ii = sim->neighbor_list[2*next];
+	  jj = sim->neighbor_list[2*next+1];
+	  if (abs(ii) < sim->len) {
 	    if ((ii > 0) && (jj > 0)) trans = 'i';
 	    else if ((ii < 0) && (jj < 0)) trans = 'd';
 	    else if ((ii > 0) && (jj < 0)) trans = 's';
@@ -341,113 +358,114 @@ int sel_nb(void) {
 	    else trans = 'D';
 	  }
 	}
-	printf(" %4d %c %d", top, trans, lmin);
+	sim_printf(sim, " %4d %c %d", sim->top, trans, sim->lmin);
       }
-      if (flag) printf("\n");
+      if (flag) sim_printf(sim, "\n");
     }
   }
 
 
   /* store last lmin seen, so we can avoid printing the same lmin twice */
-  if (lmin==1)
-    strcpy(GAV.prevform, GAV.currform);
+  if (sim->lmin==1)
+    strcpy(sim->prevform, sim->currform);
 
 #if 0
-  if (lmin==1) {
+  if (sim->lmin==1) {
     /* went back to previous lmin */
-    if (strcmp(GAV.prevform, GAV.currform) == 0) {
+    if (strcmp(sim->prevform, sim->currform) == 0) {
       if (OhighestE < highestE) {
 	highestE = OhighestE;  /* delete loop */
 	strcpy(highestS, OhighestS);
       }
     } else {
-      strcpy(GAV.prevform, GAV.currform);
+      strcpy(sim->prevform, sim->currform);
       OhighestE = 10000.;
     }
   }
 
-  if ( strcmp(GAV.currform, GAV.startform)==0 ) {
+  if ( strcmp(sim->currform, sim->startform)==0 ) {
     OhighestE = highestE = -1000.;
     highestS[0] = 0;
   }
 
   /* log highes energy */
-  if (GSV.currE > highestE) {
+  if (sim->currE > highestE) {
     OhighestE = highestE;
-    highestE = GSV.currE;
+    highestE = sim->currE;
     strcpy(OhighestS, highestS);
-    strcpy(highestS, GAV.currform);
+    strcpy(highestS, sim->currform);
   }
 #endif
 
-  if (next>=0) update_tree(neighbor_list[2*next], neighbor_list[2*next+1]);
+  if (next>=0) update_tree(sim, sim->neighbor_list[2*next], sim->neighbor_list[2*next+1]);
   else {
-    clean_up_rl(); ini_or_reset_rl();
+    clean_up_rl(sim); ini_or_reset_rl(sim);
   }
 
-  reset_nbList();
+  reset_nbList(sim);
   return(0);
 }
 
 /*==========================*/
-static void reset_nbList(void) {
+static void reset_nbList(SimState *sim) {
 
-  top = 0;
-  totalflux = 0.0;
+  sim->top = 0;
+  sim->totalflux = 0.0;
   /*    meanE = 0.0; */
-  lmin = 1;
+  sim->lmin = 1;
 }
 
 /*======================*/
-void clean_up_nbList(void){
-
-  free(neighbor_list);
-  free(bmf);
-  free(energies);
-  fprintf(logFP,"\n");
-  fclose(logFP);
+void clean_up_nbList(SimState *sim){
+
+  free(sim->neighbor_list);
+  free(sim->bmf);
+  free(sim->energies);
+  free(sim->costr);
+  free(sim->out);
+  free(sim->log);
 }
 
 /*======================*/
-static void grow_chain(void){
+static void grow_chain(SimState *sim){
   int newl;
   /* note Zeit=0 corresponds to chain length GSV.glen */
-  if (Zeit<(GSV.len+1-GSV.glen) * GSV.grow) return;
-  newl = GSV.len+1;
-  Zeit = (newl-GSV.glen) * GSV.grow;
-  top=0; /* prevent structure move in sel_nb */
-
-  if (GSV.len<newl) {
-    strncpy(GAV.farbe, GAV.farbe_full, newl);
-    GAV.farbe[newl] = '\0';
-    strcpy(GAV.startform, GAV.currform);
-    strcat(GAV.startform, ".");
-
-    GSV.len = newl;
+  if (sim->Zeit<(sim->len+1-GSV.glen) * GSV.grow) return;
+  newl = sim->len+1;
+  sim->Zeit = (newl-GSV.glen) * GSV.grow;
+  sim->top=0; /* prevent structure move in sel_nb */
+
+  if (sim->len<newl) {
+    strncpy(sim->farbe, GAV.farbe_full, newl);
+    sim->farbe[newl] = '\0';
+    strcpy(sim->startform, sim->currform);
+    strcat(sim->startform, ".");
+
+    sim->len = newl;
 #if HAVE_LIBRNA_API3
-    /* fake actual length of sequence in GAV.vc */
-    GAV.vc->length = newl;
+    /* fake actual length of sequence in sim->vc */
+    sim->vc->length = newl;
 #endif
   }
 }
 
-static const char *costring(const char *str) {
-  static char* buffer=NULL;
-  static int size=0;
+static const char *costring(SimState *sim, const char *str) {
+  char *buffer;
   int n;
   if (str==NULL) {
-    if (buffer) {
+    if (sim->costr) {
       /* make it possible to free buffer */
-      free(buffer);
-      size = 0; buffer = NULL;
+      free(sim->costr);
+      sim->costr_size = 0; sim->costr = NULL;
     }
     return NULL;
   }
   n=strlen(str);
-  if (n>=size) {
-    size = n+2;
-    buffer = realloc(buffer, size);
+  if (n>=sim->costr_size) {
+    sim->costr_size = n+2;
+    sim->costr = realloc(sim->costr, sim->costr_size);
   }
+  buffer = sim->costr;
   if ((cut_point>0)&&(cut_point<=n)) {
     strncpy(buffer, str, cut_point-1);
     buffer[cut_point-1] = '&';
@@ -458,3 +476,71 @@ static const char *costring(const char *str) {
   }
   return buffer;
 }
+
+/*
+  random numbers from the trajectory's own stream. Without erand48(),
+  use the same 48-bit linear congruential generator, since urn() would
+  draw from the global state and ignore the seed of the trajectory
+*/
+static double sim_urn(SimState *sim) {
+#ifdef HAVE_ERAND48
+  return erand48(sim->xsubi);
+#else
+  uint64_t x;
+
+  x = (uint64_t)sim->xsubi[0]
+      | ((uint64_t)sim->xsubi[1] << 16)
+      | ((uint64_t)sim->xsubi[2] << 32);
+  x = (x * 0x5DEECE66DULL + 0xBULL) & 0xFFFFFFFFFFFFULL;
+
+  sim->xsubi[0] = (unsigned short)(x & 0xFFFF);
+  sim->xsubi[1] = (unsigned short)((x >> 16) & 0xFFFF);
+  sim->xsubi[2] = (unsigned short)((x >> 32) & 0xFFFF);
+
+  return (double)x / 281474976710656.0; /* 2^48 */
+#endif
+}
+
+/* print to stdout, or to the output buffer of the trajectory */
+static void sim_printf(SimState *sim, const char *fmt, ...) {
+  va_list args;
+
+  va_start(args, fmt);
+  if (sim->buffered)
+    append_output(&sim->out, &sim->out_len, &sim->out_size, fmt, args);
+  else
+    vfprintf(stdout, fmt, args);
+  va_end(args);
+}
+
+/* print to log-file, or to the log buffer of the trajectory */
+static void sim_log(SimState *sim, const char *fmt, ...) {
+  va_list args;
+
+  va_start(args, fmt);
+  if (sim->buffered)
+    append_output(&sim->log, &sim->log_len, &sim->log_size, fmt, args);
+  else
+    vfprintf(sim->logFP, fmt, args);
+  va_end(args);
+}
+
+/**/
+static void append_output(char **buf, size_t *len, size_t *size,
+                          const char *fmt, va_list args) {
+  va_list copy;
+  int n;
+
+  va_copy(copy, args);
+  n = vsnprintf(NULL, 0, fmt, copy);
+  va_end(copy);
+  if (n < 0) return;
+
+  if (*len + n + 1 > *size) {
+    *size = 2 * (*len + n + 1);
+    *buf = (char *)realloc(*buf, *size);
+    assert(*buf != NULL);
+  }
+  vsnprintf(*buf + *len, *size - *len, fmt, args);
+  *len += n;
+}
@@ -9,13 +9,16 @@
 #ifndef NACHBAR_H
 #define NACHBAR_H
 
+#include "globals.h"
+
 /* used in baum.c */
-extern void ini_nbList(int chords);
-extern void update_nbList(int i,int j, int iE);
+extern void update_nbList(SimState *sim, int i,int j, int iE);
 
 /* used in main.c */
-extern int sel_nb(void);
-extern void clean_up_nbList(void);
-
-extern void grow_chain(void);
+extern FILE *ini_simulation(void);
+extern void clean_up_simulation(FILE *logFP);
+extern void write_output(FILE *logFP, const char *out, const char *log);
+extern void ini_nbList(SimState *sim, int chords);
+extern int sel_nb(SimState *sim);
+extern void clean_up_nbList(SimState *sim);
 #endif
@@ -18,6 +18,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>    /* #defines FLT_MAX ... */
+#include <limits.h>
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
@@ -31,6 +32,10 @@
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/part_func_window.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -78,6 +83,33 @@ typedef void (add_QI5)(FLT_OR_DBL **,
                        FLT_OR_DBL,
                        FLT_OR_DBL);
 
+/* a buffered callback execution of a sequence block (block-parallel mode) */
+typedef struct {
+  unsigned int  type;
+  int           i;
+  int           pr_size;
+  int           max;
+  int           first;  /* index of the first buffered value in the original array */
+  size_t        offset; /* position of the first value in the value buffer (in bytes) */
+} window_event;
+
+/* a sequence block that is folded independently (block-parallel mode) */
+typedef struct {
+  int           shift;        /* start position of the block - 1 */
+  int           length;       /* length of the block */
+  int           window_size;
+  int           step_min;     /* range of iteration steps of the serial recursions */
+  int           step_max;     /* whose callback executions are reported by this block */
+
+  window_event  *events;
+  size_t        num_events;
+  size_t        max_events;
+
+  char          *values;
+  size_t        num_values;
+  size_t        max_values;
+} window_block;
+
 /*
  #################################
  # PRIVATE VARIABLES             #
@@ -243,6 +275,42 @@ sc_dummy(vrna_fold_compound_t *vc,
          int                  l);
 
 
+#ifdef _OPENMP
+
+PRIVATE int
+probs_window_blocks(vrna_fold_compound_t        *vc,
+                    int                         ulength,
+                    unsigned int                options,
+                    vrna_probs_window_callback  *cb,
+                    void                        *data);
+
+
+PRIVATE int
+fold_block(vrna_fold_compound_t *vc,
+           int                  ulength,
+           unsigned int         options,
+           window_block         *block,
+           int                  start,
+           int                  end);
+
+
+PRIVATE void
+block_callback(FLT_OR_DBL   *pr,
+               int          pr_size,
+               int          i,
+               int          max,
+               unsigned int type,
+               void         *data);
+
+
+PRIVATE void
+replay_block(window_block               *block,
+             vrna_probs_window_callback *cb,
+             void                       *data);
+
+
+#endif
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -702,6 +770,16 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
   n         = vc->length;
   pf_params = vc->exp_params;
   md        = &(pf_params->model_details);
+
+#ifdef _OPENMP
+  /* fold overlapping sequence blocks in parallel */
+  if (md->threads > 1) {
+    int ret = probs_window_blocks(vc, ulength, options, cb, data);
+    if (ret >= 0)
+      return ret;
+  }
+
+#endif
   matrices  = vc->exp_matrices;
   winSize   = vc->window_size;
   pairSize  = md->max_bp_span;
@@ -947,6 +1025,254 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
 }
 
 
+#ifdef _OPENMP
+
+/*
+ *  Split the sequence into overlapping blocks that are folded independently
+ *  and in parallel. Each block reports the callback executions of a contiguous
+ *  range of iteration steps of the serial recursions, such that replaying the
+ *  blocks in order yields exactly the same callback executions as the serial
+ *  implementation. Returns -1 if the fold compound is not suitable for this mode
+ */
+PRIVATE int
+probs_window_blocks(vrna_fold_compound_t        *vc,
+                    int                         ulength,
+                    unsigned int                options,
+                    vrna_probs_window_callback  *cb,
+                    void                        *data)
+{
+  int n, b, threads, winSize, ext, overlap_5, overlap_3, block_size, num_blocks, failed;
+
+  n       = (int)vc->length;
+  winSize = vc->window_size;
+  threads = MIN2(vc->exp_params->model_details.threads, omp_get_num_procs());
+
+  /*
+   *  we cannot assume that user-defined callbacks or soft constraints are
+   *  thread-safe, and stacking probabilities are computed from matrix rows
+   *  that are already partially rotated in the serial recursions
+   */
+  if ((threads < 2) ||
+      (options & VRNA_PROBS_WINDOW_STACKP) ||
+      (vc->type != VRNA_FC_TYPE_SINGLE) ||
+      (vc->strands > 1) ||
+      (vc->hc->f) ||
+      (vc->hc->depot) ||
+      (vc->sc) ||
+      (vc->stat_cb) ||
+      (vc->domains_up) ||
+      (vc->aux_grammar))
+    return -1;
+
+  ext = ((options & VRNA_PROBS_WINDOW_UP) && (ulength > MAXLOOP)) ? ulength : MAXLOOP;
+
+  /*
+   *  Callbacks executed in iteration step j report data for positions
+   *  of at least j - 2 * winSize - MAXLOOP - 1, which in turn depends on
+   *  at most winSize + ext further nucleotides upstream. Downstream, all
+   *  data of step j depends on nucleotides up to j + winSize + ext. We add
+   *  some safety margin on both sides
+   */
+  overlap_5   = 4 * winSize + 2 * ext + 4;
+  overlap_3   = winSize + ext + 2;
+  block_size  = MAX2(8 * (overlap_5 + overlap_3),
+                     MIN2(n / (4 * threads) + 1, 32768));
+  num_blocks  = (n + block_size - 1) / block_size;
+
+  if (num_blocks < 2)
+    return -1;
+
+  failed = 0;
+
+#pragma omp parallel for ordered schedule(dynamic, 1) num_threads(threads)
+  for (b = 0; b < num_blocks; b++) {
+    int           start, end, ret;
+    window_block  block;
+
+    memset(&block, 0, sizeof(window_block));
+
+    block.step_min  = (b == 0) ? INT_MIN : 1 + b * block_size;
+    block.step_max  = (b == num_blocks - 1) ? INT_MAX : 1 + (b + 1) * block_size;
+
+    start = (b == 0) ? 1 : MAX2(1, block.step_min - overlap_5);
+    end   = (b == num_blocks - 1) ? n : MIN2(n, block.step_max - 1 + overlap_3);
+    ret   = fold_block(vc, ulength, options, &block, start, end);
+
+#pragma omp ordered
+    {
+      if (!ret)
+        failed = 1;
+
+      /* report the blocks in order, and stop reporting at the first failure */
+      if (!failed)
+        replay_block(&block, cb, data);
+    }
+
+    free(block.events);
+    free(block.values);
+  }
+
+  return (failed) ? 0 : 1;
+}
+
+
+PRIVATE int
+fold_block(vrna_fold_compound_t *vc,
+           int                  ulength,
+           unsigned int         options,
+           window_block         *block,
+           int                  start,
+           int                  end)
+{
+  char                  *sequence;
+  int                   ret;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  block->shift        = start - 1;
+  block->length       = end - start + 1;
+  block->window_size  = vc->window_size;
+
+  sequence = (char *)vrna_alloc(sizeof(char) * (block->length + 1));
+  memcpy(sequence, vc->sequence + start - 1, sizeof(char) * block->length);
+
+  vrna_md_copy(&md, &(vc->params->model_details));
+  md.threads = 1;
+
+  fc = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW);
+
+  /* use exactly the same Boltzmann factors, including the scaling factor */
+  vrna_exp_params_subst(fc, vc->exp_params);
+  fc->exp_params->model_details.threads = 1;
+
+  ret = vrna_probs_window(fc, ulength, options, &block_callback, (void *)block);
+
+  vrna_fold_compound_free(fc);
+  free(sequence);
+
+  return ret;
+}
+
+
+PRIVATE void
+block_callback(FLT_OR_DBL   *pr,
+               int          pr_size,
+               int          i,
+               int          max,
+               unsigned int type,
+               void         *data)
+{
+  int           step, first, num;
+  size_t        size, offset;
+  window_block  *block;
+  window_event  *e;
+
+  block = (window_block *)data;
+
+  /* determine the iteration step of the serial recursions and the data range */
+  if (type & VRNA_PROBS_WINDOW_PF) {
+    step  = pr_size;
+    first = i;
+    num   = pr_size - i + 1;
+    size  = sizeof(double);
+  } else if (type & VRNA_PROBS_WINDOW_UP) {
+    step  = i + block->window_size + MAXLOOP + 1;
+    first = 0;
+    num   = pr_size + 1;
+    size  = sizeof(double);
+  } else if (type & VRNA_PROBS_WINDOW_BPP) {
+    step  = i + 2 * block->window_size + MAXLOOP + 1;
+    first = i;
+    num   = pr_size - i + 1;
+    size  = sizeof(FLT_OR_DBL);
+  } else {
+    return;
+  }
+
+  step += block->shift;
+
+  if ((step < block->step_min) ||
+      (step >= block->step_max))
+    return;
+
+  if (block->num_events == block->max_events) {
+    block->max_events = 1.4 * block->max_events + 1024;
+    block->events     = (window_event *)vrna_realloc(block->events,
+                                                     sizeof(window_event) * block->max_events);
+  }
+
+  /* keep values aligned */
+  offset = (block->num_values + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+
+  if (offset + num * size > block->max_values) {
+    block->max_values = 1.4 * (offset + num * size) + 65536;
+    block->values     = (char *)vrna_realloc(block->values,
+                                             sizeof(char) * block->max_values);
+  }
+
+  memcpy(block->values + offset, (char *)pr + first * size, num * size);
+
+  block->num_values = offset + num * size;
+
+  e           = block->events + block->num_events++;
+  e->type     = type;
+  e->i        = i + block->shift;
+  e->max      = max;
+  e->offset   = offset;
+  e->pr_size  = (type & (VRNA_PROBS_WINDOW_PF | VRNA_PROBS_WINDOW_BPP)) ?
+                pr_size + block->shift :
+                pr_size;
+  e->first    = (type & VRNA_PROBS_WINDOW_UP) ?
+                first :
+                first + block->shift;
+}
+
+
+/*
+ *  Execute the buffered callbacks of a block. The callbacks address their
+ *  data by sequence position, so the values of each execution are copied
+ *  to their positions first..pr_size of a scratch array
+ */
+PRIVATE void
+replay_block(window_block               *block,
+             vrna_probs_window_callback *cb,
+             void                       *data)
+{
+  char          *scratch;
+  size_t        k, size, scratch_size, num;
+  window_event  *e;
+
+  scratch       = NULL;
+  scratch_size  = 0;
+
+  for (k = 0; k < block->num_events; k++) {
+    e     = block->events + k;
+    size  = (e->type & (VRNA_PROBS_WINDOW_PF | VRNA_PROBS_WINDOW_UP)) ?
+            sizeof(double) :
+            sizeof(FLT_OR_DBL);
+    num   = (size_t)(e->pr_size - e->first + 1);
+
+    if ((size_t)(e->pr_size + 1) * size > scratch_size) {
+      scratch_size  = (size_t)(e->pr_size + 1) * size;
+      scratch       = (char *)vrna_realloc(scratch, sizeof(char) * scratch_size);
+    }
+
+    memcpy(scratch + e->first * size, block->values + e->offset, num * size);
+
+    cb((FLT_OR_DBL *)scratch,
+       e->pr_size,
+       e->i,
+       e->max,
+       e->type,
+       data);
+  }
+
+  free(scratch);
+}
+
+
+#endif
+
 PRIVATE FLT_OR_DBL
 sc_contribution(vrna_fold_compound_t  *vc,
                 int                   i,
@@ -11,10 +11,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <float.h>
 #include <math.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
@@ -40,15 +45,24 @@
 #ifdef VRNA_NR_SAMPLING_HASH
 # define NR_NODE tr_node
 # define NR_TOTAL_WEIGHT(a) total_weight_par(a)
-# define NR_TOTAL_WEIGHT_TYPE(a, b) total_weight_par_type(a, b)
+# define NR_TOTAL_WEIGHT_TYPE(m, a, b) total_weight_par_type(a, b)
 # define NR_GET_WEIGHT(a, b, c, d, e)  tr_node_weight(a, c, d, e)
 #else
 # define NR_NODE tllr_node
 # define NR_TOTAL_WEIGHT(a) get_weight_all(a)
-# define NR_TOTAL_WEIGHT_TYPE(a, b) get_weight_type_spec(a, b)
+# define NR_TOTAL_WEIGHT_TYPE(m, a, b) get_weight_type_spec(m, a, b)
 # define NR_GET_WEIGHT(a, b, c, d, e)  get_weight(b, c, d, e)
 #endif
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/* increment of the SplitMix64 generator (golden ratio) */
+#define RNG_GAMMA 0x9E3779B97F4A7C15ULL
+
 
 /* combination of soft constraint wrappers */
 struct sc_wrappers {
@@ -69,6 +83,23 @@ struct vrna_pbacktrack_memory_s {
   struct nr_memory  *memory_dat;
 };
 
+/*
+ * Seeded random numbers for stochastic backtracking attached to a fold compound.
+ * Each sample obtains its own stream, derived from the seed and the running
+ * number of the sample, such that the result neither depends on the number
+ * of threads nor on how samples are distributed among them.
+ */
+struct vrna_pbacktrack_rng_s {
+  uint64_t  seed;
+  uint64_t  count;  /* number of samples drawn with this seed so far */
+};
+
+/* counter-based random number stream of a single sample */
+struct sample_rng {
+  uint64_t  key;
+  uint64_t  counter;
+};
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -121,13 +152,60 @@ PRIVATE void
 sc_free(struct sc_wrappers *sc_wrap);
 
 
+PRIVATE INLINE uint64_t
+rng_mix(uint64_t z);
+
+
+PRIVATE INLINE struct sample_rng *
+sample_rng_init(vrna_fold_compound_t  *fc,
+                unsigned int          num,
+                struct sample_rng     *rng);
+
+
+PRIVATE INLINE double
+sample_urn(struct sample_rng *rng);
+
+
 PRIVATE unsigned int
 wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      length,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem);
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                unsigned int                      options);
+
+
+#ifdef _OPENMP
+
+PRIVATE unsigned int
+wrap_pbacktrack_parallel(vrna_fold_compound_t             *vc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         int                              threads);
+
+
+#if !defined(VRNA_NR_SAMPLING_HASH) && !defined(VRNA_NR_SAMPLING_MPFR)
+
+PRIVATE unsigned int
+wrap_pbacktrack_nr_parallel(vrna_fold_compound_t              *vc,
+                            unsigned int                      length,
+                            unsigned int                      num_samples,
+                            vrna_boltzmann_sampling_callback  *bs_cb,
+                            void                              *data,
+                            struct vrna_pbacktrack_memory_s   *nr_mem,
+                            int                               threads);
+
+
+#endif
+
+PRIVATE INLINE int
+parallel_compatible(vrna_fold_compound_t *fc);
+
+
+#endif
 
 
 PRIVATE int
@@ -136,7 +214,8 @@ backtrack(int                             i,
           char                            *pstruc,
           vrna_fold_compound_t            *vc,
           struct sc_wrappers              *sc_wrap,
-          struct vrna_pbacktrack_memory_s *nr_mem);
+          struct vrna_pbacktrack_memory_s *nr_mem,
+          struct sample_rng               *rng);
 
 
 PRIVATE int
@@ -145,7 +224,8 @@ backtrack_ext_loop(int                              init_val,
                    vrna_fold_compound_t             *vc,
                    int                              length,
                    struct sc_wrappers               *sc_wrap,
-                   struct vrna_pbacktrack_memory_s  *nr_mem);
+                   struct vrna_pbacktrack_memory_s  *nr_mem,
+                   struct sample_rng                *rng);
 
 
 PRIVATE int
@@ -154,7 +234,8 @@ backtrack_qm(int                              i,
              char                             *pstruc,
              vrna_fold_compound_t             *vc,
              struct sc_wrappers               *sc_wrap,
-             struct vrna_pbacktrack_memory_s  *nr_mem);
+             struct vrna_pbacktrack_memory_s  *nr_mem,
+             struct sample_rng                *rng);
 
 
 PRIVATE int
@@ -163,7 +244,8 @@ backtrack_qm1(int                             i,
               char                            *pstruc,
               vrna_fold_compound_t            *vc,
               struct sc_wrappers              *sc_wrap,
-              struct vrna_pbacktrack_memory_s *nr_mem);
+              struct vrna_pbacktrack_memory_s *nr_mem,
+              struct sample_rng               *rng);
 
 
 PRIVATE void
@@ -171,7 +253,8 @@ backtrack_qm2(int                   u,
               int                   n,
               char                  *pstruc,
               vrna_fold_compound_t  *vc,
-              struct sc_wrappers    *sc_wrap);
+              struct sc_wrappers    *sc_wrap,
+              struct sample_rng     *rng);
 
 
 PRIVATE unsigned int
@@ -220,7 +303,7 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
         if (*nr_mem == NULL)
           *nr_mem = nr_init(fc);
 
-        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem);
+        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem, options);
 
         /* print warning if we've aborted backtracking too early */
         if ((i > 0) && (i < num_samples)) {
@@ -237,7 +320,7 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
     } else if (fc->exp_params->model_details.circ) {
       i = pbacktrack_circ(fc, num_samples, bs_cb, data);
     } else {
-      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL);
+      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL, options);
     }
   }
 
@@ -259,6 +342,31 @@ vrna_pbacktrack_mem_free(struct vrna_pbacktrack_memory_s *s)
 }
 
 
+PUBLIC void
+vrna_pbacktrack_set_seed(vrna_fold_compound_t *fc,
+                         unsigned long long   seed)
+{
+  if (fc) {
+    if (!fc->pbacktrack_rng)
+      fc->pbacktrack_rng =
+        (struct vrna_pbacktrack_rng_s *)vrna_alloc(sizeof(struct vrna_pbacktrack_rng_s));
+
+    fc->pbacktrack_rng->seed  = (uint64_t)seed;
+    fc->pbacktrack_rng->count = 0;
+  }
+}
+
+
+PUBLIC void
+vrna_pbacktrack_unset_seed(vrna_fold_compound_t *fc)
+{
+  if (fc) {
+    free(fc->pbacktrack_rng);
+    fc->pbacktrack_rng = NULL;
+  }
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -291,23 +399,20 @@ sc_free(struct sc_wrappers *sc_wrap)
 PRIVATE struct vrna_pbacktrack_memory_s *
 nr_init(vrna_fold_compound_t *fc)
 {
-  size_t                          block_size;
-  double                          pf;
   struct vrna_pbacktrack_memory_s *s;
 
   s = (struct vrna_pbacktrack_memory_s *)vrna_alloc(
     sizeof(struct vrna_pbacktrack_memory_s));
-  pf          = fc->exp_matrices->q[fc->iindx[1] - fc->length];
-  block_size  = 5000 * sizeof(NR_NODE);
 
   s->memory_dat = NULL;
   s->q_remain   = 0;
 
 #ifdef VRNA_NR_SAMPLING_HASH
-  s->root_node = create_root(fc->length, pf);
+  s->root_node = create_root(fc->length, fc->exp_matrices->q[fc->iindx[1] - fc->length]);
 #else
-  s->memory_dat = create_nr_memory(sizeof(NR_NODE), block_size, NULL);  /* memory pre-allocation */
-  s->root_node  = create_ll_root(&(s->memory_dat), pf);
+  /* maximum weights of the nodes are determined anew for each sample */
+  s->memory_dat = create_nr_memory();
+  s->root_node  = create_ll_root(&(s->memory_dat));
 #endif
 
   s->current_node = s->root_node;
@@ -323,7 +428,8 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem)
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                unsigned int                      options)
 {
   char                *pstruc;
   unsigned int        i, n;
@@ -331,10 +437,10 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
   FLT_OR_DBL          *q1k, *qln, *q;
   vrna_mx_pf_t        *matrices;
   struct sc_wrappers  *sc_wrap;
+  struct sample_rng   rng_sample, *rng;
 
   i           = 0;
   pf_overflow = 0;
-  sc_wrap     = sc_init(vc);
 
   n         = vc->length;
   my_iindx  = vc->iindx;
@@ -356,19 +462,63 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
     qln[n + 1]  = 1.0;
   }
 
+#ifdef _OPENMP
+  /*
+   *  With seeded random number streams, the samples are independent of
+   *  each other and we may distribute them among several threads. This
+   *  does not hold for non-redundant sampling, where each sample depends
+   *  on all structures drawn before. Here, concurrent sampling must be
+   *  requested explicitly, since the resulting sample set then depends on
+   *  the timing of the threads.
+   */
+  if ((vc->pbacktrack_rng) &&
+      (num_samples > 1) &&
+      (parallel_compatible(vc))) {
+    int threads = vc->exp_params->model_details.threads;
+
+    if (threads > omp_get_num_procs())
+      threads = omp_get_num_procs();
+
+    if ((threads > 1) && (!nr_mem)) {
+      i = wrap_pbacktrack_parallel(vc, length, num_samples, bs_cb, data, threads);
+      vc->pbacktrack_rng->count += i;
+
+      return i;
+    }
+
+#if !defined(VRNA_NR_SAMPLING_HASH) && !defined(VRNA_NR_SAMPLING_MPFR)
+    if ((threads > 1) && (options & VRNA_PBACKTRACK_NR_CONCURRENT)) {
+      i = wrap_pbacktrack_nr_parallel(vc, length, num_samples, bs_cb, data, nr_mem, threads);
+      vc->pbacktrack_rng->count += i;
+
+      return i;
+    }
+
+#endif
+  }
+
+#endif
+
+  sc_wrap = sc_init(vc);
+
   for (i = 0; i < num_samples; i++) {
     is_dup  = 1;
     pstruc  = vrna_alloc((length + 1) * sizeof(char));
+    rng     = sample_rng_init(vc, i, &rng_sample);
 
     memset(pstruc, '.', sizeof(char) * length);
 
-    if (nr_mem)
+    if (nr_mem) {
       nr_mem->q_remain = vc->exp_matrices->q[vc->iindx[1] - length];
+#ifndef VRNA_NR_SAMPLING_HASH
+      nr_path_start(nr_mem->memory_dat, nr_mem->current_node, nr_mem->q_remain);
+#endif
+    }
 
 #ifdef VRNA_WITH_BOUSTROPHEDON
-    ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, nr_mem);
+    ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, nr_mem, rng);
 #else
-    ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, nr_mem);
+    ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, nr_mem, rng);
 #endif
 
     if (nr_mem) {
@@ -378,7 +528,7 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                                                &is_dup,
                                                &pf_overflow);
 #else
-      nr_mem->current_node = traceback_to_ll_root(nr_mem->current_node,
+      nr_mem->current_node = traceback_to_ll_root(nr_mem->memory_dat,
                                                   nr_mem->q_remain,
                                                   &is_dup,
                                                   &pf_overflow);
@@ -408,10 +558,285 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
 
   sc_free(sc_wrap);
 
+  if (vc->pbacktrack_rng)
+    vc->pbacktrack_rng->count += i;
+
   return i;
 }
 
 
+#ifdef _OPENMP
+
+/*
+ *  Draw num_samples structures using several threads. Each thread uses its
+ *  own soft constraint wrappers, and the callback is executed in sample
+ *  order, one sample at a time.
+ */
+PRIVATE unsigned int
+wrap_pbacktrack_parallel(vrna_fold_compound_t             *vc,
+                         unsigned int                     length,
+                         unsigned int                     num_samples,
+                         vrna_boltzmann_sampling_callback *bs_cb,
+                         void                             *data,
+                         int                              threads)
+{
+  unsigned int  i, num_done;
+
+  num_done = num_samples;
+
+#pragma omp parallel num_threads(threads) private(i)
+  {
+    char                *pstruc;
+    int                 ret;
+    struct sc_wrappers  *sc_wrap;
+    struct sample_rng   rng_sample, *rng;
+
+    sc_wrap = sc_init(vc);
+    pstruc  = vrna_alloc((length + 1) * sizeof(char));
+
+#pragma omp for ordered schedule(dynamic, 1)
+    for (i = 0; i < num_samples; i++) {
+      memset(pstruc, '.', sizeof(char) * length);
+      rng = sample_rng_init(vc, i, &rng_sample);
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+      ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, NULL, rng);
+#else
+      ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, NULL, rng);
+#endif
+
+#pragma omp ordered
+      {
+        if (i < num_done) {
+          if (ret > 0) {
+            if (bs_cb)
+              bs_cb(pstruc, data);
+          } else {
+            num_done = i;
+          }
+        }
+      }
+    }
+
+    free(pstruc);
+    sc_free(sc_wrap);
+  }
+
+  return num_done;
+}
+
+
+#if !defined(VRNA_NR_SAMPLING_HASH) && !defined(VRNA_NR_SAMPLING_MPFR)
+
+/*
+ *  Non-redundant sampling with several threads that share the tree of
+ *  structures drawn so far. Each thread walks the current state of the tree
+ *  and commits its sample afterwards. Samples that are invalidated by a
+ *  concurrent commit, i.e. duplicates or new nodes that can no longer be
+ *  linked into the tree at their position, are simply drawn again.
+ */
+PRIVATE unsigned int
+wrap_pbacktrack_nr_parallel(vrna_fold_compound_t              *vc,
+                            unsigned int                      length,
+                            unsigned int                      num_samples,
+                            vrna_boltzmann_sampling_callback  *bs_cb,
+                            void                              *data,
+                            struct vrna_pbacktrack_memory_s   *nr_mem,
+                            int                               threads)
+{
+  unsigned int  num_done, num_next;
+  int           failure;
+  double        q;
+
+  num_done  = 0;
+  num_next  = 0;
+  failure   = 0; /* 1: duplicates, 2: overflow, 3: exhausted ensemble */
+  q         = vc->exp_matrices->q[vc->iindx[1] - length];
+
+#pragma omp parallel num_threads(threads)
+  {
+    char                            *pstruc;
+    int                             ret, is_dup, pf_overflow, stop, again;
+    unsigned int                    num, version;
+    NR_NODE                         *root;
+    struct sc_wrappers              *sc_wrap;
+    struct sample_rng               rng_sample, *rng;
+    struct vrna_pbacktrack_memory_s mem;
+
+    mem             = *nr_mem;
+    mem.memory_dat  = nr_memory_attach(nr_mem->memory_dat);
+    sc_wrap         = sc_init(vc);
+    pstruc          = vrna_alloc((length + 1) * sizeof(char));
+
+    while (1) {
+#pragma omp atomic capture
+      num = num_next++;
+
+      if (num >= num_samples)
+        break;
+
+      rng = sample_rng_init(vc, num, &rng_sample);
+
+      do {
+        again = 0;
+
+#pragma omp atomic read
+        stop = failure;
+
+        if (stop)
+          break;
+
+        is_dup            = 1;
+        pf_overflow       = 0;
+        version           = nr_version(mem.memory_dat);
+        mem.q_remain      = q;
+        mem.current_node  = mem.root_node;
+
+        memset(pstruc, '.', sizeof(char) * length);
+        nr_path_start(mem.memory_dat, mem.root_node, q);
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+        ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, &mem, rng);
+#else
+        ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, &mem, rng);
+#endif
+
+        root = (ret > 0) ?
+               traceback_to_ll_root(mem.memory_dat, mem.q_remain, &is_dup, &pf_overflow) :
+               NULL;
+
+        if (!root) {
+          nr_path_discard(mem.memory_dat);
+
+          if (ret > 0) {
+            again = 1;
+          } else if (ret == 0) {
+            /* the ensemble only appears to be exhausted if someone else updated the tree meanwhile */
+            if (nr_version(mem.memory_dat) != version) {
+              again = 1;
+            } else {
+#pragma omp atomic write
+              failure = 3;
+            }
+          }
+        } else if (pf_overflow) {
+#pragma omp atomic write
+          failure = 2;
+        } else if (is_dup) {
+          if (nr_version(mem.memory_dat) != version) {
+            again = 1;
+          } else {
+#pragma omp atomic write
+            failure = 1;
+          }
+        } else {
+#pragma omp critical (pbacktrack_nr_callback)
+          {
+            if (bs_cb)
+              bs_cb(pstruc, data);
+
+            num_done++;
+          }
+        }
+      } while (again);
+    }
+
+    free(pstruc);
+    sc_free(sc_wrap);
+    nr_memory_detach(mem.memory_dat);
+  }
+
+  nr_mem->current_node = nr_mem->root_node;
+
+  if (failure == 1)
+    vrna_message_warning("vrna_pbacktrack_nr*(): %s", info_nr_duplicates);
+  else if (failure == 2)
+    vrna_message_warning("vrna_pbacktrack_nr*(): %s", info_nr_overflow);
+
+  return num_done;
+}
+
+
+#endif
+
+
+/* user-defined callbacks may not be thread-safe */
+PRIVATE INLINE int
+parallel_compatible(vrna_fold_compound_t *fc)
+{
+  unsigned int s;
+
+  if ((fc->hc->f) ||
+      (fc->aux_grammar) ||
+      (fc->domains_up))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      if ((fc->sc) && (fc->sc->exp_f))
+        return 0;
+
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      if (fc->scs)
+        for (s = 0; s < fc->n_seq; s++)
+          if ((fc->scs[s]) && (fc->scs[s]->exp_f))
+            return 0;
+
+      break;
+  }
+
+  return 1;
+}
+
+
+#endif
+
+
+/* SplitMix64 output function */
+PRIVATE INLINE uint64_t
+rng_mix(uint64_t z)
+{
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return z ^ (z >> 31);
+}
+
+
+/*
+ *  Prepare the random number stream for the num-th sample of the current
+ *  call, or return NULL if no seed is attached to the fold compound
+ */
+PRIVATE INLINE struct sample_rng *
+sample_rng_init(vrna_fold_compound_t  *fc,
+                unsigned int          num,
+                struct sample_rng     *rng)
+{
+  if (!fc->pbacktrack_rng)
+    return NULL;
+
+  rng->key      = rng_mix(rng_mix(fc->pbacktrack_rng->seed) +
+                          (fc->pbacktrack_rng->count + num + 1) * RNG_GAMMA);
+  rng->counter  = 0;
+
+  return rng;
+}
+
+
+/* uniformly distributed random number in [0, 1) */
+PRIVATE INLINE double
+sample_urn(struct sample_rng *rng)
+{
+  if (rng)
+    return (double)(rng_mix(rng->key + (++rng->counter) * RNG_GAMMA) >> 11) *
+           (1. / 9007199254740992.); /* 2^-53 */
+
+  return vrna_urn();
+}
+
+
 /* backtrack one external */
 PRIVATE int
 backtrack_ext_loop(int                              init_val,
@@ -419,7 +844,8 @@ backtrack_ext_loop(int                              init_val,
                    vrna_fold_compound_t             *vc,
                    int                              length,
                    struct sc_wrappers               *sc_wrap,
-                   struct vrna_pbacktrack_memory_s  *nr_mem)
+                   struct vrna_pbacktrack_memory_s  *nr_mem,
+                   struct sample_rng                *rng)
 {
   unsigned char             *hard_constraints;
   short                     *S1, *S2, **S, **S5, **S3;
@@ -496,10 +922,8 @@ backtrack_ext_loop(int                              init_val,
   scale = matrices->scale;
 
 #ifndef VRNA_NR_SAMPLING_HASH
-  if (current_node) {
-    memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
-  }
+  if (current_node)
+    reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node);
 
 #endif
 
@@ -525,7 +949,7 @@ backtrack_ext_loop(int                              init_val,
             return 0;
         }
 
-        r       = vrna_urn() * (q1k[j] - fbd);
+        r       = sample_urn(rng) * (q1k[j] - fbd);
         q_temp  = q1k[j - 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -553,7 +977,7 @@ backtrack_ext_loop(int                              init_val,
                                             memorized_node_cur,
                                             *current_node,
                                             *q_remain);
-          reset_cursor(&memorized_node_prev, &memorized_node_cur, *current_node); /* resets cursor */
+          reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node); /* resets cursor */
 #endif
         }
       }
@@ -563,17 +987,17 @@ backtrack_ext_loop(int                              init_val,
 
 #ifndef  VRNA_NR_SAMPLING_HASH
     if (current_node)
-      advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_UNPAIRED_SG, j - 1, j);
+      advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_UNPAIRED_SG, j - 1, j);
 
 #endif
     /* now find the pairing partner i */
     if (current_node) {
-      fbd = NR_TOTAL_WEIGHT_TYPE(NRT_EXT_LOOP, *current_node) *
+      fbd = NR_TOTAL_WEIGHT_TYPE(memory_dat, NRT_EXT_LOOP, *current_node) *
             q1k[j] /
             (*q_remain);
     }
 
-    r = vrna_urn() * (q1k[j] - q_temp - fbd);
+    r = sample_urn(rng) * (q1k[j] - q_temp - fbd);
     u = j - 1;
     i = 2;
 
@@ -640,7 +1064,7 @@ backtrack_ext_loop(int                              init_val,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_EXT_LOOP, i, j);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_EXT_LOOP, i, j);
 
 #endif
       }
@@ -656,9 +1080,9 @@ backtrack_ext_loop(int                              init_val,
       }
     }
 
-    backtrack(i, j, pstruc, vc, sc_wrap, nr_mem);
+    backtrack(i, j, pstruc, vc, sc_wrap, nr_mem, rng);
     j   = i - 1;
-    ret = backtrack_ext_loop(j, pstruc, vc, length, sc_wrap, nr_mem);
+    ret = backtrack_ext_loop(j, pstruc, vc, length, sc_wrap, nr_mem, rng);
   }
 
 #else
@@ -673,7 +1097,7 @@ backtrack_ext_loop(int                              init_val,
                 (*q_remain);
         }
 
-        r       = vrna_urn() * (qln[i] - fbd);
+        r       = sample_urn(rng) * (qln[i] - fbd);
         q_temp  = qln[i + 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -700,7 +1124,7 @@ backtrack_ext_loop(int                              init_val,
                                             memorized_node_cur,
                                             *current_node,
                                             *q_remain);
-          reset_cursor(&memorized_node_prev, &memorized_node_cur, *current_node); /* resets cursor */
+          reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node); /* resets cursor */
 #endif
         }
       }
@@ -710,18 +1134,18 @@ backtrack_ext_loop(int                              init_val,
 
 #ifndef VRNA_NR_SAMPLING_HASH
     if (current_node)
-      advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_UNPAIRED_SG, i, i + 1);
+      advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_UNPAIRED_SG, i, i + 1);
 
 #endif
 
     /* now find the pairing partner j */
     if (current_node) {
-      fbd = NR_TOTAL_WEIGHT_TYPE(NRT_EXT_LOOP, *current_node) *
+      fbd = NR_TOTAL_WEIGHT_TYPE(memory_dat, NRT_EXT_LOOP, *current_node) *
             qln[i] /
             (*q_remain);
     }
 
-    r = vrna_urn() * (qln[i] - q_temp - fbd);
+    r = sample_urn(rng) * (qln[i] - q_temp - fbd);
     for (qt = 0, j = i + 1; j <= length; j++) {
       ij            = my_iindx[i] - j;
       hc_decompose  = hard_constraints[n * i + j];
@@ -783,7 +1207,7 @@ backtrack_ext_loop(int                              init_val,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_EXT_LOOP, i, j);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_EXT_LOOP, i, j);
 
 #endif
       }
@@ -800,11 +1224,11 @@ backtrack_ext_loop(int                              init_val,
     }
 
     start = j + 1;
-    ret   = backtrack(i, j, pstruc, vc, sc_wrap, nr_mem);
+    ret   = backtrack(i, j, pstruc, vc, sc_wrap, nr_mem, rng);
     if (!ret)
       return ret;
 
-    ret = backtrack_ext_loop(start, pstruc, vc, length, sc_wrap, nr_mem);
+    ret = backtrack_ext_loop(start, pstruc, vc, length, sc_wrap, nr_mem, rng);
   }
 
 #endif
@@ -820,7 +1244,8 @@ backtrack_qm(int                              i,
              char                             *pstruc,
              vrna_fold_compound_t             *vc,
              struct sc_wrappers               *sc_wrap,
-             struct vrna_pbacktrack_memory_s  *nr_mem)
+             struct vrna_pbacktrack_memory_s  *nr_mem,
+             struct sample_rng                *rng)
 {
   /* divide multiloop into qm and qm1  */
   int                       k, u, cnt, span, turn, is_unpaired, *my_iindx, *jindx, *hc_up_ml, ret;
@@ -871,10 +1296,8 @@ backtrack_qm(int                              i,
   turn = vc->exp_params->model_details.min_loop_size;
 
 #ifndef VRNA_NR_SAMPLING_HASH
-  if (current_node) {
-    memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
-  }
+  if (current_node)
+    reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node);
 
 #endif
 
@@ -887,7 +1310,7 @@ backtrack_qm(int                              i,
             (*q_remain);
     }
 
-    r = vrna_urn() * (qm[my_iindx[i] - j] - fbd);
+    r = sample_urn(rng) * (qm[my_iindx[i] - j] - fbd);
     if (current_node) {
       fbds = NR_GET_WEIGHT(*current_node, memorized_node_cur, NRT_QM_UNPAIR, i, 0) *
              qm[my_iindx[i] - j] /
@@ -903,7 +1326,7 @@ backtrack_qm(int                              i,
     if (qmt < r) {
 #ifndef VRNA_NR_SAMPLING_HASH
       if (current_node)
-        advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_QM_UNPAIR, i, 0);
+        advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_QM_UNPAIR, i, 0);
 
 #endif
 
@@ -941,7 +1364,7 @@ backtrack_qm(int                              i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_QM_UNPAIR, k, 0);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_QM_UNPAIR, k, 0);
 
 #endif
 
@@ -966,7 +1389,7 @@ backtrack_qm(int                              i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_QM_PAIR, k, 0);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_QM_PAIR, k, 0);
 
 #endif
       }
@@ -1008,7 +1431,7 @@ backtrack_qm(int                              i,
     if (cnt > j)
       return 0;
 
-    ret = backtrack_qm1(k, j, pstruc, vc, sc_wrap, nr_mem);
+    ret = backtrack_qm1(k, j, pstruc, vc, sc_wrap, nr_mem, rng);
 
     if (ret == 0)
       return ret;
@@ -1018,7 +1441,7 @@ backtrack_qm(int                              i,
 
     if (!is_unpaired) {
       /* if we've chosen creating a branch in [i..k-1] */
-      ret = backtrack_qm(i, k - 1, pstruc, vc, sc_wrap, nr_mem);
+      ret = backtrack_qm(i, k - 1, pstruc, vc, sc_wrap, nr_mem, rng);
 
       if (ret == 0)
         return ret;
@@ -1035,7 +1458,8 @@ backtrack_qm1(int                             i,
               char                            *pstruc,
               vrna_fold_compound_t            *vc,
               struct sc_wrappers              *sc_wrap,
-              struct vrna_pbacktrack_memory_s *nr_mem)
+              struct vrna_pbacktrack_memory_s *nr_mem,
+              struct sample_rng               *rng)
 {
   /* i is paired to l, i<l<j; backtrack in qm1 to find l */
   unsigned char             *hard_constraints;
@@ -1106,10 +1530,8 @@ backtrack_qm1(int                             i,
   turn = pf_params->model_details.min_loop_size;
 
 #ifndef VRNA_NR_SAMPLING_HASH
-  if (current_node) {
-    memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
-  }
+  if (current_node)
+    reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node);
 
 #endif
 
@@ -1119,7 +1541,7 @@ backtrack_qm1(int                             i,
           (*q_remain);
   }
 
-  r   = vrna_urn() * (qm1[jindx[j] + i] - fbd);
+  r   = sample_urn(rng) * (qm1[jindx[j] + i] - fbd);
   ii  = my_iindx[i];
   for (qt = 0., l = j; l > i + turn; l--) {
     il = jindx[l] + i;
@@ -1173,7 +1595,7 @@ backtrack_qm1(int                             i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_QM1_BRANCH, i, l);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_QM1_BRANCH, i, l);
 
 #endif
       } else {
@@ -1191,7 +1613,7 @@ backtrack_qm1(int                             i,
     }
   }
 
-  return backtrack(i, l, pstruc, vc, sc_wrap, nr_mem);
+  return backtrack(i, l, pstruc, vc, sc_wrap, nr_mem, rng);
 }
 
 
@@ -1200,7 +1622,8 @@ backtrack_qm2(int                   k,
               int                   n,
               char                  *pstruc,
               vrna_fold_compound_t  *vc,
-              struct sc_wrappers    *sc_wrap)
+              struct sc_wrappers    *sc_wrap,
+              struct sample_rng     *rng)
 {
   int                       u, turn, *jindx;
   FLT_OR_DBL                qom2t, r, *qm1, *qm2;
@@ -1212,7 +1635,7 @@ backtrack_qm2(int                   k,
   turn          = vc->exp_params->model_details.min_loop_size;
   sc_wrapper_ml = &(sc_wrap->sc_wrapper_ml);
 
-  r = vrna_urn() * qm2[k];
+  r = sample_urn(rng) * qm2[k];
   /* we have to search for our barrier u between qm1 and qm1  */
   if (sc_wrapper_ml->decomp_ml) {
     for (qom2t = 0., u = k + turn + 1; u < n - turn - 1; u++) {
@@ -1234,8 +1657,8 @@ backtrack_qm2(int                   k,
   if (u == n - turn)
     vrna_message_error("backtrack failed in qm2");
 
-  backtrack_qm1(k, u, pstruc, vc, sc_wrap, NULL);
-  backtrack_qm1(u + 1, n, pstruc, vc, sc_wrap, NULL);
+  backtrack_qm1(k, u, pstruc, vc, sc_wrap, NULL, rng);
+  backtrack_qm1(u + 1, n, pstruc, vc, sc_wrap, NULL, rng);
 }
 
 
@@ -1245,7 +1668,8 @@ backtrack(int                             i,
           char                            *pstruc,
           vrna_fold_compound_t            *vc,
           struct sc_wrappers              *sc_wrap,
-          struct vrna_pbacktrack_memory_s *nr_mem)
+          struct vrna_pbacktrack_memory_s *nr_mem,
+          struct sample_rng               *rng)
 {
   unsigned char             *hard_constraints, hc_decompose;
   char                      *ptype;
@@ -1335,10 +1759,8 @@ backtrack(int                             i,
   scale     = matrices->scale;
 
 #ifndef VRNA_NR_SAMPLING_HASH
-  if (current_node) {
-    memorized_node_prev = NULL;
-    memorized_node_cur  = (*current_node)->head;
-  }
+  if (current_node)
+    reset_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, *current_node);
 
 #endif
 
@@ -1364,7 +1786,7 @@ backtrack(int                             i,
     pstruc[i - 1] = '(';
     pstruc[j - 1] = ')';
 
-    r     = vrna_urn() * (qbr - fbd);
+    r     = sample_urn(rng) * (qbr - fbd);
     qbt1  = 0.;
 
     hc_decompose = hard_constraints[n * i + j];
@@ -1406,7 +1828,7 @@ backtrack(int                             i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
     if (current_node)
-      advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_HAIRPIN, 0, 0);
+      advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_HAIRPIN, 0, 0);
 
 #endif
 
@@ -1474,7 +1896,7 @@ backtrack(int                             i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
             if (current_node)
-              advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_IT_LOOP, k, l);
+              advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_IT_LOOP, k, l);
 
 #endif
           }
@@ -1501,7 +1923,7 @@ backtrack(int                             i,
 
         free(types);
 
-        return backtrack(k, l, pstruc, vc, sc_wrap, nr_mem); /* found the interior loop, repeat for inside */
+        return backtrack(k, l, pstruc, vc, sc_wrap, nr_mem, rng); /* found the interior loop, repeat for inside */
       } else {
         /* interior loop contributions did not exceed threshold, so we break */
         break;
@@ -1564,7 +1986,7 @@ backtrack(int                             i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_MT_LOOP, k, 0);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_MT_LOOP, k, 0);
 
 #endif
       }
@@ -1590,7 +2012,7 @@ backtrack(int                             i,
 
 #ifndef VRNA_NR_SAMPLING_HASH
         if (current_node)
-          advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_MT_LOOP, k, 0);
+          advance_cursor(memory_dat, &memorized_node_prev, &memorized_node_cur, NRT_MT_LOOP, k, 0);
 
 #endif
       }
@@ -1621,7 +2043,7 @@ backtrack(int                             i,
 #endif
     }
 
-    ret = backtrack_qm1(k, j, pstruc, vc, sc_wrap, nr_mem);
+    ret = backtrack_qm1(k, j, pstruc, vc, sc_wrap, nr_mem, rng);
 
     if (ret == 0) {
       free(types);
@@ -1630,7 +2052,7 @@ backtrack(int                             i,
 
     j = k - 1;
 
-    ret = backtrack_qm(i, j, pstruc, vc, sc_wrap, nr_mem);
+    ret = backtrack_qm(i, j, pstruc, vc, sc_wrap, nr_mem, rng);
   }
 
   free(types);
@@ -1661,6 +2083,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
   struct sc_wrapper_exp_ext *sc_wrapper_ext;
   struct sc_wrapper_exp_int *sc_wrapper_int;
   struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_rng         rng_sample, *rng;
 
   n             = vc->length;
   pf_params     = vc->exp_params;
@@ -1708,7 +2131,8 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
   }
 
   for (count = 0; count < num_samples; count++) {
-    pstruc = vrna_alloc((n + 1) * sizeof(char));
+    pstruc  = vrna_alloc((n + 1) * sizeof(char));
+    rng     = sample_rng_init(vc, count, &rng_sample);
 
     /* initialize pstruct with single bases  */
     memset(pstruc, '.', sizeof(char) * n);
@@ -1719,7 +2143,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     if (sc_wrapper_ext->red_up)
       qt *= sc_wrapper_ext->red_up(1, n, sc_wrapper_ext);
 
-    r = vrna_urn() * qo;
+    r = sample_urn(rng) * qo;
 
     /* open chain? */
     if (qt > r)
@@ -1739,7 +2163,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
 
         /* found a hairpin? so backtrack in the enclosed part and we're done  */
         if (qt > r) {
-          backtrack(i, j, pstruc, vc, sc_wrap, NULL);
+          backtrack(i, j, pstruc, vc, sc_wrap, NULL, rng);
           goto pbacktrack_circ_loop_end;
         }
 
@@ -1821,8 +2245,8 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
                  * forward and backtracking the both enclosed parts and we're done
                  */
                 if (qt > r) {
-                  backtrack(i, j, pstruc, vc, sc_wrap, NULL);
-                  backtrack(k, l, pstruc, vc, sc_wrap, NULL);
+                  backtrack(i, j, pstruc, vc, sc_wrap, NULL, rng);
+                  backtrack(k, l, pstruc, vc, sc_wrap, NULL, rng);
                   goto pbacktrack_circ_loop_end;
                 }
               }
@@ -1834,7 +2258,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     {
       /* as we reach this part, we have to search for our barrier between qm and qm2  */
       qt  = 0.;
-      r   = vrna_urn() * qmo;
+      r   = sample_urn(rng) * qmo;
       if (sc_wrapper_ml->decomp_ml) {
         for (k = turn + 2; k < n - 2 * turn - 3; k++) {
           qt += qm[my_iindx[1] - k] *
@@ -1849,8 +2273,8 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
 
           /* backtrack in qm and qm2 if we've found a valid barrier k  */
           if (qt > r) {
-            backtrack_qm(1, k, pstruc, vc, sc_wrap, NULL);
-            backtrack_qm2(k + 1, n, pstruc, vc, sc_wrap);
+            backtrack_qm(1, k, pstruc, vc, sc_wrap, NULL, rng);
+            backtrack_qm2(k + 1, n, pstruc, vc, sc_wrap, rng);
             goto pbacktrack_circ_loop_end;
           }
         }
@@ -1861,8 +2285,8 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
                 expMLclosing;
           /* backtrack in qm and qm2 if we've found a valid barrier k  */
           if (qt > r) {
-            backtrack_qm(1, k, pstruc, vc, sc_wrap, NULL);
-            backtrack_qm2(k + 1, n, pstruc, vc, sc_wrap);
+            backtrack_qm(1, k, pstruc, vc, sc_wrap, NULL, rng);
+            backtrack_qm2(k + 1, n, pstruc, vc, sc_wrap, rng);
             goto pbacktrack_circ_loop_end;
           }
         }
@@ -1884,5 +2308,8 @@ pbacktrack_circ_loop_end:
 
   sc_free(sc_wrap);
 
+  if (vc->pbacktrack_rng)
+    vc->pbacktrack_rng->count += count;
+
   return count;
 }
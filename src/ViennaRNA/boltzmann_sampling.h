@@ -39,6 +39,23 @@
  */
 #define VRNA_PBACKTRACK_NON_REDUNDANT   1
 
+/**
+ *  @brief  Boltzmann sampling flag that allows for concurrent non-redundant backtracing
+ *
+ *  In combination with #VRNA_PBACKTRACK_NON_REDUNDANT, this flag distributes the
+ *  samples among vrna_md_t.threads threads that share the memory of structures drawn
+ *  so far. This requires seeded random numbers, see vrna_pbacktrack_set_seed(), and
+ *  is ignored otherwise.
+ *
+ *  @warning  Each non-redundant sample depends on all structures drawn before. With
+ *            concurrent threads, the resulting sample set therefore depends on their
+ *            timing and is @b not reproducible, even for the same seed.
+ *
+ *  @see    #VRNA_PBACKTRACK_NON_REDUNDANT, vrna_pbacktrack_set_seed(),
+ *          vrna_pbacktrack5_resume_cb(), vrna_pbacktrack_resume_cb()
+ */
+#define VRNA_PBACKTRACK_NR_CONCURRENT   2
+
 /**
  *  @brief  Callback for Boltzmann sampling
  *
@@ -693,6 +710,47 @@ void
 vrna_pbacktrack_mem_free(vrna_pbacktrack_mem_t s);
 
 
+/**
+ *  @brief  Use reproducible, seeded random numbers for stochastic backtracking
+ *
+ *  After calling this function, all subsequent Boltzmann sampling calls for @p fc
+ *  draw their random numbers from an independent stream per sample that is derived
+ *  from @p seed and the running number of the sample. The sample set therefore only
+ *  depends on @p seed and the number of samples drawn so far, i.e. drawing 2x10
+ *  structures yields the same structures as drawing 20 at once.
+ *
+ *  Moreover, since the samples no longer share a random number generator, regular
+ *  (#VRNA_PBACKTRACK_DEFAULT) sampling distributes the samples among
+ *  vrna_md_t.threads threads if the library was compiled with OpenMP support. The
+ *  structures are still passed to the callback (or stored) in the same order as for
+ *  a single thread. Non-redundant sampling is processed sequentially to keep its
+ *  results reproducible, unless concurrent threads are explicitly requested via
+ *  #VRNA_PBACKTRACK_NR_CONCURRENT. Sampling for circular RNAs, and fold compounds
+ *  with user-defined (soft constraint) callbacks are always processed sequentially.
+ *
+ *  Calling this function again resets the sample counter.
+ *
+ *  @see  vrna_pbacktrack_unset_seed(), vrna_pbacktrack_num(), vrna_pbacktrack_cb()
+ *
+ *  @param  fc    The fold compound data structure
+ *  @param  seed  The seed of the random number streams
+ */
+void
+vrna_pbacktrack_set_seed(vrna_fold_compound_t *fc,
+                         unsigned long long   seed);
+
+
+/**
+ *  @brief  Switch back to the global random number generator for stochastic backtracking
+ *
+ *  @see  vrna_pbacktrack_set_seed(), vrna_init_rand()
+ *
+ *  @param  fc    The fold compound data structure
+ */
+void
+vrna_pbacktrack_unset_seed(vrna_fold_compound_t *fc);
+
+
 /**@}*/
 
 
@@ -277,6 +277,47 @@ vrna_sc_prepare(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC int
+vrna_sc_rescale(vrna_fold_compound_t *vc)
+{
+  unsigned int  s;
+  int           ret;
+
+  ret = 1;
+
+  if (vc) {
+    switch (vc->type) {
+      case VRNA_FC_TYPE_SINGLE:
+        if (vc->sc)
+          vc->sc->state |= STATE_DIRTY_UP_PF | STATE_DIRTY_BP_PF;
+
+        break;
+
+      case VRNA_FC_TYPE_COMPARATIVE:
+        /*
+         *  Boltzmann weighted stacking pseudo-energies are re-computed from
+         *  energy_stack by each vrna_sc_prepare() anyway. Boltzmann factors
+         *  for unpaired and paired positions, however, are provided as such,
+         *  so there is nothing we could re-compute them from
+         */
+        if (vc->scs)
+          for (s = 0; s < vc->n_seq; s++)
+            if ((vc->scs[s]) &&
+                ((vc->scs[s]->exp_energy_up) ||
+                 (vc->scs[s]->exp_energy_bp)))
+              ret = 0;
+
+        break;
+
+      default:                      /* do nothing */
+        break;
+    }
+  }
+
+  return ret;
+}
+
+
 PUBLIC void
 vrna_sc_update(vrna_fold_compound_t *vc,
                unsigned int         i,
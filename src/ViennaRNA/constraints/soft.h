@@ -258,6 +258,29 @@ vrna_sc_update(vrna_fold_compound_t *vc,
                unsigned int         options);
 
 
+/**
+ *  @brief  Mark the Boltzmann factors of soft constraints for re-computation
+ *
+ *  Use this function whenever the Boltzmann factors of the fold compound change,
+ *  e.g. due to a different temperature. The Boltzmann weighted soft constraints
+ *  are then re-computed upon the next call to vrna_sc_prepare().
+ *
+ *  For comparative fold compounds, only the Boltzmann weighted stacking
+ *  pseudo-energies, e.g. from SHAPE reactivity data, can be re-computed. Any
+ *  Boltzmann factors for unpaired or paired positions of the individual
+ *  sequences are kept as they are, and this function returns 0.
+ *
+ *  @ingroup  soft_constraints
+ *
+ *  @see  vrna_fold_compound_set_temperature(), vrna_sc_prepare()
+ *
+ *  @param  vc  The #vrna_fold_compound_t the soft constraints are associated with
+ *  @return     1 if all Boltzmann weighted soft constraints will be re-computed, 0 otherwise
+ */
+int
+vrna_sc_rescale(vrna_fold_compound_t *vc);
+
+
 /**
  *  @brief  Set soft constraints for paired nucleotides
  *
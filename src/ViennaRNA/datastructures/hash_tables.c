@@ -5,16 +5,44 @@
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/datastructures/hash_tables.h"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  The hash table is implemented as open-addressing table with linear
+ *  probing and Robin Hood replacement. Each slot stores the entry together
+ *  with its (full range) hash value, such that neither look-ups nor
+ *  re-hashing upon growth of the table need to call the hash function or
+ *  the comparison function for entries with different hash values.
+ */
+
+/* hash values are requested from the hash function for this virtual table size */
+#define HT_HASH_RANGE       UINT_MAX
+
+/* maximum load factor of 3/4 before the table grows */
+#define HT_MAX_LOAD(size)   (((size) >> 1) + ((size) >> 2))
+
+#define HT_NOT_FOUND        ULONG_MAX
+
+typedef struct {
+  void          *entry;
+  unsigned int  hash;
+} ht_slot_t;
+
 
 struct vrna_hash_table_s {
   unsigned int                      hash_bits;
-  unsigned long                     Hash_size;
-  /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )*/
-  void                              **Hash_table;
+  unsigned long                     Hash_size;  /* number of slots, always a power of 2 */
+  unsigned long                     Count;      /* number of stored entries */
+  ht_slot_t                         *Hash_table;
   unsigned long                     Collisions;
   vrna_callback_ht_compare_entries  *Compare_function;
   vrna_callback_ht_hash_function    *Hash_function;
@@ -22,14 +50,39 @@ struct vrna_hash_table_s {
 };
 
 
-typedef struct vrna_hash_entry_list_s {
-  unsigned long length;
-  unsigned long allocated_length;
-  void **hash_entries;
-} vrna_hash_entry_list_t;
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE INLINE unsigned long
+probe_distance(struct vrna_hash_table_s *ht,
+               unsigned long            slot,
+               unsigned int             hash);
 
-/* ----------------------------------------------------------------- */
 
+PRIVATE unsigned long
+lookup(struct vrna_hash_table_s *ht,
+       void                     *x,
+       unsigned int             hash);
+
+
+PRIVATE void
+insert_hashed(struct vrna_hash_table_s  *ht,
+              void                      *x,
+              unsigned int              hash);
+
+
+PRIVATE int
+reserve(struct vrna_hash_table_s  *ht,
+        unsigned long             num);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
 PUBLIC struct vrna_hash_table_s *
 vrna_ht_init(unsigned int                     hash_bits,
              vrna_callback_ht_compare_entries *compare_function,
@@ -38,20 +91,21 @@ vrna_ht_init(unsigned int                     hash_bits,
 {
   struct vrna_hash_table_s *ht = NULL;
 
-  if (hash_bits > 0) {
+  if ((hash_bits > 0) &&
+      (hash_bits < sizeof(unsigned long) * CHAR_BIT)) {
     ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
 
-    ht->hash_bits = hash_bits;
-    /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )
-     * if we want to use '&' instead of modulo '%' for limiting the hash value. */
-    ht->Hash_size   = (((unsigned long)1 << hash_bits) - 1);
-    ht->Hash_table  = calloc((ht->Hash_size + 1), sizeof(void *));
-    if(!ht->Hash_table){
-    	fprintf(stderr,"Error: could not allocate space for the hash table!\n");
-    	free(ht);
-    	return NULL;
+    ht->hash_bits   = hash_bits;
+    ht->Hash_size   = (unsigned long)1 << hash_bits;
+    ht->Count       = 0;
+    ht->Hash_table  = (ht_slot_t *)calloc(ht->Hash_size, sizeof(ht_slot_t));
+    if (!ht->Hash_table) {
+      fprintf(stderr, "Error: could not allocate space for the hash table!\n");
+      free(ht);
+      return NULL;
     }
-    ht->Collisions  = 0;
+
+    ht->Collisions = 0;
 
     if ((!compare_function) &&
         (!hash_function) &&
@@ -76,6 +130,7 @@ vrna_ht_init(unsigned int                     hash_bits,
        *  One of the function pointers is missing, so we don't initialize
        *  anything!
        */
+      free(ht->Hash_table);
       free(ht);
       ht = NULL;
     }
@@ -85,7 +140,7 @@ vrna_ht_init(unsigned int                     hash_bits,
 }
 
 
-unsigned long
+PUBLIC unsigned long
 vrna_ht_size(struct vrna_hash_table_s *ht)
 {
   if (ht)
@@ -95,7 +150,17 @@ vrna_ht_size(struct vrna_hash_table_s *ht)
 }
 
 
-unsigned long
+PUBLIC unsigned long
+vrna_ht_count(struct vrna_hash_table_s *ht)
+{
+  if (ht)
+    return ht->Count;
+
+  return 0L;
+}
+
+
+PUBLIC unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht)
 {
   if (ht)
@@ -107,106 +172,94 @@ vrna_ht_collisions(struct vrna_hash_table_s *ht)
 
 PUBLIC void *
 vrna_ht_get(struct vrna_hash_table_s  *ht,
-            void                      *x)             /* returns NULL unless x is in the hash */
+            void                      *x)
 {
-  unsigned int hashval;
+  unsigned long slot;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return NULL;
-    }
-
-    vrna_hash_entry_list_t *entries =  ht->Hash_table[hashval];
-    if(entries){
-      int i;
-      for(i=0; i < entries->length; i++){
-        if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-          //found the same entry
-          return entries->hash_entries[i]; /* success */
-        }
-      }
-    }
+    slot = lookup(ht, x, ht->Hash_function(x, HT_HASH_RANGE));
+    if (slot != HT_NOT_FOUND)
+      return ht->Hash_table[slot].entry;
   }
+
   return NULL;
 }
 
 
-/* ----------------------------------------------------------------- */
-
 PUBLIC int
 vrna_ht_insert(struct vrna_hash_table_s *ht,
-               void                     *x)         /* returns 1 if x already was in the hash */
+               void                     *x)
 {
-  unsigned int hashval;
+  unsigned int hash;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return -1; /* failure */;
-    }
-    else {
-      vrna_hash_entry_list_t *entries = (vrna_hash_entry_list_t *)ht->Hash_table[hashval];
-      if(entries){
-        //at first test if the entry is already in the list.
-        int i;
-        for(i=0; i < entries->length; i++){
-          if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-            //found the same entry
-            return 0; /* success */
-          }
-        }
+    hash = ht->Hash_function(x, HT_HASH_RANGE);
+
+    if (lookup(ht, x, hash) != HT_NOT_FOUND)
+      return 1;
+
+    if (reserve(ht, 1))
+      return -1;
+
+    insert_hashed(ht, x, hash);
+
+    return 0;
+  }
+
+  return -1;
+}
+
+
+PUBLIC unsigned long
+vrna_ht_insert_bulk(struct vrna_hash_table_s  *ht,
+                    void                      **x,
+                    unsigned long             num)
+{
+  unsigned int  *hashes;
+  unsigned long i, inserted;
 
-        ht->Collisions++;
-        //append the entry to the list with same hash values.
-        if(i >= entries->length){
-          if(i >= entries->allocated_length){
-            //we have to extend the list.
-            entries->allocated_length += 100;
-            entries->hash_entries = vrna_realloc(entries->hash_entries, entries->allocated_length*sizeof(void*));
-          }
-          entries->hash_entries[entries->length] = x;
-          entries->length++;
+  inserted = 0;
+
+  if ((ht) && (x) && (num > 0)) {
+    /* compute all hash values first, and grow the table at most once */
+    hashes = (unsigned int *)vrna_alloc(sizeof(unsigned int) * num);
+
+    for (i = 0; i < num; i++)
+      if (x[i])
+        hashes[i] = ht->Hash_function(x[i], HT_HASH_RANGE);
+
+    if (reserve(ht, num) == 0) {
+      for (i = 0; i < num; i++) {
+        if ((x[i]) &&
+            (lookup(ht, x[i], hashes[i]) == HT_NOT_FOUND)) {
+          insert_hashed(ht, x[i], hashes[i]);
+          inserted++;
         }
       }
-      else{
-        //allocate new list and insert the value
-    	entries = malloc(sizeof(vrna_hash_entry_list_t));
-        entries->allocated_length = 2;
-        entries->hash_entries = vrna_alloc(entries->allocated_length*sizeof(void*));
-        entries->hash_entries[0] = x;
-        entries->length = 1;
-        ht->Hash_table[hashval] = entries;
-      }
-      return 0; /* success */
     }
+
+    free(hashes);
   }
-  return -1; /* failure */
+
+  return inserted;
 }
 
 
 PUBLIC void
 vrna_ht_clear(struct vrna_hash_table_s *ht)
 {
-  unsigned int i;
+  unsigned long i;
 
   if (ht) {
-    for (i = 0; i < ht->Hash_size + 1; i++) {
-      vrna_hash_entry_list_t *entries = ht->Hash_table[i];
-      if (entries) {
-        int i;
-        for(i=0; i < entries->length; i++){
-          ht->Free_hash_entry(entries->hash_entries[i]);
-          entries->hash_entries[i] = NULL;
-        }
-        free(entries->hash_entries);
-        free(entries);
+    for (i = 0; i < ht->Hash_size; i++)
+      if (ht->Hash_table[i].entry) {
+        ht->Free_hash_entry(ht->Hash_table[i].entry);
+        ht->Hash_table[i].entry = NULL;
+        ht->Hash_table[i].hash  = 0;
       }
-    }
 
-    ht->Collisions = 0;
+    ht->Count       = 0;
+    ht->Collisions  = 0;
   }
 }
 
@@ -222,43 +275,148 @@ vrna_ht_free(struct vrna_hash_table_s *ht)
 }
 
 
-/* ----------------------------------------------------------------- */
-
 PUBLIC void
 vrna_ht_remove(struct vrna_hash_table_s *ht,
                void                     *x)
 {
   /* doesn't free anything ! */
-  unsigned int hashval;
+  unsigned long slot, next, mask;
+  ht_slot_t     *table;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if(hashval >= ht->Hash_size){
-      fprintf(stderr,"Error: hash function returns a value that is larger than the size of the hash map!\n");
+    slot = lookup(ht, x, ht->Hash_function(x, HT_HASH_RANGE));
+    if (slot == HT_NOT_FOUND)
       return;
+
+    table = ht->Hash_table;
+    mask  = ht->Hash_size - 1;
+
+    /* backward shift deletion, i.e. move subsequent displaced entries one slot closer to their origin */
+    for (next = (slot + 1) & mask;
+         (table[next].entry) && (probe_distance(ht, next, table[next].hash) > 0);
+         next = (next + 1) & mask) {
+      table[slot] = table[next];
+      slot        = next;
     }
-    vrna_hash_entry_list_t *entries =  ht->Hash_table[hashval];
-    if(entries){
-      int i;
-      for(i=0; i < entries->length; i++){
-        if(ht->Compare_function(x, entries->hash_entries[i]) == 0){
-          //found the same entry --> shift the list to the left in order to delete the value.
-          int size_rest = entries->length-i-1;
-          if(size_rest <= 0){
-            entries->hash_entries[i] = 0;
-          }
-          else{
-            void *offset = entries->hash_entries+i;
-            void *next_entry = entries->hash_entries+i+1;
-            memcpy(offset,next_entry, size_rest*sizeof(void*));
-          }
-          entries->hash_entries[entries->length-1] = NULL;
-          entries->length--;
-          return; /* success */
-        }
-      }
+
+    table[slot].entry = NULL;
+    table[slot].hash  = 0;
+    ht->Count--;
+  }
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE INLINE unsigned long
+probe_distance(struct vrna_hash_table_s *ht,
+               unsigned long            slot,
+               unsigned int             hash)
+{
+  return (slot - (hash & (ht->Hash_size - 1))) & (ht->Hash_size - 1);
+}
+
+
+/* return the slot that holds an entry equal to x, or HT_NOT_FOUND */
+PRIVATE unsigned long
+lookup(struct vrna_hash_table_s *ht,
+       void                     *x,
+       unsigned int             hash)
+{
+  unsigned long slot, d, mask;
+  ht_slot_t     *table;
+
+  table = ht->Hash_table;
+  mask  = ht->Hash_size - 1;
+
+  for (slot = hash & mask, d = 0; table[slot].entry; slot = (slot + 1) & mask, d++) {
+    /* entries are ordered by probe distance, so x would have displaced this one */
+    if (probe_distance(ht, slot, table[slot].hash) < d)
+      break;
+
+    if ((table[slot].hash == hash) &&
+        (ht->Compare_function(x, table[slot].entry) == 0))
+      return slot;
+  }
+
+  return HT_NOT_FOUND;
+}
+
+
+/* insert an entry that is not stored yet into a table with at least one free slot */
+PRIVATE void
+insert_hashed(struct vrna_hash_table_s  *ht,
+              void                      *x,
+              unsigned int              hash)
+{
+  unsigned long slot, d, d_slot, mask;
+  ht_slot_t     *table, tmp, current;
+
+  table         = ht->Hash_table;
+  mask          = ht->Hash_size - 1;
+  current.entry = x;
+  current.hash  = hash;
+  slot          = hash & mask;
+
+  if (table[slot].entry)
+    ht->Collisions++;
+
+  for (d = 0; table[slot].entry; slot = (slot + 1) & mask, d++) {
+    d_slot = probe_distance(ht, slot, table[slot].hash);
+    if (d_slot < d) {
+      /* take from the rich, i.e. the entry closer to its origin moves on */
+      tmp         = table[slot];
+      table[slot] = current;
+      current     = tmp;
+      d           = d_slot;
     }
   }
+
+  table[slot] = current;
+  ht->Count++;
+}
+
+
+/* make sure num more entries fit into the table without exceeding the maximum load */
+PRIVATE int
+reserve(struct vrna_hash_table_s  *ht,
+        unsigned long             num)
+{
+  unsigned long i, old_size, size;
+  ht_slot_t     *old_table;
+
+  size = ht->Hash_size;
+  while (HT_MAX_LOAD(size) < ht->Count + num)
+    size *= 2;
+
+  if (size == ht->Hash_size)
+    return 0;
+
+  old_table = ht->Hash_table;
+  old_size  = ht->Hash_size;
+
+  ht->Hash_table = (ht_slot_t *)calloc(size, sizeof(ht_slot_t));
+  if (!ht->Hash_table) {
+    fprintf(stderr, "Error: could not allocate space for the hash table!\n");
+    ht->Hash_table = old_table;
+    return -1;
+  }
+
+  ht->Hash_size   = size;
+  ht->Count       = 0;
+  ht->Collisions  = 0;
+
+  /* re-insert all entries using their stored hash values */
+  for (i = 0; i < old_size; i++)
+    if (old_table[i].entry)
+      insert_hashed(ht, old_table[i].entry, old_table[i].hash);
+
+  free(old_table);
+
+  return 0;
 }
 
 
@@ -48,6 +48,18 @@ typedef int (vrna_callback_ht_compare_entries)(void *x,
 
 /**
  *  @brief  Callback function to generate a hash key, i.e. hash function
+ *
+ *  The hash table calls this function only once per insertion or look-up
+ *  and always passes the largest possible @p hashtable_size. Hash functions
+ *  should therefore spread their keys evenly over the range
+ *  @f$[0, \mathrm{hashtable\_size})@f$.
+ *
+ *  @note   Previous versions passed the current size of the hash table
+ *          instead, i.e. @f$2^b - 1@f$ for a table initialized with
+ *          vrna_ht_init(b, ...). Now, @p hashtable_size is always
+ *          @p UINT_MAX, and the hash value no longer depends on the
+ *          table size.
+ *
  *  @see    vrna_ht_init(), vrna_ht_db_hash_func()
  *  @param  x               A hash table entry
  *  @param  hashtable_size  The size of the hash table
@@ -70,7 +82,11 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *  @brief  Get an initialized hash table
  *
  *  This function returns a ready-to-use hash table with pre-allocated
- *  memory for a particular number of entries.
+ *  memory for a particular number of entries. The hash table uses open
+ *  addressing and automatically doubles its size whenever it is filled
+ *  to more than 75%. Each entry is stored together with its hash value,
+ *  such that look-ups and growth of the table only rarely require calls
+ *  to the comparison function and never re-compute any hash value.
  *
  *  @note
  *  @parblock
@@ -82,10 +98,7 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *
  *  arguments.
  *  @endparblock
- *  @warning  If @p hash_bits is larger than 27 you have to compile it with
- *            the flag gcc -mcmodel=large.
- *
- *  @param  b                 Number of bits for the hash table. This determines the size (@f$2^b -1@f$).
+ *  @param  b                 Number of bits for the initial size of the hash table (@f$2^b@f$ slots)
  *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
  *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
  *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
@@ -102,17 +115,27 @@ vrna_ht_init(unsigned int                     b,
  *  @brief  Get the size of the hash table
  *
  *  @param  ht  The hash table
- *  @return     The size of the hash table, i.e. the maximum number of entries
+ *  @return     The size of the hash table, i.e. the current number of slots
  */
 unsigned long
 vrna_ht_size(vrna_hash_table_t ht);
 
 
+/**
+ *  @brief  Get the number of entries stored in the hash table
+ *
+ *  @param  ht  The hash table
+ *  @return     The number of entries in the hash table
+ */
+unsigned long
+vrna_ht_count(vrna_hash_table_t ht);
+
+
 /**
  *  @brief  Get the number of collisions in the hash table
  *
  *  @param  ht  The hash table
- *  @return     The number of collisions in the hash table
+ *  @return     The number of entries that are not stored at the first slot they were assigned to
  */
 unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht);
@@ -142,14 +165,17 @@ vrna_ht_get(vrna_hash_table_t ht,
  *
  *  Writes the pointer to your hash entry into the table.
  *
- *  @warning  In case of collisions, this function simply
- *            increments the hash key until a free entry in
- *            the hash table is found.
+ *  @note   In case of collisions, this function uses linear probing
+ *          with Robin Hood replacement to find a free slot in the
+ *          hash table. The table grows automatically if necessary.
  *
- *  @see vrna_ht_init(), vrna_hash_delete(), vrna_ht_clear()
+ *  @see vrna_ht_init(), vrna_ht_insert_bulk(), vrna_hash_delete(), vrna_ht_clear()
  *
  *  @param  ht  The hash table
  *  @param  x   The hash entry
+ *  @note   Previous versions returned 0 for entries that were already
+ *          stored in the hash table.
+ *
  *  @return     0 on success, 1 if the value is already in the hash table, -1 on error.
  */
 int
@@ -157,6 +183,27 @@ vrna_ht_insert(vrna_hash_table_t  ht,
                void               *x);
 
 
+/**
+ *  @brief  Insert many objects into a hash table
+ *
+ *  Writes the pointers to all @p num hash entries in @p x into the table.
+ *  Compared to successive calls of vrna_ht_insert(), this function computes
+ *  all hash values first and resizes the table at most once. Entries that
+ *  are already stored in the table, and @p NULL pointers are skipped.
+ *
+ *  @see vrna_ht_insert(), vrna_ht_init()
+ *
+ *  @param  ht  The hash table
+ *  @param  x   An array of hash entries
+ *  @param  num The number of hash entries in @p x
+ *  @return     The number of entries that have been inserted
+ */
+unsigned long
+vrna_ht_insert_bulk(vrna_hash_table_t ht,
+                    void              **x,
+                    unsigned long     num);
+
+
 /**
  *  @brief  Remove an object from the hash table
  *
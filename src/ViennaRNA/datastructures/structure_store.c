@@ -0,0 +1,547 @@
+/*
+ * A memory compact store for secondary structures that hands out
+ * stable integer IDs
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
+
+#include "ViennaRNA/datastructures/structure_store.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/* number of packed structures per memory block (as power of 2) */
+#define STORE_BLOCK_BITS  16
+#define STORE_BLOCK_SIZE  ((size_t)1 << STORE_BLOCK_BITS)
+
+/* maximum load factor of the index before it grows */
+#define STORE_MAX_LOAD(size)  (((size) >> 1) + ((size) >> 2))
+
+/* packed query structures up to this size (in bytes) are kept on the stack */
+#define STORE_QUERY_STACK 128
+
+typedef struct {
+  unsigned int  id;   /* structure ID + 1, 0 marks empty slots */
+  unsigned int  hash; /* hash value of the packed structure */
+} store_slot_t;
+
+
+struct vrna_struct_store_s {
+  unsigned int  length;       /* length of the structures */
+  size_t        record_size;  /* bytes per packed structure */
+  size_t        num;          /* number of stored structures */
+
+  unsigned char **blocks;     /* packed structures, STORE_BLOCK_SIZE per block */
+  size_t        num_blocks;
+
+  store_slot_t  *index;       /* open addressing hash table */
+  size_t        index_size;   /* always a power of 2 */
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE INLINE unsigned char *
+get_record(struct vrna_struct_store_s *store,
+           size_t                     id);
+
+
+PRIVATE INLINE unsigned char *
+get_query(struct vrna_struct_store_s  *store,
+          unsigned char               *stack);
+
+
+PRIVATE int
+pack_db(struct vrna_struct_store_s  *store,
+        const char                  *structure,
+        unsigned char               *query);
+
+
+PRIVATE int
+pack_pt(struct vrna_struct_store_s  *store,
+        const short                 *pt,
+        unsigned char               *query);
+
+
+PRIVATE unsigned int
+hash_record(const unsigned char *record,
+            size_t              size);
+
+
+PRIVATE unsigned int
+lookup(struct vrna_struct_store_s *store,
+       const unsigned char        *query,
+       unsigned int               hash,
+       size_t                     *slot);
+
+
+PRIVATE unsigned int
+insert(struct vrna_struct_store_s *store,
+       const unsigned char        *query);
+
+
+PRIVATE unsigned int
+find(struct vrna_struct_store_s *store,
+     const unsigned char        *query);
+
+
+PRIVATE void
+resize_index(struct vrna_struct_store_s *store,
+             size_t                     size);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC struct vrna_struct_store_s *
+vrna_struct_store_init(unsigned int length,
+                       size_t       n)
+{
+  size_t                      size;
+  struct vrna_struct_store_s  *store = NULL;
+
+  if (length > 0) {
+    store               = (struct vrna_struct_store_s *)vrna_alloc(sizeof(struct vrna_struct_store_s));
+    store->length       = length;
+    store->record_size  = (length + 4) / 5;
+    store->num          = 0;
+    store->blocks       = NULL;
+    store->num_blocks   = 0;
+    store->index        = NULL;
+    store->index_size   = 0;
+
+    for (size = 64; STORE_MAX_LOAD(size) < n; size *= 2);
+
+    resize_index(store, size);
+  }
+
+  return store;
+}
+
+
+PUBLIC void
+vrna_struct_store_free(struct vrna_struct_store_s *store)
+{
+  size_t i;
+
+  if (store) {
+    for (i = 0; i < store->num_blocks; i++)
+      free(store->blocks[i]);
+
+    free(store->blocks);
+    free(store->index);
+    free(store);
+  }
+}
+
+
+PUBLIC size_t
+vrna_struct_store_size(struct vrna_struct_store_s *store)
+{
+  if (store)
+    return store->num;
+
+  return 0;
+}
+
+
+PUBLIC unsigned int
+vrna_struct_store_insert(struct vrna_struct_store_s *store,
+                         const char                 *structure)
+{
+  unsigned char stack[STORE_QUERY_STACK], *query;
+  unsigned int  id;
+
+  id = VRNA_STRUCT_STORE_NONE;
+
+  if ((store) && (structure)) {
+    query = get_query(store, stack);
+
+    if (pack_db(store, structure, query) == 0)
+      id = insert(store, query);
+
+    if (query != stack)
+      free(query);
+  }
+
+  return id;
+}
+
+
+PUBLIC unsigned int
+vrna_struct_store_insert_pt(struct vrna_struct_store_s  *store,
+                            const short                 *pt)
+{
+  unsigned char stack[STORE_QUERY_STACK], *query;
+  unsigned int  id;
+
+  id = VRNA_STRUCT_STORE_NONE;
+
+  if ((store) && (pt)) {
+    query = get_query(store, stack);
+
+    if (pack_pt(store, pt, query) == 0)
+      id = insert(store, query);
+
+    if (query != stack)
+      free(query);
+  }
+
+  return id;
+}
+
+
+PUBLIC unsigned int
+vrna_struct_store_find(struct vrna_struct_store_s *store,
+                       const char                 *structure)
+{
+  unsigned char stack[STORE_QUERY_STACK], *query;
+  unsigned int  id;
+
+  id = VRNA_STRUCT_STORE_NONE;
+
+  if ((store) && (structure)) {
+    query = get_query(store, stack);
+
+    if (pack_db(store, structure, query) == 0)
+      id = find(store, query);
+
+    if (query != stack)
+      free(query);
+  }
+
+  return id;
+}
+
+
+PUBLIC unsigned int
+vrna_struct_store_find_pt(struct vrna_struct_store_s  *store,
+                          const short                 *pt)
+{
+  unsigned char stack[STORE_QUERY_STACK], *query;
+  unsigned int  id;
+
+  id = VRNA_STRUCT_STORE_NONE;
+
+  if ((store) && (pt)) {
+    query = get_query(store, stack);
+
+    if (pack_pt(store, pt, query) == 0)
+      id = find(store, query);
+
+    if (query != stack)
+      free(query);
+  }
+
+  return id;
+}
+
+
+PUBLIC char *
+vrna_struct_store_get(struct vrna_struct_store_s  *store,
+                      unsigned int                id)
+{
+  char                structure[5], *s;
+  unsigned int        i, k, n;
+  int                 p;
+  const unsigned char *record;
+
+  if ((!store) ||
+      ((size_t)id >= store->num))
+    return NULL;
+
+  n       = store->length;
+  record  = get_record(store, id);
+  s       = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  for (i = 0; i < n; i += 5) {
+    p = (int)record[i / 5] - 1;
+    for (k = 5; k > 0; k--) {
+      structure[k - 1]  = "()."[p % 3];
+      p                 /= 3;
+    }
+
+    memcpy(s + i, structure, sizeof(char) * MIN2(5, n - i));
+  }
+
+  s[n] = '\0';
+
+  return s;
+}
+
+
+PUBLIC short *
+vrna_struct_store_get_pt(struct vrna_struct_store_s *store,
+                         unsigned int               id)
+{
+  char  *s;
+  short *pt;
+
+  pt  = NULL;
+  s   = vrna_struct_store_get(store, id);
+
+  if (s) {
+    pt = vrna_ptable(s);
+    free(s);
+  }
+
+  return pt;
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE INLINE unsigned char *
+get_record(struct vrna_struct_store_s *store,
+           size_t                     id)
+{
+  return store->blocks[id >> STORE_BLOCK_BITS] +
+         (id & (STORE_BLOCK_SIZE - 1)) * store->record_size;
+}
+
+
+/*
+ *  Get memory for a packed query structure. Every call uses its own query
+ *  buffer, so look-ups of different threads do not interfere. Small
+ *  records are packed into the stack buffer of the caller
+ */
+PRIVATE INLINE unsigned char *
+get_query(struct vrna_struct_store_s  *store,
+          unsigned char               *stack)
+{
+  if (store->record_size <= STORE_QUERY_STACK)
+    return stack;
+
+  return (unsigned char *)vrna_alloc(sizeof(unsigned char) * store->record_size);
+}
+
+
+/*
+ *  Pack a structure into a query buffer using the base 3 encoding of
+ *  vrna_db_pack(), i.e. '(' = 0, ')' = 1, '.' = 2, five positions per byte
+ *  (first position most significant), positions beyond the structure
+ *  length count as '(', and each byte is incremented by one
+ */
+PRIVATE int
+pack_db(struct vrna_struct_store_s  *store,
+        const char                  *structure,
+        unsigned char               *query)
+{
+  unsigned int  i, j, p, n;
+
+  n = store->length;
+
+  for (i = j = 0; i < n; j++) {
+    unsigned int k;
+    for (p = k = 0; k < 5; k++, i++) {
+      p *= 3;
+      if (i < n) {
+        switch (structure[i]) {
+          case '(':
+            break;
+          case ')':
+            p += 1;
+            break;
+          case '.':
+            p += 2;
+            break;
+          default:
+            vrna_message_warning("vrna_struct_store_*: "
+                                 "illegal character or wrong length of structure\n%s",
+                                 structure);
+            return -1;
+        }
+      }
+    }
+    query[j] = (unsigned char)(p + 1);
+  }
+
+  if (structure[n] != '\0') {
+    vrna_message_warning("vrna_struct_store_*: "
+                         "illegal character or wrong length of structure\n%s",
+                         structure);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+PRIVATE int
+pack_pt(struct vrna_struct_store_s  *store,
+        const short                 *pt,
+        unsigned char               *query)
+{
+  unsigned int  i, j, p, n;
+
+  n = store->length;
+
+  if ((unsigned int)pt[0] != n) {
+    vrna_message_warning("vrna_struct_store_*: "
+                         "pair table length %d does not match store (%u)",
+                         pt[0], n);
+    return -1;
+  }
+
+  for (i = 1, j = 0; i <= n; j++) {
+    unsigned int k;
+    for (p = k = 0; k < 5; k++, i++) {
+      p *= 3;
+      if (i <= n) {
+        if (pt[i] == 0)
+          p += 2;
+        else if ((unsigned int)pt[i] < i)
+          p += 1;
+      }
+    }
+    query[j] = (unsigned char)(p + 1);
+  }
+
+  return 0;
+}
+
+
+PRIVATE unsigned int
+hash_record(const unsigned char *record,
+            size_t              size)
+{
+  uint64_t  h, w;
+  size_t    i;
+
+  h = (uint64_t)size * 0x9E3779B97F4A7C15ULL;
+
+  for (i = 0; i + 8 <= size; i += 8) {
+    memcpy(&w, record + i, sizeof(uint64_t));
+    h = (h ^ w) * 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 31;
+  }
+
+  for (w = 0; i < size; i++)
+    w = (w << 8) | record[i];
+
+  h = (h ^ w) * 0x94D049BB133111EBULL;
+  h ^= h >> 29;
+
+  return (unsigned int)(h ^ (h >> 32));
+}
+
+
+/*
+ *  Find the packed query structure in the index. Returns its ID + 1, or 0
+ *  if it is not stored, in which case slot is set to the first empty slot
+ */
+PRIVATE unsigned int
+lookup(struct vrna_struct_store_s *store,
+       const unsigned char        *query,
+       unsigned int               hash,
+       size_t                     *slot)
+{
+  size_t        i, mask;
+  store_slot_t  *index;
+
+  index = store->index;
+  mask  = store->index_size - 1;
+
+  for (i = hash & mask; index[i].id; i = (i + 1) & mask)
+    if ((index[i].hash == hash) &&
+        (memcmp(get_record(store, index[i].id - 1),
+                query,
+                store->record_size) == 0))
+      break;
+
+  *slot = i;
+
+  return index[i].id;
+}
+
+
+PRIVATE unsigned int
+insert(struct vrna_struct_store_s *store,
+       const unsigned char        *query)
+{
+  unsigned int  hash, id;
+  size_t        slot;
+
+  hash  = hash_record(query, store->record_size);
+  id    = lookup(store, query, hash, &slot);
+
+  if (id)
+    return id - 1;
+
+  if (store->num >= (size_t)VRNA_STRUCT_STORE_NONE - 1) {
+    vrna_message_warning("vrna_struct_store_insert*: "
+                         "Maximum number of structures exceeded!");
+    return VRNA_STRUCT_STORE_NONE;
+  }
+
+  /* append packed structure */
+  if (store->num == store->num_blocks * STORE_BLOCK_SIZE) {
+    store->blocks = (unsigned char **)vrna_realloc(store->blocks,
+                                                   sizeof(unsigned char *) *
+                                                   (store->num_blocks + 1));
+    store->blocks[store->num_blocks++] = (unsigned char *)vrna_alloc(
+      sizeof(unsigned char) * STORE_BLOCK_SIZE * store->record_size);
+  }
+
+  memcpy(get_record(store, store->num), query, store->record_size);
+
+  store->index[slot].id   = (unsigned int)(++store->num);
+  store->index[slot].hash = hash;
+
+  if (store->num > STORE_MAX_LOAD(store->index_size))
+    resize_index(store, 2 * store->index_size);
+
+  return (unsigned int)(store->num - 1);
+}
+
+
+PRIVATE unsigned int
+find(struct vrna_struct_store_s *store,
+     const unsigned char        *query)
+{
+  unsigned int  id;
+  size_t        slot;
+
+  id = lookup(store, query, hash_record(query, store->record_size), &slot);
+
+  return (id) ? id - 1 : VRNA_STRUCT_STORE_NONE;
+}
+
+
+PRIVATE void
+resize_index(struct vrna_struct_store_s *store,
+             size_t                     size)
+{
+  size_t        i, j, mask;
+  store_slot_t  *old_index;
+
+  old_index         = store->index;
+  store->index      = (store_slot_t *)vrna_alloc(sizeof(store_slot_t) * size);
+  mask              = size - 1;
+
+  /* re-insert all IDs using their stored hash values */
+  for (i = 0; i < store->index_size; i++)
+    if (old_index[i].id) {
+      for (j = old_index[i].hash & mask; store->index[j].id; j = (j + 1) & mask);
+      store->index[j] = old_index[i];
+    }
+
+  store->index_size = size;
+
+  free(old_index);
+}
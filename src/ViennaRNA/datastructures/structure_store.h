@@ -0,0 +1,171 @@
+#ifndef VIENNA_RNA_PACKAGE_STRUCTURE_STORE_H
+#define VIENNA_RNA_PACKAGE_STRUCTURE_STORE_H
+
+/**
+ *  @file     ViennaRNA/datastructures/structure_store.h
+ *  @ingroup  struct_store_utils
+ *  @brief    A memory compact store for secondary structures with stable integer IDs
+ */
+
+/**
+ *  @addtogroup struct_store_utils
+ *  @{
+ *  @brief  Interning of secondary structures in packed representation
+ *
+ *  Many algorithms that explore the energy landscape of an RNA molecule,
+ *  e.g. adaptive walks, stochastic simulations, or flooding procedures,
+ *  need to remember which structures they have already visited. Storing
+ *  each of them as pair table, or dot-bracket string quickly becomes the
+ *  limiting factor for long simulations.
+ *
+ *  The structure store keeps each distinct structure exactly once in the
+ *  base 3 encoding also used by vrna_db_pack(), i.e. 5 positions per byte,
+ *  and assigns consecutive integer IDs in the order of insertion. IDs never
+ *  change, so two structures are identical if and only if their IDs are.
+ *  Look-ups hash and compare the packed records directly.
+ *
+ *  @note Every look-up packs its query into a buffer of its own, so
+ *        vrna_struct_store_find(), vrna_struct_store_get(), and their pair
+ *        table variants may be called concurrently on the same store.
+ *        Insertions, however, must not run concurrently with any other
+ *        call on the same store and need to be serialized by the caller.
+ */
+
+/**
+ *  @brief  A structure store object
+ *  @see    vrna_struct_store_init(), vrna_struct_store_free()
+ */
+typedef struct vrna_struct_store_s *vrna_struct_store_t;
+
+
+/**
+ *  @brief  Invalid structure ID that indicates errors or unsuccessful look-ups
+ */
+#define VRNA_STRUCT_STORE_NONE  ((unsigned int)-1)
+
+
+/**
+ *  @brief  Get an initialized structure store
+ *
+ *  @see    vrna_struct_store_free(), vrna_struct_store_insert()
+ *
+ *  @param  length  The length of the structures to store
+ *  @param  n       The number of structures to pre-allocate memory for (may be 0)
+ *  @return         An initialized, empty structure store, or @p NULL on any error
+ */
+vrna_struct_store_t
+vrna_struct_store_init(unsigned int length,
+                       size_t       n);
+
+
+/**
+ *  @brief  Free all memory occupied by a structure store
+ *
+ *  @param  store The structure store
+ */
+void
+vrna_struct_store_free(vrna_struct_store_t store);
+
+
+/**
+ *  @brief  Get the number of structures in a structure store
+ *
+ *  @param  store The structure store
+ *  @return       The number of distinct structures stored
+ */
+size_t
+vrna_struct_store_size(vrna_struct_store_t store);
+
+
+/**
+ *  @brief  Insert a structure in dot-bracket notation into a structure store
+ *
+ *  Structures that are already stored are not inserted again. Instead, their
+ *  ID is returned.
+ *
+ *  @see    vrna_struct_store_insert_pt(), vrna_struct_store_find(), vrna_struct_store_get()
+ *
+ *  @param  store     The structure store
+ *  @param  structure The structure in dot-bracket notation
+ *  @return           The ID of the structure, or #VRNA_STRUCT_STORE_NONE on any error
+ */
+unsigned int
+vrna_struct_store_insert(vrna_struct_store_t  store,
+                         const char           *structure);
+
+
+/**
+ *  @brief  Insert a structure in pair table representation into a structure store
+ *
+ *  @see    vrna_struct_store_insert(), vrna_struct_store_find_pt(), vrna_struct_store_get_pt()
+ *
+ *  @param  store The structure store
+ *  @param  pt    The structure as pair table
+ *  @return       The ID of the structure, or #VRNA_STRUCT_STORE_NONE on any error
+ */
+unsigned int
+vrna_struct_store_insert_pt(vrna_struct_store_t store,
+                            const short         *pt);
+
+
+/**
+ *  @brief  Look-up the ID of a structure in dot-bracket notation
+ *
+ *  @see    vrna_struct_store_insert(), vrna_struct_store_find_pt()
+ *
+ *  @param  store     The structure store
+ *  @param  structure The structure in dot-bracket notation
+ *  @return           The ID of the structure, or #VRNA_STRUCT_STORE_NONE if it is not stored
+ */
+unsigned int
+vrna_struct_store_find(vrna_struct_store_t  store,
+                       const char           *structure);
+
+
+/**
+ *  @brief  Look-up the ID of a structure in pair table representation
+ *
+ *  @see    vrna_struct_store_insert_pt(), vrna_struct_store_find()
+ *
+ *  @param  store The structure store
+ *  @param  pt    The structure as pair table
+ *  @return       The ID of the structure, or #VRNA_STRUCT_STORE_NONE if it is not stored
+ */
+unsigned int
+vrna_struct_store_find_pt(vrna_struct_store_t store,
+                          const short         *pt);
+
+
+/**
+ *  @brief  Retrieve a structure in dot-bracket notation from a structure store
+ *
+ *  @see    vrna_struct_store_get_pt(), vrna_struct_store_insert()
+ *
+ *  @param  store The structure store
+ *  @param  id    The ID of the structure
+ *  @return       The structure in dot-bracket notation (needs to be free'd), or @p NULL for invalid IDs
+ */
+char *
+vrna_struct_store_get(vrna_struct_store_t store,
+                      unsigned int        id);
+
+
+/**
+ *  @brief  Retrieve a structure as pair table from a structure store
+ *
+ *  @see    vrna_struct_store_get(), vrna_struct_store_insert_pt()
+ *
+ *  @param  store The structure store
+ *  @param  id    The ID of the structure
+ *  @return       The pair table of the structure (needs to be free'd), or @p NULL for invalid IDs
+ */
+short *
+vrna_struct_store_get_pt(vrna_struct_store_t  store,
+                         unsigned int         id);
+
+
+/**
+ *  @}
+ */
+
+#endif
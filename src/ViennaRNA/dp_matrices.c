@@ -18,6 +18,7 @@
 #endif
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 
 #include "ViennaRNA/datastructures/basic.h"
@@ -54,6 +55,27 @@
 #define ALLOC_PF_WO_PROBS         (ALLOC_F | ALLOC_C | ALLOC_FML)
 #define ALLOC_PF_DEFAULT          (ALLOC_PF_WO_PROBS | ALLOC_PROBS | ALLOC_AUX)
 
+/* alignment (in bytes) of the arrays we carve from a memory arena */
+#define ARENA_ALIGNMENT           64
+#define ARENA_ALIGN(s)            (((s) + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  A single memory block that holds all arrays of the default MFE or PF
+ *  DP matrices. Whenever matrices are re-allocated, e.g. for the next
+ *  sequence or a different set of arrays, the block is re-used as long
+ *  as it is large enough. Note, that re-used memory is not cleared!
+ */
+struct mx_arena {
+  size_t  size; /* number of usable bytes */
+  char    *mem; /* ARENA_ALIGNMENT aligned start of the usable memory */
+};
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -84,9 +106,35 @@ PRIVATE unsigned int    get_mx_pf_alloc_vector_current(vrna_mx_pf_t   *mx,
                                                        vrna_mx_type_e mx_type);
 
 
+PRIVATE struct mx_arena *arena_get(struct mx_arena  *arena,
+                                   size_t           size);
+
+
+PRIVATE INLINE void     *arena_carve(struct mx_arena  *arena,
+                                     size_t           *offset,
+                                     size_t           size);
+
+
+PRIVATE INLINE void     arena_release(struct mx_arena *arena,
+                                      void            *ptr);
+
+
+PRIVATE void            *release_mfe_matrices(vrna_fold_compound_t *vc);
+
+
+PRIVATE void            *release_pf_matrices(vrna_fold_compound_t *vc);
+
+
+PRIVATE size_t          mfe_matrices_carve_default(vrna_mx_mfe_t    *vars,
+                                                   unsigned int     m,
+                                                   unsigned int     alloc_vector,
+                                                   struct mx_arena  *arena);
+
+
 PRIVATE void            mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
                                                    unsigned int   m,
-                                                   unsigned int   alloc_vector);
+                                                   unsigned int   alloc_vector,
+                                                   void           *arena);
 
 
 PRIVATE void            mfe_matrices_free_default(vrna_mx_mfe_t *self);
@@ -113,9 +161,16 @@ PRIVATE void            mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
                                                  int            *indx);
 
 
+PRIVATE size_t          pf_matrices_carve_default(vrna_mx_pf_t    *vars,
+                                                  unsigned int    m,
+                                                  unsigned int    alloc_vector,
+                                                  struct mx_arena *arena);
+
+
 PRIVATE void            pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
                                                   unsigned int  m,
-                                                  unsigned int  alloc_vector);
+                                                  unsigned int  alloc_vector,
+                                                  void          *arena);
 
 
 PRIVATE void            pf_matrices_free_default(vrna_mx_pf_t *self);
@@ -146,25 +201,29 @@ PRIVATE void            pf_matrices_free_2Dfold(vrna_mx_pf_t  *self,
 PRIVATE vrna_mx_mfe_t *get_mfe_matrices_alloc(unsigned int    n,
                                               unsigned int    m,
                                               vrna_mx_type_e  type,
-                                              unsigned int    alloc_vector);
+                                              unsigned int    alloc_vector,
+                                              void            *arena);
 
 
 PRIVATE vrna_mx_pf_t *get_pf_matrices_alloc(unsigned int    n,
                                             unsigned int    m,
                                             vrna_mx_type_e  type,
-                                            unsigned int    alloc_vector);
+                                            unsigned int    alloc_vector,
+                                            void            *arena);
 
 
 PRIVATE int
 add_pf_matrices(vrna_fold_compound_t  *vc,
                 vrna_mx_type_e        type,
-                unsigned int          alloc_vector);
+                unsigned int          alloc_vector,
+                void                  *arena);
 
 
 PRIVATE int
 add_mfe_matrices(vrna_fold_compound_t *vc,
                  vrna_mx_type_e       type,
-                 unsigned int         alloc_vector);
+                 unsigned int         alloc_vector,
+                 void                 *arena);
 
 
 /*
@@ -175,62 +234,14 @@ add_mfe_matrices(vrna_fold_compound_t *vc,
 PUBLIC void
 vrna_mx_mfe_free(vrna_fold_compound_t *vc)
 {
-  if (vc) {
-    vrna_mx_mfe_t *self = vc->matrices;
-    if (self) {
-      switch (self->type) {
-        case VRNA_MX_DEFAULT:
-          mfe_matrices_free_default(self);
-          break;
-
-        case VRNA_MX_WINDOW:
-          mfe_matrices_free_window(self, vc->length, vc->window_size);
-          break;
-
-        case VRNA_MX_2DFOLD:
-          mfe_matrices_free_2Dfold(self, vc->length, vc->params->model_details.min_loop_size, vc->iindx);
-          break;
-
-        default:                /* do nothing */
-          break;
-      }
-      free(self);
-      vc->matrices = NULL;
-    }
-  }
+  free(release_mfe_matrices(vc));
 }
 
 
 PUBLIC void
 vrna_mx_pf_free(vrna_fold_compound_t *vc)
 {
-  if (vc) {
-    vrna_mx_pf_t *self = vc->exp_matrices;
-    if (self) {
-      switch (self->type) {
-        case VRNA_MX_DEFAULT:
-          pf_matrices_free_default(self);
-          break;
-
-        case VRNA_MX_WINDOW:
-          pf_matrices_free_window(self, vc->length, vc->window_size);
-          break;
-
-        case VRNA_MX_2DFOLD:
-          pf_matrices_free_2Dfold(self, vc->length, vc->exp_params->model_details.min_loop_size, vc->iindx, vc->jindx);
-          break;
-
-        default:                /* do nothing */
-          break;
-      }
-
-      free(self->expMLbase);
-      free(self->scale);
-
-      free(self);
-      vc->exp_matrices = NULL;
-    }
-  }
+  free(release_pf_matrices(vc));
 }
 
 
@@ -268,8 +279,8 @@ vrna_mx_mfe_add(vrna_fold_compound_t  *vc,
     mx_alloc_vector = get_mx_alloc_vector(&(vc->params->model_details),
                                           mx_type,
                                           options);
-    vrna_mx_mfe_free(vc);
-    return add_mfe_matrices(vc, mx_type, mx_alloc_vector);
+    /* hand over the memory of the current matrices for re-use */
+    return add_mfe_matrices(vc, mx_type, mx_alloc_vector, release_mfe_matrices(vc));
   }
 
   return 0;
@@ -287,8 +298,8 @@ vrna_mx_pf_add(vrna_fold_compound_t *vc,
     mx_alloc_vector = get_mx_alloc_vector(&(vc->exp_params->model_details),
                                           mx_type,
                                           options | VRNA_OPTION_PF);
-    vrna_mx_pf_free(vc);
-    return add_pf_matrices(vc, mx_type, mx_alloc_vector);
+    /* hand over the memory of the current matrices for re-use */
+    return add_pf_matrices(vc, mx_type, mx_alloc_vector, release_pf_matrices(vc));
   }
 
   return 0;
@@ -385,6 +396,127 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
+PRIVATE struct mx_arena *
+arena_get(struct mx_arena *arena,
+          size_t          size)
+{
+  if ((arena) && (arena->size >= size))
+    return arena;
+
+  free(arena);
+
+  /* header and data share a single block, alignment is done manually */
+  arena       = (struct mx_arena *)vrna_alloc(sizeof(struct mx_arena) + size + ARENA_ALIGNMENT);
+  arena->size = size;
+  arena->mem  = (char *)ARENA_ALIGN((uintptr_t)(arena + 1));
+
+  return arena;
+}
+
+
+PRIVATE INLINE void *
+arena_carve(struct mx_arena *arena,
+            size_t          *offset,
+            size_t          size)
+{
+  void *ptr = (arena) ? (void *)(arena->mem + *offset) : NULL;
+
+  *offset += ARENA_ALIGN(size);
+
+  return ptr;
+}
+
+
+/* free memory that has not been carved from the arena, e.g. arrays added later on */
+PRIVATE INLINE void
+arena_release(struct mx_arena *arena,
+              void            *ptr)
+{
+  if ((arena) &&
+      ((char *)ptr >= arena->mem) &&
+      ((char *)ptr < arena->mem + arena->size))
+    return;
+
+  free(ptr);
+}
+
+
+/*
+ *  Free the MFE matrices attached to vc, except for the memory arena
+ *  they are carved from. The arena (if any) is returned for re-use.
+ */
+PRIVATE void *
+release_mfe_matrices(vrna_fold_compound_t *vc)
+{
+  void *arena = NULL;
+
+  if (vc) {
+    vrna_mx_mfe_t *self = vc->matrices;
+    if (self) {
+      switch (self->type) {
+        case VRNA_MX_DEFAULT:
+          mfe_matrices_free_default(self);
+          break;
+
+        case VRNA_MX_WINDOW:
+          mfe_matrices_free_window(self, vc->length, vc->window_size);
+          break;
+
+        case VRNA_MX_2DFOLD:
+          mfe_matrices_free_2Dfold(self, vc->length, vc->params->model_details.min_loop_size, vc->iindx);
+          break;
+
+        default:                /* do nothing */
+          break;
+      }
+      arena = self->arena;
+      free(self);
+      vc->matrices = NULL;
+    }
+  }
+
+  return arena;
+}
+
+
+PRIVATE void *
+release_pf_matrices(vrna_fold_compound_t *vc)
+{
+  void *arena = NULL;
+
+  if (vc) {
+    vrna_mx_pf_t *self = vc->exp_matrices;
+    if (self) {
+      switch (self->type) {
+        case VRNA_MX_DEFAULT:
+          pf_matrices_free_default(self);
+          break;
+
+        case VRNA_MX_WINDOW:
+          pf_matrices_free_window(self, vc->length, vc->window_size);
+          break;
+
+        case VRNA_MX_2DFOLD:
+          pf_matrices_free_2Dfold(self, vc->length, vc->exp_params->model_details.min_loop_size, vc->iindx, vc->jindx);
+          break;
+
+        default:                /* do nothing */
+          break;
+      }
+
+      arena_release(self->arena, self->expMLbase);
+      arena_release(self->arena, self->scale);
+
+      arena = self->arena;
+      free(self);
+      vc->exp_matrices = NULL;
+    }
+  }
+
+  return arena;
+}
+
+
 PRIVATE unsigned int
 get_mx_mfe_alloc_vector_current(vrna_mx_mfe_t   *mx,
                                 vrna_mx_type_e  mx_type)
@@ -470,7 +602,8 @@ get_mx_pf_alloc_vector_current(vrna_mx_pf_t   *mx,
 PRIVATE int
 add_pf_matrices(vrna_fold_compound_t  *vc,
                 vrna_mx_type_e        mx_type,
-                unsigned int          alloc_vector)
+                unsigned int          alloc_vector,
+                void                  *arena)
 {
   if (vc) {
     switch (mx_type) {
@@ -478,13 +611,15 @@ add_pf_matrices(vrna_fold_compound_t  *vc,
         vc->exp_matrices = get_pf_matrices_alloc(vc->length,
                                                  vc->window_size,
                                                  mx_type,
-                                                 alloc_vector);
+                                                 alloc_vector,
+                                                 arena);
         break;
       default:
         vc->exp_matrices = get_pf_matrices_alloc(vc->length,
                                                  vc->length,
                                                  mx_type,
-                                                 alloc_vector);
+                                                 alloc_vector,
+                                                 arena);
         break;
     }
 
@@ -514,15 +649,16 @@ add_pf_matrices(vrna_fold_compound_t  *vc,
 PRIVATE int
 add_mfe_matrices(vrna_fold_compound_t *vc,
                  vrna_mx_type_e       mx_type,
-                 unsigned int         alloc_vector)
+                 unsigned int         alloc_vector,
+                 void                 *arena)
 {
   if (vc) {
     switch (mx_type) {
       case VRNA_MX_WINDOW:
-        vc->matrices = get_mfe_matrices_alloc(vc->length, vc->window_size, mx_type, alloc_vector);
+        vc->matrices = get_mfe_matrices_alloc(vc->length, vc->window_size, mx_type, alloc_vector, arena);
         break;
       default:
-        vc->matrices = get_mfe_matrices_alloc(vc->length, vc->length, mx_type, alloc_vector);
+        vc->matrices = get_mfe_matrices_alloc(vc->length, vc->length, mx_type, alloc_vector, arena);
         break;
     }
 
@@ -568,7 +704,8 @@ PRIVATE vrna_mx_mfe_t *
 get_mfe_matrices_alloc(unsigned int   n,
                        unsigned int   m,
                        vrna_mx_type_e type,
-                       unsigned int   alloc_vector)
+                       unsigned int   alloc_vector,
+                       void           *arena)
 {
   vrna_mx_mfe_t *vars;
 
@@ -576,6 +713,7 @@ get_mfe_matrices_alloc(unsigned int   n,
     vrna_message_warning("get_mfe_matrices_alloc: "
                          "sequence length %d exceeds addressable range",
                          n);
+    free(arena);
     return NULL;
   }
 
@@ -585,18 +723,21 @@ get_mfe_matrices_alloc(unsigned int   n,
 
   switch (type) {
     case VRNA_MX_DEFAULT:
-      mfe_matrices_alloc_default(vars, m, alloc_vector);
+      mfe_matrices_alloc_default(vars, m, alloc_vector, arena);
       break;
 
     case VRNA_MX_WINDOW:
+      free(arena);
       mfe_matrices_alloc_window(vars, m, alloc_vector);
       break;
 
     case VRNA_MX_2DFOLD:
+      free(arena);
       mfe_matrices_alloc_2Dfold(vars, m, alloc_vector);
       break;
 
     default:                /* do nothing */
+      free(arena);
       break;
   }
 
@@ -608,7 +749,8 @@ PRIVATE vrna_mx_pf_t *
 get_pf_matrices_alloc(unsigned int    n,
                       unsigned int    m,
                       vrna_mx_type_e  type,
-                      unsigned int    alloc_vector)
+                      unsigned int    alloc_vector,
+                      void            *arena)
 {
   unsigned int  lin_size;
   vrna_mx_pf_t  *vars;
@@ -617,6 +759,7 @@ get_pf_matrices_alloc(unsigned int    n,
     vrna_message_warning("get_pf_matrices_alloc: "
                          "sequence length %d exceeds addressable range",
                          n);
+    free(arena);
     return NULL;
   }
 
@@ -628,27 +771,33 @@ get_pf_matrices_alloc(unsigned int    n,
 
   switch (type) {
     case VRNA_MX_DEFAULT:
-      pf_matrices_alloc_default(vars, n, alloc_vector);
+      pf_matrices_alloc_default(vars, n, alloc_vector, arena);
       break;
 
     case VRNA_MX_WINDOW:
+      free(arena);
       pf_matrices_alloc_window(vars, m, alloc_vector);
       break;
 
     case VRNA_MX_2DFOLD:
+      free(arena);
       pf_matrices_alloc_2Dfold(vars, n, alloc_vector);
       break;
 
     default:                /* do nothing */
+      free(arena);
       break;
   }
 
   /*
    *  always alloc the helper arrays for unpaired nucleotides in multi-
-   *  branch loops and scaling
+   *  branch loops and scaling (if not already carved from an arena)
    */
-  vars->scale     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
-  vars->expMLbase = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
+  if (!vars->scale)
+    vars->scale = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
+
+  if (!vars->expMLbase)
+    vars->expMLbase = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
 
   return vars;
 }
@@ -688,16 +837,24 @@ get_mx_alloc_vector(vrna_md_t       *md_p,
 }
 
 
-PRIVATE void
-mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
-                           unsigned int   m,
-                           unsigned int   alloc_vector)
+/*
+ *  Distribute the memory of an arena among the default MFE matrices and
+ *  return the number of bytes required. If arena is NULL, only the size
+ *  is computed and all array pointers are set to NULL.
+ */
+PRIVATE size_t
+mfe_matrices_carve_default(vrna_mx_mfe_t    *vars,
+                           unsigned int     m,
+                           unsigned int     alloc_vector,
+                           struct mx_arena  *arena)
 {
-  unsigned int n, size, lin_size;
+  unsigned int  n, size, lin_size;
+  size_t        offset;
 
   n         = vars->length;
   size      = ((n + 1) * (m + 2)) / 2;
   lin_size  = n + 2;
+  offset    = 0;
 
   vars->f5  = NULL;
   vars->f3  = NULL;
@@ -709,25 +866,43 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
   vars->ggg = NULL;
 
   if (alloc_vector & ALLOC_F5)
-    vars->f5 = (int *)vrna_alloc(sizeof(int) * lin_size);
+    vars->f5 = (int *)arena_carve(arena, &offset, sizeof(int) * lin_size);
 
   if (alloc_vector & ALLOC_F3)
-    vars->f3 = (int *)vrna_alloc(sizeof(int) * lin_size);
+    vars->f3 = (int *)arena_carve(arena, &offset, sizeof(int) * lin_size);
 
   if (alloc_vector & ALLOC_HYBRID)
-    vars->fc = (int *)vrna_alloc(sizeof(int) * lin_size);
+    vars->fc = (int *)arena_carve(arena, &offset, sizeof(int) * lin_size);
 
   if (alloc_vector & ALLOC_C)
-    vars->c = (int *)vrna_alloc(sizeof(int) * size);
+    vars->c = (int *)arena_carve(arena, &offset, sizeof(int) * size);
 
   if (alloc_vector & ALLOC_FML)
-    vars->fML = (int *)vrna_alloc(sizeof(int) * size);
+    vars->fML = (int *)arena_carve(arena, &offset, sizeof(int) * size);
 
   if (alloc_vector & ALLOC_UNIQ)
-    vars->fM1 = (int *)vrna_alloc(sizeof(int) * size);
+    vars->fM1 = (int *)arena_carve(arena, &offset, sizeof(int) * size);
 
   if (alloc_vector & ALLOC_CIRC)
-    vars->fM2 = (int *)vrna_alloc(sizeof(int) * lin_size);
+    vars->fM2 = (int *)arena_carve(arena, &offset, sizeof(int) * lin_size);
+
+  return offset;
+}
+
+
+PRIVATE void
+mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
+                           unsigned int   m,
+                           unsigned int   alloc_vector,
+                           void           *arena)
+{
+  size_t size;
+
+  /* get a sufficiently large arena (re-use the one we've been given if possible) */
+  size        = mfe_matrices_carve_default(vars, m, alloc_vector, NULL);
+  vars->arena = arena_get((struct mx_arena *)arena, size);
+
+  (void)mfe_matrices_carve_default(vars, m, alloc_vector, (struct mx_arena *)vars->arena);
 
   /* setting exterior loop energies for circular case to INF is always safe */
   vars->FcH = vars->FcI = vars->FcM = vars->Fc = INF;
@@ -737,14 +912,16 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
 PRIVATE void
 mfe_matrices_free_default(vrna_mx_mfe_t *self)
 {
-  free(self->f5);
-  free(self->f3);
-  free(self->fc);
-  free(self->c);
-  free(self->fML);
-  free(self->fM1);
-  free(self->fM2);
-  free(self->ggg);
+  struct mx_arena *arena = (struct mx_arena *)self->arena;
+
+  arena_release(arena, self->f5);
+  arena_release(arena, self->f3);
+  arena_release(arena, self->fc);
+  arena_release(arena, self->c);
+  arena_release(arena, self->fML);
+  arena_release(arena, self->fM1);
+  arena_release(arena, self->fM2);
+  arena_release(arena, self->ggg);
 }
 
 
@@ -1279,16 +1456,24 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 }
 
 
-PRIVATE void
-pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
-                          unsigned int  m,
-                          unsigned int  alloc_vector)
+/*
+ *  Distribute the memory of an arena among the default PF matrices
+ *  (including the scale and expMLbase arrays) and return the number of
+ *  bytes required. If arena is NULL, only the size is computed.
+ */
+PRIVATE size_t
+pf_matrices_carve_default(vrna_mx_pf_t    *vars,
+                          unsigned int    m,
+                          unsigned int    alloc_vector,
+                          struct mx_arena *arena)
 {
-  unsigned int n, size, lin_size;
+  unsigned int  n, size, lin_size;
+  size_t        offset;
 
   n         = vars->length;
   size      = ((n + 1) * (n + 2)) / 2;
   lin_size  = n + 2;
+  offset    = 0;
 
   vars->q     = NULL;
   vars->qb    = NULL;
@@ -1300,42 +1485,65 @@ pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
   vars->qln   = NULL;
 
   if (alloc_vector & ALLOC_F)
-    vars->q = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    vars->q = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * size);
 
   if (alloc_vector & ALLOC_C)
-    vars->qb = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    vars->qb = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * size);
 
   if (alloc_vector & ALLOC_FML)
-    vars->qm = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    vars->qm = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * size);
 
   if (alloc_vector & ALLOC_UNIQ)
-    vars->qm1 = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    vars->qm1 = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * size);
 
   if (alloc_vector & ALLOC_CIRC)
-    vars->qm2 = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
+    vars->qm2 = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * lin_size);
 
   if (alloc_vector & ALLOC_PROBS)
-    vars->probs = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    vars->probs = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * size);
 
   if (alloc_vector & ALLOC_AUX) {
-    vars->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
-    vars->qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
+    vars->q1k = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * lin_size);
+    vars->qln = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * lin_size);
   }
+
+  vars->scale     = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * lin_size);
+  vars->expMLbase = (FLT_OR_DBL *)arena_carve(arena, &offset, sizeof(FLT_OR_DBL) * lin_size);
+
+  return offset;
+}
+
+
+PRIVATE void
+pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
+                          unsigned int  m,
+                          unsigned int  alloc_vector,
+                          void          *arena)
+{
+  size_t size;
+
+  /* get a sufficiently large arena (re-use the one we've been given if possible) */
+  size        = pf_matrices_carve_default(vars, m, alloc_vector, NULL);
+  vars->arena = arena_get((struct mx_arena *)arena, size);
+
+  (void)pf_matrices_carve_default(vars, m, alloc_vector, (struct mx_arena *)vars->arena);
 }
 
 
 PRIVATE void
 pf_matrices_free_default(vrna_mx_pf_t *self)
 {
-  free(self->q);
-  free(self->qb);
-  free(self->qm);
-  free(self->qm1);
-  free(self->qm2);
-  free(self->probs);
-  free(self->G);
-  free(self->q1k);
-  free(self->qln);
+  struct mx_arena *arena = (struct mx_arena *)self->arena;
+
+  arena_release(arena, self->q);
+  arena_release(arena, self->qb);
+  arena_release(arena, self->qm);
+  arena_release(arena, self->qm1);
+  arena_release(arena, self->qm2);
+  arena_release(arena, self->probs);
+  arena_release(arena, self->G);
+  arena_release(arena, self->q1k);
+  arena_release(arena, self->qln);
 }
 
 
@@ -196,6 +196,8 @@ struct {
 };
 };
 #endif
+
+  void *arena;  /**<  @brief  Memory block the (default) DP matrices are carved from (internal use only) */
 };
 
 /**
@@ -210,7 +212,6 @@ struct vrna_mx_pf_s {
   FLT_OR_DBL *scale;
   FLT_OR_DBL *expMLbase;
 
-
   /**
    *  @}
    */
@@ -355,6 +356,8 @@ struct {
 };
 };
 #endif
+
+  void *arena;  /**<  @brief  Memory block the (default) DP matrices are carved from (internal use only) */
 };
 
 /**
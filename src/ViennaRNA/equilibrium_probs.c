@@ -31,6 +31,10 @@
 
 #include "ViennaRNA/loops/external_hc.inc"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -118,6 +122,8 @@ typedef struct {
   FLT_OR_DBL  *prm_l1;
   FLT_OR_DBL  *prml;
 
+  FLT_OR_DBL  *prm_MLbk;  /* linear multibranch contributions prm_MLb for each k of the current column */
+
   int         ud_max_size;
   FLT_OR_DBL  **pmlu;
   FLT_OR_DBL  *prm_MLbu;
@@ -144,6 +150,15 @@ PRIVATE void
 compute_bpp_external(vrna_fold_compound_t *fc);
 
 
+#ifdef _OPENMP
+
+PRIVATE int
+outside_parallel_compatible(vrna_fold_compound_t *fc);
+
+
+#endif
+
+
 PRIVATE void
 compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  l,
@@ -151,7 +166,8 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *corr_cnt,
                      int                  *corr_size,
                      FLT_OR_DBL           *Qmax,
-                     int                  *ov);
+                     int                  *ov,
+                     int                  threads);
 
 
 PRIVATE void
@@ -161,7 +177,8 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
                                  int                  *corr_cnt,
                                  int                  *corr_size,
                                  FLT_OR_DBL           *Qmax,
-                                 int                  *ov);
+                                 int                  *ov,
+                                 int                  threads);
 
 
 PRIVATE void
@@ -179,7 +196,8 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
                         int                   l,
                         helper_arrays         *ml_helpers,
                         FLT_OR_DBL            *Qmax,
-                        int                   *ov);
+                        int                   *ov,
+                        int                   threads);
 
 
 PRIVATE void
@@ -187,7 +205,8 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     int                   l,
                                     helper_arrays         *ml_helpers,
                                     FLT_OR_DBL            *Qmax,
-                                    int                   *ov);
+                                    int                   *ov,
+                                    int                   threads);
 
 
 PRIVATE FLT_OR_DBL
@@ -559,7 +578,7 @@ PRIVATE int
 pf_create_bppm(vrna_fold_compound_t *vc,
                char                 *structure)
 {
-  int               n, i, j, l, ij, *pscore, *jindx, ov = 0;
+  int               n, i, j, l, ij, *pscore, *jindx, ov = 0, threads;
   FLT_OR_DBL        Qmax = 0;
   FLT_OR_DBL        *qb, *G, *probs;
   FLT_OR_DBL        *q1k, *qln;
@@ -619,13 +638,15 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                                      int                  *corr_cnt,
                                      int                  *corr_size,
                                      FLT_OR_DBL           *Qmax,
-                                     int                  *ov);
+                                     int                  *ov,
+                                     int                  threads);
 
     void (*compute_bpp_mul)(vrna_fold_compound_t  *fc,
                             int                   l,
                             helper_arrays         *ml_helpers,
                             FLT_OR_DBL            *Qmax,
-                            int                   *ov);
+                            int                   *ov,
+                            int                   threads);
 
     if (vc->type == VRNA_FC_TYPE_SINGLE) {
       compute_bpp_int = &compute_bpp_internal;
@@ -635,6 +656,22 @@ pf_create_bppm(vrna_fold_compound_t *vc,
       compute_bpp_mul = &compute_bpp_multibranch_comparative;
     }
 
+    /*
+     *  The outside recursions for single sequences may distribute the
+     *  base pairs (k, l) of each column l among multiple threads. Each
+     *  probability is still accumulated by a single thread in the same
+     *  order as in the serial implementation.
+     */
+    threads = 1;
+
+#ifdef _OPENMP
+    if ((vc->type == VRNA_FC_TYPE_SINGLE) &&
+        (md->threads > 1) &&
+        (outside_parallel_compatible(vc)))
+      threads = MIN2(md->threads, omp_get_num_procs());
+
+#endif
+
     Qmax = 0;
 
     /* init diagonal entries unable to pair in pr matrix */
@@ -653,7 +690,8 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                     &corr_cnt,
                     &corr_size,
                     &Qmax,
-                    &ov);
+                    &ov,
+                    threads);
 
     for (l = n - 1; l > turn + 1; l--) {
       compute_bpp_int(vc,
@@ -662,13 +700,15 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                       &corr_cnt,
                       &corr_size,
                       &Qmax,
-                      &ov);
+                      &ov,
+                      threads);
 
       compute_bpp_mul(vc,
                       l,
                       ml_helpers,
                       &Qmax,
-                      &ov);
+                      &ov,
+                      threads);
     }
 
     if (vc->type == VRNA_FC_TYPE_SINGLE) {
@@ -772,6 +812,9 @@ pf_create_bppm(vrna_fold_compound_t *vc,
     free_ml_helper_arrays(ml_helpers);
 
     free(bp_correction);
+
+    if (ov > 0)
+      return 0;
   } /* end if 'check for forward recursion' */
   else {
     vrna_message_warning("bppm calculations have to be done after calling forward recursion");
@@ -796,9 +839,10 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
 
   ml_helpers = (helper_arrays *)vrna_alloc(sizeof(helper_arrays));
 
-  ml_helpers->prm_l   = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
-  ml_helpers->prm_l1  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
-  ml_helpers->prml    = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_helpers->prm_l     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_helpers->prm_l1    = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_helpers->prml      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  ml_helpers->prm_MLbk  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
 
   ml_helpers->ud_max_size = 0;
   ml_helpers->pmlu        = NULL;
@@ -835,6 +879,7 @@ free_ml_helper_arrays(helper_arrays *ml_helpers)
   free(ml_helpers->prm_l);
   free(ml_helpers->prm_l1);
   free(ml_helpers->prml);
+  free(ml_helpers->prm_MLbk);
 
   if (ml_helpers->pmlu) {
     for (u = 0; u <= ml_helpers->ud_max_size; u++)
@@ -937,6 +982,28 @@ compute_bpp_external(vrna_fold_compound_t *fc)
 }
 
 
+#ifdef _OPENMP
+
+/*
+ *  The outside recursions may only be distributed among multiple threads
+ *  if we do not need to call any user-defined callback, since we can not
+ *  guarantee that those are thread-safe.
+ */
+PRIVATE int
+outside_parallel_compatible(vrna_fold_compound_t *fc)
+{
+  if ((fc->hc->f) ||
+      (fc->domains_up) ||
+      ((fc->sc) && ((fc->sc->exp_f) || (fc->sc->bt))))
+    return 0;
+
+  return 1;
+}
+
+
+#endif
+
+
 PRIVATE FLT_OR_DBL
 contrib_ext_pair(vrna_fold_compound_t *fc,
                  unsigned int         i,
@@ -1027,7 +1094,8 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *corr_cnt,
                      int                  *corr_size,
                      FLT_OR_DBL           *Qmax,
-                     int                  *ov)
+                     int                  *ov,
+                     int                  threads)
 {
   unsigned char     type, type_2;
   char              *ptype;
@@ -1065,130 +1133,152 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
 
   max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
-  /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
-  for (k = 1; k < l - turn; k++) {
-    kl = my_iindx[k] - l;
-
-    if (qb[kl] == 0.)
-      continue;
+#ifdef _OPENMP
+#pragma omp parallel if (threads > 1) num_threads(threads) \
+  private(i, j, k, ij, kl, u1, u2, type, type_2, temp, tmp2)
+#endif
+  {
+    int         ov_thread   = 0;
+    FLT_OR_DBL  qmax_thread = *Qmax;
 
-    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
-      type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
+    /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (k = 1; k < l - turn; k++) {
+      kl = my_iindx[k] - l;
 
-      for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
-        u1 = k - i - 1;
-        if (hc_up_int[i + 1] < u1)
-          continue;
+      if (qb[kl] == 0.)
+        continue;
 
-        for (j = l + 1; j <= MIN2(l + MAXLOOP - k + i + 2, n); j++) {
-          ij = my_iindx[i] - j;
+      if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+        type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
 
-          if (probs[ij] == 0.)
+        for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
+          u1 = k - i - 1;
+          if (hc_up_int[i + 1] < u1)
             continue;
 
-          u2 = j - l - 1;
+          for (j = l + 1; j <= MIN2(l + MAXLOOP - k + i + 2, n); j++) {
+            ij = my_iindx[i] - j;
 
-          if (hc_up_int[l + 1] < u2)
-            break;
+            if (probs[ij] == 0.)
+              continue;
 
-          if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
-            int jij = jindx[j] + i;
-            type = vrna_get_ptype(jij, ptype);
-
-            if ((sn[k] == sn[i]) &&
-                (sn[j] == sn[l])) {
-              tmp2 = probs[ij]
-                     * scale[u1 + u2 + 2]
-                     * exp_E_IntLoop(u1,
-                                     u2,
-                                     type,
-                                     type_2,
-                                     S1[i + 1],
-                                     S1[j - 1],
-                                     S1[k - 1],
-                                     S1[l + 1],
-                                     pf_params);
+            u2 = j - l - 1;
 
-              if (sc) {
-                if (sc->exp_energy_up)
-                  tmp2 *= sc->exp_energy_up[i + 1][u1]
-                          * sc->exp_energy_up[l + 1][u2];
-
-                if (sc->exp_energy_bp)
-                  tmp2 *= sc->exp_energy_bp[jij];
-
-                if (sc->exp_energy_stack) {
-                  if ((i + 1 == k) && (j - 1 == l)) {
-                    tmp2 *= sc->exp_energy_stack[i]
-                            * sc->exp_energy_stack[k]
-                            * sc->exp_energy_stack[l]
-                            * sc->exp_energy_stack[j];
+            if (hc_up_int[l + 1] < u2)
+              break;
+
+            if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+              int jij = jindx[j] + i;
+              type = vrna_get_ptype(jij, ptype);
+
+              if ((sn[k] == sn[i]) &&
+                  (sn[j] == sn[l])) {
+                tmp2 = probs[ij]
+                       * scale[u1 + u2 + 2]
+                       * exp_E_IntLoop(u1,
+                                       u2,
+                                       type,
+                                       type_2,
+                                       S1[i + 1],
+                                       S1[j - 1],
+                                       S1[k - 1],
+                                       S1[l + 1],
+                                       pf_params);
+
+                if (sc) {
+                  if (sc->exp_energy_up)
+                    tmp2 *= sc->exp_energy_up[i + 1][u1]
+                            * sc->exp_energy_up[l + 1][u2];
+
+                  if (sc->exp_energy_bp)
+                    tmp2 *= sc->exp_energy_bp[jij];
+
+                  if (sc->exp_energy_stack) {
+                    if ((i + 1 == k) && (j - 1 == l)) {
+                      tmp2 *= sc->exp_energy_stack[i]
+                              * sc->exp_energy_stack[k]
+                              * sc->exp_energy_stack[l]
+                              * sc->exp_energy_stack[j];
+                    }
                   }
+
+                  if (sc->exp_f)
+                    tmp2 *= sc->exp_f(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
                 }
 
-                if (sc->exp_f)
-                  tmp2 *= sc->exp_f(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
-              }
+                if (with_ud) {
+                  FLT_OR_DBL qql, qqr;
 
-              if (with_ud) {
-                FLT_OR_DBL qql, qqr;
+                  qql = qqr = 0.;
 
-                qql = qqr = 0.;
+                  if (u1 > 0) {
+                    qql = domains_up->exp_energy_cb(fc,
+                                                    i + 1, k - 1,
+                                                    VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
+                                                    domains_up->data);
+                  }
 
-                if (u1 > 0) {
-                  qql = domains_up->exp_energy_cb(fc,
-                                                  i + 1, k - 1,
-                                                  VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                                  domains_up->data);
-                }
+                  if (u2 > 0) {
+                    qqr = domains_up->exp_energy_cb(fc,
+                                                    l + 1, j - 1,
+                                                    VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
+                                                    domains_up->data);
+                  }
 
-                if (u2 > 0) {
-                  qqr = domains_up->exp_energy_cb(fc,
-                                                  l + 1, j - 1,
-                                                  VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                                  domains_up->data);
+                  temp  = tmp2;
+                  tmp2  += temp * qql;
+                  tmp2  += temp * qqr;
+                  tmp2  += temp * qql * qqr;
                 }
 
-                temp  = tmp2;
-                tmp2  += temp * qql;
-                tmp2  += temp * qqr;
-                tmp2  += temp * qql * qqr;
-              }
-
-              if (sc && sc->exp_f && sc->bt) {
-                /* store probability correction for auxiliary pairs in interior loop motif */
-                vrna_basepair_t *ptr, *aux_bps;
-                aux_bps = sc->bt(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
-                for (ptr = aux_bps; ptr && ptr->i != 0; ptr++) {
-                  (*bp_correction)[*corr_cnt].i     = ptr->i;
-                  (*bp_correction)[*corr_cnt].j     = ptr->j;
-                  (*bp_correction)[(*corr_cnt)++].p = tmp2 * qb[kl];
-                  if ((*corr_cnt) == (*corr_size)) {
-                    (*corr_size)      += 5;
-                    (*bp_correction)  = vrna_realloc(*bp_correction,
-                                                     sizeof(vrna_ep_t) * (*corr_size));
+                if (sc && sc->exp_f && sc->bt) {
+                  /* store probability correction for auxiliary pairs in interior loop motif */
+                  vrna_basepair_t *ptr, *aux_bps;
+                  aux_bps = sc->bt(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
+                  for (ptr = aux_bps; ptr && ptr->i != 0; ptr++) {
+                    (*bp_correction)[*corr_cnt].i     = ptr->i;
+                    (*bp_correction)[*corr_cnt].j     = ptr->j;
+                    (*bp_correction)[(*corr_cnt)++].p = tmp2 * qb[kl];
+                    if ((*corr_cnt) == (*corr_size)) {
+                      (*corr_size)      += 5;
+                      (*bp_correction)  = vrna_realloc(*bp_correction,
+                                                       sizeof(vrna_ep_t) * (*corr_size));
+                    }
                   }
+                  free(aux_bps);
                 }
-                free(aux_bps);
-              }
 
-              probs[kl] += tmp2;
+                probs[kl] += tmp2;
+              }
             }
           }
         }
       }
-    }
 
-    if (probs[kl] > (*Qmax)) {
-      (*Qmax) = probs[kl];
-      if ((*Qmax) > max_real / 10.)
-        vrna_message_warning("P close to overflow: %d %d %g %g\n",
-                             k, l, probs[kl], qb[kl]);
+      if (probs[kl] > qmax_thread) {
+        qmax_thread = probs[kl];
+        if (qmax_thread > max_real / 10.)
+          vrna_message_warning("P close to overflow: %d %d %g %g\n",
+                               k, l, probs[kl], qb[kl]);
+      }
+
+      if (probs[kl] >= max_real) {
+        ov_thread++;
+        probs[kl] = FLT_MAX;
+      }
     }
 
-    if (probs[kl] >= max_real) {
-      (*ov)++;
-      probs[kl] = FLT_MAX;
+#ifdef _OPENMP
+#pragma omp critical (bpp_outside_reduce)
+#endif
+    {
+      if (qmax_thread > *Qmax)
+        *Qmax = qmax_thread;
+
+      *ov += ov_thread;
     }
   }
 
@@ -1204,7 +1294,8 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
                                  int                  *corr_cnt,
                                  int                  *corr_size,
                                  FLT_OR_DBL           *Qmax,
-                                 int                  *ov)
+                                 int                  *ov,
+                                 int                  threads)
 {
   short             **SS, **S5, **S3;
   unsigned int      type, *tt, s, n_seq, **a2s;
@@ -1347,7 +1438,8 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
                         int                   l,
                         helper_arrays         *ml_helpers,
                         FLT_OR_DBL            *Qmax,
-                        int                   *ov)
+                        int                   *ov,
+                        int                   threads)
 {
   unsigned char     tt;
   char              *ptype;
@@ -1397,8 +1489,17 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
     for (i = 0; i <= n; i++)
       ml_helpers->prm_l[i] = 0;
   } else {
+    /*
+     *  The contributions for the pairs (k, l) are computed in three passes.
+     *  The first and the last pass are independent for each k and may
+     *  be distributed among multiple threads. The second pass accumulates
+     *  the linear contributions prm_MLb and is always processed sequentially.
+     */
+#ifdef _OPENMP
+#pragma omp parallel for if (threads > 1) num_threads(threads) schedule(static) \
+  private(i, j, ij, lj, ii, tt, s3, ppp, prmt, prmt1, cnt, u, temp)
+#endif
     for (k = 2; k < l - turn; k++) {
-      kl    = my_iindx[k] - l;
       i     = k - 1;
       prmt  = prmt1 = 0.0;
 
@@ -1511,6 +1612,10 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         if (with_ud)
           ml_helpers->pmlu[0][i] = prmt1;
       }
+    }
+
+    for (k = 2; k < l - turn; k++) {
+      i = k - 1;
 
       /* i is unpaired */
       if (hc->up_ml[i]) {
@@ -1560,7 +1665,10 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
 
       ml_helpers->prml[i] = ml_helpers->prml[i] + ml_helpers->prm_l[i];
 
-      tt = ptype[jindx[l] + k];
+      ml_helpers->prm_MLbk[k] = prm_MLb;
+
+      kl  = my_iindx[k] - l;
+      tt  = ptype[jindx[l] + k];
 
       if (with_gquad) {
         if ((!tt) && (G[kl] == 0.))
@@ -1570,53 +1678,88 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           continue;
       }
 
-      if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
-        temp = prm_MLb;
+      /* rotate prm_MLbu entries required for unstructured domain feature */
+      rotate_ml_helper_arrays_inner(ml_helpers);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel if (threads > 1) num_threads(threads) \
+  private(i, k, kl, tt, s5, s3, temp)
+#endif
+    {
+      int         ov_thread   = 0;
+      FLT_OR_DBL  qmax_thread = *Qmax;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for (k = 2; k < l - turn; k++) {
+        kl  = my_iindx[k] - l;
+        tt  = ptype[jindx[l] + k];
 
-        if (sn[k] == sn[k - 1]) {
-          for (i = 1; i <= k - 2; i++)
-            if (sn[i + 1] == sn[i])
-              temp += ml_helpers->prml[i] *
-                      qm[my_iindx[i + 1] - (k - 1)];
+        if (with_gquad) {
+          if ((!tt) && (G[kl] == 0.))
+            continue;
+        } else {
+          if (qb[kl] == 0.)
+            continue;
         }
 
-        s5  = ((k > 1) && (sn[k] == sn[k - 1])) ? S1[k - 1] : -1;
-        s3  = ((l < n) && (sn[l + 1] == sn[l])) ? S1[l + 1] : -1;
+        if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+          temp = ml_helpers->prm_MLbk[k];
+
+          if (sn[k] == sn[k - 1]) {
+            for (i = 1; i <= k - 2; i++)
+              if (sn[i + 1] == sn[i])
+                temp += ml_helpers->prml[i] *
+                        qm[my_iindx[i + 1] - (k - 1)];
+          }
+
+          s5  = ((k > 1) && (sn[k] == sn[k - 1])) ? S1[k - 1] : -1;
+          s3  = ((l < n) && (sn[l + 1] == sn[l])) ? S1[l + 1] : -1;
+
+          if (with_gquad) {
+            if (tt)
+              temp *= exp_E_MLstem(tt, s5, s3, pf_params) *
+                      scale[2];
+            else
+              temp *= G[kl] *
+                      expMLstem *
+                      scale[2];
+          } else {
+            if (tt == 0)
+              tt = 7;
 
-        if (with_gquad) {
-          if (tt)
             temp *= exp_E_MLstem(tt, s5, s3, pf_params) *
                     scale[2];
-          else
-            temp *= G[kl] *
-                    expMLstem *
-                    scale[2];
-        } else {
-          if (tt == 0)
-            tt = 7;
+          }
 
-          temp *= exp_E_MLstem(tt, s5, s3, pf_params) *
-                  scale[2];
+          probs[kl] += temp;
         }
 
-        probs[kl] += temp;
-      }
+        if (probs[kl] > qmax_thread) {
+          qmax_thread = probs[kl];
+          if (qmax_thread > max_real / 10.)
+            vrna_message_warning("P close to overflow: %d %d %g %g\n",
+                                 k, l, probs[kl], qb[kl]);
+        }
 
-      if (probs[kl] > (*Qmax)) {
-        (*Qmax) = probs[kl];
-        if ((*Qmax) > max_real / 10.)
-          vrna_message_warning("P close to overflow: %d %d %g %g\n",
-                               k, l, probs[kl], qb[kl]);
+        if (probs[kl] >= max_real) {
+          ov_thread++;
+          probs[kl] = FLT_MAX;
+        }
       }
 
-      if (probs[kl] >= max_real) {
-        (*ov)++;
-        probs[kl] = FLT_MAX;
-      }
+#ifdef _OPENMP
+#pragma omp critical (bpp_outside_reduce)
+#endif
+      {
+        if (qmax_thread > *Qmax)
+          *Qmax = qmax_thread;
 
-      /* rotate prm_MLbu entries required for unstructured domain feature */
-      rotate_ml_helper_arrays_inner(ml_helpers);
-    } /* end for (k=..) */
+        *ov += ov_thread;
+      }
+    }
   }
 
   rotate_ml_helper_arrays_outer(ml_helpers);
@@ -1628,7 +1771,8 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     int                   l,
                                     helper_arrays         *ml_helpers,
                                     FLT_OR_DBL            *Qmax,
-                                    int                   *ov)
+                                    int                   *ov,
+                                    int                   threads)
 {
   unsigned char     tt;
   short             **S, **S5, **S3;
@@ -2132,7 +2276,8 @@ pf_co_bppm(vrna_fold_compound_t *vc,
                          &corr_cnt,
                          &corr_size,
                          &Qmax,
-                         &ov);
+                         &ov,
+                         1);
 
     for (l = n - 1; l > turn + 1; l--) {
       compute_bpp_internal(vc,
@@ -2141,13 +2286,15 @@ pf_co_bppm(vrna_fold_compound_t *vc,
                            &corr_cnt,
                            &corr_size,
                            &Qmax,
-                           &ov);
+                           &ov,
+                           1);
 
       compute_bpp_multibranch(vc,
                               l,
                               ml_helpers,
                               &Qmax,
-                              &ov);
+                              &ov,
+                              1);
 
       /* computation of .(..(...)..&..). type features? */
       if (vc->strands <= 1)
@@ -2265,10 +2412,12 @@ pf_co_bppm(vrna_fold_compound_t *vc,
     return 0;
   }
 
-  if (ov > 0)
+  if (ov > 0) {
     vrna_message_warning("%d overflows occurred while backtracking;\n"
                          "you might try a smaller pf_scale than %g\n",
                          ov, pf_params->pf_scale);
+    return 0;
+  }
 
   return 1;
 }
@@ -59,6 +59,18 @@
  *  @{
  */
 
+/**
+ *  @brief  Compute the base pair probabilities from the filled partition function matrices
+ *
+ *  @note   Usually called from within vrna_pf(), where an overflow in the outside
+ *          recursions leads to an automatic adjustment of the scaling factor
+ *          #vrna_exp_param_t.pf_scale and re-computation of all matrices.
+ *
+ *  @param  vc        The fold compound data structure with filled partition function matrices
+ *  @param  structure A pointer to the character array where position-wise pairing propensity
+ *                    will be stored (Maybe NULL)
+ *  @return           1 on success, 0 on failure, e.g. if any of the probabilities overflowed
+ */
 int
 vrna_pairing_probs(vrna_fold_compound_t *vc,
                    char                 *structure);
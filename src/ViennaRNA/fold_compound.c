@@ -118,6 +118,7 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
     free(fc->jindx);
     free(fc->params);
     free(fc->exp_params);
+    free(fc->pbacktrack_rng);
 
     vrna_hc_free(fc->hc);
     vrna_ud_remove(fc);
@@ -187,6 +188,59 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC vrna_fold_compound_t *
+vrna_fold_compound_recycle(vrna_fold_compound_t *fc,
+                           const char           *sequence,
+                           const vrna_md_t      *md_p,
+                           unsigned int         options)
+{
+  vrna_fold_compound_t *fc_new;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (options & (VRNA_OPTION_WINDOW | VRNA_OPTION_EVAL_ONLY))) {
+    vrna_fold_compound_free(fc);
+    return vrna_fold_compound(sequence, md_p, options);
+  }
+
+  fc_new = vrna_fold_compound(sequence,
+                              md_p,
+                              options & ~(VRNA_OPTION_MFE | VRNA_OPTION_PF));
+
+  if (fc_new) {
+    /* hand over DP matrices that are large enough to hold the new sequence */
+    if ((fc->matrices) &&
+        (fc->matrices->type == VRNA_MX_DEFAULT) &&
+        (fc->matrices->length >= fc_new->length)) {
+      fc_new->matrices  = fc->matrices;
+      fc->matrices      = NULL;
+
+      /* the G-quadruplex matrix is only filled upon allocation, so re-compute it here */
+      free(fc_new->matrices->ggg);
+      fc_new->matrices->ggg = NULL;
+      if (fc_new->params->model_details.gquad)
+        fc_new->matrices->ggg = get_gquad_matrix(fc_new->sequence_encoding2, fc_new->params);
+    }
+
+    if ((fc->exp_matrices) &&
+        (fc->exp_matrices->type == VRNA_MX_DEFAULT) &&
+        (fc->exp_matrices->length >= fc_new->length)) {
+      fc_new->exp_matrices  = fc->exp_matrices;
+      fc->exp_matrices      = NULL;
+      /* scale and expMLbase arrays are re-computed along with the Boltzmann factors */
+      vrna_exp_params_rescale(fc_new, NULL);
+    }
+
+    if (options & (VRNA_OPTION_MFE | VRNA_OPTION_PF))
+      vrna_fold_compound_prepare(fc_new, options & (VRNA_OPTION_MFE | VRNA_OPTION_PF));
+  }
+
+  vrna_fold_compound_free(fc);
+
+  return fc_new;
+}
+
+
 PUBLIC vrna_fold_compound_t *
 vrna_fold_compound(const char       *sequence,
                    const vrna_md_t  *md_p,
@@ -896,6 +950,8 @@ nullify(vrna_fold_compound_t *fc)
     fc->iindx         = NULL;
     fc->jindx         = NULL;
 
+    fc->pbacktrack_rng  = NULL;
+
     fc->stat_cb       = NULL;
     fc->auxdata       = NULL;
     fc->free_auxdata  = NULL;
@@ -344,6 +344,10 @@ struct {
   /**
    *  @}
    */
+
+  struct vrna_pbacktrack_rng_s *pbacktrack_rng; /**<  @brief  Seeded random number streams for stochastic backtracking
+                                                 *    @see    vrna_pbacktrack_set_seed()
+                                                 */
 };
 
 
@@ -511,6 +515,37 @@ void
 vrna_fold_compound_free(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Re-use a #vrna_fold_compound_t for another sequence
+ *
+ *  This function behaves like a call to vrna_fold_compound_free() followed by
+ *  vrna_fold_compound(), except that the DP matrices attached to @p fc are handed
+ *  over to the newly created #vrna_fold_compound_t whenever they are large enough
+ *  to hold the new @p sequence. Applications that process many sequences one after
+ *  another, e.g. one per worker thread, thus avoid allocating and releasing large
+ *  amounts of memory for each of them.
+ *
+ *  Matrices are only transferred for single sequence fold compounds in default
+ *  (global) mode. In any other case, the old data structure is simply released.
+ *
+ *  @note The old fold compound @p fc must not be used anymore after this call,
+ *        regardless of whether its matrices have been re-used or not.
+ *
+ *  @see  vrna_fold_compound(), vrna_fold_compound_free(), vrna_fold_compound_prepare()
+ *
+ *  @param    fc        The fold compound to recycle (may be @p NULL)
+ *  @param    sequence  The new RNA sequence
+ *  @param    md_p      An optional set of model details
+ *  @param    options   The options for DP matrices memory allocation
+ *  @return             A prefilled #vrna_fold_compound_t for @p sequence (may be @p NULL on error)
+ */
+vrna_fold_compound_t *
+vrna_fold_compound_recycle(vrna_fold_compound_t *fc,
+                           const char           *sequence,
+                           const vrna_md_t      *md_p,
+                           unsigned int         options);
+
+
 /**
  *  @brief  Add auxiliary data to the #vrna_fold_compound_t
  *
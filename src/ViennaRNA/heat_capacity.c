@@ -1,9 +1,23 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include  <stdio.h>
 #include  <stdlib.h>
+#include  <string.h>
 #include  <math.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include  "ViennaRNA/utils/basic.h"
 #include  "ViennaRNA/params/constants.h"
+#include  "ViennaRNA/params/basic.h"
+#include  "ViennaRNA/fold_compound.h"
+#include  "ViennaRNA/dp_matrices.h"
+#include  "ViennaRNA/alphabet.h"
+#include  "ViennaRNA/constraints/hard.h"
 #include  "ViennaRNA/mfe.h"
 #include  "ViennaRNA/part_func.h"
 #include  "ViennaRNA/heat_capacity.h"
@@ -29,6 +43,32 @@ store_results_cb(float  t,
                  void   *data);
 
 
+#ifdef _OPENMP
+
+PRIVATE int
+heat_capacity_parallel(vrna_fold_compound_t         *fc,
+                       vrna_md_t                    *md,
+                       float                        T_min,
+                       float                        T_max,
+                       float                        h,
+                       unsigned int                 m,
+                       vrna_heat_capacity_callback  *cb,
+                       void                         *data);
+
+
+PRIVATE void
+ensemble_energies(vrna_fold_compound_t  *fc,
+                  vrna_md_t             *md,
+                  double                *temperatures,
+                  float                 *F,
+                  size_t                start,
+                  size_t                end,
+                  float                 h);
+
+
+#endif
+
+
 PUBLIC struct vrna_heat_capacity_s *
 vrna_heat_capacity_simple(const char    *sequence,
                           float         T_min,
@@ -137,6 +177,16 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
     md.backtrack    = 0;
     md.compute_bpp  = 0;
 
+#ifdef _OPENMP
+    /* evaluate the temperature grid concurrently, if requested */
+    if ((md.threads > 1) &&
+        (heat_capacity_parallel(fc, &md, T_min, T_max, h, m, cb, data))) {
+      vrna_params_reset(fc, &md_init);
+      return 1;
+    }
+
+#endif
+
     md.temperature = T_min - m * h;
     vrna_params_reset(fc, &md);
 
@@ -148,8 +198,9 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
       F[i] = vrna_pf(fc, NULL);
       /* increase temperature */
       md.temperature += h;
-      /* reset all energy parameters according to temperature changes */
-      vrna_params_reset(fc, &md);
+      /* re-scale all energy parameters according to temperature changes */
+      if (!vrna_fold_compound_set_temperature(fc, md.temperature))
+        vrna_params_reset(fc, &md);
 
       min_en = F[i] + h * 0.00727 * n;
 
@@ -170,7 +221,8 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
       /*       printf("%g\n", F[2*m]);*/
       md.temperature += h;
 
-      vrna_params_reset(fc, &md);
+      if (!vrna_fold_compound_set_temperature(fc, md.temperature))
+        vrna_params_reset(fc, &md);
 
       min_en = F[i] + h * 0.00727 * n;
 
@@ -227,3 +279,172 @@ store_results_cb(float  t,
   d->data[d->num_entries].heat_capacity = hc;
   d->num_entries++;
 }
+
+
+#ifdef _OPENMP
+
+/*
+ *  Compute the ensemble free energies for the entire temperature grid in
+ *  parallel and assemble the finite differences afterwards. Each thread
+ *  processes a contiguous range of temperatures with a shallow copy of the
+ *  fold compound that only owns its energy parameters, DP matrices, and hard
+ *  constraint struct, i.e. sequence encodings, pair type arrays and hard
+ *  constraint arrays are shared.
+ *  Returns 0 if the fold compound is not suitable for this mode
+ */
+PRIVATE int
+heat_capacity_parallel(vrna_fold_compound_t         *fc,
+                       vrna_md_t                    *md,
+                       float                        T_min,
+                       float                        T_max,
+                       float                        h,
+                       unsigned int                 m,
+                       vrna_heat_capacity_callback  *cb,
+                       void                         *data)
+{
+  int     threads;
+  float   hc, T_last, *F;
+  double  *temperatures;
+  size_t  i, k, num, num_F, chunk;
+
+  threads = MIN2(md->threads, omp_get_num_procs());
+
+  /* we cannot assume that user-defined callbacks or soft constraints are thread-safe */
+  if ((threads < 2) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (fc->hc->f) ||
+      (fc->sc) ||
+      (fc->stat_cb) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar))
+    return 0;
+
+  /*
+   *  determine the temperature grid the same way the serial implementation
+   *  walks through it, i.e. by repeatedly adding h to the lowest temperature.
+   *  Results are reported for every grid point k > 2m that does not exceed
+   *  the upper bound and require the ensemble free energies of points
+   *  k - 2m - 1 to k - 1
+   */
+  T_last        = T_max + m * h + h;
+  num           = 2 * m + 2;
+  temperatures  = (double *)vrna_alloc(sizeof(double) * num);
+
+  temperatures[0] = T_min - m * h;
+  for (k = 1; k < num; k++)
+    temperatures[k] = temperatures[k - 1] + h;
+
+  while (temperatures[num - 1] <= T_last) {
+    temperatures      = (double *)vrna_realloc(temperatures, sizeof(double) * (num + 1));
+    temperatures[num] = temperatures[num - 1] + h;
+    num++;
+  }
+
+  /* number of ensemble free energies actually required */
+  num_F = num - 2;
+  F     = (float *)vrna_alloc(sizeof(float) * num_F);
+
+  if ((size_t)threads > num_F)
+    threads = (int)num_F;
+
+  /*
+   *  make sure pair types and hard constraints are in place before the workers
+   *  start reading them. Both do not depend on the temperature
+   */
+  md->temperature = temperatures[0];
+  vrna_params_reset(fc, md);
+  vrna_params_prepare(fc, VRNA_OPTION_PF);
+  vrna_ptypes_prepare(fc, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+  (void)vrna_hc_prepare(fc, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+
+  chunk = (num_F + threads - 1) / threads;
+
+#pragma omp parallel for num_threads(threads) schedule(static, 1)
+  for (i = 0; i < (size_t)threads; i++)
+    ensemble_energies(fc,
+                      md,
+                      temperatures,
+                      F,
+                      MIN2(i * chunk, num_F),
+                      MIN2((i + 1) * chunk, num_F),
+                      h);
+
+  /* assemble the finite differences */
+  for (k = 2 * m + 1; k < num - 1; k++) {
+    hc = -ddiff(F + k - 2 * m - 1, h, m) * (temperatures[k] + K0 - m * h - h);
+    cb((temperatures[k] - (float)m * h - h), hc, data);
+  }
+
+  free(F);
+  free(temperatures);
+
+  return 1;
+}
+
+
+PRIVATE void
+ensemble_energies(vrna_fold_compound_t  *fc,
+                  vrna_md_t             *md,
+                  double                *temperatures,
+                  float                 *F,
+                  size_t                start,
+                  size_t                end,
+                  float                 h)
+{
+  size_t                k;
+  double                min_en;
+  vrna_md_t             md_worker;
+  vrna_hc_t             hc_worker;
+  vrna_fold_compound_t  *worker;
+
+  if (start >= end)
+    return;
+
+  worker = (vrna_fold_compound_t *)vrna_alloc(sizeof(vrna_fold_compound_t));
+  memcpy(worker, fc, sizeof(vrna_fold_compound_t));
+
+  /* the worker only owns its energy parameters and DP matrices */
+  worker->params          = NULL;
+  worker->exp_params      = NULL;
+  worker->matrices        = NULL;
+  worker->exp_matrices    = NULL;
+  worker->pbacktrack_rng  = NULL;
+
+  /*
+   *  vrna_hc_prepare() always resets the state of the hard constraints, so
+   *  each worker gets its own copy of the struct that still refers to the
+   *  shared (and already prepared) constraint arrays
+   */
+  hc_worker   = *(fc->hc);
+  worker->hc  = &hc_worker;
+
+  md_worker         = *md;
+  md_worker.threads = 1;
+
+  md_worker.temperature = temperatures[start];
+  vrna_params_reset(worker, &md_worker);
+
+  for (k = start; k < end; k++) {
+    /* the first temperature of each range requires an MFE to determine the scaling factor */
+    if (k == start) {
+      min_en = (double)vrna_mfe(worker, NULL);
+    } else {
+      (void)vrna_fold_compound_set_temperature(worker, temperatures[k]);
+      min_en = F[k - 1] + h * 0.00727 * worker->length;
+    }
+
+    vrna_exp_params_rescale(worker, &min_en);
+
+    F[k] = vrna_pf(worker, NULL);
+  }
+
+  vrna_mx_mfe_free(worker);
+  vrna_mx_pf_free(worker);
+  free(worker->params);
+  free(worker->exp_params);
+  free(worker);
+}
+
+
+#endif
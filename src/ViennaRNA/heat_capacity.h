@@ -114,6 +114,16 @@ vrna_heat_capacity(vrna_fold_compound_t *fc,
  *  to @f$ 2 \cdot mpoints + 1 @f$ data points to calculate 2nd derivatives. Increasing this
  *  parameter produces a smoother curve.
  *
+ *  If the model details of @p fc request more than one thread (see #vrna_md_t.threads) and
+ *  the library has been compiled with OpenMP support, the partition functions for the
+ *  individual temperatures are computed in parallel. Each thread then processes a
+ *  contiguous range of the temperature grid with its own energy parameters and DP
+ *  matrices, while the sequence encoding and hard constraints of @p fc are shared. The
+ *  callback is only executed after all partition functions are available, always in
+ *  order of increasing temperature, and from the calling thread. The serial implementation
+ *  is used whenever soft constraints, hard constraint callbacks, or other user-defined callbacks
+ *  are attached to @p fc.
+ *
  *  @see  vrna_heat_capacity(), vrna_heat_capacity_callback
  *
  *  @param  fc            The #vrna_fold_compound_t with the RNA sequence to analyze
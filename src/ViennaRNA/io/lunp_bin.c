@@ -0,0 +1,506 @@
+/*
+ * Binary files of unpaired probabilities with random access
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/part_func_window.h"
+#include "ViennaRNA/io/lunp_bin.h"
+
+#define LUNP_MAGIC        "VRNALUNP"
+#define LUNP_VERSION      1
+#define LUNP_BOM          0x01020304
+#define LUNP_HEADER_SIZE  64
+
+struct vrna_lunp_writer_s {
+  FILE          *fp;
+  unsigned int  length;
+  unsigned int  ulength;
+  unsigned int  chunk_size;
+  unsigned int  num_chunks;
+  unsigned int  chunk;      /* current chunk */
+  float         *buffer;    /* data of the current chunk */
+  uint64_t      *index;     /* offsets of the chunks */
+  uint64_t      offset;     /* current file offset */
+  int           error;
+};
+
+
+struct vrna_lunp_s {
+  unsigned char   *data;
+  size_t          size;
+  int             mapped;
+  unsigned int    length;
+  unsigned int    ulength;
+  unsigned int    chunk_size;
+  unsigned int    num_chunks;
+  const uint64_t  *index;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+write_header(vrna_lunp_writer_t writer,
+             uint64_t           index_offset);
+
+
+PRIVATE void
+flush_chunk(vrna_lunp_writer_t writer);
+
+
+PRIVATE unsigned char *
+map_file(const char *filename,
+         size_t     *size,
+         int        *mapped);
+
+
+PRIVATE void
+unmap_file(unsigned char  *data,
+           size_t         size,
+           int            mapped);
+
+
+PRIVATE int
+parse_header(vrna_lunp_t lunp);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_lunp_writer_t
+vrna_lunp_writer_open(const char    *filename,
+                      unsigned int  length,
+                      unsigned int  ulength)
+{
+  size_t              k;
+  vrna_lunp_writer_t  writer;
+
+  if ((!filename) ||
+      (length == 0) ||
+      (ulength == 0))
+    return NULL;
+
+  writer              = (vrna_lunp_writer_t)vrna_alloc(sizeof(struct vrna_lunp_writer_s));
+  writer->fp          = fopen(filename, "wb");
+  writer->length      = length;
+  writer->ulength     = ulength;
+  writer->chunk_size  = MIN2(length, VRNA_LUNP_CHUNK_SIZE);
+  writer->num_chunks  = (length + writer->chunk_size - 1) / writer->chunk_size;
+  writer->chunk       = 0;
+  writer->offset      = LUNP_HEADER_SIZE;
+  writer->error       = 0;
+
+  if (!writer->fp) {
+    vrna_message_warning("vrna_lunp_writer_open: "
+                         "Failed to open file \"%s\" for writing!",
+                         filename);
+    free(writer);
+    return NULL;
+  }
+
+  writer->buffer  = (float *)vrna_alloc(sizeof(float) * ulength * writer->chunk_size);
+  writer->index   = (uint64_t *)vrna_alloc(sizeof(uint64_t) * writer->num_chunks);
+
+  for (k = 0; k < (size_t)ulength * writer->chunk_size; k++)
+    writer->buffer[k] = (float)NAN;
+
+  /* reserve space for the header, the index offset is written upon closing */
+  if (!write_header(writer, 0))
+    writer->error = 1;
+
+  return writer;
+}
+
+
+PUBLIC void
+vrna_lunp_writer_cb(FLT_OR_DBL    *pr,
+                    int           pr_size,
+                    int           i,
+                    int           max,
+                    unsigned int  type,
+                    void          *data)
+{
+  unsigned int        chunk, u, u_max;
+  float               *values;
+  double              *probs;
+  vrna_lunp_writer_t  writer;
+
+  writer = (vrna_lunp_writer_t)data;
+
+  if ((!writer) ||
+      (!(type & VRNA_PROBS_WINDOW_UP)) ||
+      ((type & VRNA_ANY_LOOP) != VRNA_ANY_LOOP) ||
+      (i < 1) ||
+      ((unsigned int)i > writer->length))
+    return;
+
+  chunk = (unsigned int)(i - 1) / writer->chunk_size;
+
+  if (chunk < writer->chunk) {
+    vrna_message_warning("vrna_lunp_writer_cb: "
+                         "Unpaired probabilities for position %d arrived out of order!",
+                         i);
+    writer->error = 1;
+    return;
+  }
+
+  /* write all chunks up to the one of position i */
+  while (writer->chunk < chunk)
+    flush_chunk(writer);
+
+  /* unpaired probabilities are always provided as double precision values */
+  probs   = (double *)pr;
+  values  = writer->buffer + (i - 1) % writer->chunk_size;
+  u_max   = (unsigned int)MIN2(MIN2(pr_size, max), (int)writer->ulength);
+
+  for (u = 1; u <= u_max; u++)
+    values[(size_t)(u - 1) * writer->chunk_size] = (float)probs[u];
+}
+
+
+PUBLIC int
+vrna_lunp_writer_close(vrna_lunp_writer_t writer)
+{
+  int ret;
+
+  if (!writer)
+    return 0;
+
+  while (writer->chunk < writer->num_chunks)
+    flush_chunk(writer);
+
+  /* align the chunk index */
+  if (writer->offset % sizeof(uint64_t)) {
+    float pad = 0.;
+    if (fwrite(&pad, sizeof(float), 1, writer->fp) != 1)
+      writer->error = 1;
+
+    writer->offset += sizeof(float);
+  }
+
+  if (fwrite(writer->index, sizeof(uint64_t), writer->num_chunks,
+             writer->fp) != writer->num_chunks)
+    writer->error = 1;
+
+  if ((fseek(writer->fp, 0, SEEK_SET) != 0) ||
+      (!write_header(writer, writer->offset)))
+    writer->error = 1;
+
+  if (fclose(writer->fp) != 0)
+    writer->error = 1;
+
+  ret = (writer->error) ? 0 : 1;
+
+  if (!ret)
+    vrna_message_warning("vrna_lunp_writer_close: "
+                         "Failed to write binary unpaired probability file!");
+
+  free(writer->buffer);
+  free(writer->index);
+  free(writer);
+
+  return ret;
+}
+
+
+PUBLIC vrna_lunp_t
+vrna_lunp_open(const char *filename)
+{
+  vrna_lunp_t lunp;
+
+  if (!filename)
+    return NULL;
+
+  lunp        = (vrna_lunp_t)vrna_alloc(sizeof(struct vrna_lunp_s));
+  lunp->data  = map_file(filename, &(lunp->size), &(lunp->mapped));
+
+  if (!lunp->data) {
+    vrna_message_warning("vrna_lunp_open: "
+                         "Failed to open file \"%s\"!",
+                         filename);
+    free(lunp);
+    return NULL;
+  }
+
+  if (!parse_header(lunp)) {
+    vrna_message_warning("vrna_lunp_open: "
+                         "File \"%s\" is not a valid binary unpaired probability file!",
+                         filename);
+    vrna_lunp_close(lunp);
+    return NULL;
+  }
+
+  return lunp;
+}
+
+
+PUBLIC void
+vrna_lunp_close(vrna_lunp_t lunp)
+{
+  if (lunp) {
+    unmap_file(lunp->data, lunp->size, lunp->mapped);
+    free(lunp);
+  }
+}
+
+
+PUBLIC unsigned int
+vrna_lunp_length(vrna_lunp_t lunp)
+{
+  return (lunp) ? lunp->length : 0;
+}
+
+
+PUBLIC unsigned int
+vrna_lunp_ulength(vrna_lunp_t lunp)
+{
+  return (lunp) ? lunp->ulength : 0;
+}
+
+
+PUBLIC float
+vrna_lunp_get(vrna_lunp_t   lunp,
+              unsigned int  i,
+              unsigned int  u)
+{
+  unsigned int  first;
+  const float   *values;
+
+  values = vrna_lunp_chunk(lunp, i, u, &first, NULL);
+
+  return (values) ? values[i - first] : (float)NAN;
+}
+
+
+PUBLIC const float *
+vrna_lunp_chunk(vrna_lunp_t   lunp,
+                unsigned int  i,
+                unsigned int  u,
+                unsigned int  *first,
+                unsigned int  *last)
+{
+  unsigned int  chunk, start, end;
+
+  if ((!lunp) ||
+      (i < 1) ||
+      (i > lunp->length) ||
+      (u < 1) ||
+      (u > lunp->ulength))
+    return NULL;
+
+  chunk = (i - 1) / lunp->chunk_size;
+  start = chunk * lunp->chunk_size + 1;
+  end   = MIN2(start + lunp->chunk_size - 1, lunp->length);
+
+  if (first)
+    *first = start;
+
+  if (last)
+    *last = end;
+
+  return (const float *)(lunp->data + lunp->index[chunk]) +
+         (size_t)(u - 1) * (end - start + 1);
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE int
+write_header(vrna_lunp_writer_t writer,
+             uint64_t           index_offset)
+{
+  unsigned char header[LUNP_HEADER_SIZE];
+  uint32_t      v[6];
+
+  v[0]  = LUNP_VERSION;
+  v[1]  = LUNP_BOM;
+  v[2]  = writer->length;
+  v[3]  = writer->ulength;
+  v[4]  = writer->chunk_size;
+  v[5]  = writer->num_chunks;
+
+  memset(header, 0, sizeof(header));
+  memcpy(header, LUNP_MAGIC, 8);
+  memcpy(header + 8, v, sizeof(v));
+  memcpy(header + 32, &index_offset, sizeof(uint64_t));
+
+  return fwrite(header, sizeof(unsigned char), LUNP_HEADER_SIZE, writer->fp) == LUNP_HEADER_SIZE;
+}
+
+
+/*
+ *  Write the data of the current chunk, i.e. one array per segment length,
+ *  and prepare the buffer for the next chunk
+ */
+PRIVATE void
+flush_chunk(vrna_lunp_writer_t writer)
+{
+  unsigned int  u, start, size;
+  size_t        k;
+  float         *values;
+
+  start = writer->chunk * writer->chunk_size;
+  size  = MIN2(writer->chunk_size, writer->length - start);
+
+  writer->index[writer->chunk] = writer->offset;
+
+  for (u = 0; u < writer->ulength; u++) {
+    values = writer->buffer + (size_t)u * writer->chunk_size;
+
+    if (fwrite(values, sizeof(float), size, writer->fp) != size)
+      writer->error = 1;
+
+    writer->offset += sizeof(float) * size;
+  }
+
+  for (k = 0; k < (size_t)writer->ulength * writer->chunk_size; k++)
+    writer->buffer[k] = (float)NAN;
+
+  writer->chunk++;
+}
+
+
+PRIVATE unsigned char *
+map_file(const char *filename,
+         size_t     *size,
+         int        *mapped)
+{
+  unsigned char *data = NULL;
+
+#ifndef _WIN32
+  int           fd;
+  struct stat   st;
+
+  fd = open(filename, O_RDONLY);
+
+  if (fd < 0)
+    return NULL;
+
+  if ((fstat(fd, &st) == 0) &&
+      (st.st_size > 0)) {
+    data = (unsigned char *)mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      data = NULL;
+    } else {
+      *size   = (size_t)st.st_size;
+      *mapped = 1;
+    }
+  }
+
+  close(fd);
+#else
+  FILE          *fp;
+  long          s;
+
+  fp = fopen(filename, "rb");
+
+  if (!fp)
+    return NULL;
+
+  if ((fseek(fp, 0, SEEK_END) == 0) &&
+      ((s = ftell(fp)) > 0) &&
+      (fseek(fp, 0, SEEK_SET) == 0)) {
+    data = (unsigned char *)vrna_alloc(sizeof(unsigned char) * s);
+    if (fread(data, sizeof(unsigned char), (size_t)s, fp) != (size_t)s) {
+      free(data);
+      data = NULL;
+    } else {
+      *size   = (size_t)s;
+      *mapped = 0;
+    }
+  }
+
+  fclose(fp);
+#endif
+
+  return data;
+}
+
+
+PRIVATE void
+unmap_file(unsigned char  *data,
+           size_t         size,
+           int            mapped)
+{
+#ifndef _WIN32
+  if (mapped) {
+    munmap(data, size);
+    return;
+  }
+
+#endif
+  free(data);
+}
+
+
+PRIVATE int
+parse_header(vrna_lunp_t lunp)
+{
+  unsigned int  c, start, size;
+  uint32_t      v[6];
+  uint64_t      index_offset;
+
+  if ((lunp->size < LUNP_HEADER_SIZE) ||
+      (memcmp(lunp->data, LUNP_MAGIC, 8) != 0))
+    return 0;
+
+  memcpy(v, lunp->data + 8, sizeof(v));
+  memcpy(&index_offset, lunp->data + 32, sizeof(uint64_t));
+
+  if ((v[0] != LUNP_VERSION) ||
+      (v[1] != LUNP_BOM) ||
+      (v[2] == 0) ||
+      (v[3] == 0) ||
+      (v[4] == 0) ||
+      (v[5] != (v[2] + v[4] - 1) / v[4]))
+    return 0;
+
+  lunp->length      = v[2];
+  lunp->ulength     = v[3];
+  lunp->chunk_size  = v[4];
+  lunp->num_chunks  = v[5];
+
+  if ((index_offset % sizeof(uint64_t)) ||
+      (index_offset > lunp->size) ||
+      ((lunp->size - index_offset) / sizeof(uint64_t) < lunp->num_chunks))
+    return 0;
+
+  lunp->index = (const uint64_t *)(lunp->data + index_offset);
+
+  /* make sure all chunks are within the file and properly aligned */
+  for (c = 0; c < lunp->num_chunks; c++) {
+    start = c * lunp->chunk_size;
+    size  = MIN2(lunp->chunk_size, lunp->length - start);
+
+    if ((lunp->index[c] % sizeof(float)) ||
+        (lunp->index[c] > lunp->size) ||
+        ((lunp->size - lunp->index[c]) / sizeof(float) / lunp->ulength < size))
+      return 0;
+  }
+
+  return 1;
+}
@@ -0,0 +1,209 @@
+#ifndef VIENNA_RNA_PACKAGE_LUNP_BIN_H
+#define VIENNA_RNA_PACKAGE_LUNP_BIN_H
+
+/**
+ *  @file     ViennaRNA/io/lunp_bin.h
+ *  @ingroup  lunp_bin
+ *  @brief    Binary files of unpaired probabilities with random access
+ */
+
+#include <ViennaRNA/datastructures/basic.h>
+
+/**
+ *  @addtogroup lunp_bin
+ *  @{
+ *  @brief  Write and read unpaired probabilities of sliding window computations in binary format
+ *
+ *  Unpaired probabilities for all positions @f$ i @f$ and lengths @f$ u @f$, as computed
+ *  by vrna_probs_window() with the #VRNA_PROBS_WINDOW_UP option, quickly become large for
+ *  long sequences. Instead of writing and parsing text files, they may be stored in a
+ *  compact binary container that is memory mapped for reading, such that each value can
+ *  be retrieved in constant time without loading the entire file.
+ *
+ *  The file consists of a header of 64 bytes, followed by the data of consecutive chunks
+ *  of positions and the chunk index. For each chunk, the data consists of one dense array
+ *  of single precision floating point numbers per length @f$ u = 1, \ldots, u_{max} @f$,
+ *  holding the probability that the segment @f$ [i - u + 1, i] @f$ is unpaired for all
+ *  positions @f$ i @f$ of the chunk. Undefined values, i.e. @f$ i < u @f$, are stored as
+ *  @p NaN. The chunk index lists the file offsets of all chunks. All numbers are
+ *  stored in the byte order of the machine that wrote the file.
+ *
+ *  | Offset | Type           | Content                                          |
+ *  | ------ | -------------- | ------------------------------------------------ |
+ *  | 0      | char[8]        | Magic string @p VRNALUNP                         |
+ *  | 8      | uint32         | Format version (1)                               |
+ *  | 12     | uint32         | Byte order mark @p 0x01020304                    |
+ *  | 16     | uint32         | Sequence length @f$ n @f$                        |
+ *  | 20     | uint32         | Maximum length @f$ u_{max} @f$                   |
+ *  | 24     | uint32         | Number of positions per chunk                    |
+ *  | 28     | uint32         | Number of chunks                                 |
+ *  | 32     | uint64         | Offset of the chunk index (array of uint64)      |
+ *  | 40     |                | Reserved                                         |
+ *
+ *  A writer may be passed as callback data to vrna_probs_window() directly, or the
+ *  unpaired probability data may be forwarded to vrna_lunp_writer_cb() from within
+ *  another callback.
+ *
+ *  @see  vrna_probs_window(), vrna_lunp_writer_open(), vrna_lunp_open()
+ */
+
+/**
+ *  @brief  A writer for binary unpaired probability files
+ *  @see    vrna_lunp_writer_open(), vrna_lunp_writer_cb(), vrna_lunp_writer_close()
+ */
+typedef struct vrna_lunp_writer_s *vrna_lunp_writer_t;
+
+
+/**
+ *  @brief  A binary unpaired probability file opened for reading
+ *  @see    vrna_lunp_open(), vrna_lunp_get(), vrna_lunp_close()
+ */
+typedef struct vrna_lunp_s *vrna_lunp_t;
+
+
+/**
+ *  @brief  Default number of positions per chunk in binary unpaired probability files
+ */
+#define VRNA_LUNP_CHUNK_SIZE  4096
+
+
+/**
+ *  @brief  Open a binary unpaired probability file for writing
+ *
+ *  Memory is only required for a single chunk of positions, since the data
+ *  of each chunk is written as soon as unpaired probabilities for a position
+ *  of the next chunk arrive.
+ *
+ *  @see    vrna_lunp_writer_cb(), vrna_lunp_writer_close()
+ *
+ *  @param  filename  The name of the file to write
+ *  @param  length    The length of the sequence
+ *  @param  ulength   The maximum length of unpaired segments
+ *  @return           A writer, or @p NULL on any error
+ */
+vrna_lunp_writer_t
+vrna_lunp_writer_open(const char    *filename,
+                      unsigned int  length,
+                      unsigned int  ulength);
+
+
+/**
+ *  @brief  Store unpaired probabilities reported by vrna_probs_window()
+ *
+ *  This function is of type #vrna_probs_window_callback and expects a writer
+ *  as @p data argument. It only processes unpaired probabilities of any loop
+ *  context, i.e. data where @p type contains #VRNA_PROBS_WINDOW_UP and
+ *  #VRNA_ANY_LOOP, and ignores all other data. Thus, vrna_probs_window() must
+ *  be called without the #VRNA_PROBS_WINDOW_UP_SPLIT option. Positions must be
+ *  reported in increasing order, as done by vrna_probs_window().
+ *
+ *  @see    vrna_probs_window(), vrna_lunp_writer_open()
+ *
+ *  @param  pr      The unpaired probabilities for segments of length 1 to @p pr_size ending at @p i
+ *  @param  pr_size The size of the probability array
+ *  @param  i       The position
+ *  @param  max     The maximum segment length
+ *  @param  type    The type of data
+ *  @param  data    The writer
+ */
+void
+vrna_lunp_writer_cb(FLT_OR_DBL    *pr,
+                    int           pr_size,
+                    int           i,
+                    int           max,
+                    unsigned int  type,
+                    void          *data);
+
+
+/**
+ *  @brief  Finish a binary unpaired probability file and free the writer
+ *
+ *  @param  writer  The writer
+ *  @return         1 if the file has been written successfully, 0 otherwise
+ */
+int
+vrna_lunp_writer_close(vrna_lunp_writer_t writer);
+
+
+/**
+ *  @brief  Open a binary unpaired probability file for reading
+ *
+ *  The file is memory mapped where supported, and read into memory otherwise.
+ *
+ *  @see    vrna_lunp_get(), vrna_lunp_chunk(), vrna_lunp_close()
+ *
+ *  @param  filename  The name of the file
+ *  @return           The opened file, or @p NULL on any error
+ */
+vrna_lunp_t
+vrna_lunp_open(const char *filename);
+
+
+/**
+ *  @brief  Close a binary unpaired probability file
+ *
+ *  @param  lunp  The opened file
+ */
+void
+vrna_lunp_close(vrna_lunp_t lunp);
+
+
+/**
+ *  @brief  Get the sequence length of a binary unpaired probability file
+ *
+ *  @param  lunp  The opened file
+ *  @return       The sequence length
+ */
+unsigned int
+vrna_lunp_length(vrna_lunp_t lunp);
+
+
+/**
+ *  @brief  Get the maximum segment length of a binary unpaired probability file
+ *
+ *  @param  lunp  The opened file
+ *  @return       The maximum length of unpaired segments
+ */
+unsigned int
+vrna_lunp_ulength(vrna_lunp_t lunp);
+
+
+/**
+ *  @brief  Get the probability that a segment is unpaired
+ *
+ *  @param  lunp  The opened file
+ *  @param  i     The 3' end of the segment (1-based)
+ *  @param  u     The length of the segment
+ *  @return       The probability that the segment @f$ [i - u + 1, i] @f$ is unpaired, or @p NaN if undefined
+ */
+float
+vrna_lunp_get(vrna_lunp_t   lunp,
+              unsigned int  i,
+              unsigned int  u);
+
+
+/**
+ *  @brief  Get direct access to the unpaired probabilities of a chunk of positions
+ *
+ *  @param  lunp  The opened file
+ *  @param  i     A position within the chunk (1-based)
+ *  @param  u     The length of the segments
+ *  @param  first A pointer to store the first position of the chunk (may be @p NULL)
+ *  @param  last  A pointer to store the last position of the chunk (may be @p NULL)
+ *  @return       An array of unpaired probabilities for segments of length @p u ending at
+ *                positions @p first to @p last, indexed from 0, or @p NULL if @p i or @p u
+ *                are out of range
+ */
+const float *
+vrna_lunp_chunk(vrna_lunp_t   lunp,
+                unsigned int  i,
+                unsigned int  u,
+                unsigned int  *first,
+                unsigned int  *last);
+
+
+/**
+ *  @}
+ */
+
+#endif
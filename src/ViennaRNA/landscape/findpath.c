@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/model.h"
@@ -18,19 +19,14 @@
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/utils/structures.h"
+#include "ViennaRNA/constraints/soft.h"
 #include "ViennaRNA/landscape/findpath.h"
 
 
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
-#endif
-
-#define LOOP_EN
-
 #define   PATH_DIRECT_FINDPATH     1U
 
 /**
@@ -47,10 +43,11 @@ typedef struct move {
  *  @brief
  */
 typedef struct intermediate {
-  short   *pt;      /**<  @brief  pair table */
-  int     Sen;      /**<  @brief  saddle energy so far */
-  int     curr_en;  /**<  @brief  current energy */
-  move_t  *moves;   /**<  @brief  remaining moves to target */
+  short     *pt;      /**<  @brief  pair table */
+  int       Sen;      /**<  @brief  saddle energy so far */
+  int       curr_en;  /**<  @brief  current energy */
+  move_t    *moves;   /**<  @brief  remaining moves to target */
+  uint64_t  hash;     /**<  @brief  Zobrist hash of the pair table */
 } intermediate_t;
 
 
@@ -77,15 +74,21 @@ PRIVATE move_t                *path = NULL;
 PRIVATE int                   path_fwd; /* 1: s1->s2, else s2 -> s1 */
 
 
+#ifdef _OPENMP
+
+/* NOTE: all variables are assumed to be uninitialized if they are declared as threadprivate
+ */
+#pragma omp threadprivate(BP_dist, path, path_fwd)
+
+#endif
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 PRIVATE vrna_fold_compound_t  *backward_compat_compound = NULL;
 
 #ifdef _OPENMP
 
-/* NOTE: all variables are assumed to be uninitialized if they are declared as threadprivate
- */
-#pragma omp threadprivate(BP_dist, path, path_fwd, backward_compat_compound)
+#pragma omp threadprivate(backward_compat_compound)
 
 #endif
 
@@ -97,12 +100,29 @@ PRIVATE vrna_fold_compound_t  *backward_compat_compound = NULL;
  #################################
  */
 PRIVATE move_t *
-copy_moves(move_t *mvs);
+copy_moves(move_t *mvs,
+           int    num_moves);
+
+
+PRIVATE uint64_t
+hash_pair(int i,
+          int j);
+
+
+PRIVATE uint64_t
+hash_ptable(const short *pt);
 
 
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B);
+remove_duplicates(intermediate_t  *next,
+                  int             num_next,
+                  unsigned int    *table);
+
+
+PRIVATE void
+select_best(intermediate_t  *list,
+            int             n,
+            int             k);
 
 
 PRIVATE int
@@ -119,6 +139,14 @@ PRIVATE void
 free_intermediate(intermediate_t *i);
 
 
+PRIVATE int
+indirect_saddle(const int     *M,
+                unsigned int  n,
+                unsigned int  a,
+                unsigned int  b,
+                int           maxE);
+
+
 #ifdef TEST_FINDPATH
 
 /* TEST_FINDPATH, COFOLD */
@@ -133,7 +161,20 @@ find_path_once(vrna_fold_compound_t *vc,
                short                *pt1,
                short                *pt2,
                int                  maxl,
-               int                  maxE);
+               int                  maxE,
+               move_t               **route,
+               int                  *route_len);
+
+
+PRIVATE int
+findpath_saddle(vrna_fold_compound_t  *vc,
+                short                 *pt1,
+                short                 *pt2,
+                int                   width,
+                int                   maxE,
+                move_t                **route,
+                int                   *route_len,
+                int                   *route_fwd);
 
 
 PRIVATE int
@@ -141,7 +182,8 @@ try_moves(vrna_fold_compound_t  *vc,
           intermediate_t        c,
           int                   maxE,
           intermediate_t        *next,
-          int                   dist);
+          int                   dist,
+          int                   bp_dist);
 
 
 /*
@@ -189,48 +231,15 @@ vrna_path_findpath_saddle_ub(vrna_fold_compound_t *vc,
                              int                  width,
                              int                  maxE)
 {
-  int     maxl;
-  short   *ptr, *pt1, *pt2;
-  move_t  *bestpath = NULL;
-  int     dir;
-
-  path_fwd  = dir = 0;
-  pt1       = vrna_ptable(s1);
-  pt2       = vrna_ptable(s2);
-
-  maxl = 1;
-  do {
-    int saddleE;
-    path_fwd = !path_fwd;
-    if (maxl > width)
-      maxl = width;
-
-    if (path)
-      free(path);
-
-    saddleE = find_path_once(vc, pt1, pt2, maxl, maxE);
-    if (saddleE < maxE) {
-      maxE = saddleE;
-      if (bestpath)
-        free(bestpath);
+  short *pt1, *pt2;
 
-      bestpath  = path;
-      path      = NULL;
-      dir       = path_fwd;
-    } else {
-      free(path);
-      path = NULL;
-    }
+  pt1 = vrna_ptable(s1);
+  pt2 = vrna_ptable(s2);
 
-    ptr   = pt1;
-    pt1   = pt2;
-    pt2   = ptr;
-    maxl  *= 2;
-  } while (maxl < 2 * width);
+  free(path);
+  path = NULL;
 
-  /* (re)set some globals */
-  path      = bestpath;
-  path_fwd  = dir;
+  maxE = findpath_saddle(vc, pt1, pt2, width, maxE, &path, &BP_dist, &path_fwd);
 
   free(pt1);
   free(pt2);
@@ -284,6 +293,113 @@ vrna_path_findpath_ub(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC int *
+vrna_path_findpath_saddle_batch(vrna_fold_compound_t  *fc,
+                                const char            **structures,
+                                const unsigned int    *pairs,
+                                unsigned int          num_pairs,
+                                int                   width,
+                                int                   maxE,
+                                unsigned int          options)
+{
+  short         **pts;
+  int           *M;
+  unsigned int  a, b, n, p, *all_pairs;
+  long int      k;
+
+#ifdef _OPENMP
+  int           threads;
+#endif
+
+  if ((!fc) || (!structures))
+    return NULL;
+
+  for (n = 0; structures[n]; n++)
+    if (strlen(structures[n]) != fc->length) {
+      vrna_message_warning("vrna_path_findpath_saddle_batch: "
+                           "Length of structure %u (%u) does not match sequence length (%u)",
+                           n, (unsigned int)strlen(structures[n]), fc->length);
+      return NULL;
+    }
+
+  all_pairs = NULL;
+
+  if (!pairs) {
+    num_pairs = n * (n - 1) / 2;
+    all_pairs = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (2 * num_pairs + 1));
+    for (p = 0, a = 0; a < n; a++)
+      for (b = a + 1; b < n; b++) {
+        all_pairs[p++]  = a;
+        all_pairs[p++]  = b;
+      }
+    pairs = all_pairs;
+  }
+
+  M   = (int *)vrna_alloc(sizeof(int) * (n * n + 1));
+  pts = (short **)vrna_alloc(sizeof(short *) * (n + 1));
+
+  for (a = 0; a < n * n; a++)
+    M[a] = INF;
+
+  /* soft constraints must be prepared before threads start to evaluate energies */
+  vrna_sc_prepare(fc, VRNA_OPTION_MFE);
+
+  for (a = 0; a < n; a++) {
+    pts[a]          = vrna_ptable(structures[a]);
+    M[a * n + a]    = vrna_eval_structure_pt(fc, pts[a]);
+  }
+
+#ifdef _OPENMP
+  threads = MIN2(fc->params->model_details.threads, omp_get_num_procs());
+  threads = MAX2(threads, 1);
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads) private(a, b)
+#endif
+  for (k = 0; k < (long int)num_pairs; k++) {
+    int ub, saddle;
+
+    a = pairs[2 * k];
+    b = pairs[2 * k + 1];
+
+    if ((a >= n) || (b >= n)) {
+      vrna_message_warning("vrna_path_findpath_saddle_batch: "
+                           "Structure index out of range in pair (%u, %u)",
+                           a, b);
+      continue;
+    }
+
+    if (a == b)
+      continue;
+
+    ub = maxE;
+    if (options & VRNA_PATH_BATCH_INDIRECT_UB) {
+#ifdef _OPENMP
+#pragma omp critical (findpath_batch)
+#endif
+      ub = indirect_saddle(M, n, a, b, maxE);
+    }
+
+    saddle = findpath_saddle(fc, pts[a], pts[b], width, ub, NULL, NULL, NULL);
+
+#ifdef _OPENMP
+#pragma omp critical (findpath_batch)
+#endif
+    {
+      M[a * n + b]  = saddle;
+      M[b * n + a]  = saddle;
+    }
+  }
+
+  for (a = 0; a < n; a++)
+    free(pts[a]);
+
+  free(pts);
+  free(all_pairs);
+
+  return M;
+}
+
+
 PUBLIC struct vrna_path_options_s *
 vrna_path_options_findpath(int          width,
                            unsigned int type)
@@ -314,11 +430,19 @@ findpath_method(vrna_fold_compound_t  *fc,
                 int                   maxE,
                 unsigned int          return_type)
 {
-  int         E, d;
+  short       *pt1, *pt2;
+  int         E, d, BP_dist, path_fwd;
   float       last_E;
+  move_t      *path;
   vrna_path_t *route = NULL;
 
-  E = vrna_path_findpath_saddle_ub(fc, s1, s2, width, maxE);
+  pt1   = vrna_ptable(s1);
+  pt2   = vrna_ptable(s2);
+  path  = NULL;
+  E     = findpath_saddle(fc, pt1, pt2, width, maxE, &path, &BP_dist, &path_fwd);
+
+  free(pt1);
+  free(pt2);
 
   /* did we find a better path than one with saddle maxE? */
   if (E < maxE) {
@@ -421,7 +545,6 @@ findpath_method(vrna_fold_compound_t  *fc,
   }
 
   free(path);
-  path = NULL;
 
   return route;
 }
@@ -604,12 +727,73 @@ usage(void)
  # STATIC helper functions below #
  #################################
  */
+/*
+ *  Iteratively widen the search between pt1 and pt2, alternating the
+ *  search direction. Returns the lowest saddle energy below maxE, or maxE.
+ *  If route is not NULL, the moves of the best path, their number, and
+ *  direction (1: pt1 -> pt2) are stored in route, route_len, and route_fwd.
+ *  This function does not touch any global variables.
+ */
+PRIVATE int
+findpath_saddle(vrna_fold_compound_t  *vc,
+                short                 *pt1,
+                short                 *pt2,
+                int                   width,
+                int                   maxE,
+                move_t                **route,
+                int                   *route_len,
+                int                   *route_fwd)
+{
+  int     maxl, fwd, dir, dist;
+  short   *ptr;
+  move_t  *bestpath, *moves;
+
+  bestpath  = NULL;
+  fwd       = dir = 0;
+  dist      = 0;
+  maxl      = 1;
+
+  do {
+    int saddleE;
+    fwd = !fwd;
+    if (maxl > width)
+      maxl = width;
+
+    saddleE = find_path_once(vc, pt1, pt2, maxl, maxE, &moves, &dist);
+    if (saddleE < maxE) {
+      maxE = saddleE;
+      free(bestpath);
+      bestpath  = moves;
+      dir       = fwd;
+    } else {
+      free(moves);
+    }
+
+    ptr   = pt1;
+    pt1   = pt2;
+    pt2   = ptr;
+    maxl  *= 2;
+  } while (maxl < 2 * width);
+
+  if (route) {
+    *route      = bestpath;
+    *route_len  = dist;
+    *route_fwd  = dir;
+  } else {
+    free(bestpath);
+  }
+
+  return maxE;
+}
+
+
 PRIVATE int
 try_moves(vrna_fold_compound_t  *vc,
           intermediate_t        c,
           int                   maxE,
           intermediate_t        *next,
-          int                   dist)
+          int                   dist,
+          int                   bp_dist)
 {
   int     *loopidx, len, num_next = 0, en, oldE;
   move_t  *mv;
@@ -623,42 +807,37 @@ try_moves(vrna_fold_compound_t  *vc,
     if (mv->when > 0)
       continue;
 
-    i   = mv->i;
-    j   = mv->j;
-    pt  = (short *)vrna_alloc(sizeof(short) * (len + 1));
-    memcpy(pt, c.pt, (len + 1) * sizeof(short));
-    if (j < 0) {
-      /*it's a delete move */
-      pt[-i]  = 0;
-      pt[-j]  = 0;
-    } else {
-      /* insert move */
-      if ((loopidx[i] == loopidx[j]) && /* i and j belong to same loop */
-          (pt[i] == 0) && (pt[j] == 0)  /* ... and are unpaired */
-          ) {
+    i = mv->i;
+    j = mv->j;
+
+    /* insert moves require i and j to be unpaired and belong to the same loop */
+    if ((j > 0) &&
+        ((loopidx[i] != loopidx[j]) || (c.pt[i] != 0) || (c.pt[j] != 0)))
+      continue; /* illegal move, try next; */
+
+    /* evaluate the move before we create a new intermediate */
+    en = c.curr_en + vrna_eval_move_pt(vc, c.pt, i, j);
+
+    if (en < maxE) {
+      pt = (short *)vrna_alloc(sizeof(short) * (len + 1));
+      memcpy(pt, c.pt, (len + 1) * sizeof(short));
+      if (j < 0) {
+        /*it's a delete move */
+        pt[-i]  = 0;
+        pt[-j]  = 0;
+      } else {
         pt[i] = j;
         pt[j] = i;
-      } else {
-        free(pt);
-        continue; /* llegal move, try next; */
       }
-    }
 
-#ifdef LOOP_EN
-    en = c.curr_en + vrna_eval_move_pt(vc, c.pt, i, j);
-#else
-    en = vrna_eval_structure_pt(vc, pt);
-#endif
-    if (en < maxE) {
       next[num_next].Sen      = (en > oldE) ? en : oldE;
       next[num_next].curr_en  = en;
       next[num_next].pt       = pt;
+      next[num_next].hash     = c.hash ^ hash_pair(abs(i), abs(j));
       mv->when                = dist;
       mv->E                   = en;
-      next[num_next++].moves  = copy_moves(c.moves);
+      next[num_next++].moves  = copy_moves(c.moves, bp_dist);
       mv->when                = 0;
-    } else {
-      free(pt);
     }
   }
   free(loopidx);
@@ -671,10 +850,13 @@ find_path_once(vrna_fold_compound_t *vc,
                short                *pt1,
                short                *pt2,
                int                  maxl,
-               int                  maxE)
+               int                  maxE,
+               move_t               **route,
+               int                  *route_len)
 {
   move_t          *mlist;
   int             i, len, d, dist = 0, result;
+  unsigned int    *table;
   short           *pt;
   intermediate_t  *current, *next;
 
@@ -701,12 +883,14 @@ find_path_once(vrna_fold_compound_t *vc,
     }
   }
 
-  BP_dist           = dist;
+  *route_len        = dist;
   current           = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (maxl + 1));
   current[0].pt     = pt;
   current[0].Sen    = current[0].curr_en = vrna_eval_structure_pt(vc, pt);
   current[0].moves  = mlist;
+  current[0].hash   = hash_ptable(pt);
   next              = (intermediate_t *)vrna_alloc(sizeof(intermediate_t) * (dist * maxl + 1));
+  table             = NULL;
 
   for (d = 1; d <= dist; d++) {
     /* go through the distance classes */
@@ -714,7 +898,7 @@ find_path_once(vrna_fold_compound_t *vc,
     intermediate_t  *cc;
 
     for (c = 0; current[c].pt != NULL; c++)
-      num_next += try_moves(vc, current[c], maxE, next + num_next, d);
+      num_next += try_moves(vc, current[c], maxE, next + num_next, d, dist);
     if (num_next == 0) {
       for (cc = current; cc->pt != NULL; cc++)
         free_intermediate(cc);
@@ -722,17 +906,16 @@ find_path_once(vrna_fold_compound_t *vc,
       break;
     }
 
-    /* remove duplicates via sort|uniq
-     * if this becomes a bottleneck we can use a hash instead */
-    qsort(next, num_next, sizeof(intermediate_t), compare_ptable);
-    for (u = 0, c = 1; c < num_next; c++) {
-      if (memcmp(next[u].pt, next[c].pt, sizeof(short) * len) != 0)
-        next[++u] = next[c];
-      else
-        free_intermediate(next + c);
-    }
-    num_next = u + 1;
-    qsort(next, num_next, sizeof(intermediate_t), compare_energy);
+    /* remove duplicates via a hash set of the pair tables */
+    if (!table) /* enough space for the next power of two >= 2 * num_next */
+      table = (unsigned int *)vrna_alloc(sizeof(unsigned int) * 4 * (dist * maxl + 1));
+
+    num_next = remove_duplicates(next, num_next, table);
+
+    /* keep only the maxl best intermediates, in ascending order of their energies */
+    select_best(next, num_next, maxl);
+    qsort(next, MIN2(maxl, num_next), sizeof(intermediate_t), compare_energy);
+
     /* free the old stuff */
     for (cc = current; cc->pt != NULL; cc++)
       free_intermediate(cc);
@@ -743,7 +926,8 @@ find_path_once(vrna_fold_compound_t *vc,
     num_next = 0;
   }
   free(next);
-  path    = current[0].moves;
+  free(table);
+  *route  = current[0].moves;
   result  = current[0].Sen;
   free(current[0].pt);
   free(current);
@@ -751,6 +935,31 @@ find_path_once(vrna_fold_compound_t *vc,
 }
 
 
+/*
+ *  Return the lowest saddle energy of an indirect path a -> k -> b over all
+ *  structures k where both pairs (a, k) and (k, b) have been evaluated, or maxE
+ */
+PRIVATE int
+indirect_saddle(const int     *M,
+                unsigned int  n,
+                unsigned int  a,
+                unsigned int  b,
+                int           maxE)
+{
+  int           e1, e2;
+  unsigned int  k;
+
+  for (k = 0; k < n; k++) {
+    e1  = M[a * n + k];
+    e2  = M[k * n + b];
+    if ((e1 != INF) && (e2 != INF))
+      maxE = MIN2(maxE, MAX2(e1, e2));
+  }
+
+  return maxE;
+}
+
+
 PRIVATE void
 free_intermediate(intermediate_t *i)
 {
@@ -762,27 +971,155 @@ free_intermediate(intermediate_t *i)
 }
 
 
+/* pseudo-random 64-bit key of base pair (i,j) for Zobrist hashing */
+PRIVATE uint64_t
+hash_pair(int i,
+          int j)
+{
+  uint64_t z = ((uint64_t)i << 32) | (uint64_t)j;
+
+  /* splitmix64 finalizer */
+  z += 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+  return z ^ (z >> 31);
+}
+
+
+PRIVATE uint64_t
+hash_ptable(const short *pt)
+{
+  int       i;
+  uint64_t  h = 0;
+
+  for (i = 1; i <= pt[0]; i++)
+    if (i < pt[i])
+      h ^= hash_pair(i, pt[i]);
+
+  return h;
+}
+
+
+/*
+ *  Remove intermediates with identical pair tables and keep the one with
+ *  lowest saddle energy, or the first one generated in case of ties.
+ *  Returns the number of remaining intermediates, which keep their order.
+ *  The table must provide space for the next power of two >= 2 * num_next.
+ */
 PRIVATE int
-compare_ptable(const void *A,
-               const void *B)
+remove_duplicates(intermediate_t  *next,
+                  int             num_next,
+                  unsigned int    *table)
 {
-  intermediate_t  *a, *b;
-  int             c;
+  int           c, u;
+  unsigned int  size, mask, h;
 
-  a = (intermediate_t *)A;
-  b = (intermediate_t *)B;
+  for (size = 2; size < 2 * (unsigned int)num_next; size *= 2);
 
-  c = memcmp(a->pt, b->pt, a->pt[0] * sizeof(short));
-  if (c != 0)
-    return c;
+  mask = size - 1;
+  memset(table, 0, sizeof(unsigned int) * size);
 
-  if ((a->Sen - b->Sen) != 0)
-    return a->Sen - b->Sen;
+  for (u = c = 0; c < num_next; c++) {
+    for (h = (unsigned int)next[c].hash & mask; table[h]; h = (h + 1) & mask) {
+      intermediate_t *k = next + table[h] - 1;
+
+      if ((k->hash == next[c].hash) &&
+          (memcmp(k->pt, next[c].pt, sizeof(short) * (k->pt[0] + 1)) == 0))
+        break;
+    }
 
-  return a->curr_en - b->curr_en;
+    if (table[h] == 0) {
+      next[u]   = next[c];
+      table[h]  = ++u;
+    } else if (next[c].Sen < next[table[h] - 1].Sen) {
+      intermediate_t tmp = next[table[h] - 1];
+      next[table[h] - 1] = next[c];
+      free_intermediate(&tmp);
+    } else {
+      free_intermediate(next + c);
+    }
+  }
+
+  return u;
 }
 
 
+/*
+ *  Partially sort the list such that its first k entries are the k
+ *  best intermediates (in arbitrary order), and release all others
+ */
+PRIVATE void
+select_best(intermediate_t  *list,
+            int             n,
+            int             k)
+{
+  int             lo, hi, i, j;
+  intermediate_t  pivot, tmp;
+
+  if (k >= n)
+    return;
+
+  lo  = 0;
+  hi  = n - 1;
+
+  /* quickselect with median-of-three pivot */
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+
+    if (compare_energy(list + mid, list + lo) < 0) {
+      tmp       = list[mid];
+      list[mid] = list[lo];
+      list[lo]  = tmp;
+    }
+
+    if (compare_energy(list + hi, list + lo) < 0) {
+      tmp       = list[hi];
+      list[hi]  = list[lo];
+      list[lo]  = tmp;
+    }
+
+    if (compare_energy(list + hi, list + mid) < 0) {
+      tmp       = list[hi];
+      list[hi]  = list[mid];
+      list[mid] = tmp;
+    }
+
+    pivot = list[mid];
+    i     = lo;
+    j     = hi;
+
+    while (i <= j) {
+      while (compare_energy(list + i, &pivot) < 0)
+        i++;
+      while (compare_energy(&pivot, list + j) < 0)
+        j--;
+      if (i <= j) {
+        tmp     = list[i];
+        list[i] = list[j];
+        list[j] = tmp;
+        i++;
+        j--;
+      }
+    }
+
+    if (k - 1 <= j)
+      hi = j;
+    else if (k - 1 >= i)
+      lo = i;
+    else
+      break;
+  }
+
+  for (i = k; i < n; i++)
+    free_intermediate(list + i);
+}
+
+
+/*
+ *  Order intermediates by saddle and current energy. Ties are broken
+ *  by the pair tables to render the selection deterministic
+ */
 PRIVATE int
 compare_energy(const void *A,
                const void *B)
@@ -795,7 +1132,10 @@ compare_energy(const void *A,
   if ((a->Sen - b->Sen) != 0)
     return a->Sen - b->Sen;
 
-  return a->curr_en - b->curr_en;
+  if ((a->curr_en - b->curr_en) != 0)
+    return a->curr_en - b->curr_en;
+
+  return memcmp(a->pt, b->pt, sizeof(short) * (a->pt[0] + 1));
 }
 
 
@@ -813,12 +1153,13 @@ compare_moves_when(const void *A,
 
 
 PRIVATE move_t *
-copy_moves(move_t *mvs)
+copy_moves(move_t *mvs,
+           int    num_moves)
 {
   move_t *new;
 
-  new = (move_t *)vrna_alloc(sizeof(move_t) * (BP_dist + 1));
-  memcpy(new, mvs, sizeof(move_t) * (BP_dist + 1));
+  new = (move_t *)vrna_alloc(sizeof(move_t) * (num_moves + 1));
+  memcpy(new, mvs, sizeof(move_t) * (num_moves + 1));
   return new;
 }
 
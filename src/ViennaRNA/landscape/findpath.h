@@ -155,6 +155,70 @@ vrna_path_findpath_ub(vrna_fold_compound_t  *fc,
                       int                   maxE);
 
 
+/**
+ *  @brief  Option flag for vrna_path_findpath_saddle_batch() to compute direct paths only
+ *
+ *  @see vrna_path_findpath_saddle_batch(), #VRNA_PATH_BATCH_INDIRECT_UB
+ */
+#define VRNA_PATH_BATCH_DEFAULT       0U
+
+/**
+ *  @brief  Option flag for vrna_path_findpath_saddle_batch() to bound the search by indirect paths
+ *
+ *  If two pairs (a, k) and (k, b) have already been evaluated, the larger of both saddle
+ *  energies is the saddle energy of an indirect path from a to b via k. The lowest of these
+ *  values serves as upper bound @f$E_{max}@f$ for the direct path search between a and b,
+ *  which then terminates early and simply reports the bound if no better direct path exists.
+ *
+ *  @see vrna_path_findpath_saddle_batch(), #VRNA_PATH_BATCH_DEFAULT
+ */
+#define VRNA_PATH_BATCH_INDIRECT_UB   1U
+
+
+/**
+ *  @brief Find saddle point energies for many pairs of structures (search only direct paths)
+ *
+ *  This function evaluates vrna_path_findpath_saddle_ub() for a set of structure pairs
+ *  and returns the saddle energies as a matrix. Pairs are distributed among
+ *  #vrna_md_t.threads threads (requires OpenMP support) that share the sequence encoding
+ *  and energy parameters of @p fc in a read-only fashion.
+ *
+ *  The pairs to be evaluated are specified as array of @p num_pairs pairs of 0-based indices
+ *  into the @p structures list, i.e. the i-th pair is (@p pairs[2 * i], @p pairs[2 * i + 1]).
+ *  If @p pairs is @em NULL, all pairs of distinct structures are evaluated.
+ *
+ *  The returned matrix @f$M@f$ is stored in row-major order, i.e. the saddle energy of the
+ *  pair (a, b) is found at index @f$a \cdot n + b@f$, where @f$n@f$ is the number of
+ *  structures. It is symmetric, and its diagonal holds the free energies of the structures.
+ *  Entries for pairs that have not been requested are set to #INF, and entries for pairs
+ *  without a path below @p maxE are set to @p maxE.
+ *
+ *  With option #VRNA_PATH_BATCH_INDIRECT_UB, the saddle energies of already evaluated pairs
+ *  that share an endpoint are used to terminate the search early. In this case, an entry
+ *  may be the saddle energy of an indirect path if it is lower than that of the best direct
+ *  path found, and results may differ between runs with more than one thread.
+ *
+ *  @see vrna_path_findpath_saddle_ub(), #VRNA_PATH_BATCH_DEFAULT, #VRNA_PATH_BATCH_INDIRECT_UB
+ *
+ *  @param fc         The #vrna_fold_compound_t with precomputed sequence encoding and model details
+ *  @param structures A @em NULL terminated list of structures in dot-bracket notation
+ *  @param pairs      The pairs of structure indices to evaluate (may be @em NULL)
+ *  @param num_pairs  The number of pairs in @p pairs
+ *  @param width      A number specifying how many strutures are being kept at each step during the search
+ *  @param maxE       An upper bound for the saddle point energies in 10cal/mol
+ *  @param options    Options, i.e. #VRNA_PATH_BATCH_DEFAULT or #VRNA_PATH_BATCH_INDIRECT_UB
+ *  @returns          The matrix of saddle energies in 10cal/mol, or @em NULL on any error
+ */
+int *
+vrna_path_findpath_saddle_batch(vrna_fold_compound_t  *fc,
+                                const char            **structures,
+                                const unsigned int    *pairs,
+                                unsigned int          num_pairs,
+                                int                   width,
+                                int                   maxE,
+                                unsigned int          options);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /**
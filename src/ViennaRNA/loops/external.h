@@ -144,6 +144,20 @@ struct vrna_mx_pf_aux_el_s *
 vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Prepare auxiliary helper arrays for a wavefront fill of the exterior loop
+ *
+ *  Same as vrna_exp_E_ext_fast_init() but keeps the helper array for each column
+ *  @f$ j @f$, such that vrna_exp_E_ext_fast() can be called for any @f$ (i, j) @f$
+ *  whose dependencies have already been computed. No vrna_exp_E_ext_fast_rotate() calls
+ *  are required in this mode. Unstructured domains and sliding-window mode are not supported.
+ *
+ *  @see vrna_exp_E_ext_fast_init(), vrna_exp_E_ext_fast_free()
+ */
+struct vrna_mx_pf_aux_el_s *
+vrna_exp_E_ext_fast_init_wavefront(vrna_fold_compound_t *fc);
+
+
 void
 vrna_exp_E_ext_fast_rotate(struct vrna_mx_pf_aux_el_s *aux_mx);
 
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/external.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -37,6 +38,8 @@ struct vrna_mx_pf_aux_el_s {
 
   int         qqu_size;
   FLT_OR_DBL  **qqu;
+
+  FLT_OR_DBL  **qq_mx;  /* column-wise storage of qq, only for wavefront fills */
 };
 
 /*
@@ -153,6 +156,7 @@ vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc)
     aux_mx->qq1       = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
     aux_mx->qqu_size  = 0;
     aux_mx->qqu       = NULL;
+    aux_mx->qq_mx     = NULL;
 
     /* pre-processing ligand binding production rule(s) and auxiliary memory */
     if (with_ud) {
@@ -202,6 +206,41 @@ vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC struct vrna_mx_pf_aux_el_s *
+vrna_exp_E_ext_fast_init_wavefront(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_pf_aux_el_s *aux_mx = vrna_exp_E_ext_fast_init(fc);
+
+  if ((aux_mx) && (fc->hc->type != VRNA_HC_WINDOW) && (!aux_mx->qqu)) {
+    int         j, n;
+    size_t      size;
+    FLT_OR_DBL  *block;
+
+    n = (int)fc->length;
+
+    /*
+     *  Column j holds the entries qq[0..j + 1] that a serial fill would have
+     *  stored in the helper array after processing column j. Keeping all
+     *  columns allows for filling the DP matrices in any order that
+     *  respects the (i, j) dependencies.
+     */
+    size = 0;
+    for (j = 0; j <= n + 1; j++)
+      size += (size_t)(j + 2);
+
+    block         = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    aux_mx->qq_mx = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (n + 2));
+
+    for (j = 0; j <= n + 1; j++) {
+      aux_mx->qq_mx[j]  = block;
+      block             += j + 2;
+    }
+  }
+
+  return aux_mx;
+}
+
+
 PUBLIC void
 vrna_exp_E_ext_fast_rotate(struct vrna_mx_pf_aux_el_s *aux_mx)
 {
@@ -233,6 +272,11 @@ vrna_exp_E_ext_fast_free(struct vrna_mx_pf_aux_el_s *aux_mx)
     free(aux_mx->qq);
     free(aux_mx->qq1);
 
+    if (aux_mx->qq_mx) {
+      free(aux_mx->qq_mx[0]);
+      free(aux_mx->qq_mx);
+    }
+
     if (aux_mx->qqu) {
       for (u = 0; u <= aux_mx->qqu_size; u++)
         free(aux_mx->qqu[u]);
@@ -545,12 +589,12 @@ split_ext_fast(vrna_fold_compound_t       *fc,
    *  increases speed. However, once we check for the split point between
    *  strands in hard constraints, we have to think of something else...
    */
-  if ((evaluate == &hc_default) || (evaluate == &hc_default_window)) {
-    for (k = j; k > i; k--) {
-      qbt += q[ij1] *
-             qqq[k];
-      ij1 -= factor;
-    }
+  if (evaluate == &hc_default_window) {
+    /* both arrays are accessed in the same direction, so use the sum-of-products kernel */
+    qbt = vrna_fun_zip_mult_sum(q + i, qqq + i + 1, j - i);
+  } else if (evaluate == &hc_default) {
+    /* q[ij1] * qqq[k], where ij1 increases with decreasing k */
+    qbt = vrna_fun_zip_mult_sum_rev(q + ij1, qqq + i + 1, j - i);
   } else {
     for (k = j; k > i; k--)
       if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local)) {
@@ -585,14 +629,23 @@ exp_E_ext_fast(vrna_fold_compound_t       *fc,
                int                        j,
                struct vrna_mx_pf_aux_el_s *aux_mx)
 {
-  int                       *iidx, ij, with_ud, with_gquad;
-  FLT_OR_DBL                qbt1, *qq, **qqu, *G, **G_local;
-  vrna_md_t                 *md;
-  vrna_exp_param_t          *pf_params;
-  vrna_ud_t                 *domains_up;
-  vrna_callback_hc_evaluate *evaluate;
-  struct default_data       hc_dat_local;
-  struct sc_wrapper_exp_ext sc_wrapper;
+  int                         *iidx, ij, with_ud, with_gquad;
+  FLT_OR_DBL                  qbt1, *qq, **qqu, *G, **G_local;
+  vrna_md_t                   *md;
+  vrna_exp_param_t            *pf_params;
+  vrna_ud_t                   *domains_up;
+  vrna_callback_hc_evaluate   *evaluate;
+  struct default_data         hc_dat_local;
+  struct sc_wrapper_exp_ext   sc_wrapper;
+  struct vrna_mx_pf_aux_el_s  aux_mx_column;
+
+  if (aux_mx->qq_mx) {
+    /* wavefront fill, use the columns j and j - 1 of the helper matrix */
+    aux_mx_column     = *aux_mx;
+    aux_mx_column.qq  = aux_mx->qq_mx[j];
+    aux_mx_column.qq1 = aux_mx->qq_mx[j - 1];
+    aux_mx            = &aux_mx_column;
+  }
 
   qq          = aux_mx->qq;
   qqu         = aux_mx->qqu;
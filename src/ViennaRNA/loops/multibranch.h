@@ -109,6 +109,20 @@ vrna_mx_pf_aux_ml_t
 vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Prepare auxiliary helper arrays for a wavefront fill of multibranch loops
+ *
+ *  Same as vrna_exp_E_ml_fast_init() but keeps the helper array for each column
+ *  @f$ j @f$, such that vrna_exp_E_ml_fast() and vrna_exp_E_mb_loop_fast() can be
+ *  called for any @f$ (i, j) @f$ whose dependencies have already been computed.
+ *  Unstructured domains and sliding-window mode are not supported.
+ *
+ *  @see vrna_exp_E_ml_fast_init(), vrna_exp_E_ml_fast_qqm_column()
+ */
+vrna_mx_pf_aux_ml_t
+vrna_exp_E_ml_fast_init_wavefront(vrna_fold_compound_t *fc);
+
+
 void
 vrna_exp_E_ml_fast_rotate(vrna_mx_pf_aux_ml_t aux_mx);
 
@@ -125,6 +139,16 @@ const FLT_OR_DBL *
 vrna_exp_E_ml_fast_qqm1(struct vrna_mx_pf_aux_ml_s *aux_mx);
 
 
+/**
+ *  @brief  Get the helper array of column @f$ j @f$ (wavefront mode) or the current column
+ *
+ *  @see vrna_exp_E_ml_fast_init_wavefront()
+ */
+const FLT_OR_DBL *
+vrna_exp_E_ml_fast_qqm_column(struct vrna_mx_pf_aux_ml_s  *aux_mx,
+                              int                         j);
+
+
 FLT_OR_DBL
 vrna_exp_E_ml_fast(vrna_fold_compound_t *fc,
                    int                  i,
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -926,26 +927,61 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
   }
 
   /* 2. Test for possible split point */
-  for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
-    if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-      if (sliding_window)
+  if (sliding_window) {
+    for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
+      if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
         en = fML_local[ii][u - ii] +
              fML_local[u + 1][jj - (u + 1)];
-      else
-        en = my_fML[idx[u] + ii] +
-             my_fML[idx[jj] + u + 1];
-
-      if (sc_wrapper.decomp_ml)
-        en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
-
-      if (fij == en) {
-        *i  = ii;
-        *j  = u;
-        *k  = u + 1;
-        *l  = jj;
-        return 1;
+
+        if (sc_wrapper.decomp_ml)
+          en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
+
+        if (fij == en) {
+          *i  = ii;
+          *j  = u;
+          *k  = u + 1;
+          *l  = jj;
+          return 1;
+        }
       }
     }
+  } else if (jj - 2 - turn >= ii + 1 + turn) {
+    /*
+     *  collect the 5' parts of all possible splits, including hard and soft
+     *  constraints, and let the min-plus kernel find the first split point
+     *  that yields the minimum. Since fij can not be smaller than any split,
+     *  this is the same split point the linear search would report.
+     */
+    int *fml_5, pos;
+
+    cnt   = jj - 2 - turn - (ii + 1 + turn) + 1;
+    fml_5 = (int *)vrna_alloc(sizeof(int) * cnt);
+
+    for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
+      en = INF;
+      if ((evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) &&
+          (my_fML[idx[u] + ii] != INF)) {
+        en = my_fML[idx[u] + ii];
+
+        if (sc_wrapper.decomp_ml)
+          en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
+      }
+
+      fml_5[u - (ii + 1 + turn)] = en;
+    }
+
+    en = vrna_fun_zip_add_min_idx(fml_5, my_fML + idx[jj] + ii + 2 + turn, cnt, &pos);
+
+    free(fml_5);
+
+    if ((pos >= 0) && (fij == en)) {
+      u   = ii + 1 + turn + pos;
+      *i  = ii;
+      *j  = u;
+      *k  = u + 1;
+      *l  = jj;
+      return 1;
+    }
   }
 
   /* 3. last chance! Maybe coax stack */
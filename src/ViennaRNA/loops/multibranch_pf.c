@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -35,6 +36,8 @@ struct vrna_mx_pf_aux_ml_s {
 
   int         qqmu_size;
   FLT_OR_DBL  **qqmu;
+
+  FLT_OR_DBL  **qqm_mx; /* column-wise storage of qqm, only for wavefront fills */
 };
 
 
@@ -114,6 +117,7 @@ vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc)
     aux_mx->qqm1      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
     aux_mx->qqmu_size = 0;
     aux_mx->qqmu      = NULL;
+    aux_mx->qqm_mx    = NULL;
 
     if (fc->type == VRNA_FC_TYPE_SINGLE) {
       vrna_ud_t *domains_up = fc->domains_up;
@@ -165,6 +169,36 @@ vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC struct vrna_mx_pf_aux_ml_s *
+vrna_exp_E_ml_fast_init_wavefront(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_pf_aux_ml_s *aux_mx = vrna_exp_E_ml_fast_init(fc);
+
+  if ((aux_mx) && (fc->hc->type != VRNA_HC_WINDOW) && (!aux_mx->qqmu)) {
+    int         j, n;
+    size_t      size;
+    FLT_OR_DBL  *block;
+
+    n = (int)fc->length;
+
+    /* column j holds the entries qqm[0..j + 1] of a serial fill after processing column j */
+    size = 0;
+    for (j = 0; j <= n + 1; j++)
+      size += (size_t)(j + 2);
+
+    block           = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+    aux_mx->qqm_mx  = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (n + 2));
+
+    for (j = 0; j <= n + 1; j++) {
+      aux_mx->qqm_mx[j] = block;
+      block             += j + 2;
+    }
+  }
+
+  return aux_mx;
+}
+
+
 PUBLIC void
 vrna_exp_E_ml_fast_rotate(struct vrna_mx_pf_aux_ml_s *aux_mx)
 {
@@ -196,6 +230,11 @@ vrna_exp_E_ml_fast_free(struct vrna_mx_pf_aux_ml_s *aux_mx)
     free(aux_mx->qqm);
     free(aux_mx->qqm1);
 
+    if (aux_mx->qqm_mx) {
+      free(aux_mx->qqm_mx[0]);
+      free(aux_mx->qqm_mx);
+    }
+
     if (aux_mx->qqmu) {
       for (u = 0; u <= aux_mx->qqmu_size; u++)
         free(aux_mx->qqmu[u]);
@@ -228,6 +267,21 @@ vrna_exp_E_ml_fast_qqm1(struct vrna_mx_pf_aux_ml_s *aux_mx)
 }
 
 
+PUBLIC const FLT_OR_DBL *
+vrna_exp_E_ml_fast_qqm_column(struct vrna_mx_pf_aux_ml_s  *aux_mx,
+                              int                         j)
+{
+  if (aux_mx) {
+    if (aux_mx->qqm_mx)
+      return (const FLT_OR_DBL *)aux_mx->qqm_mx[j];
+
+    return (const FLT_OR_DBL *)aux_mx->qqm;
+  }
+
+  return NULL;
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -252,7 +306,8 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
   struct default_data       hc_dat_local;
   struct sc_wrapper_exp_ml  sc_wrapper;
 
-  qqm1            = aux_mx->qqm1;
+  /* in wavefront mode, the previous column is column j - 1 of the helper matrix */
+  qqm1            = (aux_mx->qqm_mx) ? aux_mx->qqm_mx[j - 1] : aux_mx->qqm1;
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   se              = fc->strand_end;
@@ -337,9 +392,10 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
     k = i + 2;
 
     if (sliding_window) {
-      for (; k <= j - 1; k++, kl--)
-        temp += qm_local[i + 1][k - 1] *
-                qqm1_tmp[k];
+      /* qm_local[i + 1][k - 1] * qqm1[k] for all k in [i + 2, j - 1] */
+      temp = vrna_fun_zip_mult_sum(qm_local[i + 1] + i + 1,
+                                   qqm1_tmp + i + 2,
+                                   j - i - 2);
     } else {
       kl = my_iindx[i + 1] - (i + 1);
       /*
@@ -351,9 +407,14 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
         /* limit for-loop to last nucleotide of 5' part strand */
         int stop = MIN2(j - 1, se[sn[k - 1]]);
 
-        for (; k <= stop; k++, kl--)
-          temp += qm[kl] *
-                  qqm1_tmp[k];
+        if (stop >= k) {
+          /* qm[kl] * qqm1[k], where kl decreases with increasing k */
+          temp  += vrna_fun_zip_mult_sum_rev(qqm1_tmp + k,
+                                             qm + kl - (stop - k),
+                                             stop - k + 1);
+          kl    -= stop - k + 1;
+          k     = stop + 1;
+        }
 
         k++;
         kl--;
@@ -410,8 +471,8 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   S3              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   iidx            = (sliding_window) ? NULL : fc->iindx;
   ij              = (sliding_window) ? 0 : iidx[i] - j;
-  qqm             = aux_mx->qqm;
-  qqm1            = aux_mx->qqm1;
+  qqm             = (aux_mx->qqm_mx) ? aux_mx->qqm_mx[j] : aux_mx->qqm;
+  qqm1            = (aux_mx->qqm_mx) ? aux_mx->qqm_mx[j - 1] : aux_mx->qqm1;
   qqmu            = aux_mx->qqmu;
   qm              = (sliding_window) ? NULL : fc->exp_matrices->qm;
   qb              = (sliding_window) ? NULL : fc->exp_matrices->qb;
@@ -556,18 +617,25 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   k     = j;
 
   if (sliding_window) {
-    for (; k > i; k--)
-      temp += qm_local[i][k - 1] *
-              qqm_tmp[k];
+    /* qm_local[i][k - 1] * qqm[k] for all k in [i + 1, j] */
+    temp = vrna_fun_zip_mult_sum(qm_local[i] + i,
+                                 qqm_tmp + i + 1,
+                                 j - i);
   } else {
     kl = iidx[i] - j + 1; /* ii-k=[i,k-1] */
 
     while (1) {
       /* limit for-loop to first nucleotide of 3' part strand */
       int stop = MAX2(i, ss[sn[k]]);
-      for (; k > stop; k--, kl++)
-        temp += qm[kl] *
-                qqm_tmp[k];
+
+      if (k > stop) {
+        /* qm[kl] * qqm[k], where kl increases with decreasing k */
+        temp  += vrna_fun_zip_mult_sum_rev(qm + kl,
+                                           qqm_tmp + stop + 1,
+                                           k - stop);
+        kl    += k - stop;
+        k     = stop;
+      }
 
       k--;
       kl++;
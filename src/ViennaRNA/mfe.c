@@ -22,6 +22,10 @@
 #include <string.h>
 #include <limits.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/params/default.h"
@@ -45,6 +49,8 @@
 
 #define MAXSECTORS        500     /* dimension for a backtrack array */
 
+#define WAVEFRONT_TILE_SIZE 64      /* edge length of tiles processed by a single thread in parallel fill */
+
 struct aux_arrays {
   int *cc;    /* auxilary arrays for canonical structures     */
   int *cc1;   /* auxilary arrays for canonical structures     */
@@ -54,6 +60,20 @@ struct aux_arrays {
   int *DMLi2; /*                MIN(fML[i+2,k]+fML[k+1,j])    */
 };
 
+/*
+ *  Triangular, row-major counterparts of the auxiliary arrays above.
+ *  These are required for the parallel (wavefront) fill where
+ *  rows are no longer processed one after another.
+ */
+struct aux_matrices {
+  int *cc;    /* cc[i][j] as in aux_arrays (only allocated for noLP) */
+  int *Fm;    /* Fm[i][j] = fML[i,j] in row-major order               */
+  int *DML;   /* DML[i][j] = MIN(fML[i,k]+fML[k+1,j])                  */
+  int **cc_rows;
+  int **Fm_rows;
+  int **DML_rows;
+};
+
 
 /*
  #################################
@@ -77,6 +97,27 @@ PRIVATE int
 fill_arrays(vrna_fold_compound_t *fc);
 
 
+#ifdef _OPENMP
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   threads);
+
+
+PRIVATE INLINE int
+wavefront_compatible(vrna_fold_compound_t *fc);
+
+
+PRIVATE struct aux_matrices *
+get_aux_matrices(unsigned int length,
+                 int          with_cc);
+
+
+PRIVATE void
+free_aux_matrices(struct aux_matrices *aux);
+
+
+#endif
+
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
                      sect                 bt_stack[],
@@ -320,6 +361,19 @@ fill_arrays(vrna_fold_compound_t *fc)
     return 0;
   }
 
+#ifdef _OPENMP
+  if ((P->model_details.threads > 1) &&
+      (wavefront_compatible(fc))) {
+    fill_arrays_wavefront(fc, P->model_details.threads);
+    (void)vrna_E_ext_loop_5(fc);
+
+    free_aux_arrays(helper_arrays);
+
+    return f5[length];
+  }
+
+#endif
+
   for (i = length - turn - 1; i >= 1; i--) {
     for (j = i + turn + 1; j <= length; j++) {
       ij = indx[j] + i;
@@ -352,6 +406,177 @@ fill_arrays(vrna_fold_compound_t *fc)
 }
 
 
+#ifdef _OPENMP
+/*
+ *  Fill the DP matrices c, fML, and fM1 by anti-diagonals, i.e. by span
+ *  d = j - i. Each cell only depends on cells (p, q) with i <= p <= q <= j
+ *  such that all cells with the same span can be computed concurrently.
+ *  To retain the memory locality of the serial recursions, we actually
+ *  process square tiles of the matrices along the anti-diagonals, where
+ *  cells within a tile are filled in the same order as in the serial
+ *  implementation. The row-wise auxiliary arrays are replaced by
+ *  triangular matrices such that each cell finds the data of its
+ *  (former) neighboring rows.
+ */
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   threads)
+{
+  int                 i, j, ij, length, turn, uniq_ML, *indx, *c, *fML, *fM1,
+                      tiles, d, t, i_start, i_stop, j_start, j_stop;
+  struct aux_arrays   aux;
+  struct aux_matrices *aux_mx;
+
+  length  = (int)fc->length;
+  indx    = fc->jindx;
+  uniq_ML = fc->params->model_details.uniq_ML;
+  turn    = fc->params->model_details.min_loop_size;
+  c       = fc->matrices->c;
+  fML     = fc->matrices->fML;
+  fM1     = fc->matrices->fM1;
+  tiles   = (length + WAVEFRONT_TILE_SIZE - 1) / WAVEFRONT_TILE_SIZE;
+  aux_mx  = get_aux_matrices(length, fc->params->model_details.noLP);
+
+  /* do not oversubscribe the available processors */
+  if (threads > omp_get_num_procs())
+    threads = omp_get_num_procs();
+
+#pragma omp parallel num_threads(threads) \
+  private(d, t, i, j, ij, i_start, i_stop, j_start, j_stop, aux)
+  for (d = 0; d < tiles; d++) {
+    /* all tiles (t, t + d) on the d-th anti-diagonal of tiles are independent */
+#pragma omp for schedule(dynamic, 1)
+    for (t = 0; t < tiles - d; t++) {
+      i_start = t * WAVEFRONT_TILE_SIZE + 1;
+      i_stop  = MIN2(i_start + WAVEFRONT_TILE_SIZE - 1, length);
+      j_start = (t + d) * WAVEFRONT_TILE_SIZE + 1;
+      j_stop  = MIN2(j_start + WAVEFRONT_TILE_SIZE - 1, length);
+
+      for (i = i_stop; i >= i_start; i--) {
+        aux.cc    = (aux_mx->cc_rows) ? aux_mx->cc_rows[i] : NULL;
+        aux.cc1   = (aux_mx->cc_rows) ? aux_mx->cc_rows[i + 1] : NULL;
+        aux.Fmi   = aux_mx->Fm_rows[i];
+        aux.DMLi  = aux_mx->DML_rows[i];
+        aux.DMLi1 = aux_mx->DML_rows[i + 1];
+        aux.DMLi2 = aux_mx->DML_rows[i + 2];
+
+        for (j = MAX2(i + turn + 1, j_start); j <= j_stop; j++) {
+          ij = indx[j] + i;
+
+          c[ij] = decompose_pair(fc, i, j, &aux);
+
+          fML[ij] = vrna_E_ml_stems_fast(fc, i, j, aux.Fmi, aux.DMLi);
+
+          if (uniq_ML)
+            fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+        }
+      }
+    }
+  }
+
+  free_aux_matrices(aux_mx);
+}
+
+
+/*
+ *  The parallel fill may only be used if we do not need to call any
+ *  user-defined callback, since we can not guarantee that those are
+ *  thread-safe, or require a particular order of evaluation.
+ */
+PRIVATE INLINE int
+wavefront_compatible(vrna_fold_compound_t *fc)
+{
+  unsigned int s;
+
+  if ((fc->hc->f) ||
+      (fc->aux_grammar) ||
+      (fc->domains_up))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      if ((fc->sc) && (fc->sc->f))
+        return 0;
+
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      if (fc->scs)
+        for (s = 0; s < fc->n_seq; s++)
+          if ((fc->scs[s]) && (fc->scs[s]->f))
+            return 0;
+
+      break;
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Each row r of the triangular matrices spans the columns [r - 2, n + 1]
+ *  such that accesses to (i + 1, j - 2) and (i + 2, j - 1) stay within
+ *  the row boundaries for any min_loop_size
+ */
+PRIVATE struct aux_matrices *
+get_aux_matrices(unsigned int length,
+                 int          with_cc)
+{
+  unsigned int        r;
+  size_t              size, offset;
+  struct aux_matrices *aux;
+
+  aux   = (struct aux_matrices *)vrna_alloc(sizeof(struct aux_matrices));
+  size  = 0;
+
+  for (r = 1; r <= length + 2; r++)
+    size += length + 4 - r;
+
+  aux->Fm       = (int *)vrna_alloc(sizeof(int) * size);
+  aux->DML      = (int *)vrna_alloc(sizeof(int) * size);
+  aux->Fm_rows  = (int **)vrna_alloc(sizeof(int *) * (length + 3));
+  aux->DML_rows = (int **)vrna_alloc(sizeof(int *) * (length + 3));
+
+  for (offset = 0; offset < size; offset++)
+    aux->Fm[offset] = aux->DML[offset] = INF;
+
+  if (with_cc) {
+    aux->cc       = (int *)vrna_alloc(sizeof(int) * size);
+    aux->cc_rows  = (int **)vrna_alloc(sizeof(int *) * (length + 3));
+    for (offset = 0; offset < size; offset++)
+      aux->cc[offset] = INF;
+  }
+
+  for (offset = 0, r = 1; r <= length + 2; r++) {
+    /* shift row pointers such that they can be indexed by j directly */
+    aux->Fm_rows[r]   = aux->Fm + offset - ((int)r - 2);
+    aux->DML_rows[r]  = aux->DML + offset - ((int)r - 2);
+    if (with_cc)
+      aux->cc_rows[r] = aux->cc + offset - ((int)r - 2);
+
+    offset += length + 4 - r;
+  }
+
+  return aux;
+}
+
+
+PRIVATE void
+free_aux_matrices(struct aux_matrices *aux)
+{
+  free(aux->cc);
+  free(aux->Fm);
+  free(aux->DML);
+  free(aux->cc_rows);
+  free(aux->Fm_rows);
+  free(aux->DML_rows);
+  free(aux);
+}
+
+
+#endif
+
+
 /* post-processing step for circular RNAs */
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
@@ -1812,10 +2037,13 @@ get_aux_arrays(unsigned int length)
   aux->DMLi1  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   aux->DMLi2  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+2,k]+fML[k+1,j])    */
 
-  /* prefill helper arrays */
+  /* prefill helper arrays, cc and cc1 just like rotate_aux_arrays() and the parallel fill do */
   for (j = 0; j <= length; j++)
     aux->Fmi[j] = aux->DMLi[j] = aux->DMLi1[j] = aux->DMLi2[j] = INF;
 
+  for (j = 0; j <= length + 1; j++)
+    aux->cc[j] = aux->cc1[j] = INF;
+
   return aux;
 }
 
@@ -71,6 +71,13 @@
  *  @note This function is polymorphic. It accepts #vrna_fold_compound_t of type
  *        #VRNA_FC_TYPE_SINGLE, and #VRNA_FC_TYPE_COMPARATIVE.
  *
+ *  @note If #vrna_md_t.threads is larger than 1 and the library was compiled with
+ *        OpenMP support, the DP matrices are filled in parallel along anti-diagonals.
+ *        The result is identical to the serial fill. This mode requires additional
+ *        memory in the order of the size of two (three for @p noLP) DP matrices and is
+ *        not applied if user-defined hard/soft constraint callbacks, unstructured domains,
+ *        or auxiliary grammar extensions are present.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_fold(), vrna_circfold(),
  *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold()
  *
@@ -241,6 +248,88 @@ vrna_cofold(const char  *sequence,
             char        *structure);
 
 
+/**
+ *  @brief  Option flag for vrna_fold_batch() to compute MFE and MFE structure only
+ *  @see    vrna_fold_batch(), #VRNA_FOLD_BATCH_PF
+ */
+#define VRNA_FOLD_BATCH_DEFAULT   0U
+
+
+/**
+ *  @brief  Option flag for vrna_fold_batch() to additionally compute the ensemble free energy
+ *  @see    vrna_fold_batch(), #VRNA_FOLD_BATCH_DEFAULT
+ */
+#define VRNA_FOLD_BATCH_PF        1U
+
+
+/**
+ *  @brief  A single result of vrna_fold_batch()
+ */
+typedef struct vrna_fold_batch_result_s vrna_fold_batch_result_t;
+
+
+/**
+ *  @brief  A single result of vrna_fold_batch()
+ */
+struct vrna_fold_batch_result_s {
+  char  *structure;       /**< @brief  MFE structure in dot-bracket notation, or @em NULL on failure */
+  float mfe;              /**< @brief  Minimum free energy in kcal/mol */
+  float ensemble_energy;  /**< @brief  Ensemble free energy in kcal/mol (only with #VRNA_FOLD_BATCH_PF) */
+};
+
+
+/**
+ *  @brief Compute MFE, MFE structure, and optionally the ensemble free energy for a batch of RNA sequences
+ *
+ *  This function is meant for large sets of sequences that are all folded under the same model
+ *  settings, e.g. in screening applications. The sequences are distributed among a pool of
+ *  @p md->threads worker threads (see vrna_md_defaults_threads()). Each worker allocates the
+ *  dynamic programming matrices for the longest sequence in the batch once and passes them
+ *  on from one sequence to the next via vrna_fold_compound_recycle().
+ *
+ *  @note Apart from the DP matrices, nothing is shared between the sequences. Each of them
+ *        still receives its own #vrna_fold_compound_t with a private copy of the energy
+ *        parameters (and Boltzmann factors), see vrna_params(). Compared to calling vrna_fold()
+ *        for each sequence, a batch thus mainly saves memory allocations besides running
+ *        the predictions in parallel.
+ *
+ *  Sequences that consist of multiple strands, i.e. that contain the '&' delimiter, are processed
+ *  using a separate #vrna_fold_compound_t and vrna_mfe_dimer(). Empty sequences result in an entry
+ *  with @em NULL structure.
+ *
+ *  @note The result for each sequence is identical to calling vrna_mfe() (and vrna_pf() after
+ *        vrna_exp_params_rescale()) on a newly created #vrna_fold_compound_t. The order of
+ *        the results is the same as in the input, independent of the number of threads.
+ *
+ *  @see vrna_fold_batch_free(), vrna_fold(), vrna_mfe(), vrna_pf(), #VRNA_FOLD_BATCH_DEFAULT,
+ *       #VRNA_FOLD_BATCH_PF
+ *
+ *  @param sequences      The RNA sequences
+ *  @param num_sequences  The number of sequences in @p sequences
+ *  @param md             The model details to use for all sequences (may be @em NULL for default settings)
+ *  @param options        Options, either #VRNA_FOLD_BATCH_DEFAULT or #VRNA_FOLD_BATCH_PF
+ *  @return               An array of @p num_sequences results, or @em NULL on failure
+ */
+vrna_fold_batch_result_t *
+vrna_fold_batch(const char      **sequences,
+                size_t          num_sequences,
+                const vrna_md_t *md,
+                unsigned int    options);
+
+
+/**
+ *  @brief  Release memory occupied by the results of vrna_fold_batch()
+ *
+ *  @see vrna_fold_batch()
+ *
+ *  @param results      The results as returned by vrna_fold_batch()
+ *  @param num_results  The number of results in @p results
+ */
+void
+vrna_fold_batch_free(vrna_fold_batch_result_t *results,
+                     size_t                   num_results);
+
+
 /**
  * End simplified global MFE interface
  * @}
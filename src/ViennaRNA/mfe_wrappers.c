@@ -9,12 +9,45 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "ViennaRNA/fold_compound.h"
 #include "ViennaRNA/model.h"
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/part_func.h"
 #include "ViennaRNA/mfe.h"
 
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE void
+batch_fold(vrna_fold_compound_t     **worker,
+           const char               *sequence,
+           const char               *longest,
+           vrna_md_t                *md,
+           unsigned int             options,
+           vrna_fold_batch_result_t *result);
+
+
+PRIVATE void
+batch_compute(vrna_fold_compound_t      *fc,
+              unsigned int              options,
+              vrna_fold_batch_result_t  *result);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+
 
 /* wrappers for single sequences */
 PUBLIC float
@@ -116,3 +149,175 @@ vrna_cofold(const char  *seq,
 
   return mfe;
 }
+
+
+/* batch processing of many sequences with recycled DP matrices */
+PUBLIC vrna_fold_batch_result_t *
+vrna_fold_batch(const char      **sequences,
+                size_t          num_sequences,
+                const vrna_md_t *md_p,
+                unsigned int    options)
+{
+  const char                *longest;
+  size_t                    i, n, n_max;
+  int                       threads;
+  vrna_md_t                 md;
+  vrna_fold_compound_t      *worker;
+  vrna_fold_batch_result_t  *results;
+
+  if ((!sequences) || (num_sequences == 0))
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* the workers process one sequence each, so do not parallelize within a single prediction */
+  threads     = md.threads;
+  md.threads  = 1;
+
+  /* we only require the ensemble free energy but no base pair probabilities */
+  md.compute_bpp = 0;
+
+  results = (vrna_fold_batch_result_t *)vrna_alloc(sizeof(vrna_fold_batch_result_t) *
+                                                   num_sequences);
+
+  /* determine the longest sequence to let each worker allocate its memory only once */
+  longest = NULL;
+  n_max   = 0;
+
+  for (i = 0; i < num_sequences; i++) {
+    results[i].structure        = NULL;
+    results[i].mfe              = (float)(INF / 100.);
+    results[i].ensemble_energy  = (float)(INF / 100.);
+
+    if ((sequences[i]) && (!strchr(sequences[i], '&'))) {
+      n = strlen(sequences[i]);
+      if (n > n_max) {
+        n_max   = n;
+        longest = sequences[i];
+      }
+    }
+  }
+
+#ifdef _OPENMP
+  /* do not oversubscribe the available processors */
+  if (threads > omp_get_num_procs())
+    threads = omp_get_num_procs();
+
+  if ((size_t)threads > num_sequences)
+    threads = (int)num_sequences;
+
+  if (threads > 1) {
+#pragma omp parallel num_threads(threads) private(i, worker)
+    {
+      worker = NULL;
+
+#pragma omp for schedule(dynamic, 1)
+      for (i = 0; i < num_sequences; i++)
+        batch_fold(&worker, sequences[i], longest, &md, options, &(results[i]));
+
+      vrna_fold_compound_free(worker);
+    }
+
+    return results;
+  }
+
+#endif
+
+  worker = NULL;
+
+  for (i = 0; i < num_sequences; i++)
+    batch_fold(&worker, sequences[i], longest, &md, options, &(results[i]));
+
+  vrna_fold_compound_free(worker);
+
+  return results;
+}
+
+
+PUBLIC void
+vrna_fold_batch_free(vrna_fold_batch_result_t *results,
+                     size_t                   num_results)
+{
+  size_t i;
+
+  if (results) {
+    for (i = 0; i < num_results; i++)
+      free(results[i].structure);
+
+    free(results);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+batch_fold(vrna_fold_compound_t     **worker,
+           const char               *sequence,
+           const char               *longest,
+           vrna_md_t                *md,
+           unsigned int             options,
+           vrna_fold_batch_result_t *result)
+{
+  unsigned int          fc_options;
+  vrna_fold_compound_t  *fc;
+
+  if ((!sequence) || (*sequence == '\0'))
+    return;
+
+  fc_options = VRNA_OPTION_MFE;
+  if (options & VRNA_FOLD_BATCH_PF)
+    fc_options |= VRNA_OPTION_PF;
+
+  if (strchr(sequence, '&')) {
+    /* multiple strands, use a separate fold compound */
+    fc = vrna_fold_compound(sequence, md, fc_options);
+    if (fc) {
+      batch_compute(fc, options, result);
+      vrna_fold_compound_free(fc);
+    }
+
+    return;
+  }
+
+  /*
+   *  each worker starts with a fold compound for the longest sequence of the
+   *  batch, such that its DP matrices are allocated only once and handed over
+   *  to the fold compounds of all subsequent sequences
+   */
+  if (!(*worker))
+    *worker = vrna_fold_compound(longest, md, fc_options);
+
+  *worker = vrna_fold_compound_recycle(*worker, sequence, md, fc_options);
+
+  if (*worker)
+    batch_compute(*worker, options, result);
+}
+
+
+PRIVATE void
+batch_compute(vrna_fold_compound_t      *fc,
+              unsigned int              options,
+              vrna_fold_batch_result_t  *result)
+{
+  double mfe;
+
+  result->structure = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
+
+  if (fc->strands > 1)
+    result->mfe = vrna_mfe_dimer(fc, result->structure);
+  else
+    result->mfe = vrna_mfe(fc, result->structure);
+
+  if (options & VRNA_FOLD_BATCH_PF) {
+    mfe = (double)result->mfe;
+    vrna_exp_params_rescale(fc, &mfe);
+    result->ensemble_energy = vrna_pf(fc, NULL);
+  }
+}
@@ -134,7 +134,8 @@ PRIVATE vrna_md_t defaults = {
     { 0,                            0,  0, 0, 0, 0, 2, 0 },
     { 0,                            0,  0, 0, 0, 1, 0, 0 },
     { 0,                            6,  0, 0, 5, 0, 0, 0 }
-  }
+  },
+  VRNA_MODEL_DEFAULT_THREADS
 };
 
 /*
@@ -335,6 +336,7 @@ vrna_md_defaults_reset(vrna_md_t *md_p)
   defaults.betaScale        = VRNA_MODEL_DEFAULT_BETA_SCALE;
   defaults.pf_smooth        = VRNA_MODEL_DEFAULT_PF_SMOOTH;
   defaults.sfact            = 1.07;
+  defaults.threads          = VRNA_MODEL_DEFAULT_THREADS;
   defaults.nonstandards[0]  = '\0';
 
   if (md_p) {
@@ -369,6 +371,7 @@ vrna_md_defaults_reset(vrna_md_t *md_p)
     vrna_md_defaults_betaScale(md_p->betaScale);
     vrna_md_defaults_pf_smooth(md_p->pf_smooth);
     vrna_md_defaults_sfact(md_p->sfact);
+    vrna_md_defaults_threads(md_p->threads);
     copy_nonstandards(&defaults, &(md_p->nonstandards[0]));
   }
 
@@ -824,6 +827,20 @@ vrna_md_defaults_sfact_get(void)
 }
 
 
+PUBLIC void
+vrna_md_defaults_threads(int threads)
+{
+  defaults.threads = (threads < 1) ? 1 : threads;
+}
+
+
+PUBLIC int
+vrna_md_defaults_threads_get(void)
+{
+  return defaults.threads;
+}
+
+
 PUBLIC void
 vrna_md_update(vrna_md_t *md)
 {
@@ -993,6 +1010,7 @@ set_model_details(vrna_md_t *md)
     md->betaScale       = VRNA_MODEL_DEFAULT_BETA_SCALE;
     md->pf_smooth       = VRNA_MODEL_DEFAULT_PF_SMOOTH;
     md->sfact           = 1.07;
+    md->threads         = VRNA_MODEL_DEFAULT_THREADS;
 
     if (nonstandards)
       copy_nonstandards(md, nonstandards);
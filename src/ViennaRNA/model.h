@@ -156,6 +156,12 @@ typedef struct vrna_md_s vrna_md_t;
 
 #define VRNA_MODEL_DEFAULT_PF_SMOOTH      1
 
+/**
+ *  @brief  Default number of threads used to fill the dynamic programming matrices
+ *  @see    #vrna_md_t.threads, vrna_md_defaults_reset(), vrna_md_set_default()
+ */
+#define VRNA_MODEL_DEFAULT_THREADS        1
+
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
@@ -233,6 +239,25 @@ struct vrna_md_s {
   int     rtype[8];                         /**<  @brief  Reverse base pair type array */
   short   alias[MAXALPHA + 1];              /**<  @brief  alias of an integer nucleotide representation */
   int     pair[MAXALPHA + 1][MAXALPHA + 1]; /**<  @brief  Integer representation of a base pair */
+  int     threads;                          /**<  @brief  Number of threads used to fill the DP matrices
+                                             *
+                                             *    Values larger than 1 activate the parallel (wavefront)
+                                             *    fill of the dynamic programming matrices, where all cells
+                                             *    with the same span @f$ d = j - i @f$ are processed
+                                             *    concurrently. This requires the library to be compiled
+                                             *    with OpenMP support. Otherwise, or if user-defined callbacks
+                                             *    are attached to the fold compound, the serial recursions
+                                             *    are used. Results never depend on the number of threads,
+                                             *    since each matrix entry is always accumulated by a single
+                                             *    thread in the order of the serial recursions.
+                                             *    Suboptimal structure enumeration in vrna_subopt_cb() also
+                                             *    distributes its search tree among this number of threads,
+                                             *    see there for the order of the reported structures.
+                                             *    vrna_heat_capacity_cb() uses the threads to evaluate
+                                             *    different temperatures concurrently instead, and
+                                             *    vrna_probs_window() folds overlapping blocks of the
+                                             *    sequence in parallel.
+                                             */
 };
 
 
@@ -742,6 +767,24 @@ double
 vrna_md_defaults_sfact_get(void);
 
 
+/**
+ *  @brief  Set the default number of threads used to fill the dynamic programming matrices
+ *  @see vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_THREADS
+ *  @param  threads The number of threads (values < 1 are treated as 1)
+ */
+void
+vrna_md_defaults_threads(int threads);
+
+
+/**
+ *  @brief  Get the default number of threads used to fill the dynamic programming matrices
+ *  @see vrna_md_defaults_threads(), vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_THREADS
+ *  @return The global default settings for the number of threads
+ */
+int
+vrna_md_defaults_threads_get(void);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 #define model_detailsT        vrna_md_t               /* restore compatibility of struct rename */
@@ -363,11 +363,74 @@ vrna_exp_params_reset(vrna_fold_compound_t  *vc,
                       vrna_md_t             *md_p);
 
 
+/**
+ *  @brief  Change the temperature of a #vrna_fold_compound_t
+ *
+ *  In contrast to vrna_params_reset(), this function only re-computes what actually
+ *  depends on the temperature. The free energy parameters and, if present, the
+ *  Boltzmann factors are re-scaled in place from the stored enthalpies and free
+ *  energies, bypassing the parameter cache, and the scaling factor for partition
+ *  function computations is guessed anew (see vrna_exp_params_rescale()).
+ *  Sequence encodings, pair type arrays, hard constraints, DP matrix accessors,
+ *  and the DP matrices themselves are kept. The G-quadruplex energies of the
+ *  MFE matrices are re-computed, and Boltzmann weighted soft constraints are marked
+ *  for re-computation upon the next partition function computation. All other
+ *  model details remain unchanged.
+ *
+ *  This makes temperature scans, e.g. for melting curves, considerably cheaper for
+ *  short sequences, where re-creating the parameter tables easily dominates the
+ *  actual computations.
+ *
+ *  @note Energy contributions of user-defined callbacks, e.g. generic soft constraints,
+ *        are not affected.
+ *
+ *  @note Comparative fold compounds with Boltzmann weighted soft constraints for
+ *        unpaired or paired positions cannot be re-scaled, see vrna_sc_rescale().
+ *        In this case, the function leaves the fold compound untouched and returns 0.
+ *
+ *  @see  vrna_params_reset(), vrna_exp_params_rescale(), vrna_heat_capacity()
+ *
+ *  @param  fc          The fold compound data structure
+ *  @param  temperature The new temperature in &deg;C
+ *  @return             Non-zero on success, 0 otherwise
+ */
+int
+vrna_fold_compound_set_temperature(vrna_fold_compound_t *fc,
+                                   double               temperature);
+
+
 void
 vrna_params_prepare(vrna_fold_compound_t  *vc,
                     unsigned int          options);
 
 
+/**
+ *  @brief  Remove all energy parameter sets from the internal parameter cache
+ *
+ *  Temperature scaled energy parameters and Boltzmann factors obtained through vrna_params(),
+ *  vrna_exp_params(), and vrna_exp_params_comparative() are derived from an internal,
+ *  thread-safe cache. This cache stores one read-only instance of the parameter tables for
+ *  each distinct combination of the model details that affect them, i.e.
+ *  #vrna_md_t.temperature, #vrna_md_t.betaScale, #vrna_md_t.dangles, and #vrna_md_t.pf_smooth.
+ *  Subsequent requests receive a copy of the cached tables instead of re-computing them.
+ *
+ *  @note The cache only saves the computation of the tables, not the memory they occupy.
+ *        Every request still returns a full, private copy that the caller may modify and
+ *        must release. In particular, each #vrna_fold_compound_t holds its own copy of the
+ *        energy parameters and Boltzmann factors.
+ *
+ *  The cache is cleared automatically whenever a new energy parameter set is loaded, e.g.
+ *  through vrna_params_load(). Use this function only if the global energy parameters
+ *  were altered by any other means.
+ *
+ *  @note The cache is only available if RNAlib was compiled with POSIX threads support.
+ *
+ *  @see  vrna_params(), vrna_exp_params(), vrna_exp_params_comparative(), vrna_params_load()
+ */
+void
+vrna_params_cache_clear(void);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /**
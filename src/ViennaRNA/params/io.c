@@ -19,6 +19,7 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/params/default.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/static/energy_parameter_sets.h"
 
@@ -264,6 +265,9 @@ vrna_params_load(const char   fname[],
     ret = set_parameters_from_string(file_content,
                                      (const char *)name);
 
+    /* previously computed parameter tables are outdated now */
+    vrna_params_cache_clear();
+
     free(name);
     for (ptr = file_content; *ptr != NULL; ptr++)
       free(*ptr);
@@ -328,6 +332,9 @@ vrna_params_load_from_string(const char   *string,
     ret = set_parameters_from_string(params_array,
                                      name);
 
+    /* previously computed parameter tables are outdated now */
+    vrna_params_cache_clear();
+
     /* cleanup memory */
     free(tmp_string);
 
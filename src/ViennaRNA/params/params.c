@@ -13,11 +13,23 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
+
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/gquad.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
 
 /**
  *** \file ViennaRNA/params/basic.c
@@ -55,6 +67,17 @@
  */
 #define TRUNC_MAYBE(X) ((!pf_smooth) ? (double)((int)(X)) : (X))
 
+/* size of the memoization table for Boltzmann factors (as power of 2) */
+#define BF_MEMO_BITS  12
+#define BF_MEMO_SIZE  (1U << BF_MEMO_BITS)
+
+/* maximum number of distinct parameter sets kept in the parameter cache */
+#define PARAMS_CACHE_SIZE   8
+
+#define PARAMS_CACHE_MFE    1U
+#define PARAMS_CACHE_PF     2U
+#define PARAMS_CACHE_PF_ALI 3U
+
 
 /* Rescale Free energy contribution according to deviation of temperature from measurement conditions */
 #define RESCALE_dG(dG, dH, dT)   ((dH) - ((dH) - (dG)) * dT)
@@ -96,6 +119,33 @@ PRIVATE int               pf_id = -1;
 #pragma omp threadprivate(id, pf_id)
 #endif
 
+#if VRNA_WITH_PTHREADS
+/*
+ *  Parameter cache, i.e. read-only templates of the parameter tables for
+ *  the model settings that actually affect the tables. Entries are
+ *  reference counted while their content is copied outside the lock,
+ *  so clearing or replacing them may be deferred until the last
+ *  reader has finished.
+ */
+struct params_cache_entry {
+  unsigned int  type;
+  double        temperature;
+  double        betaScale;
+  int           dangles;
+  int           pf_smooth;
+  unsigned int  n_seq;
+  void          *data;
+  size_t        size;
+  unsigned int  refs;
+  unsigned int  stale;
+  unsigned long last_use;
+};
+
+PRIVATE struct params_cache_entry params_cache[PARAMS_CACHE_SIZE];
+PRIVATE unsigned long             params_cache_clock  = 0;
+PRIVATE pthread_mutex_t           params_cache_mtx    = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -117,6 +167,56 @@ get_exp_params_ali(vrna_md_t    *md,
                    double       pfs);
 
 
+PRIVATE void
+compute_params(vrna_param_t *params,
+               vrna_md_t    *md);
+
+
+PRIVATE void
+compute_exp_params(vrna_exp_param_t *pf,
+                   vrna_md_t        *md,
+                   double           pfs);
+
+
+PRIVATE void
+compute_exp_params_ali(vrna_exp_param_t *pf,
+                       vrna_md_t        *md,
+                       unsigned int     n_seq,
+                       double           pfs);
+
+
+PRIVATE INLINE void
+rescale_dG_table(int        *table,
+                 const int  *dG,
+                 const int  *dH,
+                 size_t     size,
+                 double     tempf);
+
+
+PRIVATE INLINE void
+rescale_BF_table(double     *table,
+                 const int  *dG,
+                 const int  *dH,
+                 size_t     size,
+                 double     TT,
+                 double     kT,
+                 int        pf_smooth);
+
+
+PRIVATE void *
+params_cache_fetch(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq);
+
+
+PRIVATE void
+params_cache_store(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq,
+                   const void   *data,
+                   size_t       size);
+
+
 PRIVATE void
 rescale_params(vrna_fold_compound_t *vc);
 
@@ -194,6 +294,31 @@ vrna_exp_params_copy(vrna_exp_param_t *par)
 }
 
 
+PUBLIC void
+vrna_params_cache_clear(void)
+{
+#if VRNA_WITH_PTHREADS
+  unsigned int i;
+
+  pthread_mutex_lock(&params_cache_mtx);
+
+  for (i = 0; i < PARAMS_CACHE_SIZE; i++) {
+    if (params_cache[i].data) {
+      if (params_cache[i].refs > 0) {
+        /* still in use, the last reader will release the memory */
+        params_cache[i].stale = 1;
+      } else {
+        free(params_cache[i].data);
+        params_cache[i].data = NULL;
+      }
+    }
+  }
+
+  pthread_mutex_unlock(&params_cache_mtx);
+#endif
+}
+
+
 PUBLIC void
 vrna_params_subst(vrna_fold_compound_t  *vc,
                   vrna_param_t          *parameters)
@@ -271,6 +396,73 @@ vrna_exp_params_reset(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC int
+vrna_fold_compound_set_temperature(vrna_fold_compound_t *fc,
+                                   double               temperature)
+{
+  vrna_md_t md;
+
+  if ((!fc) ||
+      (!fc->params) ||
+      (temperature < -K0))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:     /* fall through */
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      break;
+
+    default:
+      return 0;
+  }
+
+  /* Boltzmann weighted soft constraints are lazily re-computed, if possible */
+  if (!vrna_sc_rescale(fc))
+    return 0;
+
+  /* re-compute the free energies in place */
+  md              = fc->params->model_details;
+  md.temperature  = temperature;
+
+  compute_params(fc->params, &md);
+  fc->params->id = ++id;
+
+  /* the Boltzmann factors keep their own model details, e.g. for multiple strands */
+  if (fc->exp_params) {
+    md              = fc->exp_params->model_details;
+    md.temperature  = temperature;
+
+    if (fc->type == VRNA_FC_TYPE_SINGLE)
+      compute_exp_params(fc->exp_params, &md, -1.);
+    else
+      compute_exp_params_ali(fc->exp_params, &md, fc->n_seq, -1.);
+
+    /* guess a new scaling factor and update the DP matrix helper arrays */
+    vrna_exp_params_rescale(fc, NULL);
+  }
+
+  /* G-quadruplex free energies are only computed upon DP matrix allocation */
+  if ((fc->matrices) &&
+      (fc->matrices->type == VRNA_MX_DEFAULT) &&
+      (fc->matrices->ggg)) {
+    free(fc->matrices->ggg);
+
+    if (fc->type == VRNA_FC_TYPE_SINGLE)
+      fc->matrices->ggg = get_gquad_matrix(fc->sequence_encoding2, fc->params);
+    else
+      fc->matrices->ggg = get_gquad_ali_matrix(fc->length,
+                                               fc->S_cons,
+                                               fc->S,
+                                               fc->a2s,
+                                               fc->n_seq,
+                                               fc->params);
+  }
+
+  return 1;
+}
+
+
 PUBLIC void
 vrna_exp_params_subst(vrna_fold_compound_t  *vc,
                       vrna_exp_param_t      *params)
@@ -399,11 +591,77 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
 PRIVATE vrna_param_t *
 get_scaled_params(vrna_md_t *md)
 {
-  unsigned int  i, j, k, l;
-  double        tempf;
-  vrna_param_t  *params;
+  vrna_param_t *params;
+
+  params = (vrna_param_t *)params_cache_fetch(PARAMS_CACHE_MFE, md, 0);
+
+  if (!params) {
+    params = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
+    compute_params(params, md);
+    params_cache_store(PARAMS_CACHE_MFE, md, 0, params, sizeof(vrna_param_t));
+  }
+
+  params->model_details = *md;  /* copy over the model details */
+  params->id            = ++id;
+
+  return params;
+}
 
-  params = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
+
+PRIVATE vrna_exp_param_t *
+get_scaled_exp_params(vrna_md_t *md,
+                      double    pfs)
+{
+  vrna_exp_param_t *pf;
+
+  pf = (vrna_exp_param_t *)params_cache_fetch(PARAMS_CACHE_PF, md, 0);
+
+  if (!pf) {
+    pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+    compute_exp_params(pf, md, pfs);
+    params_cache_store(PARAMS_CACHE_PF, md, 0, pf, sizeof(vrna_exp_param_t));
+  }
+
+  pf->model_details = *md;
+  pf->pf_scale      = pfs;
+
+  return pf;
+}
+
+
+PRIVATE vrna_exp_param_t *
+get_exp_params_ali(vrna_md_t    *md,
+                   unsigned int n_seq,
+                   double       pfs)
+{
+  vrna_exp_param_t *pf;
+
+  pf = (vrna_exp_param_t *)params_cache_fetch(PARAMS_CACHE_PF_ALI, md, n_seq);
+
+  if (!pf) {
+    pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+    compute_exp_params_ali(pf, md, n_seq, pfs);
+    params_cache_store(PARAMS_CACHE_PF_ALI, md, n_seq, pf, sizeof(vrna_exp_param_t));
+  }
+
+  pf->model_details = *md;
+  pf->pf_scale      = pfs;
+
+  return pf;
+}
+
+
+/*
+ *  Fill (or overwrite) the energy parameter tables in params, such that
+ *  memory of an existing data structure can be re-used for different
+ *  temperatures
+ */
+PRIVATE void
+compute_params(vrna_param_t *params,
+               vrna_md_t    *md)
+{
+  unsigned int  i, j, k;
+  double        tempf;
 
   memset(params->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
@@ -460,11 +718,11 @@ get_scaled_params(vrna_md_t *md)
     params->MLintern[i] = RESCALE_dG(ML_intern37, ML_interndH, tempf);
 
   /* stacks    G(T) = H - [H - G(T0)]*T/T0 */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      params->stack[i][j] = RESCALE_dG(stack37[i][j],
-                                       stackdH[i][j],
-                                       tempf);
+  rescale_dG_table(&(params->stack[0][0]),
+                   &(stack37[0][0]),
+                   &(stackdH[0][0]),
+                   sizeof(params->stack) / sizeof(int),
+                   tempf);
 
   /* mismatches */
   for (i = 0; i <= NBPAIRS; i++)
@@ -511,60 +769,40 @@ get_scaled_params(vrna_md_t *md)
       params->dangle3[i][j] = (dd > 0) ? 0 : dd;  /* must be <= 0 */
     }
 
-  /* interior 1x1 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++)
-          params->int11[i][j][k][l] = RESCALE_dG(int11_37[i][j][k][l],
-                                                 int11_dH[i][j][k][l],
-                                                 tempf);
-
-  /* interior 2x1 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m;
-          for (m = 0; m < 5; m++)
-            params->int21[i][j][k][l][m] = RESCALE_dG(int21_37[i][j][k][l][m],
-                                                      int21_dH[i][j][k][l][m],
-                                                      tempf);
-        }
-
-  /* interior 2x2 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m, n;
-          for (m = 0; m < 5; m++)
-            for (n = 0; n < 5; n++)
-              params->int22[i][j][k][l][m][n] = RESCALE_dG(int22_37[i][j][k][l][m][n],
-                                                           int22_dH[i][j][k][l][m][n],
-                                                           tempf);
-        }
+  /* interior 1x1, 2x1, and 2x2 loops */
+  rescale_dG_table(&(params->int11[0][0][0][0]),
+                   &(int11_37[0][0][0][0]),
+                   &(int11_dH[0][0][0][0]),
+                   sizeof(params->int11) / sizeof(int),
+                   tempf);
+
+  rescale_dG_table(&(params->int21[0][0][0][0][0]),
+                   &(int21_37[0][0][0][0][0]),
+                   &(int21_dH[0][0][0][0][0]),
+                   sizeof(params->int21) / sizeof(int),
+                   tempf);
+
+  rescale_dG_table(&(params->int22[0][0][0][0][0][0]),
+                   &(int22_37[0][0][0][0][0][0]),
+                   &(int22_dH[0][0][0][0][0][0]),
+                   sizeof(params->int22) / sizeof(int),
+                   tempf);
 
   strncpy(params->Tetraloops, Tetraloops, 281);
   strncpy(params->Triloops, Triloops, 241);
   strncpy(params->Hexaloops, Hexaloops, 361);
-
-  params->id = ++id;
-  return params;
 }
 
 
-PRIVATE vrna_exp_param_t *
-get_scaled_exp_params(vrna_md_t *md,
-                      double    pfs)
+PRIVATE void
+compute_exp_params(vrna_exp_param_t *pf,
+                   vrna_md_t        *md,
+                   double           pfs)
 {
-  unsigned int      i, j, k, l;
-  int               pf_smooth;
-  double            kT, TT;
-  double            GT;
-  vrna_exp_param_t  *pf;
-
-  pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+  unsigned int  i, j, k;
+  int           pf_smooth;
+  double        kT, TT;
+  double        GT;
 
   memset(pf->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
@@ -650,9 +888,13 @@ get_scaled_exp_params(vrna_md_t *md,
     }
 
   /* stacking energies */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      pf->expstack[i][j] = RESCALE_BF(stack37[i][j], stackdH[i][j], TT, kT);
+  rescale_BF_table(&(pf->expstack[0][0]),
+                   &(stack37[0][0]),
+                   &(stackdH[0][0]),
+                   sizeof(pf->expstack) / sizeof(double),
+                   TT,
+                   kT,
+                   pf_smooth);
 
   /* mismatch energies */
   for (i = 0; i <= NBPAIRS; i++)
@@ -689,67 +931,49 @@ get_scaled_exp_params(vrna_md_t *md,
         }
       }
 
-  /* interior lops of length 2 */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          pf->expint11[i][j][k][l] = RESCALE_BF(int11_37[i][j][k][l],
-                                                int11_dH[i][j][k][l],
-                                                TT,
-                                                kT);
-        }
-
-  /* interior 2x1 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m;
-          for (m = 0; m < 5; m++) {
-            pf->expint21[i][j][k][l][m] = RESCALE_BF(int21_37[i][j][k][l][m],
-                                                     int21_dH[i][j][k][l][m],
-                                                     TT,
-                                                     kT);
-          }
-        }
-
-  /* interior 2x2 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m, n;
-          for (m = 0; m < 5; m++)
-            for (n = 0; n < 5; n++) {
-              pf->expint22[i][j][k][l][m][n] = RESCALE_BF(int22_37[i][j][k][l][m][n],
-                                                          int22_dH[i][j][k][l][m][n],
-                                                          TT,
-                                                          kT);
-            }
-        }
+  /* interior 1x1, 2x1, and 2x2 loops */
+  rescale_BF_table(&(pf->expint11[0][0][0][0]),
+                   &(int11_37[0][0][0][0]),
+                   &(int11_dH[0][0][0][0]),
+                   sizeof(pf->expint11) / sizeof(double),
+                   TT,
+                   kT,
+                   pf_smooth);
+
+  rescale_BF_table(&(pf->expint21[0][0][0][0][0]),
+                   &(int21_37[0][0][0][0][0]),
+                   &(int21_dH[0][0][0][0][0]),
+                   sizeof(pf->expint21) / sizeof(double),
+                   TT,
+                   kT,
+                   pf_smooth);
+
+  rescale_BF_table(&(pf->expint22[0][0][0][0][0][0]),
+                   &(int22_37[0][0][0][0][0][0]),
+                   &(int22_dH[0][0][0][0][0][0]),
+                   sizeof(pf->expint22) / sizeof(double),
+                   TT,
+                   kT,
+                   pf_smooth);
 
   strncpy(pf->Tetraloops, Tetraloops, 281);
   strncpy(pf->Triloops, Triloops, 241);
   strncpy(pf->Hexaloops, Hexaloops, 361);
-
-  return pf;
 }
 
 
-PRIVATE vrna_exp_param_t *
-get_exp_params_ali(vrna_md_t    *md,
-                   unsigned int n_seq,
-                   double       pfs)
+PRIVATE void
+compute_exp_params_ali(vrna_exp_param_t *pf,
+                       vrna_md_t        *md,
+                       unsigned int     n_seq,
+                       double           pfs)
 {
   /* scale energy parameters and pre-calculate Boltzmann weights */
-  unsigned int      i, j, k, l;
-  int               pf_smooth;
-  double            kTn, TT;
-  double            GT;
-  vrna_exp_param_t  *pf;
+  unsigned int  i, j, k;
+  int           pf_smooth;
+  double        kTn, TT;
+  double        GT;
 
-  pf                = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
   pf->model_details = *md;
   pf->alpha         = md->betaScale;
   pf->temperature   = md->temperature;
@@ -838,13 +1062,13 @@ get_exp_params_ali(vrna_md_t    *md,
     }
 
   /* stacking energies */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++) {
-      pf->expstack[i][j] = RESCALE_BF(stack37[i][j],
-                                      stackdH[i][j],
-                                      TT,
-                                      kTn);
-    }
+  rescale_BF_table(&(pf->expstack[0][0]),
+                   &(stack37[0][0]),
+                   &(stackdH[0][0]),
+                   sizeof(pf->expstack) / sizeof(double),
+                   TT,
+                   kTn,
+                   pf_smooth);
 
   /* mismatch energies */
   for (i = 0; i <= NBPAIRS; i++)
@@ -881,51 +1105,104 @@ get_exp_params_ali(vrna_md_t    *md,
         }
       }
 
-  /* interior lops of length 2 */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          pf->expint11[i][j][k][l] = RESCALE_BF(int11_37[i][j][k][l],
-                                                int11_dH[i][j][k][l],
-                                                TT,
-                                                kTn);
-        }
-
-  /* interior 2x1 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m;
-          for (m = 0; m < 5; m++) {
-            pf->expint21[i][j][k][l][m] = RESCALE_BF(int21_37[i][j][k][l][m],
-                                                     int21_dH[i][j][k][l][m],
-                                                     TT,
-                                                     kTn);
-          }
-        }
-
-  /* interior 2x2 loops */
-  for (i = 0; i <= NBPAIRS; i++)
-    for (j = 0; j <= NBPAIRS; j++)
-      for (k = 0; k < 5; k++)
-        for (l = 0; l < 5; l++) {
-          int m, n;
-          for (m = 0; m < 5; m++)
-            for (n = 0; n < 5; n++) {
-              pf->expint22[i][j][k][l][m][n] = RESCALE_BF(int22_37[i][j][k][l][m][n],
-                                                          int22_dH[i][j][k][l][m][n],
-                                                          TT,
-                                                          kTn);
-            }
-        }
+  /* interior 1x1, 2x1, and 2x2 loops */
+  rescale_BF_table(&(pf->expint11[0][0][0][0]),
+                   &(int11_37[0][0][0][0]),
+                   &(int11_dH[0][0][0][0]),
+                   sizeof(pf->expint11) / sizeof(double),
+                   TT,
+                   kTn,
+                   pf_smooth);
+
+  rescale_BF_table(&(pf->expint21[0][0][0][0][0]),
+                   &(int21_37[0][0][0][0][0]),
+                   &(int21_dH[0][0][0][0][0]),
+                   sizeof(pf->expint21) / sizeof(double),
+                   TT,
+                   kTn,
+                   pf_smooth);
+
+  rescale_BF_table(&(pf->expint22[0][0][0][0][0][0]),
+                   &(int22_37[0][0][0][0][0][0]),
+                   &(int22_dH[0][0][0][0][0][0]),
+                   sizeof(pf->expint22) / sizeof(double),
+                   TT,
+                   kTn,
+                   pf_smooth);
 
   strncpy(pf->Tetraloops, Tetraloops, 281);
   strncpy(pf->Triloops, Triloops, 241);
   strncpy(pf->Hexaloops, Hexaloops, 361);
+}
 
-  return pf;
+
+/*
+ *  Rescale a contiguous table of free energies. The loop has no data
+ *  dependencies, so it may be vectorized by the compiler
+ */
+PRIVATE INLINE void
+rescale_dG_table(int        *table,
+                 const int  *dG,
+                 const int  *dH,
+                 size_t     size,
+                 double     tempf)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    table[i] = RESCALE_dG(dG[i], dH[i], tempf);
+}
+
+
+/*
+ *  Convert a contiguous table of free energies into Boltzmann factors. Large
+ *  tables, such as the interior loop energies, consist of comparatively few
+ *  distinct pairs of free energy and enthalpy. We therefore memoize recently
+ *  computed Boltzmann factors in a small, direct-mapped table to save most of
+ *  the calls to exp(). Since equal input yields equal output, the results are
+ *  the same as without memoization. Slots are initialized with the pair
+ *  (INF, INF), whose Boltzmann factor underflows to 0 at any temperature.
+ */
+PRIVATE INLINE void
+rescale_BF_table(double     *table,
+                 const int  *dG,
+                 const int  *dH,
+                 size_t     size,
+                 double     TT,
+                 double     kT,
+                 int        pf_smooth)
+{
+  size_t        i;
+  unsigned int  slot;
+  struct {
+    int     dG;
+    int     dH;
+    double  bf;
+  }             *memo;
+
+  memo = vrna_alloc(sizeof(*memo) * BF_MEMO_SIZE);
+
+  for (slot = 0; slot < BF_MEMO_SIZE; slot++) {
+    memo[slot].dG = INF;
+    memo[slot].dH = INF;
+    memo[slot].bf = 0.;
+  }
+
+  for (i = 0; i < size; i++) {
+    slot = ((unsigned int)dG[i] * 2654435761U + (unsigned int)dH[i] * 2246822519U) >>
+           (32 - BF_MEMO_BITS);
+
+    if ((memo[slot].dG != dG[i]) ||
+        (memo[slot].dH != dH[i])) {
+      memo[slot].dG = dG[i];
+      memo[slot].dH = dH[i];
+      memo[slot].bf = RESCALE_BF(dG[i], dH[i], TT, kT);
+    }
+
+    table[i] = memo[slot].bf;
+  }
+
+  free(memo);
 }
 
 
@@ -949,6 +1226,149 @@ rescale_params(vrna_fold_compound_t *vc)
 }
 
 
+#if VRNA_WITH_PTHREADS
+
+PRIVATE INLINE int
+params_cache_match(struct params_cache_entry  *entry,
+                   unsigned int               type,
+                   vrna_md_t                  *md,
+                   unsigned int               n_seq)
+{
+  return (entry->data) &&
+         (!entry->stale) &&
+         (entry->type == type) &&
+         (entry->n_seq == n_seq) &&
+         (entry->temperature == md->temperature) &&
+         (entry->betaScale == md->betaScale) &&
+         (entry->dangles == md->dangles) &&
+         (entry->pf_smooth == md->pf_smooth);
+}
+
+
+/* return a private copy of a cached parameter set, or NULL if not present */
+PRIVATE void *
+params_cache_fetch(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq)
+{
+  unsigned int              i;
+  void                      *copy;
+  struct params_cache_entry *entry;
+
+  copy  = NULL;
+  entry = NULL;
+
+  pthread_mutex_lock(&params_cache_mtx);
+
+  for (i = 0; i < PARAMS_CACHE_SIZE; i++)
+    if (params_cache_match(&(params_cache[i]), type, md, n_seq)) {
+      entry           = &(params_cache[i]);
+      entry->last_use = ++params_cache_clock;
+      entry->refs++;
+      break;
+    }
+
+  pthread_mutex_unlock(&params_cache_mtx);
+
+  if (entry) {
+    copy = vrna_alloc(entry->size);
+    memcpy(copy, entry->data, entry->size);
+
+    pthread_mutex_lock(&params_cache_mtx);
+
+    if ((--entry->refs == 0) && (entry->stale)) {
+      free(entry->data);
+      entry->data   = NULL;
+      entry->stale  = 0;
+    }
+
+    pthread_mutex_unlock(&params_cache_mtx);
+  }
+
+  return copy;
+}
+
+
+/* store a read-only copy of a parameter set, replacing the least recently used entry */
+PRIVATE void
+params_cache_store(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq,
+                   const void   *data,
+                   size_t       size)
+{
+  unsigned int              i;
+  void                      *copy;
+  struct params_cache_entry *entry;
+
+  copy = vrna_alloc(size);
+  memcpy(copy, data, size);
+
+  entry = NULL;
+
+  pthread_mutex_lock(&params_cache_mtx);
+
+  for (i = 0; i < PARAMS_CACHE_SIZE; i++) {
+    /* another thread might have been faster */
+    if (params_cache_match(&(params_cache[i]), type, md, n_seq)) {
+      entry = NULL;
+      break;
+    }
+
+    if ((params_cache[i].refs > 0) || (params_cache[i].stale))
+      continue;
+
+    if ((!entry) ||
+        (!params_cache[i].data) ||
+        ((entry->data) && (params_cache[i].last_use < entry->last_use)))
+      entry = &(params_cache[i]);
+  }
+
+  if (entry) {
+    free(entry->data);
+    entry->type         = type;
+    entry->temperature  = md->temperature;
+    entry->betaScale    = md->betaScale;
+    entry->dangles      = md->dangles;
+    entry->pf_smooth    = md->pf_smooth;
+    entry->n_seq        = n_seq;
+    entry->data         = copy;
+    entry->size         = size;
+    entry->last_use     = ++params_cache_clock;
+    copy                = NULL;
+  }
+
+  pthread_mutex_unlock(&params_cache_mtx);
+
+  free(copy);
+}
+
+
+#else
+
+PRIVATE void *
+params_cache_fetch(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq)
+{
+  return NULL;
+}
+
+
+PRIVATE void
+params_cache_store(unsigned int type,
+                   vrna_md_t    *md,
+                   unsigned int n_seq,
+                   const void   *data,
+                   size_t       size)
+{
+  return;
+}
+
+
+#endif
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /*
@@ -19,6 +19,7 @@
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
+#include "ViennaRNA/eval.h"
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/gquad.h"
 #include "ViennaRNA/constraints/hard.h"
@@ -30,6 +31,15 @@
 #include <omp.h>
 #endif
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#define WAVEFRONT_TILE_SIZE 64      /* edge length of tiles processed by a single thread in parallel fill */
+#define PF_SCALE_ATTEMPTS   10      /* maximum number of fallback pf_scale adjustments */
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -48,9 +58,41 @@
  #################################
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays(vrna_fold_compound_t  *fc,
+            int                   *ov_span);
+
+
+PRIVATE int
+fill_arrays_autoscale(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+adjust_pf_scale(vrna_fold_compound_t  *fc,
+                double                log_q,
+                int                   span);
+
+
+PRIVATE int
+adjust_pf_scale_underflow(vrna_fold_compound_t  *fc,
+                          FLT_OR_DBL            Q);
+
+
+#ifdef _OPENMP
+
+PRIVATE int
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   threads,
+                      vrna_mx_pf_aux_el_t   aux_mx_el,
+                      vrna_mx_pf_aux_ml_t   aux_mx_ml,
+                      int                   *ov_span);
 
 
+PRIVATE INLINE int
+wavefront_compatible(vrna_fold_compound_t *fc);
+
+
+#endif
+
 PRIVATE void
 postprocess_circular(vrna_fold_compound_t *fc);
 
@@ -71,7 +113,7 @@ PUBLIC float
 vrna_pf(vrna_fold_compound_t  *fc,
         char                  *structure)
 {
-  int               n;
+  int               n, attempt;
   FLT_OR_DBL        Q;
   double            free_energy;
   vrna_md_t         *md;
@@ -111,33 +153,69 @@ vrna_pf(vrna_fold_compound_t  *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
 
-    if (!fill_arrays(fc)) {
+    /*
+     *  Fill the DP matrices and compute the pair probabilities. Whenever
+     *  the scaling factor pf_scale turns out to be inappropriate, i.e.
+     *  the partition function under-, or the outside recursions overflow,
+     *  we fall back to adjusting pf_scale to the observed ensemble free
+     *  energy and start over. Every such attempt repeats the entire
+     *  computation, so a suitable pf_scale, e.g. from vrna_exp_params_rescale(),
+     *  should still be provided by the caller
+     */
+    for (attempt = 0; ; attempt++) {
+      if (!fill_arrays_autoscale(fc)) {
 #ifdef SUN4
-      standard_arithmetic();
+        standard_arithmetic();
 #elif defined(HP9)
-      fpsetfastmode(0);
+        fpsetfastmode(0);
 #endif
-      return (float)(INF / 100.);
-    }
+        return (float)(INF / 100.);
+      }
 
-    if (md->circ)
-      /* do post processing step for circular RNAs */
-      postprocess_circular(fc);
+      if (md->circ)
+        /* do post processing step for circular RNAs */
+        postprocess_circular(fc);
 
-    /* calculate base pairing probability matrix (bppm)  */
-    if (md->compute_bpp) {
-      vrna_pairing_probs(fc, structure);
+      switch (md->backtrack_type) {
+        case 'C':
+          Q = matrices->qb[fc->iindx[1] - n];
+          break;
+
+        case 'M':
+          Q = matrices->qm[fc->iindx[1] - n];
+          break;
+
+        default:
+          Q = (md->circ) ? matrices->qo : matrices->q[fc->iindx[1] - n];
+          break;
+      }
+
+      if ((Q <= FLT_MIN) &&
+          (attempt < PF_SCALE_ATTEMPTS) &&
+          (adjust_pf_scale_underflow(fc, Q)))
+        continue;
+
+      /* calculate base pairing probability matrix (bppm)  */
+      if (md->compute_bpp) {
+        if ((!vrna_pairing_probs(fc, structure)) &&
+            (attempt < PF_SCALE_ATTEMPTS) &&
+            (Q > 0.) &&
+            (adjust_pf_scale(fc, log(Q), n)))
+          continue;
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
-      /*
-       *  Backward compatibility:
-       *  This block may be removed if deprecated functions
-       *  relying on the global variable "pr" vanish from within the package!
-       */
-      pr = matrices->probs;
+        /*
+         *  Backward compatibility:
+         *  This block may be removed if deprecated functions
+         *  relying on the global variable "pr" vanish from within the package!
+         */
+        pr = matrices->probs;
 
 #endif
+      }
+
+      break;
     }
 
     /* call user-defined recursion status callback function */
@@ -148,20 +226,6 @@ vrna_pf(vrna_fold_compound_t  *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_POST, fc->aux_grammar->data);
 
-    switch (md->backtrack_type) {
-      case 'C':
-        Q = matrices->qb[fc->iindx[1] - n];
-        break;
-
-      case 'M':
-        Q = matrices->qm[fc->iindx[1] - n];
-        break;
-
-      default:
-        Q = (md->circ) ? matrices->qo : matrices->q[fc->iindx[1] - n];
-        break;
-    }
-
     /* ensemble free energy in Kcal/mol              */
     if (Q <= FLT_MIN)
       vrna_message_warning("pf_scale too large");
@@ -189,7 +253,7 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
               char                  *structure)
 {
   unsigned int      *so, *se, *ss;
-  int               n;
+  int               n, attempt;
   FLT_OR_DBL        Q;
   vrna_dimer_pf_t   X;
   double            free_energy;
@@ -231,30 +295,60 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
 
-  if (!fill_arrays(fc)) {
-    X.FA    = X.FB = X.FAB = X.F0AB = (float)(INF / 100.);
-    X.FcAB  = 0;
+  /* same automatic pf_scale adjustment as in vrna_pf() */
+  for (attempt = 0; ; attempt++) {
+    if (!fill_arrays_autoscale(fc)) {
+      X.FA    = X.FB = X.FAB = X.F0AB = (float)(INF / 100.);
+      X.FcAB  = 0;
 
 #ifdef SUN4
-    standard_arithmetic();
+      standard_arithmetic();
 #elif defined(HP9)
-    fpsetfastmode(0);
+      fpsetfastmode(0);
 #endif
 
-    return X;
+      return X;
+    }
+
+    if (md->backtrack_type == 'C')
+      Q = matrices->qb[fc->iindx[1] - n];
+    else if (md->backtrack_type == 'M')
+      Q = matrices->qm[fc->iindx[1] - n];
+    else
+      Q = matrices->q[fc->iindx[1] - n];
+
+    if ((Q <= FLT_MIN) &&
+        (attempt < PF_SCALE_ATTEMPTS) &&
+        (adjust_pf_scale_underflow(fc, Q)))
+      continue;
+
+    /* backtracking to construct binding probabilities of pairs */
+    if (md->compute_bpp) {
+      if ((!vrna_pairing_probs(fc, structure)) &&
+          (attempt < PF_SCALE_ATTEMPTS) &&
+          (Q > 0.) &&
+          (adjust_pf_scale(fc, log(Q), n)))
+        continue;
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+      /*
+       *  Backward compatibility:
+       *  This block may be removed if deprecated functions
+       *  relying on the global variable "pr" vanish from within the package!
+       */
+      pr = fc->exp_matrices->probs;
+
+#endif
+    }
+
+    break;
   }
 
   /* call user-defined recursion status callback function */
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
 
-  if (md->backtrack_type == 'C')
-    Q = matrices->qb[fc->iindx[1] - n];
-  else if (md->backtrack_type == 'M')
-    Q = matrices->qm[fc->iindx[1] - n];
-  else
-    Q = matrices->q[fc->iindx[1] - n];
-
   /* ensemble free energy in Kcal/mol */
   if (Q <= FLT_MIN)
     vrna_message_warning("pf_scale too large");
@@ -300,22 +394,6 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
     X.FcAB  = 0;
   }
 
-  /* backtracking to construct binding probabilities of pairs */
-  if (md->compute_bpp) {
-    vrna_pairing_probs(fc, structure);
-
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-
-    /*
-     *  Backward compatibility:
-     *  This block may be removed if deprecated functions
-     *  relying on the global variable "pr" vanish from within the package!
-     */
-    pr = fc->exp_matrices->probs;
-
-#endif
-  }
-
 #ifdef SUN4
   standard_arithmetic();
 #elif defined(HP9)
@@ -339,11 +417,123 @@ vrna_pf_float_precision(void)
  #################################
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays_autoscale(vrna_fold_compound_t *fc)
+{
+  int     attempt, ov_span;
+  double  max_real;
+
+  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+
+  for (attempt = 0; attempt <= PF_SCALE_ATTEMPTS; attempt++) {
+    if (fill_arrays(fc, &ov_span))
+      return 1;
+
+    /*
+     *  A segment of length ov_span exceeded max_real, so its Boltzmann
+     *  factor per nucleotide is at least max_real^(1 / ov_span). Adjust
+     *  pf_scale such that this segment would be scaled down to 1
+     */
+    if (!adjust_pf_scale(fc, log(max_real), ov_span))
+      break;
+  }
+
+  vrna_message_warning("overflow while computing partition function, "
+                       "failed to find an appropriate pf_scale (last: %g)",
+                       fc->exp_params->pf_scale);
+
+  return 0; /* failure */
+}
+
+
+/*
+ *  Multiply pf_scale by exp(log_q / span), i.e. adjust the scaling
+ *  factor such that a (scaled) partition function log_q of a segment
+ *  of length span would become 1, and update the scaling arrays.
+ *  Ensembles with positive free energy, e.g. due to enforced base
+ *  pairs, require pf_scale < 1. Returns 0 if pf_scale could not be
+ *  changed
+ */
+PRIVATE int
+adjust_pf_scale(vrna_fold_compound_t  *fc,
+                double                log_q,
+                int                   span)
+{
+  int               i;
+  double            pf_scale;
+  vrna_exp_param_t  *pf;
+  vrna_mx_pf_t      *m;
+
+  pf  = fc->exp_params;
+  m   = fc->exp_matrices;
+
+  if ((span < 1) || (!(log_q > -DBL_MAX)) || (!(log_q < DBL_MAX)))
+    return 0;
+
+  pf_scale = exp(log(pf->pf_scale) + log_q / span);
+
+  if ((!(pf_scale > 0.)) ||
+      (!(pf_scale < DBL_MAX)) ||
+      (fabs(pf_scale - pf->pf_scale) <= 1e-6 * pf->pf_scale))
+    return 0;
+
+  pf->pf_scale = pf_scale;
+
+  /* same scaling as in vrna_exp_params_rescale() */
+  m->scale[0]     = 1.;
+  m->scale[1]     = (FLT_OR_DBL)(1. / pf->pf_scale);
+  m->expMLbase[0] = 1;
+  m->expMLbase[1] = (FLT_OR_DBL)(pf->expMLbase / pf->pf_scale);
+  for (i = 2; i <= (int)fc->length; i++) {
+    m->scale[i]     = m->scale[i / 2] * m->scale[i - (i / 2)];
+    m->expMLbase[i] = (FLT_OR_DBL)pow(pf->expMLbase, (double)i) * m->scale[i];
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Adjust pf_scale after the partition function Q of the entire
+ *  sequence underflowed. If Q is still representable, we simply
+ *  re-center pf_scale at Q^(1/n). Otherwise, the longest prefix
+ *  1..j with non-zero partition function serves as estimate. If
+ *  even that fails, we fall back to the unscaled partition function.
+ *  Returns 0 if pf_scale could not be changed
+ */
+PRIVATE int
+adjust_pf_scale_underflow(vrna_fold_compound_t  *fc,
+                          FLT_OR_DBL            Q)
+{
+  int           n, j;
+  FLT_OR_DBL    q_ens;
+  vrna_mx_pf_t  *m;
+
+  n = (int)fc->length;
+  m = fc->exp_matrices;
+
+  if (Q > 0.)
+    return adjust_pf_scale(fc, log(Q), n);
+
+  /* Q may legitimately be 0, e.g. for backtrack_type 'C' if (1, n) can not pair */
+  q_ens = (fc->exp_params->model_details.circ) ? m->qo : m->q[fc->iindx[1] - n];
+  if (q_ens > FLT_MIN)
+    return 0;
+
+  for (j = n; j > 0; j--)
+    if (m->q[fc->iindx[1] - j] > 0.)
+      return adjust_pf_scale(fc, log(m->q[fc->iindx[1] - j]), j);
+
+  return adjust_pf_scale(fc, -log(fc->exp_params->pf_scale), 1);
+}
+
+
+PRIVATE int
+fill_arrays(vrna_fold_compound_t  *fc,
+            int                   *ov_span)
 {
   int                 n, i, j, k, ij, d, *my_iindx, *jindx, with_gquad, turn,
-                      with_ud;
-  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *q1k, *qln;
+                      with_ud, wavefront;
+  FLT_OR_DBL          temp, *q, *qb, *qm, *qm1, *q1k, *qln;
   double              max_real;
   vrna_ud_t           *domains_up;
   vrna_md_t           *md;
@@ -369,9 +559,9 @@ fill_arrays(vrna_fold_compound_t *fc)
   turn        = md->min_loop_size;
 
   with_ud = (domains_up && domains_up->exp_energy_cb && (!(fc->type == VRNA_FC_TYPE_COMPARATIVE)));
-  Qmax    = 0;
 
   max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  *ov_span  = 0;
 
   if (with_ud && domains_up->exp_prod_cb)
     domains_up->exp_prod_cb(fc, domains_up->data);
@@ -400,9 +590,20 @@ fill_arrays(vrna_fold_compound_t *fc)
     }
   }
 
+  wavefront = 0;
+
+#ifdef _OPENMP
+  wavefront = ((md->threads > 1) && (wavefront_compatible(fc))) ? 1 : 0;
+#endif
+
   /* init auxiliary arrays for fast exterior/multibranch loops */
-  aux_mx_el = vrna_exp_E_ext_fast_init(fc);
-  aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+  if (wavefront) {
+    aux_mx_el = vrna_exp_E_ext_fast_init_wavefront(fc);
+    aux_mx_ml = vrna_exp_E_ml_fast_init_wavefront(fc);
+  } else {
+    aux_mx_el = vrna_exp_E_ext_fast_init(fc);
+    aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+  }
 
   /*array initialization ; qb,qm,q
    * qb,qm,q (i,j) are stored as ((n+1-i)*(n-i) div 2 + n+1-j */
@@ -413,52 +614,57 @@ fill_arrays(vrna_fold_compound_t *fc)
       qb[ij]  = 0.0;
     }
 
-  for (j = turn + 2; j <= n; j++) {
-    for (i = j - turn - 1; i >= 1; i--) {
-      ij = my_iindx[i] - j;
+  if (wavefront) {
+#ifdef _OPENMP
+    if (!fill_arrays_wavefront(fc, md->threads, aux_mx_el, aux_mx_ml, ov_span)) {
+      vrna_exp_E_ml_fast_free(aux_mx_ml);
+      vrna_exp_E_ext_fast_free(aux_mx_el);
 
-      qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+      return 0; /* failure */
+    }
 
-      /* Multibranch loop */
-      qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+#endif
+  } else {
+    for (j = turn + 2; j <= n; j++) {
+      for (i = j - turn - 1; i >= 1; i--) {
+        ij = my_iindx[i] - j;
 
-      if (qm1) {
-        temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
+        qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
 
-        /* apply auxiliary grammar rule for multibranch loop (M1) case */
-        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
-          temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
+        /* Multibranch loop */
+        qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
 
-        qm1[jindx[j] + i] = temp;
-      }
+        if (qm1) {
+          temp = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i]; /* for stochastic backtracking and circfold */
 
-      /* Exterior loop */
-      q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+          /* apply auxiliary grammar rule for multibranch loop (M1) case */
+          if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp_m1))
+            temp += fc->aux_grammar->cb_aux_exp_m1(fc, i, j, fc->aux_grammar->data);
 
-      /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
-      if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
-        fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
+          qm1[jindx[j] + i] = temp;
+        }
 
-      if (q[ij] > Qmax) {
-        Qmax = q[ij];
-        if (Qmax > max_real / 10.)
-          vrna_message_warning("Q close to overflow: %d %d %g", i, j, q[ij]);
-      }
+        /* Exterior loop */
+        q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+        /* apply auxiliary grammar rule (storage takes place in user-defined data structure */
+        if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
+          fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
 
-      if (q[ij] >= max_real) {
-        vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
-                             "use larger pf_scale", i, j);
+        if (q[ij] >= max_real) {
+          *ov_span = j - i + 1;
 
-        vrna_exp_E_ml_fast_free(aux_mx_ml);
-        vrna_exp_E_ext_fast_free(aux_mx_el);
+          vrna_exp_E_ml_fast_free(aux_mx_ml);
+          vrna_exp_E_ext_fast_free(aux_mx_el);
 
-        return 0; /* failure */
+          return 0; /* failure */
+        }
       }
-    }
 
-    /* rotate auxiliary arrays */
-    vrna_exp_E_ext_fast_rotate(aux_mx_el);
-    vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+      /* rotate auxiliary arrays */
+      vrna_exp_E_ext_fast_rotate(aux_mx_el);
+      vrna_exp_E_ml_fast_rotate(aux_mx_ml);
+    }
   }
 
   /* prefill linear qln, q1k arrays */
@@ -479,6 +685,133 @@ fill_arrays(vrna_fold_compound_t *fc)
 }
 
 
+#ifdef _OPENMP
+
+/*
+ *  Parallel fill of the (inside) partition function matrices. Just like
+ *  for the MFE, we process square tiles of the matrices along the
+ *  anti-diagonals. Cells within a tile are filled in the same order as
+ *  in the serial implementation, and each cell is computed by a single
+ *  thread using the very same sequence of floating point operations.
+ *  Thus, the results are identical to the serial fill, independent of
+ *  the number of threads. Instead of rotating the auxiliary arrays, we
+ *  keep one of them per column j.
+ */
+PRIVATE int
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   threads,
+                      vrna_mx_pf_aux_el_t   aux_mx_el,
+                      vrna_mx_pf_aux_ml_t   aux_mx_ml,
+                      int                   *ov_span)
+{
+  int         n, i, j, ij, turn, *my_iindx, *jindx, tiles, d, t, i_start, i_stop,
+              j_start, j_stop, overflow;
+  FLT_OR_DBL  *q, *qb, *qm, *qm1;
+  double      max_real;
+
+  n           = (int)fc->length;
+  my_iindx    = fc->iindx;
+  jindx       = fc->jindx;
+  turn        = fc->exp_params->model_details.min_loop_size;
+  q           = fc->exp_matrices->q;
+  qb          = fc->exp_matrices->qb;
+  qm          = fc->exp_matrices->qm;
+  qm1         = fc->exp_matrices->qm1;
+  tiles       = (n + WAVEFRONT_TILE_SIZE - 1) / WAVEFRONT_TILE_SIZE;
+  max_real    = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  overflow    = 0;
+
+  /* do not oversubscribe the available processors */
+  if (threads > omp_get_num_procs())
+    threads = omp_get_num_procs();
+
+#pragma omp parallel num_threads(threads) \
+  private(d, t, i, j, ij, i_start, i_stop, j_start, j_stop)
+  {
+    for (d = 0; d < tiles; d++) {
+      /* all tiles (t, t + d) on the d-th anti-diagonal of tiles are independent */
+#pragma omp for schedule(dynamic, 1)
+      for (t = 0; t < tiles - d; t++) {
+        i_start = t * WAVEFRONT_TILE_SIZE + 1;
+        i_stop  = MIN2(i_start + WAVEFRONT_TILE_SIZE - 1, n);
+        j_start = (t + d) * WAVEFRONT_TILE_SIZE + 1;
+        j_stop  = MIN2(j_start + WAVEFRONT_TILE_SIZE - 1, n);
+
+        for (j = MAX2(j_start, turn + 2); j <= j_stop; j++) {
+          for (i = MIN2(i_stop, j - turn - 1); i >= i_start; i--) {
+            ij = my_iindx[i] - j;
+
+            qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+
+            /* Multibranch loop */
+            qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+
+            if (qm1)
+              qm1[jindx[j] + i] = vrna_exp_E_ml_fast_qqm_column(aux_mx_ml, j)[i];
+
+            /* Exterior loop */
+            q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+            if (q[ij] >= max_real) {
+#pragma omp critical (pf_wavefront_overflow)
+              {
+                if (j - i + 1 > overflow)
+                  overflow = j - i + 1;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (overflow) {
+    *ov_span = overflow;
+    return 0; /* failure */
+  }
+
+  return 1;
+}
+
+
+/*
+ *  The parallel fill may only be used if we do not need to call any
+ *  user-defined callback, since we can not guarantee that those are
+ *  thread-safe, or require a particular order of evaluation.
+ */
+PRIVATE INLINE int
+wavefront_compatible(vrna_fold_compound_t *fc)
+{
+  unsigned int s;
+
+  if ((fc->hc->f) ||
+      (fc->aux_grammar) ||
+      (fc->domains_up))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      if ((fc->sc) && (fc->sc->exp_f))
+        return 0;
+
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      if (fc->scs)
+        for (s = 0; s < fc->n_seq; s++)
+          if ((fc->scs[s]) && (fc->scs[s]->exp_f))
+            return 0;
+
+      break;
+  }
+
+  return 1;
+}
+
+
+#endif
+
+
 PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
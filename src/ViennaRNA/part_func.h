@@ -127,6 +127,25 @@ struct vrna_dimer_pf_s {
  *        or numerical over-/underflow. In the latter case, a corresponding warning
  *        will be issued to @p stdout.
  *
+ *  @note As a fallback for inappropriate scaling factors, i.e. whenever the Boltzmann
+ *        factors of (sub-)segments over- or underflow, or the base pair probabilities
+ *        overflow, the scaling factor #vrna_exp_param_t.pf_scale is adjusted to the
+ *        observed ensemble free energy, and all computations are repeated (at most
+ *        10 times). Every adjustment costs another complete computation, so a suitable
+ *        @p pf_scale, e.g. from vrna_exp_params_rescale(), should still be provided.
+ *        The final scaling factor is available in @p vc->exp_params->pf_scale and
+ *        applies to subsequent calls of, e.g. vrna_pbacktrack().
+ *
+ *  @note If #vrna_md_t.threads is larger than 1 and the library was compiled with
+ *        OpenMP support, the partition function matrices are filled in parallel
+ *        along anti-diagonals, and the base pair probabilities of single sequences
+ *        are computed in parallel for each column of the outside recursions. Every
+ *        matrix entry is still summed up by a single thread in the same order as in
+ *        the serial implementation, so the results are bit-identical to the serial
+ *        computation and do not depend on the number of threads. The parallel mode
+ *        is not applied if user-defined hard/soft constraint callbacks, unstructured
+ *        domains, or auxiliary grammar extensions are present.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_pf_fold(), vrna_pf_circfold(),
  *        vrna_fold_compound_comparative(), vrna_pf_alifold(), vrna_pf_circalifold(),
  *        vrna_db_from_probs(), vrna_exp_params(), vrna_aln_pinfo()
@@ -152,6 +171,10 @@ vrna_pf(vrna_fold_compound_t  *vc,
  *        or numerical over-/underflow. In the latter case, a corresponding warning
  *        will be issued to @p stdout.
  *
+ *  @note Just like vrna_pf(), this function falls back to adjusting the scaling factor
+ *        #vrna_exp_param_t.pf_scale and repeating all computations upon numeric over- or
+ *        underflow of the partition functions or the base pair probabilities.
+ *
  *  @see    vrna_fold_compound() for how to retrieve the necessary data structure
  *
  *  @param  vc        the fold compound data structure
@@ -195,6 +195,13 @@ typedef void (vrna_probs_window_callback)(FLT_OR_DBL    *pr,
  *
  *  Options may be OR-ed together
  *
+ *  If the model details of @p fc request more than one thread (#vrna_md_t.threads) and
+ *  the sequence is much longer than the window size, the sequence is split into overlapping
+ *  blocks that are folded independently and in parallel. The callback @p cb is still executed
+ *  by one thread at a time, with exactly the same data and in the same order as in the serial
+ *  implementation. Fold compounds with soft constraints, user-defined hard constraints or
+ *  callbacks, and requests for #VRNA_PROBS_WINDOW_STACKP always use the serial implementation.
+ *
  *  @see  vrna_pfl_fold_cb(), vrna_pfl_fold_up_cb()
  *
  *  @param  fc            The fold compound with sequence data, model settings and precomputed energy parameters
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <string.h>
@@ -21,7 +22,7 @@
 #include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
-#include "ViennaRNA/datastructures/lists.h"
+#include "ViennaRNA/datastructures/heap.h"
 #include "ViennaRNA/eval.h"
 #include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/loops/all.h"
@@ -44,36 +45,129 @@
 #define ON_SAME_STRAND(I, J, C)  (((I) >= (C)) || ((J) < (C)))
 #endif
 
+/* number of nodes per slab of a node pool */
+#define POOL_SLAB_SIZE        4096
+
 /**
  *  @brief  Sequence interval stack element used in subopt.c
+ *
+ *  Interval stacks are persistent, i.e. states derived from each other share
+ *  their common tail, and a node is released once no state refers to it anymore
  */
 typedef struct INTERVAL {
-  int i;
-  int j;
-  int array_flag;
+  int             i;
+  int             j;
+  int             array_flag;
+  unsigned int    refs;       /* number of references to this node */
+  struct INTERVAL *next;      /* next interval on the stack */
 } INTERVAL;
 
-typedef struct {
-  char  *structure;
-  LIST  *Intervals;
-  int   partial_energy;
-  int   is_duplex;
-  /* int best_energy;   */ /* best attainable energy */
+/**
+ *  @brief  Element of a partial structure, i.e. a base pair (i,j), or a
+ *          run of -j consecutive G-quadruplex nucleotides starting at i
+ *
+ *  Similar to the interval stacks, these lists are shared among derived states
+ */
+typedef struct ELEMENT {
+  int             i;
+  int             j;
+  unsigned int    refs;
+  struct ELEMENT  *next;
+} ELEMENT;
+
+typedef struct STATE {
+  INTERVAL      *Intervals;       /* intervals that remain to be backtracked */
+  ELEMENT       *Elements;        /* structure elements backtracked so far */
+  int           partial_energy;
+  int           is_duplex;
+  int           best_energy;      /* best attainable energy */
+  struct STATE  *next;            /* next state on the stack */
 } STATE;
 
+/* fixed size node allocator with slab-wise memory management */
+typedef struct {
+  size_t  size;         /* size of a single node in bytes */
+  void    *released;    /* list of released nodes available for re-use */
+  char    *next;        /* next unused node of the current slab */
+  char    *end;         /* end of the current slab */
+  char    **slabs;
+  size_t  num_slabs;
+  size_t  used;         /* number of nodes currently in use */
+} node_pool;
+
 typedef struct {
-  LIST  *Intervals;
-  LIST  *Stack;
-  int   nopush;
+  STATE                 *Stack;
+  unsigned int          stack_size;
+  vrna_heap_t           Heap;       /* best-first queue for sorted enumeration, or NULL */
+  vrna_fold_compound_t  *fc;
+  int                   lower;      /* structures up to this energy have been reported already */
+  int                   nopush;
+  int                   stream;     /* process all states depth-first while streaming an energy level */
+  node_pool             state_pool;
+  node_pool             interval_pool;
+  node_pool             element_pool;
 } subopt_env;
 
 
+/* energy sorted buffer of solutions with identical energy (or all solutions, if required) */
+struct subopt_buffer {
+  unsigned long size;
+  unsigned long n;
+  SOLUTION      *list;
+  int           packed;     /* store structures in compressed form */
+  size_t        entry_size; /* memory of a single stored structure in bytes */
+  unsigned long max;        /* maximum number of stored structures, or 0 for no limit */
+  int           dropped;    /* structures were dropped to stay within the limit */
+  char          *bound;     /* structures from here on were dropped */
+  char          *last;      /* structures up to here were passed to the callback already */
+  int           (*compare)(const void *a,
+                           const void *b);
+};
+
+
+/* settings for the output of complete structures */
+struct subopt_output {
+  vrna_subopt_callback  *cb;
+  void                  *data;
+  struct subopt_buffer  *buffer;    /* collect structures for sorting, or NULL */
+  int                   length;
+  int                   cp;
+  int                   reeval;     /* re-evaluate free energies */
+  int                   dos;        /* count structures in the density of states */
+  double                min_en;
+  double                eprint;
+  float                 correction;
+};
+
+
+#ifdef _OPENMP
+
+/* a pending sub-tree of the enumeration handed over to another thread */
+struct subopt_task {
+  int       partial_energy;
+  int       is_duplex;
+  int       num_intervals;
+  int       num_elements;
+  INTERVAL  *intervals;             /* top of the stack first */
+  ELEMENT   *elements;
+};
+
+struct subopt_workers {
+  vrna_fold_compound_t  *fc;
+  struct subopt_output  *out;
+  int                   threshold;
+  int                   threads;
+  int                   busy;       /* number of tasks currently queued or processed */
+};
+
+#endif
+
+
 struct old_subopt_dat {
   unsigned long max_sol;
   unsigned long n_sol;
   SOLUTION      *SolutionList;
   FILE          *fp;
-  int           cp;
 };
 
 /*
@@ -122,56 +216,103 @@ wrap_subopt(char          *seq,
 #endif
 
 PRIVATE void
-make_pair(int   i,
-          int   j,
-          STATE *state);
+pool_init(node_pool *pool,
+          size_t    size);
+
+
+PRIVATE void
+pool_free(node_pool *pool);
+
+
+PRIVATE void *
+pool_get(node_pool *pool);
+
+
+PRIVATE void
+pool_put(node_pool  *pool,
+         void       *node);
+
+
+PRIVATE void
+pool_trim(node_pool *pool);
+
+
+PRIVATE size_t
+slab_index(node_pool  *pool,
+           uintptr_t  *start,
+           size_t     num,
+           void       *node);
+
+
+PRIVATE int
+compare_slab_address(const void *a,
+                     const void *b);
+
+
+PRIVATE void
+trim_pools(subopt_env *env);
+
+
+PRIVATE void
+make_pair(subopt_env  *env,
+          int         i,
+          int         j,
+          STATE       *state);
 
 
 /* mark a gquadruplex in the resulting dot-bracket structure */
 PRIVATE void
-make_gquad(int    i,
-           int    L,
-           int    l[3],
-           STATE  *state);
+make_gquad(subopt_env *env,
+           int        i,
+           int        L,
+           int        l[3],
+           STATE      *state);
 
 
-PRIVATE INTERVAL *
-make_interval(int i,
-              int j,
-              int ml);
+PRIVATE int
+is_pair(STATE *state,
+        int   i,
+        int   j);
 
 
-PRIVATE STATE *
-make_state(LIST *Intervals,
-           char *structure,
-           int  partial_energy,
-           int  is_duplex,
-           int  length);
+PRIVATE void
+push_interval(subopt_env  *env,
+              STATE       *state,
+              int         i,
+              int         j,
+              int         array_flag);
 
 
-PRIVATE STATE *
-copy_state(STATE *state);
+PRIVATE INTERVAL
+pop_interval(subopt_env *env,
+             STATE      *state);
 
 
 PRIVATE void
-print_state(STATE *state);
+release_intervals(subopt_env  *env,
+                  INTERVAL    *node);
 
 
 PRIVATE void
-UNUSED print_stack(LIST *list);
+release_elements(subopt_env *env,
+                 ELEMENT    *node);
 
 
-PRIVATE LIST *
-make_list(void);
+PRIVATE STATE *
+make_state(subopt_env *env);
+
+
+PRIVATE STATE *
+copy_state(subopt_env *env,
+           STATE      *state);
 
 
 PRIVATE void
-push(LIST *list,
-     void *data);
+print_state(STATE *state);
 
 
 PRIVATE void
-*pop(LIST *list);
+UNUSED print_stack(STATE *stack);
 
 
 PRIVATE int
@@ -190,20 +331,133 @@ scan_interval(vrna_fold_compound_t  *vc,
 
 
 PRIVATE void
-free_interval_node(INTERVAL *node);
+free_state_node(subopt_env  *env,
+                STATE       *node);
+
+
+PRIVATE void
+push_back(subopt_env  *env,
+          STATE       *state);
+
+
+PRIVATE void
+push_state(subopt_env *env,
+           STATE      *state);
+
+
+PRIVATE STATE *
+pop_state(subopt_env *env);
+
+
+PRIVATE int
+compare_state_energy(const void *a,
+                     const void *b,
+                     void       *data);
+
+
+PRIVATE void
+subopt_enumerate(vrna_fold_compound_t *fc,
+                 int                  delta,
+                 int                  sorted,
+                 size_t               max_memory,
+                 vrna_subopt_callback *cb,
+                 void                 *data);
+
+
+PRIVATE void
+push_initial_state(subopt_env *env,
+                   int        length);
+
+
+PRIVATE void
+report_structure(vrna_fold_compound_t *fc,
+                 STATE                *state,
+                 struct subopt_output *out);
+
+
+PRIVATE int
+dos_index(struct subopt_output  *out,
+          double                energy);
+
+
+#ifdef _OPENMP
+
+PRIVATE int
+parallel_compatible(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+subopt_parallel(vrna_fold_compound_t  *fc,
+                int                   threshold,
+                struct subopt_output  *out,
+                int                   threads);
+
+
+PRIVATE void
+subopt_worker(struct subopt_task    *task,
+              struct subopt_workers *workers);
+
+
+PRIVATE struct subopt_task *
+task_from_state(subopt_env  *env,
+                STATE       *state);
+
+
+PRIVATE STATE *
+state_from_task(subopt_env          *env,
+                struct subopt_task  *task);
+
+
+#endif
+
+
+PRIVATE int
+shrink_window(subopt_env  *env,
+              int         current,
+              int         upper,
+              size_t      memory);
+
+
+PRIVATE size_t
+queue_memory(subopt_env *env);
+
+
+PRIVATE void
+discard_states(subopt_env *env);
+
+
+PRIVATE void
+buffer_store(struct subopt_buffer *buf,
+             const char           *structure,
+             float                energy);
+
+
+PRIVATE void
+buffer_flush(struct subopt_buffer *buf,
+             int                  cp,
+             vrna_subopt_callback *cb,
+             void                 *data);
+
+
+PRIVATE void
+buffer_truncate(struct subopt_buffer *buf);
 
 
 PRIVATE void
-free_state_node(STATE *node);
+buffer_discard(struct subopt_buffer *buf);
 
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state);
+buffer_unbound(struct subopt_buffer *buf);
+
+
+PRIVATE size_t
+buffer_memory(struct subopt_buffer *buf);
 
 
 PRIVATE char *
-get_structure(STATE *state);
+get_structure(STATE *state,
+              int   length);
 
 
 PRIVATE int
@@ -215,12 +469,6 @@ compare_en(const void  *solution1,
            const void  *solution2);
 
 
-PRIVATE void
-make_output(SOLUTION  *SL,
-            int       cp,
-            FILE      *fp);
-
-
 PRIVATE void
 repeat(vrna_fold_compound_t *vc,
        int                  i,
@@ -257,12 +505,6 @@ old_subopt_store(const char *structure,
                  void       *data);
 
 
-PRIVATE void
-old_subopt_store_compressed(const char *structure,
-                            float      energy,
-                            void       *data);
-
-
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -271,103 +513,309 @@ old_subopt_store_compressed(const char *structure,
 
 
 /*---------------------------------------------------------------------------*/
-/*List routines--------------------------------------------------------------*/
+/*Memory management----------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-make_pair(int   i,
-          int   j,
-          STATE *state)
+pool_init(node_pool *pool,
+          size_t    size)
+{
+  /* make sure every node may hold the pointer of the list of released nodes */
+  pool->size      = MAX2(size, sizeof(void *));
+  pool->released  = NULL;
+  pool->next      = NULL;
+  pool->end       = NULL;
+  pool->slabs     = NULL;
+  pool->num_slabs = 0;
+  pool->used      = 0;
+}
+
+
+PRIVATE void
+pool_free(node_pool *pool)
+{
+  size_t i;
+
+  for (i = 0; i < pool->num_slabs; i++)
+    free(pool->slabs[i]);
+
+  free(pool->slabs);
+  pool_init(pool, pool->size);
+}
+
+
+PRIVATE void *
+pool_get(node_pool *pool)
+{
+  void *node;
+
+  pool->used++;
+
+  if (pool->released) {
+    node            = pool->released;
+    pool->released  = *((void **)node);
+    return node;
+  }
+
+  if (pool->next == pool->end) {
+    pool->slabs = (char **)vrna_realloc(pool->slabs,
+                                        sizeof(char *) * (pool->num_slabs + 1));
+    pool->next                      = (char *)vrna_alloc(pool->size * POOL_SLAB_SIZE);
+    pool->end                       = pool->next + pool->size * POOL_SLAB_SIZE;
+    pool->slabs[pool->num_slabs++]  = pool->next;
+  }
+
+  node        = (void *)pool->next;
+  pool->next  += pool->size;
+
+  return node;
+}
+
+
+PRIVATE void
+pool_put(node_pool  *pool,
+         void       *node)
 {
-  state->structure[i - 1] = '(';
-  state->structure[j - 1] = ')';
+  *((void **)node)  = pool->released;
+  pool->released    = node;
+  pool->used--;
 }
 
 
+/*
+ *  Return the memory of slabs whose nodes have all been released, except
+ *  for the current slab. This requires a pass through the list of released
+ *  nodes, so it's meant for occasional use after many states were discarded
+ */
 PRIVATE void
-make_gquad(int    i,
-           int    L,
-           int    l[3],
-           STATE  *state)
+pool_trim(node_pool *pool)
 {
-  int x;
+  size_t    i, k, num, *released;
+  uintptr_t *start;
+  void      *node, **tail;
+
+  if (pool->used == 0) {
+    pool_free(pool);
+    return;
+  }
+
+  /* all slabs but the current one, in ascending order of their addresses */
+  num = pool->num_slabs - 1;
+  if (num == 0)
+    return;
+
+  start     = (uintptr_t *)vrna_alloc(sizeof(uintptr_t) * num);
+  released  = (size_t *)vrna_alloc(sizeof(size_t) * (num + 1));
+
+  for (i = 0; i < num; i++)
+    start[i] = (uintptr_t)pool->slabs[i];
+
+  qsort(start, num, sizeof(uintptr_t), compare_slab_address);
 
-  for (x = 0; x < L; x++) {
-    state->structure[i - 1 + x]                               = '+';
-    state->structure[i - 1 + x + L + l[0]]                    = '+';
-    state->structure[i - 1 + x + 2 * L + l[0] + l[1]]         = '+';
-    state->structure[i - 1 + x + 3 * L + l[0] + l[1] + l[2]]  = '+';
+  for (node = pool->released; node; node = *((void **)node))
+    released[slab_index(pool, start, num, node)]++;
+
+  /* remove the nodes of empty slabs from the list of released nodes */
+  for (tail = &(pool->released); (node = *tail);) {
+    if (released[slab_index(pool, start, num, node)] == POOL_SLAB_SIZE)
+      *tail = *((void **)node);
+    else
+      tail = (void **)node;
+  }
+
+  for (i = k = 0; i < pool->num_slabs; i++) {
+    if ((i < num) &&
+        (released[slab_index(pool, start, num, pool->slabs[i])] == POOL_SLAB_SIZE))
+      free(pool->slabs[i]);
+    else
+      pool->slabs[k++] = pool->slabs[i];
+  }
+
+  pool->num_slabs = k;
+
+  free(start);
+  free(released);
+}
+
+
+/* index of the slab that contains node, or num if it's none of the num sorted ones */
+PRIVATE size_t
+slab_index(node_pool  *pool,
+           uintptr_t  *start,
+           size_t     num,
+           void       *node)
+{
+  size_t    lo, hi, k;
+  uintptr_t address = (uintptr_t)node;
+
+  if (address < start[0])
+    return num;
+
+  for (lo = 0, hi = num; hi - lo > 1;) {
+    k = (lo + hi) / 2;
+    if (start[k] <= address)
+      lo = k;
+    else
+      hi = k;
   }
+
+  return (address < start[lo] + pool->size * POOL_SLAB_SIZE) ? lo : num;
+}
+
+
+PRIVATE int
+compare_slab_address(const void *a,
+                     const void *b)
+{
+  uintptr_t x = *((const uintptr_t *)a);
+  uintptr_t y = *((const uintptr_t *)b);
+
+  return (x > y) - (x < y);
+}
+
+
+/*---------------------------------------------------------------------------*/
+/*List routines--------------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+PRIVATE void
+make_pair(subopt_env  *env,
+          int         i,
+          int         j,
+          STATE       *state)
+{
+  ELEMENT *e = (ELEMENT *)pool_get(&(env->element_pool));
+
+  e->i            = i;
+  e->j            = j;
+  e->refs         = 1;
+  e->next         = state->Elements;
+  state->Elements = e;
+}
+
+
+PRIVATE void
+make_gquad(subopt_env *env,
+           int        i,
+           int        L,
+           int        l[3],
+           STATE      *state)
+{
+  make_pair(env, i, -L, state);
+  make_pair(env, i + L + l[0], -L, state);
+  make_pair(env, i + 2 * L + l[0] + l[1], -L, state);
+  make_pair(env, i + 3 * L + l[0] + l[1] + l[2], -L, state);
+}
+
+
+PRIVATE int
+is_pair(STATE *state,
+        int   i,
+        int   j)
+{
+  ELEMENT *e;
+
+  for (e = state->Elements; e; e = e->next)
+    if (e->i == i)
+      return e->j == j;
+
+  return 0;
 }
 
 
 /*---------------------------------------------------------------------------*/
 
-PRIVATE INTERVAL *
-make_interval(int i,
-              int j,
-              int array_flag)
+PRIVATE void
+push_interval(subopt_env  *env,
+              STATE       *state,
+              int         i,
+              int         j,
+              int         array_flag)
 {
-  INTERVAL *interval;
+  INTERVAL *interval = (INTERVAL *)pool_get(&(env->interval_pool));
 
-  interval              = lst_newnode(sizeof(INTERVAL));
   interval->i           = i;
   interval->j           = j;
   interval->array_flag  = array_flag;
-  return interval;
+  interval->refs        = 1;
+  interval->next        = state->Intervals;   /* takes over the reference of state */
+  state->Intervals      = interval;
 }
 
 
-/*---------------------------------------------------------------------------*/
+PRIVATE INTERVAL
+pop_interval(subopt_env *env,
+             STATE      *state)
+{
+  INTERVAL top, *node;
+
+  node              = state->Intervals;
+  top               = *node;
+  state->Intervals  = node->next;
+
+  if (node->next)
+    node->next->refs++;
+
+  release_intervals(env, node);
+
+  return top;
+}
+
 
 PRIVATE void
-free_interval_node(INTERVAL *node)
+release_intervals(subopt_env  *env,
+                  INTERVAL    *node)
 {
-  lst_freenode(node);
-}
+  INTERVAL *next;
 
+  while ((node) && (--node->refs == 0)) {
+    next = node->next;
+    pool_put(&(env->interval_pool), node);
+    node = next;
+  }
+}
 
-/*---------------------------------------------------------------------------*/
 
 PRIVATE void
-free_state_node(STATE *node)
+release_elements(subopt_env *env,
+                 ELEMENT    *node)
 {
-  free(node->structure);
-  if (node->Intervals)
-    lst_kill(node->Intervals, lst_freenode);
+  ELEMENT *next;
 
-  lst_freenode(node);
+  while ((node) && (--node->refs == 0)) {
+    next = node->next;
+    pool_put(&(env->element_pool), node);
+    node = next;
+  }
 }
 
 
 /*---------------------------------------------------------------------------*/
 
-PRIVATE STATE *
-make_state(LIST *Intervals,
-           char *structure,
-           int  partial_energy,
-           int  is_duplex,
-           int  length)
+PRIVATE void
+free_state_node(subopt_env  *env,
+                STATE       *node)
 {
-  STATE *state;
+  release_intervals(env, node->Intervals);
+  release_elements(env, node->Elements);
+  pool_put(&(env->state_pool), node);
+}
 
-  state = lst_newnode(sizeof(STATE));
 
-  if (Intervals)
-    state->Intervals = Intervals;
-  else
-    state->Intervals = lst_init();
+/*---------------------------------------------------------------------------*/
 
-  if (structure) {
-    state->structure = structure;
-  } else {
-    int i;
-    state->structure = (char *)vrna_alloc(length + 1);
-    for (i = 0; i < length; i++)
-      state->structure[i] = '.';
-  }
+PRIVATE STATE *
+make_state(subopt_env *env)
+{
+  STATE *state;
 
-  state->partial_energy = partial_energy;
+  state                 = (STATE *)pool_get(&(env->state_pool));
+  state->Intervals      = NULL;
+  state->Elements       = NULL;
+  state->partial_energy = 0;
+  state->is_duplex      = 0;
+  state->best_energy    = 0;
+  state->next           = NULL;
 
   return state;
 }
@@ -376,30 +824,23 @@ make_state(LIST *Intervals,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE STATE *
-copy_state(STATE *state)
+copy_state(subopt_env *env,
+           STATE      *state)
 {
-  STATE     *new_state;
-  void      *after;
-  INTERVAL  *new_interval, *next;
+  STATE *new_state;
 
-  new_state                 = lst_newnode(sizeof(STATE));
-  new_state->Intervals      = lst_init();
+  /* share intervals and structure elements with the original state */
+  new_state                 = make_state(env);
+  new_state->Intervals      = state->Intervals;
+  new_state->Elements       = state->Elements;
   new_state->partial_energy = state->partial_energy;
-  /* new_state->best_energy = state->best_energy; */
-
-  if (state->Intervals->count) {
-    after = LST_HEAD(new_state->Intervals);
-    for (next = lst_first(state->Intervals); next; next = lst_next(next)) {
-      new_interval  = lst_newnode(sizeof(INTERVAL));
-      *new_interval = *next;
-      lst_insertafter(new_state->Intervals, new_interval, after);
-      after = new_interval;
-    }
-  }
+  new_state->best_energy    = state->best_energy;
 
-  new_state->structure = strdup(state->structure);
-  if (!new_state->structure)
-    vrna_message_error("out of memory");
+  if (state->Intervals)
+    state->Intervals->refs++;
+
+  if (state->Elements)
+    state->Elements->refs++;
 
   return new_state;
 }
@@ -410,19 +851,22 @@ copy_state(STATE *state)
 /*@unused @*/ PRIVATE void
 print_state(STATE *state)
 {
-  INTERVAL *next;
+  INTERVAL  *next;
+  ELEMENT   *e;
 
-  if (state->Intervals->count) {
-    printf("%d intervals:\n", state->Intervals->count);
-    for (next = lst_first(state->Intervals); next; next = lst_next(next))
+  if (state->Intervals) {
+    printf("intervals:\n");
+    for (next = state->Intervals; next; next = next->next)
       printf("[%d,%d],%d ", next->i, next->j, next->array_flag);
     printf("\n");
   }
 
-  printf("partial structure: %s\n", state->structure);
+  printf("partial structure:");
+  for (e = state->Elements; e; e = e->next)
+    printf(" (%d,%d)", e->i, e->j);
   printf("\n");
   printf(" partial_energy: %d\n", state->partial_energy);
-  /* printf(" best_energy: %d\n", state->best_energy); */
+  printf(" best_energy: %d\n", state->best_energy);
   (void)fflush(stdout);
 }
 
@@ -430,13 +874,12 @@ print_state(STATE *state)
 /*---------------------------------------------------------------------------*/
 
 /*@unused @*/ PRIVATE void
-print_stack(LIST *list)
+print_stack(STATE *stack)
 {
-  void *rec;
+  STATE *rec;
 
   printf("================\n");
-  printf("%d states\n", list->count);
-  for (rec = lst_first(list); rec; rec = lst_next(rec)) {
+  for (rec = stack; rec; rec = rec->next) {
     printf("state-----------\n");
     print_state(rec);
   }
@@ -444,49 +887,6 @@ print_stack(LIST *list)
 }
 
 
-/*---------------------------------------------------------------------------*/
-
-PRIVATE LIST *
-make_list(void)
-{
-  return lst_init();
-}
-
-
-/*---------------------------------------------------------------------------*/
-
-PRIVATE void
-push(LIST *list,
-     void *data)
-{
-  lst_insertafter(list, data, LST_HEAD(list));
-}
-
-
-/* PRIVATE void */
-/* push_stack(STATE *state) { */ /* keep the stack sorted by energy */
-/*   STATE *after, *next; */
-/*   nopush = false; */
-/*   next = after = LST_HEAD(Stack); */
-/*   while ( next = lst_next(next)) { */
-/*     if ( next->best_energy >= state->best_energy ) break; */
-/*     after = next; */
-/*   } */
-/*   lst_insertafter(Stack, state, after); */
-/* } */
-
-/*---------------------------------------------------------------------------*/
-
-PRIVATE void *
-pop(LIST *list)
-{
-  void *data;
-
-  data = lst_deletenext(list, LST_HEAD(list));
-  return data;
-}
-
-
 /*---------------------------------------------------------------------------*/
 /*auxiliary routines---------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -509,7 +909,7 @@ best_attainable_energy(vrna_fold_compound_t *vc,
 
   sum = state->partial_energy;  /* energy of already found elements */
 
-  for (next = lst_first(state->Intervals); next; next = lst_next(next)) {
+  for (next = state->Intervals; next; next = next->next) {
     if (next->array_flag == 0)
       sum += (md->circ) ? matrices->Fc : matrices->f5[next->j];
     else if (next->array_flag == 1)
@@ -533,22 +933,100 @@ best_attainable_energy(vrna_fold_compound_t *vc,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state)
+push_back(subopt_env  *env,
+          STATE       *state)
 {
-  push(Stack, copy_state(state));
+  push_state(env, copy_state(env, state));
   return;
 }
 
 
 /*---------------------------------------------------------------------------*/
 
-PRIVATE char *
-get_structure(STATE *state)
+PRIVATE void
+push_state(subopt_env *env,
+           STATE      *state)
 {
-  char *structure;
+  if ((env->Heap) && (!env->stream)) {
+    /* best-first order, the priority is a lower bound of any structure derived from state */
+    state->best_energy = best_attainable_energy(env->fc, state);
+
+    if (state->best_energy > env->lower) {
+      vrna_heap_insert(env->Heap, state);
+      return;
+    }
+  }
+
+  /*
+   *  depth-first order otherwise, this also applies to states that
+   *  only lead to structures we need to skip or must pass through
+   */
+  state->next = env->Stack;
+  env->Stack  = state;
+  env->stack_size++;
+}
+
+
+PRIVATE STATE *
+pop_state(subopt_env *env)
+{
+  STATE *state;
+
+  if (env->Stack) {
+    state       = env->Stack;
+    env->Stack  = state->next;
+    env->stack_size--;
+    return state;
+  }
+
+  if (env->Heap)
+    return (STATE *)vrna_heap_pop(env->Heap);
+
+  return NULL;
+}
+
+
+PRIVATE int
+compare_state_energy(const void *a,
+                     const void *b,
+                     void       *data)
+{
+  const STATE *s1 = (const STATE *)a;
+  const STATE *s2 = (const STATE *)b;
+
+  if (s1->best_energy > s2->best_energy)
+    return 1;
+
+  if (s1->best_energy < s2->best_energy)
+    return -1;
+
+  return 0;
+}
+
+
+/*---------------------------------------------------------------------------*/
+
+PRIVATE char *
+get_structure(STATE *state,
+              int   length)
+{
+  int     k;
+  char    *structure;
+  ELEMENT *e;
+
+  structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+  memset(structure, '.', length);
+
+  for (e = state->Elements; e; e = e->next) {
+    if (e->j > 0) {
+      structure[e->i - 1] = '(';
+      structure[e->j - 1] = ')';
+    } else {
+      for (k = 0; k < -e->j; k++)
+        structure[e->i - 1 + k] = '+';
+    }
+  }
 
-  structure = strdup(state->structure);
   return structure;
 }
 
@@ -583,38 +1061,17 @@ compare_en(const void  *solution1,
 }
 
 
-/*---------------------------------------------------------------------------*/
-
-PRIVATE void
-make_output(SOLUTION  *SL,
-            int       cp,
-            FILE      *fp)                                /* prints stuff */
-{
-  SOLUTION *sol;
-
-  for (sol = SL; sol->structure != NULL; sol++) {
-    char *e_string  = vrna_strdup_printf(" %6.2f", sol->energy);
-    char *ss        = vrna_db_unpack(sol->structure);
-    char *s         = vrna_cut_point_insert(ss, cp);
-    print_structure(fp, s, e_string);
-    free(s);
-    free(ss);
-    free(e_string);
-  }
-}
-
-
 PRIVATE STATE *
-derive_new_state(int    i,
-                 int    j,
-                 STATE  *s,
-                 int    e,
-                 int    flag)
+derive_new_state(int        i,
+                 int        j,
+                 STATE      *s,
+                 int        e,
+                 int        flag,
+                 subopt_env *env)
 {
-  STATE     *s_new  = copy_state(s);
-  INTERVAL  *ival   = make_interval(i, j, flag);
+  STATE *s_new = copy_state(env, s);
 
-  push(s_new->Intervals, ival);
+  push_interval(env, s_new, i, j, flag);
 
   s_new->partial_energy += e;
 
@@ -630,9 +1087,9 @@ fork_state(int        i,
            int        flag,
            subopt_env *env)
 {
-  STATE *s_new = derive_new_state(i, j, s, e, flag);
+  STATE *s_new = derive_new_state(i, j, s, e, flag, env);
 
-  push(env->Stack, s_new);
+  push_state(env, s_new);
   env->nopush = false;
 }
 
@@ -646,358 +1103,999 @@ fork_int_state(int        i,
                int        e,
                subopt_env *env)
 {
-  STATE *s_new = derive_new_state(p, q, s, e, 2);
+  STATE *s_new = derive_new_state(p, q, s, e, 2, env);
 
-  make_pair(i, j, s_new);
-  make_pair(p, q, s_new);
-  push(env->Stack, s_new);
+  make_pair(env, i, j, s_new);
+  make_pair(env, p, q, s_new);
+  push_state(env, s_new);
   env->nopush = false;
 }
 
 
 PRIVATE void
-fork_state_pair(int         i,
-                int         j,
-                STATE       *s,
-                int         e,
-                subopt_env  *env)
+fork_state_pair(int         i,
+                int         j,
+                STATE       *s,
+                int         e,
+                subopt_env  *env)
+{
+  STATE *new_state;
+
+  new_state = copy_state(env, s);
+  make_pair(env, i, j, new_state);
+  new_state->partial_energy += e;
+  push_state(env, new_state);
+  env->nopush = false;
+}
+
+
+PRIVATE void
+fork_two_states_pair(int        i,
+                     int        j,
+                     int        k,
+                     STATE      *s,
+                     int        e,
+                     int        flag1,
+                     int        flag2,
+                     subopt_env *env)
+{
+  STATE *new_state;
+
+  new_state = copy_state(env, s);
+  if (k - i < j - k) {
+    /* push larger interval first */
+    push_interval(env, new_state, i + 1, k - 1, flag1);
+    push_interval(env, new_state, k, j - 1, flag2);
+  } else {
+    push_interval(env, new_state, k, j - 1, flag2);
+    push_interval(env, new_state, i + 1, k - 1, flag1);
+  }
+
+  make_pair(env, i, j, new_state);
+  new_state->partial_energy += e;
+
+  push_state(env, new_state);
+  env->nopush = false;
+}
+
+
+PRIVATE void
+fork_two_states(int         i,
+                int         j,
+                int         p,
+                int         q,
+                STATE       *s,
+                int         e,
+                int         flag1,
+                int         flag2,
+                subopt_env  *env)
+{
+  STATE *new_state;
+
+  new_state = copy_state(env, s);
+
+  if ((j - i) < (q - p)) {
+    push_interval(env, new_state, i, j, flag1);
+    push_interval(env, new_state, p, q, flag2);
+  } else {
+    push_interval(env, new_state, p, q, flag2);
+    push_interval(env, new_state, i, j, flag1);
+  }
+
+  new_state->partial_energy += e;
+
+  push_state(env, new_state);
+  env->nopush = false;
+}
+
+
+/*---------------------------------------------------------------------------*/
+/* start of subopt backtracking ---------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+
+PUBLIC SOLUTION *
+vrna_subopt(vrna_fold_compound_t  *vc,
+            int                   delta,
+            int                   sorted,
+            FILE                  *fp)
+{
+  struct old_subopt_dat data;
+  vrna_subopt_callback  *cb;
+
+  data.SolutionList = NULL;
+  data.max_sol      = 128;
+  data.n_sol        = 0;
+  data.fp           = fp;
+
+  if (vc) {
+    /* SolutionList stores the suboptimal structures found */
+
+    data.SolutionList = (SOLUTION *)vrna_alloc(data.max_sol * sizeof(SOLUTION));
+
+    /* end initialize ------------------------------------------------------- */
+
+    if (fp) {
+      float min_en;
+      char  *SeQ, *energies = NULL;
+      if (vc->strands > 1)
+        min_en = vrna_mfe_dimer(vc, NULL);
+      else
+        min_en = vrna_mfe(vc, NULL);
+
+      SeQ       = vrna_cut_point_insert(vc->sequence, vc->cutpoint);
+      energies  = vrna_strdup_printf(" %6.2f %6.2f", min_en, (float)delta / 100.);
+      print_structure(fp, SeQ, energies);
+      free(SeQ);
+      free(energies);
+
+      vrna_mx_mfe_free(vc);
+    }
+
+    cb = (fp) ? old_subopt_print : old_subopt_store;
+
+    /* call subopt(), sorted output is already generated in the requested order */
+    vrna_subopt_sorted_cb(vc, delta, sorted, 0, cb, (void *)&data);
+
+    if (fp) {
+      /* we've printed everything -- free solutions */
+      SOLUTION *sol;
+      for (sol = data.SolutionList; sol->structure != NULL; sol++)
+        free(sol->structure);
+      free(data.SolutionList);
+      data.SolutionList = NULL;
+    }
+  }
+
+  return data.SolutionList;
+}
+
+
+PUBLIC void
+vrna_subopt_cb(vrna_fold_compound_t *vc,
+               int                  delta,
+               vrna_subopt_callback *cb,
+               void                 *data)
+{
+  subopt_enumerate(vc, delta, VRNA_UNSORTED, 0, cb, data);
+}
+
+
+PUBLIC void
+vrna_subopt_sorted_cb(vrna_fold_compound_t  *vc,
+                      int                   delta,
+                      int                   sorted,
+                      size_t                max_memory,
+                      vrna_subopt_callback  *cb,
+                      void                  *data)
+{
+  if (sorted == VRNA_UNSORTED)
+    max_memory = 0;
+
+  subopt_enumerate(vc, delta, sorted, max_memory, cb, data);
+}
+
+
+PRIVATE void
+subopt_enumerate(vrna_fold_compound_t *vc,
+                 int                  delta,
+                 int                  sorted,
+                 size_t               max_memory,
+                 vrna_subopt_callback *cb,
+                 void                 *data)
+{
+  subopt_env    *env;
+  STATE         *state;
+  INTERVAL      interval;
+  unsigned int  *so, *ss, *se;
+  int           maxlevel, count, old_dangles, logML, dangle_model, length, circular,
+                threshold, cp, level, level_count, lowest, upper, shrunk, threads;
+  struct subopt_buffer buffer;
+  struct subopt_output out;
+  double        min_en, eprint;
+  char          *struc;
+  float         correction;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+  int           minimal_energy;
+  int           Fc;
+  int           *f5;
+
+  vrna_fold_compound_prepare(vc, VRNA_OPTION_MFE | VRNA_OPTION_HYBRID);
+
+  length  = vc->length;
+  so      = vc->strand_order;
+  ss      = vc->strand_start;
+  se      = vc->strand_end;
+  P       = vc->params;
+  md      = &(P->model_details);
+
+  /* do mfe folding to get fill arrays and get ground state energy  */
+  /* in case dangles is neither 0 or 2, set dangles=2 while folding */
+
+  circular    = md->circ;
+  logML       = md->logML;
+  old_dangles = dangle_model = md->dangles;
+
+  if (md->uniq_ML != 1) /* failsafe mechanism to enforce valid fM1 array */
+    md->uniq_ML = 1;
+
+  /* temporarily set dangles to 2 if necessary */
+  if ((md->dangles != 0) && (md->dangles != 2))
+    md->dangles = 2;
+
+  struc = (char *)vrna_alloc(sizeof(char) * (length + 1));
+
+  if (circular) {
+    min_en  = vrna_mfe(vc, struc);
+    Fc      = vc->matrices->Fc;
+    f5      = vc->matrices->f5;
+
+    /* restore dangle model */
+    md->dangles = old_dangles;
+    /* re-evaluate in case we're using logML etc */
+    min_en = vrna_eval_structure(vc, struc);
+  } else {
+    min_en = vrna_mfe_dimer(vc, struc);
+
+    f5 = vc->matrices->f5;
+
+    /* restore dangle model */
+    md->dangles = old_dangles;
+    /* re-evaluate in case we're using logML etc */
+    min_en = vrna_eval_structure(vc, struc);
+  }
+
+  free(struc);
+  eprint = print_energy + min_en;
+
+  correction = (min_en < 0) ? -0.1 : 0.1;
+
+  /* Initialize ------------------------------------------------------------ */
+
+  maxlevel  = 0;
+  count     = 0;
+
+  /* Initialize the stack ------------------------------------------------- */
+
+  minimal_energy  = (circular) ? Fc : f5[length];
+  threshold       = minimal_energy + delta;
+  if (threshold >= INF) {
+    vrna_message_warning("Energy range too high, limiting to reasonable value");
+    threshold = INF - EMAX;
+  }
+
+  cp = (vc->strands > 1) ? ss[so[1]] : -1;
+
+  /*
+   *  By default, sorted output is obtained by collecting all structures and
+   *  sorting them at the very end. Upon request, i.e. if a memory budget for
+   *  the queue is given, we process the states in best-first order of their
+   *  best attainable energy rather than depth-first. Complete structures then
+   *  leave the priority queue in ascending order of their energy, and only those
+   *  of the current energy level require buffering for lexicographic ordering.
+   *
+   *  Since the queue may grow as large as the number of structures still to come,
+   *  we limit its size by enumerating energy windows (lower, upper] one after
+   *  the other. Whenever the queue and the buffered structures exceed the memory
+   *  budget, the upper bound of the current window is lowered and all states
+   *  beyond are discarded. They will be re-generated in the next pass, which
+   *  traverses all states that can't reach the new window depth-first, and skips
+   *  structures already reported.
+   *
+   *  The window can't be lowered below the current energy level, though. If this
+   *  level alone exceeds the budget, we stream it instead, i.e. we enumerate its
+   *  structures depth-first with the window (level - 1, level]. For lexicographic
+   *  order, each pass keeps the smallest structures beyond those already passed
+   *  to the callback, as many as fit into the budget, and passes are repeated
+   *  until the level is exhausted.
+   *
+   *  If the reported energies are re-evaluated (logML, dangles = 1 or 3), they
+   *  no longer coincide with the queue priorities. In that case, we stay with
+   *  depth-first traversal and sort all structures at the very end.
+   */
+  buffer.size       = 0;
+  buffer.n          = 0;
+  buffer.list       = NULL;
+  buffer.packed     = (md->gquad) ? 0 : 1;
+  buffer.entry_size = (buffer.packed) ? (length + 4) / 5 + 1 : length + 1;
+  buffer.max        = 0;
+  buffer.dropped    = 0;
+  buffer.bound      = NULL;
+  buffer.last       = NULL;
+  buffer.compare    = (sorted == VRNA_SORT_BY_ENERGY_ASC) ? compare_en : compare;
+  level             = INF;
+  level_count       = 0;
+  upper             = threshold;
+  shrunk            = 0;
+
+  /* init env data structure */
+  env             = (subopt_env *)vrna_alloc(sizeof(subopt_env));
+  env->fc         = vc;
+  env->Heap       = NULL;
+  env->Stack      = NULL;
+  env->stack_size = 0;
+  env->nopush     = true;
+  env->stream     = 0;
+  env->lower      = minimal_energy - 1;
+
+  pool_init(&(env->state_pool), sizeof(STATE));
+  pool_init(&(env->interval_pool), sizeof(INTERVAL));
+  pool_init(&(env->element_pool), sizeof(ELEMENT));
+
+  /*
+   *  best-first enumeration requires a lower bound for the energy of each state.
+   *  This is not available if energies are re-evaluated, or with noLP, where a
+   *  pair stacked onto its enclosing pair may undercut the energy stored in c.
+   */
+  if ((sorted != VRNA_UNSORTED) && (max_memory > 0)) {
+    if ((logML) || (dangle_model == 1) || (dangle_model == 3) || (md->noLP))
+      vrna_message_warning("vrna_subopt_sorted_cb(): "
+                           "Memory bounded enumeration is not available for "
+                           "logML, dangles = 1 or 3, and noLP! "
+                           "Collecting all structures before sorting instead");
+    else
+      env->Heap = vrna_heap_init(1024, compare_state_energy, NULL, NULL, NULL);
+  }
+
+  threads = 1;
+
+#ifdef _OPENMP
+  threads = MIN2(md->threads, omp_get_num_procs());
+
+  /* parallel enumeration always proceeds depth-first */
+  if ((!parallel_compatible(vc)) || (env->Heap))
+    threads = 1;
+
+#endif
+
+  out.cb          = cb;
+  out.data        = data;
+  out.buffer      = ((sorted != VRNA_UNSORTED) &&
+                     ((!env->Heap) || (sorted != VRNA_SORT_BY_ENERGY_ASC))) ? &buffer : NULL;
+  out.length      = length;
+  out.cp          = cp;
+  out.reeval      = (logML || (dangle_model == 1) || (dangle_model == 3)) ? 1 : 0;
+  out.dos         = 1;
+  out.min_en      = min_en;
+  out.eprint      = eprint;
+  out.correction  = correction;
+
+#ifdef _OPENMP
+  /*
+   *  all structures are passed to the callback (or buffer) by the worker
+   *  threads, the loop below then only finalizes the output
+   */
+  if (threads > 1)
+    subopt_parallel(vc, threshold, &out, threads);
+  else
+#endif
+  push_initial_state(env, length);
+
+  /* end initialize ------------------------------------------------------- */
+
+
+  while (1) {
+    /* forever, til nothing remains on stack */
+
+    maxlevel = (env->stack_size > maxlevel ? env->stack_size : maxlevel);
+
+    /* pop the last element ---------------------------------------------- */
+
+    state = pop_state(env);                         /* current state to work with */
+
+    /* all structures of the current energy level have been seen */
+    if ((buffer.n > 0) &&
+        ((!state) || ((env->Heap) && (!env->stream) && (state->best_energy > level))))
+      buffer_flush(&buffer, cp, cb, data);
+
+    if (!state) {
+      if (env->stream) {
+        if (buffer.dropped) {
+          /* another pass for the structures of the level that didn't fit */
+          buffer.dropped  = 0;
+          out.dos         = 0;
+          push_initial_state(env, length);
+          continue;
+        }
+
+        /* the level is complete, continue best-first with the next window */
+        env->stream = 0;
+        out.dos     = 1;
+        buffer_unbound(&buffer);
+      }
+
+      if ((env->Heap) && (upper < threshold)) {
+        /*
+         *  start over with the next energy window, which may be twice
+         *  as large if the current one didn't exhaust the memory budget
+         */
+        int width = (shrunk) ? upper - env->lower : 2 * (upper - env->lower);
+
+        env->lower  = upper;
+        upper       = MIN2(threshold, upper + width);
+        shrunk      = 0;
+        trim_pools(env);
+        push_initial_state(env, length);
+        continue;
+      }
+
+      /* we are done! clean up and quit */
+      /* fprintf(stderr, "maxlevel: %d\n", maxlevel); */
+
+      cb(NULL, 0, data);   /* NULL (last time to call callback function */
+
+      break;
+    }
+
+    if (!state->Intervals) {
+      /* state has no intervals left: we got a solution */
+
+      if (state->partial_energy <= env->lower) {
+        /* already reported in a previous energy window */
+        free_state_node(env, state);
+        continue;
+      }
+
+      count++;
+
+      /* in best-first order, structures arrive level by level */
+      if (state->partial_energy != level) {
+        level       = state->partial_energy;
+        level_count = 0;
+      }
+
+      level_count++;
+
+      report_structure(vc, state, &out);
+    } else {
+      /* get (and remove) next interval of state to analyze */
+
+      interval = pop_interval(env, state);
+      scan_interval(vc, interval.i, interval.j, interval.array_flag, upper, state, env);
+    }
+
+    if ((env->Heap) &&
+        (!env->stream) &&
+        (queue_memory(env) + buffer_memory(&buffer) > max_memory)) {
+      size_t buffered = buffer_memory(&buffer);
+
+      /* the window can't be reduced below the current energy level */
+      lowest  = MAX2(state->best_energy, env->lower + 1);
+      upper   = shrink_window(env,
+                              lowest,
+                              upper,
+                              (max_memory / 2 > buffered) ? max_memory / 2 - buffered : 0);
+      shrunk  = 1;
+
+      if (queue_memory(env) + buffer_memory(&buffer) > max_memory) {
+        /* all structures below the current level have been reported, stream the level */
+        env->stream = 1;
+
+        if ((out.buffer) || (level != lowest)) {
+          /* start over from scratch, where the depth-first states occupy little memory */
+          discard_states(env);
+
+          if (out.buffer) {
+            buffer_discard(&buffer);
+            buffer.max = MAX2(2, max_memory / (sizeof(SOLUTION) + buffer.entry_size));
+          }
+
+          /* structures of the level are counted again in the first pass */
+          if (level == lowest)
+            density_of_states[dos_index(&out, lowest / 100.)] -= level_count;
+
+          env->lower = lowest - 1;
+          push_initial_state(env, length);
+        } else {
+          /*
+           *  some structures of the level have been passed to the callback
+           *  already, so we process the remaining states of the level
+           *  depth-first, and discard all others
+           */
+          shrink_window(env, lowest, lowest, 0);
+        }
+
+        upper = lowest;
+      }
+    }
+
+    free_state_node(env, state);                     /* free the current state */
+  } /* end of while (1) */
+
+  /* cleanup memory */
+  vrna_heap_free(env->Heap);
+  pool_free(&(env->state_pool));
+  pool_free(&(env->interval_pool));
+  pool_free(&(env->element_pool));
+  buffer_unbound(&buffer);
+  free(buffer.list);
+  free(env);
+}
+
+
+PRIVATE void
+push_initial_state(subopt_env *env,
+                   int        length)
+{
+  STATE *state;
+
+  state = make_state(env);                  /* initial state: */
+  push_interval(env, state, 1, length, 0);  /* interval [1,length,0] */
+  push_state(env, state);
+  env->nopush = false;
+}
+
+
+/*
+ *  Pass a complete structure to the callback, or store it in the buffer
+ *  for sorted output. The callback and buffer are accessed by one thread
+ *  at a time.
+ */
+PRIVATE void
+report_structure(vrna_fold_compound_t *vc,
+                 STATE                *state,
+                 struct subopt_output *out)
+{
+  int     e;
+  char    *structure;
+  double  structure_energy;
+
+  structure         = get_structure(state, out->length);
+  structure_energy  = state->partial_energy / 100.;
+
+#ifdef CHECK_ENERGY
+  structure_energy = vrna_eval_structure(vc, structure);
+
+  if (!vc->params->model_details.logML)
+    if ((double)(state->partial_energy / 100.) != structure_energy) {
+      vrna_message_error("%s %6.2f %6.2f",
+                         structure,
+                         state->partial_energy / 100.,
+                         structure_energy);
+      exit(1);
+    }
+
+#endif
+  if (out->reeval) /* recalc energy */
+    structure_energy = vrna_eval_structure(vc, structure);
+
+  if (out->dos) {
+    e = dos_index(out, structure_energy);
+
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    density_of_states[e]++;
+  }
+
+  if (structure_energy <= out->eprint) {
+#ifdef _OPENMP
+#pragma omp critical (subopt_output)
+#endif
+    {
+      if (out->buffer) {
+        buffer_store(out->buffer, structure, structure_energy);
+      } else {
+        char *outstruct = vrna_cut_point_insert(structure, out->cp);
+        out->cb((const char *)outstruct, structure_energy, out->data);
+        free(outstruct);
+      }
+    }
+  }
+
+  free(structure);
+}
+
+
+/* bin of the density of states a structure energy falls into */
+PRIVATE int
+dos_index(struct subopt_output  *out,
+          double                energy)
+{
+  int e = (int)((energy - out->min_en) * 10. - out->correction); /* avoid rounding errors */
+
+  return MIN2(e, MAXDOS);
+}
+
+
+#ifdef _OPENMP
+
+PRIVATE int
+parallel_compatible(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md = &(fc->params->model_details);
+
+  /* user-defined constraint callbacks may not be thread-safe */
+  if ((fc->hc->f) ||
+      ((fc->sc) && (fc->sc->f)))
+    return 0;
+
+  /* energy re-evaluation temporarily modifies the model settings for G-quadruplexes */
+  if ((md->gquad) &&
+      ((md->logML) || (md->dangles == 1) || (md->dangles == 3)))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  Depth-first enumeration with several threads. The search tree is
+ *  distributed among OpenMP tasks, each of which processes its sub-tree
+ *  with its own stack of states and node pools. Whenever a thread would
+ *  otherwise idle, a busy worker splits off the bottom-most state of its
+ *  stack, i.e. the largest sub-tree it has not entered yet, as a new task.
+ */
+PRIVATE void
+subopt_parallel(vrna_fold_compound_t  *fc,
+                int                   threshold,
+                struct subopt_output  *out,
+                int                   threads)
 {
-  STATE *new_state;
-
-  new_state = copy_state(s);
-  make_pair(i, j, new_state);
-  new_state->partial_energy += e;
-  push(env->Stack, new_state);
-  env->nopush = false;
+  struct subopt_task    *task;
+  struct subopt_workers workers;
+
+  workers.fc        = fc;
+  workers.out       = out;
+  workers.threshold = threshold;
+  workers.threads   = threads;
+  workers.busy      = 1;
+
+  /* initial state: interval [1,length,0] */
+  task                  = (struct subopt_task *)vrna_alloc(sizeof(struct subopt_task));
+  task->num_intervals   = 1;
+  task->intervals       = (INTERVAL *)vrna_alloc(sizeof(INTERVAL));
+  task->intervals[0].i  = 1;
+  task->intervals[0].j  = out->length;
+
+#pragma omp parallel num_threads(threads)
+  {
+#pragma omp single
+    subopt_worker(task, &workers);
+  }
 }
 
 
 PRIVATE void
-fork_two_states_pair(int        i,
-                     int        j,
-                     int        k,
-                     STATE      *s,
-                     int        e,
-                     int        flag1,
-                     int        flag2,
-                     subopt_env *env)
+subopt_worker(struct subopt_task    *task,
+              struct subopt_workers *workers)
 {
-  INTERVAL  *interval1, *interval2;
-  STATE     *new_state;
+  int         busy;
+  STATE       *state, *prev;
+  INTERVAL    interval;
+  subopt_env  *env;
 
-  new_state = copy_state(s);
-  interval1 = make_interval(i + 1, k - 1, flag1);
-  interval2 = make_interval(k, j - 1, flag2);
-  if (k - i < j - k) {
-    /* push larger interval first */
-    push(new_state->Intervals, interval1);
-    push(new_state->Intervals, interval2);
-  } else {
-    push(new_state->Intervals, interval2);
-    push(new_state->Intervals, interval1);
-  }
+  env         = (subopt_env *)vrna_alloc(sizeof(subopt_env));
+  env->fc     = workers->fc;
+  env->nopush = true;
 
-  make_pair(i, j, new_state);
-  new_state->partial_energy += e;
+  pool_init(&(env->state_pool), sizeof(STATE));
+  pool_init(&(env->interval_pool), sizeof(INTERVAL));
+  pool_init(&(env->element_pool), sizeof(ELEMENT));
 
-  push(env->Stack, new_state);
+  push_state(env, state_from_task(env, task));
   env->nopush = false;
-}
 
+  while ((state = pop_state(env))) {
+    if (!state->Intervals) {
+      report_structure(workers->fc, state, workers->out);
+    } else {
+      interval = pop_interval(env, state);
+      scan_interval(workers->fc,
+                    interval.i,
+                    interval.j,
+                    interval.array_flag,
+                    workers->threshold,
+                    state,
+                    env);
+    }
 
-PRIVATE void
-fork_two_states(int         i,
-                int         j,
-                int         p,
-                int         q,
-                STATE       *s,
-                int         e,
-                int         flag1,
-                int         flag2,
-                subopt_env  *env)
-{
-  INTERVAL  *interval1, *interval2;
-  STATE     *new_state;
+    free_state_node(env, state);
 
-  new_state = copy_state(s);
-  interval1 = make_interval(i, j, flag1);
-  interval2 = make_interval(p, q, flag2);
+    if (env->stack_size > 1) {
+#pragma omp atomic read
+      busy = workers->busy;
 
-  if ((j - i) < (q - p)) {
-    push(new_state->Intervals, interval1);
-    push(new_state->Intervals, interval2);
-  } else {
-    push(new_state->Intervals, interval2);
-    push(new_state->Intervals, interval1);
+      if (busy < workers->threads) {
+        /* hand over the bottom-most state of our stack to an idle thread */
+        for (prev = env->Stack; prev->next->next; prev = prev->next);
+
+        task        = task_from_state(env, prev->next);
+        prev->next  = NULL;
+        env->stack_size--;
+
+#pragma omp atomic
+        workers->busy++;
+
+#pragma omp task firstprivate(task, workers)
+        subopt_worker(task, workers);
+      }
+    }
   }
 
-  new_state->partial_energy += e;
+  pool_free(&(env->state_pool));
+  pool_free(&(env->interval_pool));
+  pool_free(&(env->element_pool));
+  free(env);
 
-  push(env->Stack, new_state);
-  env->nopush = false;
+#pragma omp atomic
+  workers->busy--;
 }
 
 
-/*---------------------------------------------------------------------------*/
-/* start of subopt backtracking ---------------------------------------------*/
-/*---------------------------------------------------------------------------*/
-
-PUBLIC SOLUTION *
-vrna_subopt(vrna_fold_compound_t  *vc,
-            int                   delta,
-            int                   sorted,
-            FILE                  *fp)
+/*
+ *  Convert a state into a self-contained task, since its interval
+ *  stack and partial structure are shared with other states of the
+ *  same thread
+ */
+PRIVATE struct subopt_task *
+task_from_state(subopt_env  *env,
+                STATE       *state)
 {
-  struct old_subopt_dat data;
-  vrna_subopt_callback  *cb;
+  int                 k;
+  INTERVAL            *interval;
+  ELEMENT             *e;
+  struct subopt_task  *task;
 
-  data.SolutionList = NULL;
-  data.max_sol      = 128;
-  data.n_sol        = 0;
-  data.fp           = fp;
-  data.cp           = vc->cutpoint;
+  task                  = (struct subopt_task *)vrna_alloc(sizeof(struct subopt_task));
+  task->partial_energy  = state->partial_energy;
+  task->is_duplex       = state->is_duplex;
 
-  if (vc) {
-    /* SolutionList stores the suboptimal structures found */
+  for (interval = state->Intervals; interval; interval = interval->next)
+    task->num_intervals++;
 
-    data.SolutionList = (SOLUTION *)vrna_alloc(data.max_sol * sizeof(SOLUTION));
+  for (e = state->Elements; e; e = e->next)
+    task->num_elements++;
 
-    /* end initialize ------------------------------------------------------- */
+  task->intervals = (INTERVAL *)vrna_alloc(sizeof(INTERVAL) * (task->num_intervals + 1));
+  task->elements  = (ELEMENT *)vrna_alloc(sizeof(ELEMENT) * (task->num_elements + 1));
 
-    if (fp) {
-      float min_en;
-      char  *SeQ, *energies = NULL;
-      if (vc->strands > 1)
-        min_en = vrna_mfe_dimer(vc, NULL);
-      else
-        min_en = vrna_mfe(vc, NULL);
+  for (k = 0, interval = state->Intervals; interval; interval = interval->next, k++)
+    task->intervals[k] = *interval;
 
-      SeQ       = vrna_cut_point_insert(vc->sequence, vc->cutpoint);
-      energies  = vrna_strdup_printf(" %6.2f %6.2f", min_en, (float)delta / 100.);
-      print_structure(fp, SeQ, energies);
-      free(SeQ);
-      free(energies);
+  for (k = 0, e = state->Elements; e; e = e->next, k++)
+    task->elements[k] = *e;
 
-      vrna_mx_mfe_free(vc);
-    }
+  free_state_node(env, state);
 
-    cb = old_subopt_store;
+  return task;
+}
 
-    if (fp)
-      cb = (sorted) ? old_subopt_store_compressed : old_subopt_print;
 
-    /* call subopt() */
-    vrna_subopt_cb(vc, delta, cb, (void *)&data);
+PRIVATE STATE *
+state_from_task(subopt_env          *env,
+                struct subopt_task  *task)
+{
+  int   k;
+  STATE *state;
 
-    if (sorted) {
-      /* sort structures by energy */
-      if (data.n_sol > 0) {
-        int (*compare_fun)(const void *a, const void *b);
+  state                 = make_state(env);
+  state->partial_energy = task->partial_energy;
+  state->is_duplex      = task->is_duplex;
 
-        switch (sorted) {
-          case VRNA_SORT_BY_ENERGY_ASC:
-            compare_fun = compare_en;
-            break;
+  for (k = task->num_intervals - 1; k >= 0; k--)
+    push_interval(env,
+                  state,
+                  task->intervals[k].i,
+                  task->intervals[k].j,
+                  task->intervals[k].array_flag);
 
-          default: /* a.k.a. VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC */
-            compare_fun = compare;
-            break;
-        }
+  for (k = task->num_elements - 1; k >= 0; k--)
+    make_pair(env, task->elements[k].i, task->elements[k].j, state);
 
-        qsort(data.SolutionList, data.n_sol - 1, sizeof(SOLUTION), compare_fun);
-      }
+  free(task->intervals);
+  free(task->elements);
+  free(task);
 
-      if (fp)
-        make_output(data.SolutionList, vc->cutpoint, fp);
-    }
+  return state;
+}
 
-    if (fp) {
-      /* we've printed everything -- free solutions */
-      SOLUTION *sol;
-      for (sol = data.SolutionList; sol->structure != NULL; sol++)
-        free(sol->structure);
-      free(data.SolutionList);
-      data.SolutionList = NULL;
-    }
-  }
 
-  return data.SolutionList;
-}
+#endif
 
 
-PUBLIC void
-vrna_subopt_cb(vrna_fold_compound_t *vc,
-               int                  delta,
-               vrna_subopt_callback *cb,
-               void                 *data)
+/*
+ *  Lower the upper bound of the current energy window such that the
+ *  queue occupies at most @p memory bytes, but never below energy
+ *  level @p lowest. States beyond the new bound are discarded
+ */
+PRIVATE int
+shrink_window(subopt_env  *env,
+              int         lowest,
+              int         upper,
+              size_t      memory)
 {
-  subopt_env    *env;
-  STATE         *state;
-  INTERVAL      *interval;
-  unsigned int  *so, *ss, *se;
-  int           maxlevel, count, partial_energy, old_dangles, logML, dangle_model, length, circular,
-                threshold;
-  double        structure_energy, min_en, eprint;
-  char          *struc, *structure;
-  float         correction;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  int           minimal_energy;
-  int           Fc;
-  int           *f5;
+  size_t  i, n;
+  STATE   **states;
+
+  n       = vrna_heap_size(env->Heap);
+  states  = (STATE **)vrna_alloc(sizeof(STATE *) * n);
+
+  /* states are in ascending order of their best attainable energy afterwards */
+  for (i = 0; i < n; i++)
+    states[i] = (STATE *)vrna_heap_pop(env->Heap);
+
+  /* states share memory, so we need to release them one by one */
+  while ((n > 0) &&
+         (states[n - 1]->best_energy > lowest) &&
+         ((queue_memory(env) > memory) || (states[n - 1]->best_energy > upper))) {
+    upper = states[n - 1]->best_energy - 1;
+    free_state_node(env, states[--n]);
+  }
 
-  vrna_fold_compound_prepare(vc, VRNA_OPTION_MFE | VRNA_OPTION_HYBRID);
+  for (i = 0; i < n; i++)
+    vrna_heap_insert(env->Heap, states[i]);
 
-  length  = vc->length;
-  so      = vc->strand_order;
-  ss      = vc->strand_start;
-  se      = vc->strand_end;
-  P       = vc->params;
-  md      = &(P->model_details);
+  free(states);
 
-  /* do mfe folding to get fill arrays and get ground state energy  */
-  /* in case dangles is neither 0 or 2, set dangles=2 while folding */
+  trim_pools(env);
 
-  circular    = md->circ;
-  logML       = md->logML;
-  old_dangles = dangle_model = md->dangles;
+  return upper;
+}
 
-  if (md->uniq_ML != 1) /* failsafe mechanism to enforce valid fM1 array */
-    md->uniq_ML = 1;
 
-  /* temporarily set dangles to 2 if necessary */
-  if ((md->dangles != 0) && (md->dangles != 2))
-    md->dangles = 2;
+/* memory occupied by the backtracking states of the queue */
+PRIVATE size_t
+queue_memory(subopt_env *env)
+{
+  return env->state_pool.used * env->state_pool.size +
+         env->interval_pool.used * env->interval_pool.size +
+         env->element_pool.used * env->element_pool.size +
+         vrna_heap_size(env->Heap) * sizeof(void *);
+}
 
-  struc = (char *)vrna_alloc(sizeof(char) * (length + 1));
 
-  if (circular) {
-    min_en  = vrna_mfe(vc, struc);
-    Fc      = vc->matrices->Fc;
-    f5      = vc->matrices->f5;
+/* release all states of the queue and the depth-first stack */
+PRIVATE void
+discard_states(subopt_env *env)
+{
+  STATE *state;
 
-    /* restore dangle model */
-    md->dangles = old_dangles;
-    /* re-evaluate in case we're using logML etc */
-    min_en = vrna_eval_structure(vc, struc);
-  } else {
-    min_en = vrna_mfe_dimer(vc, struc);
+  while ((state = pop_state(env)))
+    free_state_node(env, state);
 
-    f5 = vc->matrices->f5;
+  trim_pools(env);
+}
 
-    /* restore dangle model */
-    md->dangles = old_dangles;
-    /* re-evaluate in case we're using logML etc */
-    min_en = vrna_eval_structure(vc, struc);
-  }
 
-  free(struc);
-  eprint = print_energy + min_en;
+/* return the memory of the states discarded from the queue */
+PRIVATE void
+trim_pools(subopt_env *env)
+{
+  pool_trim(&(env->state_pool));
+  pool_trim(&(env->interval_pool));
+  pool_trim(&(env->element_pool));
+}
 
-  correction = (min_en < 0) ? -0.1 : 0.1;
 
-  /* Initialize ------------------------------------------------------------ */
+PRIVATE void
+buffer_store(struct subopt_buffer *buf,
+             const char           *structure,
+             float                energy)
+{
+  char *s = (buf->packed) ? vrna_db_pack(structure) : strdup(structure);
+
+  if (buf->max) {
+    /*
+     *  keep the smallest structures beyond the last one passed to the callback,
+     *  all structures are of the same energy level in this case
+     */
+    if ((buf->last) && (strcmp(s, buf->last) <= 0)) {
+      free(s);
+      return;
+    }
 
-  maxlevel        = 0;
-  count           = 0;
-  partial_energy  = 0;
+    if (buf->n == buf->max)
+      buffer_truncate(buf);
 
-  /* Initialize the stack ------------------------------------------------- */
+    if ((buf->bound) && (strcmp(s, buf->bound) >= 0)) {
+      buf->dropped = 1;
+      free(s);
+      return;
+    }
+  }
 
-  minimal_energy  = (circular) ? Fc : f5[length];
-  threshold       = minimal_energy + delta;
-  if (threshold >= INF) {
-    vrna_message_warning("Energy range too high, limiting to reasonable value");
-    threshold = INF - EMAX;
+  if (buf->n == buf->size) {
+    buf->size = (buf->size) ? 2 * buf->size : 128;
+    if (buf->max)
+      buf->size = MIN2(buf->size, buf->max);
+
+    buf->list = (SOLUTION *)vrna_realloc(buf->list, sizeof(SOLUTION) * buf->size);
   }
 
-  /* init env data structure */
-  env             = (subopt_env *)vrna_alloc(sizeof(subopt_env));
-  env->Stack      = NULL;
-  env->nopush     = true;
-  env->Stack      = make_list();                      /* anchor */
-  env->Intervals  = make_list();                      /* initial state: */
-  interval        = make_interval(1, length, 0);      /* interval [1,length,0] */
-  push(env->Intervals, interval);
-  env->nopush = false;
-  state       = make_state(env->Intervals, NULL, partial_energy, 0, length);
-  /* state->best_energy = minimal_energy; */
-  push(env->Stack, state);
-  env->nopush = false;
+  buf->list[buf->n].energy      = energy;
+  buf->list[buf->n++].structure = s;
+}
 
-  /* end initialize ------------------------------------------------------- */
 
+PRIVATE void
+buffer_flush(struct subopt_buffer *buf,
+             int                  cp,
+             vrna_subopt_callback *cb,
+             void                 *data)
+{
+  unsigned long i;
 
-  while (1) {
-    /* forever, til nothing remains on stack */
+  qsort(buf->list, buf->n, sizeof(SOLUTION), buf->compare);
 
-    maxlevel = (env->Stack->count > maxlevel ? env->Stack->count : maxlevel);
+  for (i = 0; i < buf->n; i++) {
+    char  *ss = (buf->packed) ? vrna_db_unpack(buf->list[i].structure) : buf->list[i].structure;
+    char  *s  = vrna_cut_point_insert(ss, cp);
+    cb((const char *)s, buf->list[i].energy, data);
+    free(s);
+    if (buf->packed)
+      free(ss);
 
-    if (LST_EMPTY(env->Stack)) {
-      /* we are done! clean up and quit */
-      /* fprintf(stderr, "maxlevel: %d\n", maxlevel); */
+    if ((buf->max) && (i + 1 == buf->n)) {
+      /* remember where the next pass has to continue */
+      free(buf->last);
+      buf->last = buf->list[i].structure;
+    } else {
+      free(buf->list[i].structure);
+    }
+  }
 
-      lst_kill(env->Stack, free_state_node);
+  buf->n = 0;
 
-      cb(NULL, 0, data);   /* NULL (last time to call callback function */
+  free(buf->bound);
+  buf->bound = NULL;
+}
 
-      break;
-    }
 
-    /* pop the last element ---------------------------------------------- */
+/* keep the smaller half of the stored structures, the larger one is dropped */
+PRIVATE void
+buffer_truncate(struct subopt_buffer *buf)
+{
+  unsigned long i, keep;
 
-    state = pop(env->Stack);                       /* current state to work with */
+  qsort(buf->list, buf->n, sizeof(SOLUTION), buf->compare);
 
-    if (LST_EMPTY(state->Intervals)) {
-      int e;
-      /* state has no intervals left: we got a solution */
+  keep = buf->n / 2;
 
-      count++;
-      structure         = get_structure(state);
-      structure_energy  = state->partial_energy / 100.;
+  free(buf->bound);
+  buf->bound = buf->list[keep].structure;
 
-#ifdef CHECK_ENERGY
-      structure_energy = vrna_eval_structure(vc, structure);
-
-      if (!logML)
-        if ((double)(state->partial_energy / 100.) != structure_energy) {
-          vrna_message_error("%s %6.2f %6.2f",
-                             structure,
-                             state->partial_energy / 100.,
-                             structure_energy);
-          exit(1);
-        }
+  for (i = keep + 1; i < buf->n; i++)
+    free(buf->list[i].structure);
 
-#endif
-      if (logML || (dangle_model == 1) || (dangle_model == 3)) /* recalc energy */
-        structure_energy = vrna_eval_structure(vc, structure);
+  buf->n        = keep;
+  buf->dropped  = 1;
+}
 
-      e = (int)((structure_energy - min_en) * 10. - correction); /* avoid rounding errors */
-      if (e > MAXDOS)
-        e = MAXDOS;
 
-      density_of_states[e]++;
-      if (structure_energy <= eprint) {
-        char *outstruct = vrna_cut_point_insert(structure, (vc->strands > 1) ? ss[so[1]] : -1);
-        cb((const char *)outstruct, structure_energy, data);
-        free(outstruct);
-      }
+PRIVATE void
+buffer_discard(struct subopt_buffer *buf)
+{
+  unsigned long i;
 
-      free(structure);
-    } else {
-      /* get (and remove) next interval of state to analyze */
+  for (i = 0; i < buf->n; i++)
+    free(buf->list[i].structure);
 
-      interval = pop(state->Intervals);
-      scan_interval(vc, interval->i, interval->j, interval->array_flag, threshold, state, env);
+  free(buf->list);
+  buf->list = NULL;
+  buf->size = buf->n = 0;
+}
 
-      free_interval_node(interval);        /* free the current interval */
-    }
 
-    free_state_node(state);                     /* free the current state */
-  } /* end of while (1) */
+/* remove the limit on the number of stored structures */
+PRIVATE void
+buffer_unbound(struct subopt_buffer *buf)
+{
+  free(buf->bound);
+  free(buf->last);
+  buf->bound    = NULL;
+  buf->last     = NULL;
+  buf->max      = 0;
+  buf->dropped  = 0;
+}
 
-  /* cleanup memory */
-  free(env);
+
+/* memory occupied by the buffered structures */
+PRIVATE size_t
+buffer_memory(struct subopt_buffer *buf)
+{
+  return buf->size * sizeof(SOLUTION) +
+         buf->n * buf->entry_size;
 }
 
 
@@ -1018,7 +2116,6 @@ scan_interval(vrna_fold_compound_t  *vc,
   /* array_flag = 3:  trace back in fM1-array */
 
   STATE         *new_state, *temp_state;
-  INTERVAL      *new_interval;
   vrna_param_t  *P;
   vrna_md_t     *md;
   register int  k, fi, cij, ij;
@@ -1084,7 +2181,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       state->partial_energy += f5[j];
 
     if (env->nopush) {
-      push_back(env->Stack, state);
+      push_back(env, state);
       env->nopush = false;
     }
 
@@ -1189,7 +2286,7 @@ scan_interval(vrna_fold_compound_t  *vc,
           element_energy = E_MLstem(0, -1, -1, P);
 
           if (fML[indx[k] + i] + ggg[indx[j] + k + 1] + element_energy + best_energy <= threshold) {
-            temp_state  = derive_new_state(i, k, state, 0, array_flag);
+            temp_state  = derive_new_state(i, k, state, 0, array_flag, env);
             env->nopush = false;
             repeat_gquad(vc,
                          k + 1,
@@ -1200,7 +2297,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                          best_energy,
                          threshold,
                          env);
-            free_state_node(temp_state);
+            free_state_node(env, temp_state);
           }
         }
 
@@ -1232,7 +2329,7 @@ scan_interval(vrna_fold_compound_t  *vc,
 
           if (sn[k] == sn[k + 1]) {
             if (fML[indx[k] + i] + c[k1j] + element_energy + best_energy <= threshold) {
-              temp_state  = derive_new_state(i, k, state, 0, array_flag);
+              temp_state  = derive_new_state(i, k, state, 0, array_flag, env);
               env->nopush = false;
               repeat(vc,
                      k + 1,
@@ -1243,7 +2340,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                      best_energy,
                      threshold,
                      env);
-              free_state_node(temp_state);
+              free_state_node(env, temp_state);
             }
           }
         }
@@ -1365,7 +2462,7 @@ scan_interval(vrna_fold_compound_t  *vc,
         element_energy = 0;
 
         if (f5[k - 1] + ggg[kj] + element_energy + best_energy <= threshold) {
-          temp_state  = derive_new_state(1, k - 1, state, 0, 0);
+          temp_state  = derive_new_state(1, k - 1, state, 0, 0, env);
           env->nopush = false;
           /* backtrace the quadruplex */
           repeat_gquad(vc,
@@ -1377,7 +2474,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                        best_energy,
                        threshold,
                        env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
 
@@ -1409,10 +2506,10 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
 
         if (f5[k - 1] + c[kj] + element_energy + best_energy <= threshold) {
-          temp_state  = derive_new_state(1, k - 1, state, 0, 0);
+          temp_state  = derive_new_state(1, k - 1, state, 0, 0, env);
           env->nopush = false;
           repeat(vc, k, j, temp_state, element_energy, f5[k - 1], best_energy, threshold, env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
     }
@@ -1477,9 +2574,9 @@ scan_interval(vrna_fold_compound_t  *vc,
       }
 
       if (tmp_en <= threshold) {
-        new_state                 = derive_new_state(1, 2, state, 0, 0);
+        new_state                 = derive_new_state(1, 2, state, 0, 0, env);
         new_state->partial_energy = 0;
-        push(env->Stack, new_state);
+        push_state(env, new_state);
         env->nopush = false;
       }
     }
@@ -1614,27 +2711,24 @@ scan_interval(vrna_fold_compound_t  *vc,
               if (tmpE2 + fML[indx[k] + 1] + P->MLclosing <= threshold) {
                 /* we've (hopefully) found a valid decomposition of fM2 and therefor we have all */
                 /* three intervals for our new state to be pushed on stack R */
-                new_state = copy_state(state);
+                new_state = copy_state(env, state);
 
                 /* first interval leads for search in fML array */
-                new_interval = make_interval(1, k, 1);
-                push(new_state->Intervals, new_interval);
+                push_interval(env, new_state, 1, k, 1);
                 env->nopush = false;
 
                 /* next, we have the first interval that has to be traced in fM1 */
-                new_interval = make_interval(k + 1, l, 3);
-                push(new_state->Intervals, new_interval);
+                push_interval(env, new_state, k + 1, l, 3);
                 env->nopush = false;
 
                 /* and the last of our three intervals is also one to be traced within fM1 array... */
-                new_interval = make_interval(l + 1, j, 3);
-                push(new_state->Intervals, new_interval);
+                push_interval(env, new_state, l + 1, j, 3);
                 env->nopush = false;
 
                 /* mmh, we add the energy for closing the multiloop now... */
                 new_state->partial_energy += P->MLclosing;
                 /* next we push our state onto the R stack */
-                push(env->Stack, new_state);
+                push_state(env, new_state);
                 env->nopush = false;
               }
 
@@ -1682,10 +2776,10 @@ scan_interval(vrna_fold_compound_t  *vc,
           (fc[k + 1] != INF) &&
           (ggg[ik] != INF)) {
         if (fc[k + 1] + ggg[ik] + best_energy <= threshold) {
-          temp_state  = derive_new_state(k + 1, j, state, 0, 4);
+          temp_state  = derive_new_state(k + 1, j, state, 0, 4, env);
           env->nopush = false;
           repeat_gquad(vc, i, k, temp_state, 0, fc[k + 1], best_energy, threshold, env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
 
@@ -1712,10 +2806,10 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
 
         if (fc[k + 1] + c[ik] + element_energy + best_energy <= threshold) {
-          temp_state  = derive_new_state(k + 1, j, state, 0, 4);
+          temp_state  = derive_new_state(k + 1, j, state, 0, 4, env);
           env->nopush = false;
           repeat(vc, i, k, temp_state, element_energy, fc[k + 1], best_energy, threshold, env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
     }
@@ -1786,10 +2880,10 @@ scan_interval(vrna_fold_compound_t  *vc,
           (fc[k - 1] != INF) &&
           (ggg[kj] != INF)) {
         if (fc[k - 1] + ggg[kj] + best_energy <= threshold) {
-          temp_state  = derive_new_state(i, k - 1, state, 0, 5);
+          temp_state  = derive_new_state(i, k - 1, state, 0, 5, env);
           env->nopush = false;
           repeat_gquad(vc, k, j, temp_state, 0, fc[k - 1], best_energy, threshold, env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
 
@@ -1817,10 +2911,10 @@ scan_interval(vrna_fold_compound_t  *vc,
         }
 
         if (fc[k - 1] + c[kj] + element_energy + best_energy <= threshold) {
-          temp_state  = derive_new_state(i, k - 1, state, 0, 5);
+          temp_state  = derive_new_state(i, k - 1, state, 0, 5, env);
           env->nopush = false;
           repeat(vc, k, j, temp_state, element_energy, fc[k - 1], best_energy, threshold, env);
-          free_state_node(temp_state);
+          free_state_node(env, temp_state);
         }
       }
     }
@@ -1867,7 +2961,7 @@ scan_interval(vrna_fold_compound_t  *vc,
   }
 
   if (env->nopush) {
-    push_back(env->Stack, state);
+    push_back(env, state);
     env->nopush = false;
   }
 
@@ -1921,14 +3015,14 @@ repeat_gquad(vrna_fold_compound_t *vc,
       get_gquad_pattern_exhaustive(S1, i, j, P, L, l, threshold - best_energy);
 
       for (cnt = 0; L[cnt] != -1; cnt++) {
-        new_state = copy_state(state);
+        new_state = copy_state(env, state);
 
-        make_gquad(i, L[cnt], &(l[3 * cnt]), new_state);
+        make_gquad(env, i, L[cnt], &(l[3 * cnt]), new_state);
         new_state->partial_energy += part_energy;
         new_state->partial_energy += element_energy;
         /* new_state->best_energy =
          * hairpin[unpaired] + element_energy + best_energy; */
-        push(env->Stack, new_state);
+        push_state(env, new_state);
         env->nopush = false;
       }
       free(L);
@@ -2034,14 +3128,14 @@ repeat(vrna_fold_compound_t *vc,
                 energy += sc->f(i, j, i + 1, j - 1, VRNA_DECOMP_PAIR_IL, sc->data);
             }
 
-            new_state = derive_new_state(i + 1, j - 1, state, part_energy + energy, 2);
-            make_pair(i, j, new_state);
-            make_pair(i + 1, j - 1, new_state);
+            new_state = derive_new_state(i + 1, j - 1, state, part_energy + energy, 2, env);
+            make_pair(env, i, j, new_state);
+            make_pair(env, i + 1, j - 1, new_state);
 
             /* new_state->best_energy = new + best_energy; */
-            push(env->Stack, new_state);
+            push_state(env, new_state);
             env->nopush = false;
-            if (i == 1 || state->structure[i - 2] != '(' || state->structure[j] != ')')
+            if (i == 1 || !is_pair(state, i - 1, j + 1))
               /* adding a stack is the only possible structure */
               return;
           }
@@ -2235,12 +3329,12 @@ repeat(vrna_fold_compound_t *vc,
                         + sc->energy_up[q[cnt] + 1][j - q[cnt] - 1];
           }
 
-          new_state = derive_new_state(p[cnt], q[cnt], state, tmp_en + part_energy, 6);
+          new_state = derive_new_state(p[cnt], q[cnt], state, tmp_en + part_energy, 6, env);
 
-          make_pair(i, j, new_state);
+          make_pair(env, i, j, new_state);
 
           /* new_state->best_energy = new + best_energy; */
-          push(env->Stack, new_state);
+          push_state(env, new_state);
           env->nopush = false;
         }
       }
@@ -2294,36 +3388,6 @@ old_subopt_store(const char *structure,
 }
 
 
-PRIVATE void
-old_subopt_store_compressed(const char *structure,
-                            float      energy,
-                            void       *data)
-{
-  struct old_subopt_dat *d = (struct old_subopt_dat *)data;
-
-  /* store solution */
-  if (d->n_sol + 1 == d->max_sol) {
-    d->max_sol      *= 2;
-    d->SolutionList = (SOLUTION *)vrna_realloc(d->SolutionList, d->max_sol * sizeof(SOLUTION));
-  }
-
-  if (structure) {
-    d->SolutionList[d->n_sol].energy      = energy;
-    if (d->cp > 0) {
-      int   cp = d->cp;
-      char  *s = vrna_cut_point_remove(structure, &cp);
-      d->SolutionList[d->n_sol++].structure = vrna_db_pack(s);
-      free(s);
-    } else { 
-      d->SolutionList[d->n_sol++].structure = vrna_db_pack(structure);
-    }
-  } else {
-    d->SolutionList[d->n_sol].energy      = 0;
-    d->SolutionList[d->n_sol++].structure = NULL;
-  }
-}
-
-
 /*###########################################*/
 /*# deprecated functions below              #*/
 /*###########################################*/
@@ -152,6 +152,14 @@ vrna_subopt(vrna_fold_compound_t *vc,
   vrna_fold_compound_t *vc=vrna_fold_compound("GGGGGGAAAAAACCCCCC", &md, VRNA_OPTION_DEFAULT);
  *        @endcode
  *
+ *  @note If #vrna_md_t.threads of the fold compound is larger than 1, the
+ *        search tree is distributed among several threads. Every structure is
+ *        still reported exactly once, and the callback is never executed by
+ *        two threads at the same time, i.e. it doesn't need to be thread-safe.
+ *        However, the order of the structures then differs from the
+ *        single-threaded order and may change from one run to another. Use
+ *        vrna_subopt_sorted_cb() if a well-defined order is required.
+ *
  *  @see vrna_subopt_callback, vrna_subopt(), vrna_subopt_zuker()
  *  @param  vc      fold compount with the sequence data
  *  @param  delta   Energy band arround the MFE in 10cal/mol, i.e. deka-calories
@@ -164,6 +172,58 @@ vrna_subopt_cb( vrna_fold_compound_t *vc,
                 vrna_subopt_callback *cb,
                 void *data);
 
+
+/**
+ *  @brief  Generate suboptimal structures within an energy band arround the MFE in ascending order of their free energy
+ *
+ *  Same as vrna_subopt_cb(), but the callback receives the structures sorted
+ *  according to @p sorted.
+ *
+ *  If @p max_memory is 0, all structures are collected and sorted before they are
+ *  passed to the callback, just like for vrna_subopt(). With #vrna_md_t.threads
+ *  larger than 1, the search tree is then distributed among several threads, and
+ *  the output is identical to the single-threaded one, apart from the order of
+ *  structures with equal free energy for #VRNA_SORT_BY_ENERGY_ASC.
+ *
+ *  Otherwise, the backtracking states are processed in best-first order of the
+ *  lowest free energy they can still attain. Structures are then passed to the
+ *  callback as soon as no structure of lower free energy can follow, and only
+ *  structures of equal free energy are kept in memory for lexicographic ordering.
+ *  Should the pending states and these structures exceed @p max_memory bytes, the
+ *  energy band is split into consecutive windows that are enumerated one after
+ *  another, where every further window requires another pass through the search
+ *  tree. A single energy level that exceeds the budget on its own is enumerated
+ *  depth-first instead, in as many passes as batches of its structures fit into
+ *  the budget for lexicographic ordering. This is only
+ *  advisable if the structures of the energy band don't fit into memory, since
+ *  collecting and sorting is usually considerably faster. Best-first enumeration
+ *  always uses a single thread, regardless of #vrna_md_t.threads.
+ *
+ *  @ingroup subopt_wuchty
+ *
+ *  @note If the free energies of the structures are re-evaluated after backtracking,
+ *        i.e. for logarithmic multiloop energies (#vrna_md_t.logML) or dangle models
+ *        1 and 3, or if lonely pairs are prohibited (#vrna_md_t.noLP), the memory
+ *        budget can't be honoured. This function then issues a warning and collects
+ *        all structures before sorting them.
+ *
+ *  @see vrna_subopt_cb(), vrna_subopt(), #VRNA_SORT_BY_ENERGY_ASC, #VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC
+ *  @param  vc          fold compount with the sequence data
+ *  @param  delta       Energy band arround the MFE in 10cal/mol, i.e. deka-calories
+ *  @param  sorted      Sort order of the structures, or #VRNA_UNSORTED to behave exactly like vrna_subopt_cb()
+ *  @param  max_memory  Memory budget of the pending backtracking states and buffered structures in bytes, or 0 to collect all structures before sorting
+ *  @param  cb          Pointer to a callback function that handles the backtracked structure and its free energy in kcal/mol
+ *  @param  data        Pointer to some data structure that is passed along to the callback
+ */
+void
+vrna_subopt_sorted_cb(vrna_fold_compound_t  *vc,
+                      int                   delta,
+                      int                   sorted,
+                      size_t                max_memory,
+                      vrna_subopt_callback  *cb,
+                      void                  *data);
+
+
 /**
  *  @brief Compute Zuker type suboptimal structures
  *
@@ -8,6 +8,7 @@
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/cpu.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 typedef int (proto_fun_zip_reduce)(const int  *a,
@@ -15,6 +16,23 @@ typedef int (proto_fun_zip_reduce)(const int  *a,
                                    int        size);
 
 
+typedef int (proto_fun_zip_reduce_idx)(const int  *a,
+                                       const int  *b,
+                                       int        size,
+                                       int        *idx);
+
+
+typedef int (proto_fun_zip_reduce_masked)(const int           *a,
+                                          const int           *b,
+                                          const unsigned char *mask,
+                                          int                 size);
+
+
+typedef FLT_OR_DBL (proto_fun_zip_mult_sum)(const FLT_OR_DBL  *a,
+                                            const FLT_OR_DBL  *b,
+                                            int               size);
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -25,12 +43,60 @@ static int zip_add_min_dispatcher(const int *a,
                                   int       size);
 
 
+static int zip_add_min_idx_dispatcher(const int *a,
+                                      const int *b,
+                                      int       size,
+                                      int       *idx);
+
+
+static int zip_add_min_masked_dispatcher(const int            *a,
+                                         const int            *b,
+                                         const unsigned char  *mask,
+                                         int                  size);
+
+
+static FLT_OR_DBL zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                                          const FLT_OR_DBL  *b,
+                                          int               size);
+
+
+static FLT_OR_DBL zip_mult_sum_rev_dispatcher(const FLT_OR_DBL  *a,
+                                              const FLT_OR_DBL  *b,
+                                              int               size);
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
                         int       count);
 
 
+static int
+fun_zip_add_min_idx_default(const int *e1,
+                            const int *e2,
+                            int       count,
+                            int       *idx);
+
+
+static int
+fun_zip_add_min_masked_default(const int            *e1,
+                               const int            *e2,
+                               const unsigned char  *mask,
+                               int                  count);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
 #if VRNA_WITH_SIMD_AVX512
 int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -38,6 +104,67 @@ vrna_fun_zip_add_min_avx512(const int *e1,
                             int       count);
 
 
+int
+vrna_fun_zip_add_min_idx_avx512(const int *e1,
+                                const int *e2,
+                                int       count,
+                                int       *idx);
+
+
+int
+vrna_fun_zip_add_min_masked_avx512(const int            *e1,
+                                   const int            *e2,
+                                   const unsigned char  *mask,
+                                   int                  count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count);
+
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count);
+
+
+int
+vrna_fun_zip_add_min_idx_avx2(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *idx);
+
+
+int
+vrna_fun_zip_add_min_masked_avx2(const int            *e1,
+                                 const int            *e2,
+                                 const unsigned char  *mask,
+                                 int                  count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count);
+
+
 #endif
 
 #if VRNA_WITH_SIMD_SSE41
@@ -47,10 +174,28 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
                            int        count);
 
 
+int
+vrna_fun_zip_add_min_idx_sse41(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *idx);
+
+
+int
+vrna_fun_zip_add_min_masked_sse41(const int           *e1,
+                                  const int           *e2,
+                                  const unsigned char *mask,
+                                  int                 count);
+
+
 #endif
 
 
-static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce         *fun_zip_add_min        = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce_idx     *fun_zip_add_min_idx    = &zip_add_min_idx_dispatcher;
+static proto_fun_zip_reduce_masked  *fun_zip_add_min_masked = &zip_add_min_masked_dispatcher;
+static proto_fun_zip_mult_sum       *fun_zip_mult_sum       = &zip_mult_sum_dispatcher;
+static proto_fun_zip_mult_sum       *fun_zip_mult_sum_rev   = &zip_mult_sum_rev_dispatcher;
 
 
 /*
@@ -61,14 +206,22 @@ static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
 PUBLIC void
 vrna_fun_dispatch_disable(void)
 {
-  fun_zip_add_min = &fun_zip_add_min_default;
+  fun_zip_add_min         = &fun_zip_add_min_default;
+  fun_zip_add_min_idx     = &fun_zip_add_min_idx_default;
+  fun_zip_add_min_masked  = &fun_zip_add_min_masked_default;
+  fun_zip_mult_sum        = &fun_zip_mult_sum_default;
+  fun_zip_mult_sum_rev    = &fun_zip_mult_sum_rev_default;
 }
 
 
 PUBLIC void
 vrna_fun_dispatch_enable(void)
 {
-  fun_zip_add_min = &zip_add_min_dispatcher;
+  fun_zip_add_min         = &zip_add_min_dispatcher;
+  fun_zip_add_min_idx     = &zip_add_min_idx_dispatcher;
+  fun_zip_add_min_masked  = &zip_add_min_masked_dispatcher;
+  fun_zip_mult_sum        = &zip_mult_sum_dispatcher;
+  fun_zip_mult_sum_rev    = &zip_mult_sum_rev_dispatcher;
 }
 
 
@@ -81,6 +234,44 @@ vrna_fun_zip_add_min(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_idx(const int  *e1,
+                         const int  *e2,
+                         int        count,
+                         int        *idx)
+{
+  return (*fun_zip_add_min_idx)(e1, e2, count, idx);
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_masked(const int           *e1,
+                            const int           *e2,
+                            const unsigned char *mask,
+                            int                 count)
+{
+  return (*fun_zip_add_min_masked)(e1, e2, mask, count);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count)
+{
+  return (*fun_zip_mult_sum)(e1, e2, count);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count)
+{
+  return (*fun_zip_mult_sum_rev)(e1, e2, count);
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -103,6 +294,14 @@ zip_add_min_dispatcher(const int  *a,
 
 #endif
 
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min = &vrna_fun_zip_add_min_avx2;
+    goto exec_fun_zip_add_min;
+  }
+
+#endif
+
 #if VRNA_WITH_SIMD_SSE41
   if (features & VRNA_CPU_SIMD_SSE41) {
     fun_zip_add_min = &vrna_fun_zip_add_min_sse41;
@@ -119,6 +318,152 @@ exec_fun_zip_add_min:
 }
 
 
+/* zip_add_min_idx() dispatcher */
+static int
+zip_add_min_idx_dispatcher(const int  *a,
+                           const int  *b,
+                           int        size,
+                           int        *idx)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_avx512;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_avx2;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_min_idx = &vrna_fun_zip_add_min_idx_sse41;
+    goto exec_fun_zip_add_min_idx;
+  }
+
+#endif
+
+  fun_zip_add_min_idx = &fun_zip_add_min_idx_default;
+
+exec_fun_zip_add_min_idx:
+
+  return (*fun_zip_add_min_idx)(a, b, size, idx);
+}
+
+
+/* zip_add_min_masked() dispatcher */
+static int
+zip_add_min_masked_dispatcher(const int           *a,
+                              const int           *b,
+                              const unsigned char *mask,
+                              int                 size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_add_min_masked = &vrna_fun_zip_add_min_masked_avx512;
+    goto exec_fun_zip_add_min_masked;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min_masked = &vrna_fun_zip_add_min_masked_avx2;
+    goto exec_fun_zip_add_min_masked;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_min_masked = &vrna_fun_zip_add_min_masked_sse41;
+    goto exec_fun_zip_add_min_masked;
+  }
+
+#endif
+
+  fun_zip_add_min_masked = &fun_zip_add_min_masked_default;
+
+exec_fun_zip_add_min_masked:
+
+  return (*fun_zip_add_min_masked)(a, b, mask, size);
+}
+
+
+/* zip_mult_sum() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                        const FLT_OR_DBL  *b,
+                        int               size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx512;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx2;
+    goto exec_fun_zip_mult_sum;
+  }
+
+#endif
+
+  fun_zip_mult_sum = &fun_zip_mult_sum_default;
+
+exec_fun_zip_mult_sum:
+
+  return (*fun_zip_mult_sum)(a, b, size);
+}
+
+
+/* zip_mult_sum_rev() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_rev_dispatcher(const FLT_OR_DBL  *a,
+                            const FLT_OR_DBL  *b,
+                            int               size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx512;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_mult_sum_rev = &vrna_fun_zip_mult_sum_rev_avx2;
+    goto exec_fun_zip_mult_sum_rev;
+  }
+
+#endif
+
+  fun_zip_mult_sum_rev = &fun_zip_mult_sum_rev_default;
+
+exec_fun_zip_mult_sum_rev:
+
+  return (*fun_zip_mult_sum_rev)(a, b, size);
+}
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
@@ -136,3 +481,78 @@ fun_zip_add_min_default(const int *e1,
 
   return decomp;
 }
+
+
+static int
+fun_zip_add_min_idx_default(const int *e1,
+                            const int *e2,
+                            int       count,
+                            int       *idx)
+{
+  int i;
+  int decomp = INF;
+
+  *idx = -1;
+
+  for (i = 0; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        *idx    = i;
+      }
+    }
+  }
+
+  return decomp;
+}
+
+
+static int
+fun_zip_add_min_masked_default(const int            *e1,
+                               const int            *e2,
+                               const unsigned char  *mask,
+                               int                  count)
+{
+  int i;
+  int decomp = INF;
+
+  for (i = 0; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_rev_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum = 0.;
+
+  for (i = 0; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
@@ -1,6 +1,8 @@
 #ifndef VIENNA_RNA_PACKAGE_UTILS_FUN_H
 #define VIENNA_RNA_PACKAGE_UTILS_FUN_H
 
+#include <ViennaRNA/datastructures/basic.h>
+
 void
 vrna_fun_dispatch_disable(void);
 
@@ -15,4 +17,56 @@ vrna_fun_zip_add_min(const int  *e1,
                      int        count);
 
 
+/**
+ *  @brief  Same as vrna_fun_zip_add_min() but also report the position of the minimum
+ *
+ *  Stores the first index @f$ k @f$ with @f$ e1[k] + e2[k] @f$ being minimal in @p idx,
+ *  or -1 if all pairs contain an INF entry.
+ */
+int
+vrna_fun_zip_add_min_idx(const int  *e1,
+                         const int  *e2,
+                         int        count,
+                         int        *idx);
+
+
+/**
+ *  @brief  Same as vrna_fun_zip_add_min() but skip all positions @f$ k @f$ with @f$ mask[k] = 0 @f$
+ */
+int
+vrna_fun_zip_add_min_masked(const int           *e1,
+                            const int           *e2,
+                            const unsigned char *mask,
+                            int                 count);
+
+
+/**
+ *  @brief  Compute the sum of products @f$ \sum_k e1[k] \cdot e2[k] @f$
+ *
+ *  @note   The vectorized implementations use a different summation order than the
+ *          scalar fallback, results may therefore differ in the last digits.
+ */
+FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count);
+
+
+/**
+ *  @brief  Compute the sum of products @f$ \sum_k e1[k] \cdot e2[count - 1 - k] @f$
+ *
+ *  This is the same as vrna_fun_zip_mult_sum() but with the second array traversed
+ *  in reverse order. It is the inner product that appears in partition function
+ *  decompositions where one of the matrices is stored with a decreasing index, e.g.
+ *  @f$ \sum_k Q^M_{i,k-1} \cdot Q^{M1}_{k,j} @f$ with the @p iindx layout.
+ *
+ *  @note   The vectorized implementations use a different summation order than the
+ *          scalar fallback, results may therefore differ in the last digits.
+ */
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count);
+
+
 #endif
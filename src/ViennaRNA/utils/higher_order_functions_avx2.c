@@ -0,0 +1,254 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+static INLINE int
+horizontal_min_Vec8i(__m256i x);
+
+
+static INLINE __m256i
+zip_add_Vec8i(const int *e1,
+              const int *e2,
+              __m256i   inf);
+
+
+static INLINE __m256i
+load_mask_Vec8i(const unsigned char *mask);
+
+
+PUBLIC int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count)
+{
+  int     i, decomp;
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i vmin  = inf;
+
+  for (i = 0; i < count - 7; i += 8)
+    vmin = _mm256_min_epi32(vmin, zip_add_Vec8i(e1 + i, e2 + i, inf));
+
+  decomp = horizontal_min_Vec8i(vmin);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_idx_avx2(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *idx)
+{
+  int     i, decomp;
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i vmin;
+
+  decomp  = vrna_fun_zip_add_min_avx2(e1, e2, count);
+  *idx    = -1;
+
+  if (decomp == INF)
+    return decomp;
+
+  /* find the first position that attains the minimum */
+  vmin = _mm256_set1_epi32(decomp);
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i hit   = _mm256_cmpeq_epi32(zip_add_Vec8i(e1 + i, e2 + i, inf), vmin);
+    int     bits  = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+
+    if (bits) {
+      *idx = i + __builtin_ctz(bits);
+      return decomp;
+    }
+  }
+
+  for (; i < count; i++)
+    if ((e1[i] != INF) && (e2[i] != INF) && (e1[i] + e2[i] == decomp)) {
+      *idx = i;
+      break;
+    }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_masked_avx2(const int            *e1,
+                                 const int            *e2,
+                                 const unsigned char  *mask,
+                                 int                  count)
+{
+  int     i, decomp;
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i vmin  = inf;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i c = zip_add_Vec8i(e1 + i, e2 + i, inf);
+
+    /* replace all values by INF that are prohibited by the mask */
+    vmin = _mm256_min_epi32(vmin, _mm256_blendv_epi8(inf, c, load_mask_Vec8i(mask + i)));
+  }
+
+  decomp = horizontal_min_Vec8i(vmin);
+
+  for (; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m256  vsum = _mm256_setzero_ps();
+  __m128  lo;
+
+  for (i = 0; i < count - 7; i += 8)
+    vsum = _mm256_add_ps(vsum,
+                         _mm256_mul_ps(_mm256_loadu_ps(e1 + i),
+                                       _mm256_loadu_ps(e2 + i)));
+
+  lo  = _mm_add_ps(_mm256_castps256_ps128(vsum), _mm256_extractf128_ps(vsum, 1));
+  lo  = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+  lo  = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+  sum = _mm_cvtss_f32(lo);
+#else
+  __m256d vsum = _mm256_setzero_pd();
+  __m128d lo;
+
+  for (i = 0; i < count - 3; i += 4)
+    vsum = _mm256_add_pd(vsum,
+                         _mm256_mul_pd(_mm256_loadu_pd(e1 + i),
+                                       _mm256_loadu_pd(e2 + i)));
+
+  lo  = _mm_add_pd(_mm256_castpd256_pd128(vsum), _mm256_extractf128_pd(vsum, 1));
+  lo  = _mm_add_sd(lo, _mm_unpackhi_pd(lo, lo));
+  sum = _mm_cvtsd_f64(lo);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m256i rev   = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256  vsum  = _mm256_setzero_ps();
+  __m128  lo;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256 b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(e2 + count - 8 - i), rev);
+    vsum = _mm256_add_ps(vsum,
+                         _mm256_mul_ps(_mm256_loadu_ps(e1 + i), b));
+  }
+
+  lo  = _mm_add_ps(_mm256_castps256_ps128(vsum), _mm256_extractf128_ps(vsum, 1));
+  lo  = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+  lo  = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+  sum = _mm_cvtss_f32(lo);
+#else
+  __m256d vsum = _mm256_setzero_pd();
+  __m128d lo;
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m256d b = _mm256_permute4x64_pd(_mm256_loadu_pd(e2 + count - 4 - i),
+                                      _MM_SHUFFLE(0, 1, 2, 3));
+    vsum = _mm256_add_pd(vsum,
+                         _mm256_mul_pd(_mm256_loadu_pd(e1 + i), b));
+  }
+
+  lo  = _mm_add_pd(_mm256_castpd256_pd128(vsum), _mm256_extractf128_pd(vsum, 1));
+  lo  = _mm_add_sd(lo, _mm_unpackhi_pd(lo, lo));
+  sum = _mm_cvtsd_f64(lo);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
+
+
+/* add two vectors of energies, positions where any of them is INF will be INF */
+static INLINE __m256i
+zip_add_Vec8i(const int *e1,
+              const int *e2,
+              __m256i   inf)
+{
+  __m256i a = _mm256_loadu_si256((__m256i *)e1);
+  __m256i b = _mm256_loadu_si256((__m256i *)e2);
+  __m256i c = _mm256_add_epi32(a, b);
+
+  /* create mask for non-INF values */
+  __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                  _mm256_cmpgt_epi32(inf, b));
+
+  return _mm256_blendv_epi8(inf, c, mask);
+}
+
+
+/* expand 8 mask bytes into a vector of 32-bit lanes that are all ones for non-zero bytes */
+static INLINE __m256i
+load_mask_Vec8i(const unsigned char *mask)
+{
+  __m256i zero  = _mm256_setzero_si256();
+  __m256i m     = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)mask));
+
+  return _mm256_xor_si256(_mm256_cmpeq_epi32(m, zero),
+                          _mm256_cmpeq_epi32(zero, zero));
+}
+
+
+static INLINE int
+horizontal_min_Vec8i(__m256i x)
+{
+  __m128i min1  = _mm_min_epi32(_mm256_castsi256_si128(x),
+                                _mm256_extracti128_si256(x, 1));
+  __m128i min2  = _mm_min_epi32(min1, _mm_shuffle_epi32(min1, _MM_SHUFFLE(0, 0, 3, 2)));
+  __m128i min3  = _mm_min_epi32(min2, _mm_shuffle_epi32(min2, _MM_SHUFFLE(0, 0, 0, 1)));
+
+  return _mm_cvtsi128_si32(min3);
+}
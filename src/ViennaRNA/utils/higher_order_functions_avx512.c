@@ -48,3 +48,156 @@ vrna_fun_zip_add_min_avx512(const int *e1,
 
   return decomp;
 }
+
+
+PUBLIC int
+vrna_fun_zip_add_min_idx_avx512(const int *e1,
+                                const int *e2,
+                                int       count,
+                                int       *idx)
+{
+  int     i, decomp;
+  __m512i inf = _mm512_set1_epi32(INF);
+  __m512i vmin;
+
+  decomp  = vrna_fun_zip_add_min_avx512(e1, e2, count);
+  *idx    = -1;
+
+  if (decomp == INF)
+    return decomp;
+
+  /* find the first position that attains the minimum */
+  vmin = _mm512_set1_epi32(decomp);
+
+  for (i = 0; i < count - 15; i += 16) {
+    __m512i   a = _mm512_loadu_si512((__m512i *)&e1[i]);
+    __m512i   b = _mm512_loadu_si512((__m512i *)&e2[i]);
+    __mmask16 mask = _kand_mask16(_mm512_cmplt_epi32_mask(a, inf),
+                                  _mm512_cmplt_epi32_mask(b, inf));
+    __mmask16 hit = _mm512_mask_cmpeq_epi32_mask(mask, _mm512_add_epi32(a, b), vmin);
+
+    if (hit) {
+      *idx = i + __builtin_ctz((unsigned int)hit);
+      return decomp;
+    }
+  }
+
+  for (; i < count; i++)
+    if ((e1[i] != INF) && (e2[i] != INF) && (e1[i] + e2[i] == decomp)) {
+      *idx = i;
+      break;
+    }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_masked_avx512(const int            *e1,
+                                   const int            *e2,
+                                   const unsigned char  *mask,
+                                   int                  count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m512i inf = _mm512_set1_epi32(INF);
+
+  for (i = 0; i < count - 15; i += 16) {
+    __m512i   a = _mm512_loadu_si512((__m512i *)&e1[i]);
+    __m512i   b = _mm512_loadu_si512((__m512i *)&e2[i]);
+    __m512i   m = _mm512_cvtepu8_epi32(_mm_loadu_si128((__m128i *)&mask[i]));
+
+    /* compute mask for allowed entries where both, a and b, are less than INF */
+    __mmask16 k = _kand_mask16(_mm512_test_epi32_mask(m, m),
+                               _kand_mask16(_mm512_cmplt_epi32_mask(a, inf),
+                                            _mm512_cmplt_epi32_mask(b, inf)));
+
+    const int en = _mm512_mask_reduce_min_epi32(k, _mm512_add_epi32(a, b));
+
+    decomp = MIN2(decomp, en);
+  }
+
+  for (; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m512 vsum = _mm512_setzero_ps();
+
+  for (i = 0; i < count - 15; i += 16)
+    vsum = _mm512_add_ps(vsum,
+                         _mm512_mul_ps(_mm512_loadu_ps(e1 + i),
+                                       _mm512_loadu_ps(e2 + i)));
+
+  sum = _mm512_reduce_add_ps(vsum);
+#else
+  __m512d vsum = _mm512_setzero_pd();
+
+  for (i = 0; i < count - 7; i += 8)
+    vsum = _mm512_add_pd(vsum,
+                         _mm512_mul_pd(_mm512_loadu_pd(e1 + i),
+                                       _mm512_loadu_pd(e2 + i)));
+
+  sum = _mm512_reduce_add_pd(vsum);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[i];
+
+  return sum;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *e1,
+                                 const FLT_OR_DBL *e2,
+                                 int              count)
+{
+  int         i;
+  FLT_OR_DBL  sum;
+
+#ifdef USE_FLOAT_PF
+  __m512i rev   = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m512  vsum  = _mm512_setzero_ps();
+
+  for (i = 0; i < count - 15; i += 16) {
+    __m512 b = _mm512_permutexvar_ps(rev, _mm512_loadu_ps(e2 + count - 16 - i));
+    vsum = _mm512_add_ps(vsum,
+                         _mm512_mul_ps(_mm512_loadu_ps(e1 + i), b));
+  }
+
+  sum = _mm512_reduce_add_ps(vsum);
+#else
+  __m512i rev   = _mm512_set_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+  __m512d vsum  = _mm512_setzero_pd();
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m512d b = _mm512_permutexvar_pd(rev, _mm512_loadu_pd(e2 + count - 8 - i));
+    vsum = _mm512_add_pd(vsum,
+                         _mm512_mul_pd(_mm512_loadu_pd(e1 + i), b));
+  }
+
+  sum = _mm512_reduce_add_pd(vsum);
+#endif
+
+  for (; i < count; i++)
+    sum += e1[i] * e2[count - 1 - i];
+
+  return sum;
+}
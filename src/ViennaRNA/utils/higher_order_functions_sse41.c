@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "ViennaRNA/utils/basic.h"
@@ -11,10 +12,26 @@
 #include <emmintrin.h>
 #include <smmintrin.h>
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
 static int
 horizontal_min_Vec4i(__m128i x);
 
 
+static INLINE __m128i
+zip_add_Vec4i(const int *e1,
+              const int *e2,
+              __m128i   inf);
+
+
+static INLINE __m128i
+load_mask_Vec4i(const unsigned char *mask);
+
+
 PUBLIC int
 vrna_fun_zip_add_min_sse41(const int  *e1,
                            const int  *e2,
@@ -55,6 +72,119 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_idx_sse41(const int  *e1,
+                               const int  *e2,
+                               int        count,
+                               int        *idx)
+{
+  int     i, decomp;
+  __m128i inf   = _mm_set1_epi32(INF);
+  __m128i vmin  = inf;
+
+  /* 1st pass, find the minimum */
+  for (i = 0; i < count - 3; i += 4)
+    vmin = _mm_min_epi32(vmin, zip_add_Vec4i(e1 + i, e2 + i, inf));
+
+  decomp = horizontal_min_Vec4i(vmin);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  *idx = -1;
+
+  if (decomp == INF)
+    return decomp;
+
+  /* 2nd pass, find the first position that attains the minimum */
+  vmin = _mm_set1_epi32(decomp);
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i hit   = _mm_cmpeq_epi32(zip_add_Vec4i(e1 + i, e2 + i, inf), vmin);
+    int     bits  = _mm_movemask_ps(_mm_castsi128_ps(hit));
+
+    if (bits) {
+      *idx = i + __builtin_ctz(bits);
+      return decomp;
+    }
+  }
+
+  for (; i < count; i++)
+    if ((e1[i] != INF) && (e2[i] != INF) && (e1[i] + e2[i] == decomp)) {
+      *idx = i;
+      break;
+    }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_masked_sse41(const int           *e1,
+                                  const int           *e2,
+                                  const unsigned char *mask,
+                                  int                 count)
+{
+  int     i, decomp;
+  __m128i inf   = _mm_set1_epi32(INF);
+  __m128i vmin  = inf;
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i c = zip_add_Vec4i(e1 + i, e2 + i, inf);
+
+    /* replace all values by INF that are prohibited by the mask */
+    vmin = _mm_min_epi32(vmin, _mm_blendv_epi8(inf, c, load_mask_Vec4i(mask + i)));
+  }
+
+  decomp = horizontal_min_Vec4i(vmin);
+
+  for (; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+/* add two vectors of energies, positions where any of them is INF will be INF */
+static INLINE __m128i
+zip_add_Vec4i(const int *e1,
+              const int *e2,
+              __m128i   inf)
+{
+  __m128i a = _mm_loadu_si128((__m128i *)e1);
+  __m128i b = _mm_loadu_si128((__m128i *)e2);
+  __m128i c = _mm_add_epi32(a, b);
+
+  /* create mask for non-INF values */
+  __m128i mask = _mm_and_si128(_mm_cmplt_epi32(a, inf),
+                               _mm_cmplt_epi32(b, inf));
+
+  return _mm_blendv_epi8(inf, c, mask);
+}
+
+
+/* expand 4 mask bytes into a vector of 32-bit lanes that are all ones for non-zero bytes */
+static INLINE __m128i
+load_mask_Vec4i(const unsigned char *mask)
+{
+  int     m;
+  __m128i zero = _mm_setzero_si128();
+
+  memcpy(&m, mask, sizeof(int));
+
+  return _mm_xor_si128(_mm_cmpeq_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(m)), zero),
+                       _mm_cmpeq_epi32(zero, zero));
+}
+
+
 /*
  *  SSE minimum
  *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
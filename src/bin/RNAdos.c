@@ -6,6 +6,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/structures.h"
@@ -18,235 +19,219 @@
 #include "ViennaRNA/mfe.h"
 #include "ViennaRNA/file_utils.h"
 #include "ViennaRNA/io/file_formats.h"
-#include "ViennaRNA/datastructures/hash_tables.h"
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "RNAdos_cmdl.h"
 
 
-typedef struct key_value_ {
-  int key;
-  int value;
-} key_value;
-
-static unsigned
-hash_function_dos(void          *hash_entry,
-                  unsigned long hashtable_size)
-{
-  key_value     *hem  = ((key_value *)hash_entry);
-  unsigned long c     = (unsigned long)hem->key;
+/*
+ *  Number of structures per energy (in dcal/mol) for a single cell of the
+ *  dynamic programming matrices. Counts are stored densely for the energy
+ *  band [e_min, e_min + size), where e_min is the minimum free energy of the
+ *  cell. A band of size 0 denotes an empty cell.
+ */
+typedef struct {
+  int     e_min;
+  int     size;
+  double  *count;
+} energy_band;
+
+/* a dynamic programming matrix, i.e. C, M, M1, or the exterior loop A */
+typedef struct {
+  int         *e_inside;  /* minimum free energy of the cell */
+  int         *e_outside; /* minimum free energy of the remainder of any structure using the cell */
+  energy_band *bands;     /* structure counts */
+} dp_matrix;
+
+enum dp_mode {
+  DP_INSIDE,
+  DP_OUTSIDE,
+  DP_COUNT
+};
 
-  return c % hashtable_size;
-}
+struct dp_counts_per_energy {
+  dp_matrix     n_ij_e;
+  dp_matrix     n_ij_A_e;
+  dp_matrix     n_ij_M_e;
+  dp_matrix     n_ij_M1_e;
+  enum dp_mode  mode;
+};
 
 
-/***
- * 0 is equal, 1 is different!
- */
-static int
-hash_comparison_dos(void  *x,
-                    void  *y)
+static void
+band_init(energy_band *band,
+          int         e_min,
+          int         size)
 {
-  key_value *hem_x  = ((key_value *)x);
-  key_value *hem_y  = ((key_value *)y);
-
-  if ((x == NULL) ^ (y == NULL))
-    return 1;
-
-  return !(hem_x->key == hem_y->key);
+  band->e_min = e_min;
+  band->size  = MAX2(size, 0);
+  band->count = (size > 0) ? (double *)vrna_alloc(sizeof(double) * size) : NULL;
 }
 
 
-static int
-free_hash_entry_dos(void *hash_entry)
+static void
+band_free(energy_band *band)
 {
-  /*
-   * if (hash_entry != NULL) {
-   * key_value *hem_x = ((key_value *) hash_entry);
-   * free (hem_x);
-   * }
-   */
-  return 0;
+  free(band->count);
+  band->count = NULL;
+  band->size  = 0;
 }
 
 
-static vrna_hash_table_t
-create_hashtable(int hashbits)
+/* drop empty bins at the upper end of the band to keep the memory footprint small */
+static void
+band_trim(energy_band *band)
 {
-  vrna_callback_ht_free_entry       *my_free          = free_hash_entry_dos;
-  vrna_callback_ht_compare_entries  *my_comparison    = hash_comparison_dos;
-  vrna_callback_ht_hash_function    *my_hash_function = hash_function_dos;
-  vrna_hash_table_t                 ht                = vrna_ht_init(hashbits,
-                                                                     my_comparison,
-                                                                     my_hash_function,
-                                                                     my_free);
-
-  return ht;
-}
+  int size = band->size;
 
+  while ((size > 0) && (band->count[size - 1] == 0.))
+    size--;
 
-typedef struct energy_count_ {
-  int     energy;
-  double  count;
-} energy_count;
+  if (size == 0)
+    band_free(band);
+  else if (size < band->size)
+    band->count = (double *)vrna_realloc(band->count, sizeof(double) * size);
 
-typedef struct hashtable_list_ {
-  unsigned long     length;
-  unsigned long     allocated_size;
-  energy_count      *list_energy_count_pairs;
-  key_value         **list_key_value_pairs;
-  vrna_hash_table_t ht_energy_index; // lookup table;
-} hashtable_list;
+  band->size = size;
+}
 
-struct dp_counts_per_energy {
-  hashtable_list  *n_ij_e;
-  hashtable_list  *n_ij_A_e;
-  hashtable_list  *n_ij_M_e;
-  hashtable_list  *n_ij_M1_e;
-};
 
-static hashtable_list
-create_hashtable_list(int hashbits)
+/* add all counts of source, shifted by energy, to result */
+static INLINE void
+band_add_shifted(energy_band        *result,
+                 const energy_band  *source,
+                 int                energy)
 {
-  hashtable_list ht_list;
-
-  ht_list.allocated_size          = 10;
-  ht_list.length                  = 0;
-  ht_list.list_energy_count_pairs = vrna_alloc(sizeof(energy_count) * ht_list.allocated_size);
-  ht_list.list_key_value_pairs    = vrna_alloc(sizeof(key_value *) * ht_list.allocated_size);
-  ht_list.ht_energy_index         = create_hashtable(hashbits);
-  return ht_list;
+  int     k, k_min, k_max, offset;
+  double  *r;
+
+  offset  = source->e_min + energy - result->e_min;
+  k_min   = MAX2(0, -offset);
+  k_max   = MIN2(source->size, result->size - offset);
+  r       = result->count + offset;
+
+  for (k = k_min; k < k_max; k++)
+    r[k] += source->count[k];
 }
 
 
-static
-void
-free_hashtable_list(hashtable_list *ht_list)
+/* add the convolution of both sources, shifted by energy, to result */
+static INLINE void
+band_add_product(energy_band        *result,
+                 const energy_band  *source_1,
+                 const energy_band  *source_2,
+                 int                energy)
 {
-  vrna_ht_free(ht_list->ht_energy_index);
-  free(ht_list->list_energy_count_pairs);
+  int     k1, k2, k2_min, k2_max, offset;
+  double  c, *r;
 
-  int i = 0;
-  for (; i < ht_list->length; i++)
-    free(ht_list->list_key_value_pairs[i]);
+  offset = source_1->e_min + source_2->e_min + energy - result->e_min;
 
-  free(ht_list->list_key_value_pairs);
-}
+  for (k1 = 0; k1 < source_1->size; k1++, offset++) {
+    k2_max = MIN2(source_2->size, result->size - offset);
+    if (k2_max <= 0)
+      break;
 
+    c = source_1->count[k1];
+    if (c == 0.)
+      continue;
 
-static
-void
-hashtable_list_add_count(hashtable_list *htl,
-                         int            energy,
-                         double         count)
-{
-  if (htl->ht_energy_index != NULL) {
-    key_value to_check;
-    to_check.key = energy;
-    //to_check.value = count;
-    key_value *lookup_result = NULL;
-    lookup_result = vrna_ht_get(htl->ht_energy_index, (void *)&to_check);
-    if (lookup_result == NULL) {
-      //value is not in list.
-      if (htl->length >= htl->allocated_size) {
-        htl->allocated_size           += 10;
-        htl->list_energy_count_pairs  =
-          vrna_realloc(htl->list_energy_count_pairs, sizeof(energy_count) * htl->allocated_size);
-        htl->list_key_value_pairs = vrna_realloc(htl->list_key_value_pairs,
-                                                 sizeof(key_value *) * htl->allocated_size);
-      }
+    k2_min  = MAX2(0, -offset);
+    r       = result->count + offset;
 
-      energy_count  ec;
-      ec.count  = count;
-      ec.energy = energy;
-      int           list_index = htl->length;
-      htl->list_energy_count_pairs[list_index]  = ec;
-      to_check.value                            = list_index;
-      key_value     *to_store = vrna_alloc(sizeof(key_value));
-      *to_store                             = to_check;
-      htl->list_key_value_pairs[list_index] = to_store;
-      htl->length++;
-
-      key_value     *to_insert  = htl->list_key_value_pairs[list_index];
-      int           res         = vrna_ht_insert(htl->ht_energy_index, (void *)to_insert);
-      if (res != 0)
-        fprintf(stderr, "dos.c: hash table insert failed!");
-    } else {
-      // the energy-index pair is already in the list.
-      int list_index = lookup_result->value;
-      htl->list_energy_count_pairs[list_index].count += count;
-    }
+    for (k2 = k2_min; k2 < k2_max; k2++)
+      r[k2] += c * source_2->count[k2];
   }
 }
 
 
-static
-double
-lookup_count_from_energy(hashtable_list *htl,
-                         int            energy)
+/*
+ *  Process a single decomposition of cell t of matrix T into cell s1 of
+ *  matrix S1, cell s2 of matrix S2 (optional), and loop energy. If S1 is NULL,
+ *  the decomposition denotes a single structure, e.g. a hairpin.
+ *  Depending on the mode, we either
+ *  - update the minimum free energy e_min of cell t,
+ *  - update the outside energies of the source cells, or
+ *  - count the structures of cell t
+ */
+static INLINE void
+decomposition(struct dp_counts_per_energy *dp,
+              dp_matrix                   *T,
+              int                         t,
+              dp_matrix                   *S1,
+              int                         s1,
+              dp_matrix                   *S2,
+              int                         s2,
+              int                         energy,
+              int                         *e_min)
 {
-  key_value to_check;
-
-  to_check.key = energy;
-  key_value *lookup_result;
-  lookup_result = vrna_ht_get(htl->ht_energy_index, (void *)&to_check);
-  if (lookup_result == NULL) {
-    //value is not in list.
-    return 0;
-  } else {
-    int index = lookup_result->value;
-    return htl->list_energy_count_pairs[index].count;
-  }
-}
+  int e1, e2;
 
+  e1  = (S1) ? S1->e_inside[s1] : 0;
+  e2  = (S2) ? S2->e_inside[s2] : 0;
 
-static
-double
-lookup_count_from_index(hashtable_list  *htl,
-                        int             index)
-{
-  if (index < 0)
-    return 0;
+  if ((e1 == INF) || (e2 == INF))
+    return;
 
-  return htl->list_energy_count_pairs[index].count;
-}
+  switch (dp->mode) {
+    case DP_INSIDE:
+      *e_min = MIN2(*e_min, e1 + e2 + energy);
+      break;
 
+    case DP_OUTSIDE:
+      if (T->e_outside[t] != INF) {
+        if (S1)
+          S1->e_outside[s1] = MIN2(S1->e_outside[s1], T->e_outside[t] + e2 + energy);
 
-int
-lookup_energy_from_index(hashtable_list *htl,
-                         int            index)
-{
-  if (index < 0)
-    return 1000000;
+        if (S2)
+          S2->e_outside[s2] = MIN2(S2->e_outside[s2], T->e_outside[t] + e1 + energy);
+      }
 
-  return htl->list_energy_count_pairs[index].energy;
+      break;
+
+    case DP_COUNT:
+      if (T->bands[t].size == 0)
+        break;
+
+      if (S2)
+        band_add_product(&(T->bands[t]), &(S1->bands[s1]), &(S2->bands[s2]), energy);
+      else if (S1)
+        band_add_shifted(&(T->bands[t]), &(S1->bands[s1]), energy);
+      else if ((energy >= T->bands[t].e_min) &&
+               (energy < T->bands[t].e_min + T->bands[t].size))
+        T->bands[t].count[energy - T->bands[t].e_min] += 1.;
+
+      break;
+  }
 }
 
 
-PRIVATE INLINE int
+/* decompose subsegment [i, j] with pair (i, j) */
+static void
 decompose_pair(vrna_fold_compound_t         *fc,
                int                          i,
                int                          j,
-               int                          min_energy,
-               int                          max_e,
-               struct dp_counts_per_energy  *dp_count_matrix_pt)
+               struct dp_counts_per_energy  *dp)
 {
-  hashtable_list  *source_table;
-  hashtable_list  *source_table_2;
-  hashtable_list  *result_table;
+  dp_matrix *C, *M, *M1;
 
-  int             turn  = fc->params->model_details.min_loop_size;
-  int             ij    = fc->jindx[j] + i;
+  int       turn  = fc->params->model_details.min_loop_size;
+  int       ij    = fc->jindx[j] + i;
 
-  int             *rtype  = &(fc->params->model_details.rtype[0]);
-  short           *S1     = fc->sequence_encoding;
+  int       *rtype  = &(fc->params->model_details.rtype[0]);
+  short     *S1     = fc->sequence_encoding;
 
-  int             type = fc->ptype[fc->jindx[j] + i];
+  int       type  = fc->ptype[ij];
+  int       e_min = INF;
 
-  int             no_close =
+  int       no_close =
     (((type == 3) || (type == 4)) && fc->params->model_details.noGUclosure);
 
+  C   = &(dp->n_ij_e);
+  M   = &(dp->n_ij_M_e);
+  M1  = &(dp->n_ij_M1_e);
+
   /* do we evaluate this pair? */
   if (type) {
     /* check for hairpin loop */
@@ -257,10 +242,7 @@ decompose_pair(vrna_fold_compound_t         *fc,
                               fc->sequence + i - 1,
                               fc->params);
 
-    if (energy_hp <= max_e) {
-      result_table = &dp_count_matrix_pt->n_ij_e[ij];
-      hashtable_list_add_count(result_table, energy_hp, 1);
-    }
+    decomposition(dp, C, ij, NULL, 0, NULL, 0, energy_hp, &e_min);
 
     /* check for interior loops */
     int maxp = MIN2(j - 2 - turn, i + MAXLOOP + 1);
@@ -272,7 +254,7 @@ decompose_pair(vrna_fold_compound_t         *fc,
       for (q = minq; q < j; q++) {
         pq = fc->jindx[q] + p;
         /* set distance to reference structure... */
-        type_2 = fc->ptype[fc->jindx[q] + p];
+        type_2 = fc->ptype[pq];
 
         if (type_2 == 0)
           continue;
@@ -294,20 +276,10 @@ decompose_pair(vrna_fold_compound_t         *fc,
                            S1[p - 1],
                            S1[q + 1],
                            fc->params);
-        source_table = &dp_count_matrix_pt->n_ij_e[pq];
-        if (source_table->length > 0) {
-          result_table = &dp_count_matrix_pt->n_ij_e[ij];
-          for (int ei = 0; ei < source_table->length; ei++) {
-            int     pq_energy   = lookup_energy_from_index(source_table, ei);
-            double  pq_count    = lookup_count_from_index(source_table, ei);
-            int     sum_energy  = pq_energy + energy;
-            if ((sum_energy >= min_energy) && (sum_energy <= max_e))
-              hashtable_list_add_count(result_table, sum_energy, pq_count);
-          }
-        }
+
+        decomposition(dp, C, ij, C, pq, NULL, 0, energy, &e_min);
       } /* end q-loop */
     }   /* end p-loop */
-        //new_c = MIN2(new_c, min_int);
 
     /* check for multibranch loops */
     if (!no_close) {
@@ -324,386 +296,356 @@ decompose_pair(vrna_fold_compound_t         *fc,
         int i1u   = fc->jindx[u] + (i + 1);
         int u1j1  = fc->jindx[j - 1] + (u + 1);
 
-        source_table    = &dp_count_matrix_pt->n_ij_M_e[i1u];
-        source_table_2  = &dp_count_matrix_pt->n_ij_M1_e[u1j1];
-        if (source_table->length > 0 && source_table_2->length > 0) {
-          result_table = &dp_count_matrix_pt->n_ij_e[ij];
-          for (int ei_1 = 0; ei_1 < source_table->length; ei_1++) {
-            int     m_energy  = lookup_energy_from_index(source_table, ei_1);
-            double  m_count   = lookup_count_from_index(source_table, ei_1);
-            for (int ei_2 = 0; ei_2 < source_table_2->length; ei_2++) {
-              int     m1_energy   = lookup_energy_from_index(source_table_2, ei_2);
-              double  m1_count    = lookup_count_from_index(source_table_2, ei_2);
-              int     sum_energy  = m_energy + m1_energy + temp2;
-              if ((sum_energy >= min_energy) && (sum_energy <= max_e)) {
-                double c_count = m_count * m1_count;
-                hashtable_list_add_count(result_table, sum_energy, c_count);
-              }
-            }
-          }
-        }
+        decomposition(dp, C, ij, M, i1u, M1, u1j1, temp2, &e_min);
       }
     }
   } /* end >> if (pair) << */
 
-  return 0;
+  if (dp->mode == DP_INSIDE)
+    C->e_inside[ij] = e_min;
 }
 
 
-int
-print_array_energy_counts(hashtable_list  *matrix,
-                          int             length_col,
-                          int             min_energy,
-                          int             max_energy)
+/* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
+static void
+decompose_ml(vrna_fold_compound_t         *fc,
+             int                          i,
+             int                          j,
+             struct dp_counts_per_energy  *dp)
 {
-  int j = length_col;
+  int           length, turn, ij, ij1, u, type, temp2, temp3, e_M, e_M1;
+  short         *S1;
+  dp_matrix     *C, *M, *M1;
+  vrna_param_t  *P;
 
-  if (matrix[j].length > 0) {
-    for (int e = min_energy; e <= max_energy; e++) {
-      double count = lookup_count_from_energy(&matrix[j], e);
-      if (count > 0)
-        printf("%6.2f\t%10.4g\n", e / 100., count);
+  P       = fc->params;
+  length  = (int)fc->length;
+  turn    = P->model_details.min_loop_size;
+  S1      = fc->sequence_encoding;
+  ij      = fc->jindx[j] + i;
+  ij1     = fc->jindx[j - 1] + i;
+  type    = fc->ptype[ij];
+  e_M     = INF;
+  e_M1    = INF;
+
+  C   = &(dp->n_ij_e);
+  M   = &(dp->n_ij_M_e);
+  M1  = &(dp->n_ij_M1_e);
+
+  temp2 = 0;
+  if (dangles == 2)
+    temp2 += E_MLstem(type, (i == 1) ? S1[length] : S1[i - 1], S1[j + 1], P);
+  else
+    temp2 += E_MLstem(type, -1, -1, P);
+
+  /* 1st E_M[ij] = E_M1[ij] = E_C[ij] + b */
+  decomposition(dp, M1, ij, C, ij, NULL, 0, temp2, &e_M1);
+  decomposition(dp, M, ij, C, ij, NULL, 0, temp2, &e_M);
+
+  /* 2nd E_M[ij] = MIN(E_M[ij], E_M[i,j-1] + c) */
+  decomposition(dp, M, ij, M, ij1, NULL, 0, P->MLbase, &e_M);
+
+  /* 3rd E_M1[ij] = MIN(E_M1[ij], E_M1[i,j-1] + c) */
+  decomposition(dp, M1, ij, M1, ij1, NULL, 0, P->MLbase, &e_M1);
+
+  if (j > turn + 2) {
+    for (u = i; u < j; u++) {
+      int u1j = fc->jindx[j] + u + 1;
+      int iu  = fc->jindx[u] + i;
+
+      if (C->e_inside[u1j] == INF)
+        continue;
+
+      type = fc->ptype[u1j];
+
+      if (dangles == 2)
+        temp2 = E_MLstem(type, S1[u], S1[j + 1], P);
+      else
+        temp2 = E_MLstem(type, -1, -1, P);
+
+      /* [i..u] is unpaired */
+      temp3 = temp2 + (u - i + 1) * P->MLbase;
+      decomposition(dp, M, ij, C, u1j, NULL, 0, temp3, &e_M);
+
+      /* [i...u] has at least one stem */
+      decomposition(dp, M, ij, C, u1j, M, iu, temp2, &e_M);
     }
   }
 
-  printf("\n");
-  return 0;
+  if (dp->mode == DP_INSIDE) {
+    M->e_inside[ij]   = e_M;
+    M1->e_inside[ij]  = e_M1;
+  }
 }
 
 
-/* fill DP matrices */
-PRIVATE void
-compute_density_of_states(vrna_fold_compound_t  *fc,
-                          int                   max_energy_input,
-                          int                   hashbits,
-                          int                   verbose)
+/* decompose the 5' fragment [1, j] */
+static void
+decompose_ext(vrna_fold_compound_t        *fc,
+              int                         j,
+              struct dp_counts_per_energy *dp)
 {
-  int           i, j, ij, length, turn, *indx;
-  vrna_param_t  *P;
+  int       i, ij, type, length, turn, additional_en, e_min;
+  short     *S1;
+  dp_matrix *C, *A;
 
   length  = (int)fc->length;
-  indx    = fc->jindx;
-  P       = fc->params;
-  turn    = P->model_details.min_loop_size;
-  int                         dangles = P->model_details.dangles;
-  short                       *S1     = fc->sequence_encoding;
-
-  hashtable_list              *source_table;
-  hashtable_list              *source_table_2;
-  hashtable_list              *result_table;
-
-  hashtable_list              *n_ij_e =
-    (hashtable_list *)vrna_alloc(sizeof(hashtable_list) * ((length + 1) * (length + 1)));
-  hashtable_list              *n_ij_A_e =
-    (hashtable_list *)vrna_alloc(sizeof(hashtable_list) * (length + 1));
-  hashtable_list              *n_ij_M_e =
-    (hashtable_list *)vrna_alloc(sizeof(hashtable_list) * ((length + 1) * (length + 1)));
-  hashtable_list              *n_ij_M1_e =
-    (hashtable_list *)vrna_alloc(sizeof(hashtable_list) * ((length + 1) * (length + 1)));
+  turn    = fc->params->model_details.min_loop_size;
+  S1      = fc->sequence_encoding;
+  e_min   = INF;
 
-  struct dp_counts_per_energy count_matrix_pt;
-  count_matrix_pt.n_ij_e    = n_ij_e;
-  count_matrix_pt.n_ij_A_e  = n_ij_A_e;
-  count_matrix_pt.n_ij_M_e  = n_ij_M_e;
-  count_matrix_pt.n_ij_M1_e = n_ij_M1_e;
+  C = &(dp->n_ij_e);
+  A = &(dp->n_ij_A_e);
 
-  /* compute mfe and search the matrices for the minimal energy contribution */
-  int min_energy = (int)round(vrna_mfe(fc, NULL) * 100.0);
-  if (verbose)
-    printf("min_energy (global): %d \n", min_energy);
-
-  /* search through DP matrices for minimal entry */
-  for (int i = 1; i < length; i++)
-    for (int j = i + 1; j <= length; j++) {
-      ij = indx[j] + i;
-      int e = fc->matrices->c[ij];
-      if (e < min_energy)
-        min_energy = e;
-
-      e = fc->matrices->fML[ij];
-      if (e < min_energy)
-        min_energy = e;
-    }
+  /* j-1 is unpaired ... */
+  decomposition(dp, A, j, A, j - 1, NULL, 0, 0, &e_min);
 
-  for (int i = 1; i <= length; i++) {
-    int e = fc->matrices->f5[i];
-    if (e < min_energy)
-      min_energy = e;
+  /* j pairs with 1 */
+  ij            = fc->jindx[j] + 1;
+  type          = fc->ptype[ij];
+  additional_en = 0;
+
+  if (type) {
+    if (dangles == 2)
+      additional_en += E_ExtLoop(type, -1, j < length ? S1[j + 1] : -1, fc->params);
+    else
+      additional_en += E_ExtLoop(type, -1, -1, fc->params);
   }
 
-  // clean mfe fold matrices (we need only counts)
-  vrna_mx_mfe_free(fc);
+  decomposition(dp, A, j, C, ij, NULL, 0, additional_en, &e_min);
 
-  int max_energy = max_energy_input;
-  /* compute max_energy */
-  if (min_energy < 0)
-    /* increase internal energy threshold in order to count
-     * structures at the border correctly.
-     */
-    max_energy = max_energy - 2 * min_energy;
+  /* j pairs with some other nucleotide */
+  for (i = j - turn - 1; i > 1; i--) {
+    ij    = fc->jindx[j] + i;
+    type  = fc->ptype[ij];
+    if (type) {
+      if (dangles == 2)
+        additional_en = E_ExtLoop(type, S1[i - 1], j < length ? S1[j + 1] : -1, fc->params);
+      else
+        additional_en = E_ExtLoop(type, -1, -1, fc->params);
 
-  int step_energy   = 1;          // 1 decakal. (smallest unit of energy computations)
-  int range         = max_energy - min_energy;
-  int energy_length = range + 1;  // ceil (range / (float) step_energy) + 1;
-  if (verbose) {
-    printf("min_energy: %d \n", min_energy);
-    printf("max_energy: %d %d\n", max_energy, min_energy + (step_energy * (energy_length - 1)));
-    printf("range: %d, energy_length: %d\n", range, energy_length);
+      decomposition(dp, A, j, C, ij, A, i - 1, additional_en, &e_min);
+    }
   }
 
-  /* start recursion */
-  if (length <= turn)
-    /* only the open chain is possible */
-    return;
+  if (dp->mode == DP_INSIDE)
+    A->e_inside[j] = e_min;
+}
+
+
+/*
+ *  Prepare the energy band of a cell that is about to be filled. A
+ *  sub-structure of energy e in this cell can only be part of structures
+ *  with free energy of at least e + e_outside. Thus, we only need to count
+ *  the sub-structures with e_inside <= e <= max_energy - e_outside
+ */
+static void
+band_prepare(dp_matrix  *X,
+             int        x,
+             int        max_energy)
+{
+  if ((X->e_inside[x] == INF) ||
+      (X->e_outside[x] == INF))
+    band_init(&(X->bands[x]), 0, 0);
+  else
+    band_init(&(X->bands[x]),
+              X->e_inside[x],
+              max_energy - X->e_outside[x] - X->e_inside[x] + 1);
+}
+
+
+/* minimum free energies of all cells and of their outside remainders */
+static void
+fill_min_energies(vrna_fold_compound_t        *fc,
+                  struct dp_counts_per_energy *dp)
+{
+  int i, j, d, length, turn;
+
+  length  = (int)fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+
+  dp->mode = DP_INSIDE;
+
+  for (d = turn + 2; d <= length; d++)
+    for (j = d; j <= length; j++) {
+      i = j - d + 1;
+      decompose_pair(fc, i, j, dp);
+      decompose_ml(fc, i, j, dp);
+    }
+
+  for (j = 1; j <= turn + 1; j++)
+    dp->n_ij_A_e.e_inside[j] = 0;
+
+  for (j = turn + 2; j <= length; j++)
+    decompose_ext(fc, j, dp);
+
+  /* outside energies, in reverse order of the inside recursions */
+  dp->mode                          = DP_OUTSIDE;
+  dp->n_ij_A_e.e_outside[length]  = 0;
+
+  for (j = length; j > turn + 1; j--)
+    decompose_ext(fc, j, dp);
+
+  for (d = length; d >= turn + 2; d--)
+    for (j = d; j <= length; j++) {
+      i = j - d + 1;
+      decompose_ml(fc, i, j, dp);
+      decompose_pair(fc, i, j, dp);
+    }
+}
+
+
+static void
+fill_counts(vrna_fold_compound_t        *fc,
+            struct dp_counts_per_energy *dp,
+            int                         max_energy,
+            int                         threads)
+{
+  int i, j, d, ij, length, turn;
+
+  length  = (int)fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+
+  dp->mode = DP_COUNT;
 
-  //for (i = length - turn - 1; i >= 1; i--) {
-  // for (j = i + turn + 1; j <= length; j++) {
-  int d;
   for (d = turn + 2; d <= length; d++) {
-    /* i,j in [1..length] */
+    /* all cells of the same diagonal are independent of each other */
 #ifdef _OPENMP
-#pragma omp parallel for private(j, i, ij, source_table, source_table_2, result_table)
+#pragma omp parallel for private(i, j, ij) num_threads(threads) schedule(dynamic)
 #endif
     for (j = d; j <= length; j++) {
       i   = j - d + 1;
-      ij  = indx[j] + i;
+      ij  = fc->jindx[j] + i;
 
-      int type = fc->ptype[fc->jindx[j] + i];
+      band_prepare(&(dp->n_ij_e), ij, max_energy);
+      decompose_pair(fc, i, j, dp);
+      band_trim(&(dp->n_ij_e.bands[ij]));
 
-      //prepare matrices (add third dimension)
-      count_matrix_pt.n_ij_e[ij]    = create_hashtable_list(hashbits);
-      count_matrix_pt.n_ij_M_e[ij]  = create_hashtable_list(hashbits);
-      count_matrix_pt.n_ij_M1_e[ij] = create_hashtable_list(hashbits);
+      band_prepare(&(dp->n_ij_M_e), ij, max_energy);
+      band_prepare(&(dp->n_ij_M1_e), ij, max_energy);
+      decompose_ml(fc, i, j, dp);
+      band_trim(&(dp->n_ij_M_e.bands[ij]));
+      band_trim(&(dp->n_ij_M1_e.bands[ij]));
+    }
 
-      /* decompose subsegment [i, j] with pair (i, j) */
-      decompose_pair(fc, i, j, min_energy, max_energy, &count_matrix_pt);
+    /* M1 cells [., d - 1] are only required for pairs (., d) and M1 cells [., d] */
+    for (i = 1; i < d - 1; i++)
+      band_free(&(dp->n_ij_M1_e.bands[fc->jindx[d - 1] + i]));
+  }
 
-      /* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
-      int temp2 = 0;
-      if (dangles == 2)
-        temp2 += E_MLstem(type, (i == 1) ? S1[length] : S1[i - 1], S1[j + 1], P);
-      else
-        temp2 += E_MLstem(type, -1, -1, P);
-
-      /*
-       * now to the actual computations...
-       * 1st E_M[ij] = E_M1[ij] = E_C[ij] + b
-       */
-      source_table = &count_matrix_pt.n_ij_e[ij];
-      if (source_table->length > 0) {
-        result_table = &count_matrix_pt.n_ij_M1_e[ij];
-        hashtable_list *result_table_2 = &count_matrix_pt.n_ij_M_e[ij];
-        for (int ei = 0; ei < source_table->length; ei++) {
-          int     c_energy    = lookup_energy_from_index(source_table, ei);
-          double  c_count     = lookup_count_from_index(source_table, ei);
-          int     sum_energy  = c_energy + temp2;
-          if ((sum_energy >= min_energy) && (sum_energy <= max_energy)) {
-            hashtable_list_add_count(result_table, sum_energy, c_count);
-            hashtable_list_add_count(result_table_2, sum_energy, c_count);
-          }
-        }
-      }
+  for (j = 1; j <= length; j++) {
+    band_prepare(&(dp->n_ij_A_e), j, max_energy);
+    if (j > turn + 1)
+      decompose_ext(fc, j, dp);
+    else if (dp->n_ij_A_e.bands[j].size > 0)
+      dp->n_ij_A_e.bands[j].count[0] = 1.; /* the open chain */
 
-      /* 2rd E_M[ij] = MIN(E_M[ij], E_M[i,j-1] + c) */
-      source_table = &count_matrix_pt.n_ij_M_e[fc->jindx[j - 1] + i];
-      if (source_table->length > 0) {
-        result_table = &count_matrix_pt.n_ij_M_e[ij];
-        for (int ei = 0; ei < source_table->length; ei++) {
-          int     m_energy    = lookup_energy_from_index(source_table, ei);
-          double  m_count     = lookup_count_from_index(source_table, ei);
-          int     sum_energy  = m_energy + P->MLbase;
-          if ((sum_energy >= min_energy) && (sum_energy <= max_energy))
-            hashtable_list_add_count(result_table, sum_energy, m_count);
-        }
-      }
+    band_trim(&(dp->n_ij_A_e.bands[j]));
+  }
+}
 
-      /* 3th E_M1[ij] = MIN(E_M1[ij], E_M1[i,j-1] + c) */
-      source_table = &count_matrix_pt.n_ij_M1_e[fc->jindx[j - 1] + i];
-      if (source_table->length > 0) {
-        result_table = &count_matrix_pt.n_ij_M1_e[ij];
-        for (int ei = 0; ei < source_table->length; ei++) {
-          int     m1_energy   = lookup_energy_from_index(source_table, ei);
-          double  m1_count    = lookup_count_from_index(source_table, ei);
-          int     sum_energy  = m1_energy + P->MLbase;
-          if ((sum_energy >= min_energy) && (sum_energy <= max_energy))
-            hashtable_list_add_count(result_table, sum_energy, m1_count);
-        }
-      }
 
-      if (j > turn + 2) {
-        int u;
-        int temp3;
-
-        for (u = i; u < j; u++) {
-          int u1j = fc->jindx[j] + u + 1;
-          int iu  = fc->jindx[u] + i;
-
-          source_table = &count_matrix_pt.n_ij_e[u1j];
-          if (source_table->length > 0) {
-            type = fc->ptype[u1j];
-
-            /* [i..u] is unpaired */
-            if (dangles == 2)
-              temp2 = E_MLstem(type, S1[u], S1[j + 1], P);
-            else
-              temp2 = E_MLstem(type, -1, -1, P);
-
-            temp3 = temp2 + (u - i + 1) * P->MLbase;
-
-            result_table = &count_matrix_pt.n_ij_M_e[ij];
-            for (int ei = 0; ei < source_table->length; ei++) {
-              int     c_energy    = lookup_energy_from_index(source_table, ei);
-              double  c_count     = lookup_count_from_index(source_table, ei);
-              int     sum_energy  = c_energy + temp3;
-              if ((sum_energy >= min_energy) && (sum_energy <= max_energy))
-                hashtable_list_add_count(result_table, sum_energy, c_count);
-            }
-
-            /* [i...u] has at least one stem */
-            source_table_2 = &count_matrix_pt.n_ij_M_e[iu];
-            if (source_table_2->length > 0) {
-              source_table  = &count_matrix_pt.n_ij_e[u1j];
-              result_table  = &count_matrix_pt.n_ij_M_e[ij];
-              for (int ei_1 = 0; ei_1 < source_table->length; ei_1++) {
-                int     c_energy  = lookup_energy_from_index(source_table, ei_1);
-                double  c_count   = lookup_count_from_index(source_table, ei_1);
-                for (int ei_2 = 0; ei_2 < source_table_2->length; ei_2++) {
-                  int     m_energy    = lookup_energy_from_index(source_table_2, ei_2);
-                  double  m_count     = lookup_count_from_index(source_table_2, ei_2);
-                  int     sum_energy  = c_energy + m_energy + temp2;
-                  if ((sum_energy >= min_energy) && (sum_energy <= max_energy)) {
-                    double product_count = c_count * m_count;
-                    hashtable_list_add_count(result_table, sum_energy, product_count);
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    } /* end of j-loop */
-  }   /* end of i-loop */
-  /* calculate energies of 5' fragments */
-  int x;
-#ifdef _OPENMP
-#pragma omp parallel for private(x)
-#endif
-  for (x = 0; x <= length; x++)
-    count_matrix_pt.n_ij_A_e[x] = create_hashtable_list(hashbits);
+static void
+dp_matrix_init(dp_matrix    *X,
+               unsigned int size)
+{
+  unsigned int i;
 
-  int cnt1;
-#ifdef _OPENMP
-#pragma omp parallel for private(cnt1)
-#endif
-  for (cnt1 = 1; cnt1 <= turn + 1; cnt1++) {
-    int     c_energy  = 0;
-    double  c_count   = 1;
-    result_table = &count_matrix_pt.n_ij_A_e[cnt1];
-    hashtable_list_add_count(result_table, c_energy, c_count);
-  }
+  X->e_inside   = (int *)vrna_alloc(sizeof(int) * size);
+  X->e_outside  = (int *)vrna_alloc(sizeof(int) * size);
+  X->bands      = (energy_band *)vrna_alloc(sizeof(energy_band) * size);
 
-  for (j = turn + 2; j <= length; j++) {
-    /* j-1 is unpaired ... */
-    source_table  = &count_matrix_pt.n_ij_A_e[j - 1];
-    result_table  = &count_matrix_pt.n_ij_A_e[j];
-    int ei;
-    for (ei = 0; ei < source_table->length; ei++) {
-      int     c_energy  = lookup_energy_from_index(source_table, ei);
-      double  c_count   = lookup_count_from_index(source_table, ei);
-      hashtable_list_add_count(result_table, c_energy, c_count);
-    }
+  for (i = 0; i < size; i++)
+    X->e_inside[i] = X->e_outside[i] = INF;
+}
 
-    /* j pairs with 1 */
-    ij = fc->jindx[j] + 1;
-    int type          = fc->ptype[ij];
-    int additional_en = 0;
 
-    if (type) {
-      if (dangles == 2)
-        additional_en += E_ExtLoop(type, -1, j < length ? S1[j + 1] : -1, P);
-      else
-        additional_en += E_ExtLoop(type, -1, -1, P);
-    }
+static void
+dp_matrix_free(dp_matrix    *X,
+               unsigned int size)
+{
+  unsigned int i;
 
-    source_table = &count_matrix_pt.n_ij_e[ij];
-    if (source_table->length > 0) {
-      result_table = &count_matrix_pt.n_ij_A_e[j];
-      int ei;
-      for (ei = 0; ei < source_table->length; ei++) {
-        int     c_energy    = lookup_energy_from_index(source_table, ei);
-        double  c_count     = lookup_count_from_index(source_table, ei);
-        int     sum_energy  = c_energy + additional_en;
-        if ((sum_energy >= min_energy) && (sum_energy <= max_energy))
-          hashtable_list_add_count(result_table, sum_energy, c_count);
-      }
-    }
+  for (i = 0; i < size; i++)
+    band_free(&(X->bands[i]));
 
-    /* j pairs with some other nucleotide -> see below */
-    for (i = j - turn - 1; i > 1; i--) {
-      ij    = fc->jindx[j] + i;
-      type  = fc->ptype[ij];
-      if (type) {
-        if (dangles == 2)
-          additional_en = E_ExtLoop(type, S1[i - 1], j < length ? S1[j + 1] : -1, P);
-        else
-          additional_en = E_ExtLoop(type, -1, -1, P);
-
-        source_table    = &count_matrix_pt.n_ij_e[ij];
-        source_table_2  = &count_matrix_pt.n_ij_A_e[i - 1];
-        if (source_table->length > 0 && source_table_2->length > 0) {
-          result_table = &count_matrix_pt.n_ij_A_e[j];
-
-          int ei_1;
-          for (ei_1 = 0; ei_1 < source_table->length; ei_1++) {
-            int     c_energy  = lookup_energy_from_index(source_table, ei_1);
-            double  c_count   = lookup_count_from_index(source_table, ei_1);
-            int     ei_2;
-            for (ei_2 = 0; ei_2 < source_table_2->length; ei_2++) {
-              int     f5_energy   = lookup_energy_from_index(source_table_2, ei_2);
-              double  f5_count    = lookup_count_from_index(source_table_2, ei_2);
-              int     sum_energy  = c_energy + f5_energy + additional_en;
-              if ((sum_energy >= min_energy) && (sum_energy <= max_energy)) {
-                double product_count = c_count * f5_count;
-                hashtable_list_add_count(result_table, sum_energy, product_count);
-              }
-            }
-          }
-        }
-      }
-    }
+  free(X->e_inside);
+  free(X->e_outside);
+  free(X->bands);
+}
+
+
+int
+print_array_energy_counts(energy_band *matrix,
+                          int         length_col,
+                          int         min_energy,
+                          int         max_energy)
+{
+  int j = length_col;
+
+  for (int k = 0; k < matrix[j].size; k++) {
+    int     e     = matrix[j].e_min + k;
+    double  count = matrix[j].count[k];
+    if ((e >= min_energy) && (e <= max_energy) && (count > 0))
+      printf("%6.2f\t%10.4g\n", e / 100., count);
   }
 
-  printf("Energy bands with counted structures:\n");
-  print_array_energy_counts(count_matrix_pt.n_ij_A_e, length, min_energy, max_energy_input);
+  printf("\n");
+  return 0;
+}
+
+
+/* fill DP matrices */
+PRIVATE void
+compute_density_of_states(vrna_fold_compound_t  *fc,
+                          int                   max_energy,
+                          int                   threads,
+                          int                   verbose)
+{
+  int                         length, turn, min_energy;
+  unsigned int                size;
+  struct dp_counts_per_energy count_matrix_pt;
+
+  length  = (int)fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+
+  /* start recursion */
+  if (length <= turn)
+    /* only the open chain is possible */
+    return;
 
-  for (i = length - turn - 1; i >= 1; i--) {
 #ifdef _OPENMP
-#pragma omp parallel for private(j, ij)
+  threads = MAX2(1, MIN2(threads, omp_get_num_procs()));
+#else
+  threads = 1;
 #endif
-    for (j = i + turn + 1; j <= length; j++) {
-      ij = indx[j] + i;
 
-      if (count_matrix_pt.n_ij_e[ij].allocated_size > 0)
-        free_hashtable_list(&count_matrix_pt.n_ij_e[ij]);
+  size = (unsigned int)fc->jindx[length] + length + 1;
 
-      if (count_matrix_pt.n_ij_M_e[ij].allocated_size > 0)
-        free_hashtable_list(&count_matrix_pt.n_ij_M_e[ij]);
+  dp_matrix_init(&count_matrix_pt.n_ij_e, size);
+  dp_matrix_init(&count_matrix_pt.n_ij_M_e, size);
+  dp_matrix_init(&count_matrix_pt.n_ij_M1_e, size);
+  dp_matrix_init(&count_matrix_pt.n_ij_A_e, length + 1);
 
-      if (count_matrix_pt.n_ij_M1_e[ij].allocated_size > 0)
-        free_hashtable_list(&count_matrix_pt.n_ij_M1_e[ij]);
-    }
+  /* the minimum free energies of all cells determine the sizes of their energy bands */
+  fill_min_energies(fc, &count_matrix_pt);
+
+  min_energy = count_matrix_pt.n_ij_A_e.e_inside[length];
+
+  if (verbose) {
+    printf("min_energy: %d \n", min_energy);
+    printf("max_energy: %d\n", max_energy);
   }
 
-#ifdef _OPENMP
-#pragma omp parallel for private(i)
-#endif
-  for (i = 0; i <= length; i++)
-    free_hashtable_list(&count_matrix_pt.n_ij_A_e[i]);
+  fill_counts(fc, &count_matrix_pt, max_energy, threads);
 
-  free(count_matrix_pt.n_ij_e);
-  free(count_matrix_pt.n_ij_A_e);
-  free(count_matrix_pt.n_ij_M_e);
-  free(count_matrix_pt.n_ij_M1_e);
+  printf("Energy bands with counted structures:\n");
+  print_array_energy_counts(count_matrix_pt.n_ij_A_e.bands, length, min_energy, max_energy);
+
+  dp_matrix_free(&count_matrix_pt.n_ij_e, size);
+  dp_matrix_free(&count_matrix_pt.n_ij_M_e, size);
+  dp_matrix_free(&count_matrix_pt.n_ij_M1_e, size);
+  dp_matrix_free(&count_matrix_pt.n_ij_A_e, length + 1);
 }
 
 
@@ -749,7 +691,6 @@ main(int  argc,
 
   int   verbose     = 0;
   int   max_energy  = 0;
-  int   hash_bits   = 20;
 
   char  *ParamFile = NULL;
 
@@ -792,15 +733,11 @@ main(int  argc,
     max_energy = args_info.max_energy_arg;
 
   if (args_info.hashtable_bits_given)
-    hash_bits = args_info.hashtable_bits_arg;
+    vrna_message_warning("Option --hashtable-bits is obsolete and will be ignored!");
 
   /* set number of threads for parallel computation */
-  if (args_info.numThreads_given) {
-#ifdef _OPENMP
-    omp_set_num_threads(args_info.numThreads_arg);
-    omp_set_dynamic(0);
-#endif
-  }
+  if (args_info.numThreads_given)
+    md.threads = args_info.numThreads_arg;
 
   /* get energy parameter file name */
   if (args_info.paramFile_given)
@@ -827,7 +764,7 @@ main(int  argc,
     vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
 
   int max_energy_dcal = max_energy * 100;
-  compute_density_of_states(fc, max_energy_dcal, hash_bits, verbose);
+  compute_density_of_states(fc, max_energy_dcal, md.threads, verbose);
 
   free(rnaSequence);
   vrna_fold_compound_free(fc);
@@ -44,8 +44,10 @@
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/commands.h"
 #include "ViennaRNA/equilibrium_probs.h"
+#include "ViennaRNA/eval.h"
 #include "ViennaRNA/datastructures/char_stream.h"
 #include "ViennaRNA/datastructures/stream_output.h"
+#include "ViennaRNA/datastructures/heap.h"
 #include "ViennaRNA/combinatorics.h"
 #include "ViennaRNA/color_output.inc"
 
@@ -54,6 +56,23 @@
 #include "input_id_helpers.h"
 #include "parallel_helpers.h"
 
+/*
+ *  Number of input records we read ahead in parallel mode to dispatch
+ *  the longest sequences first
+ */
+#ifndef RECORD_LOOKAHEAD
+#define RECORD_LOOKAHEAD  1024
+#endif
+
+/*
+ *  Maximum size (in bytes) of the MFE matrices a worker keeps for the next
+ *  record while computing the partition function. Larger matrices are
+ *  released beforehand to lower the peak memory consumption
+ */
+#ifndef MFE_MX_KEEP_MAX_SIZE
+#define MFE_MX_KEEP_MAX_SIZE  ((size_t)512 * 1024 * 1024)
+#endif
+
 
 struct options {
   int             filename_full;
@@ -93,6 +112,7 @@ struct options {
 
 struct record_data {
   unsigned int    number;
+  size_t          length;
   char            *id;
   char            *sequence;
   char            *SEQ_ID;
@@ -194,6 +214,20 @@ static void
 process_record(struct record_data *record);
 
 
+static int
+cmp_record_length(const void  *a,
+                  const void  *b,
+                  void        *data);
+
+
+static void
+free_worker_fc(void *fc);
+
+
+static size_t
+mfe_mx_size(unsigned int length);
+
+
 /*--------------------------------------------------------------------------*/
 void
 flush_cstr_callback(void          *auxdata,
@@ -575,6 +609,9 @@ main(int  argc,
    */
   INIT_PARALLELIZATION(opt.jobs);
 
+  /* each worker keeps its fold compound (and DP matrices) for the next record */
+  worker_storage_init(&free_worker_fc);
+
   if (num_input > 0) {
     int i, skip;
     for (skip = i = 0; i < num_input; i++) {
@@ -606,6 +643,8 @@ main(int  argc,
 
   UNINIT_PARALLELIZATION
 
+  worker_storage_free();
+
   /*
    ################################################
    # post processing
@@ -714,6 +753,22 @@ process_input(FILE            *input_stream,
 
   unsigned int  read_opt = 0;
 
+  struct record_data  *record;
+  vrna_heap_t         pending = NULL;
+
+  /*
+   *  When processing batch input in parallel, read ahead a number of records
+   *  and dispatch the longest ones first. This way, a few long sequences at the
+   *  end of the input do not keep a single worker busy while all others idle.
+   *  Output order is not affected since the output queue slots are requested
+   *  in input order below.
+   */
+  if ((opt->jobs > 1) &&
+      (!istty_in) &&
+      (!opt->shape) &&
+      (!(opt->constraint_file && (!opt->constraint_batch))))
+    pending = vrna_heap_init(RECORD_LOOKAHEAD, &cmp_record_length, NULL, NULL, NULL);
+
   /* print user help if we get input from tty */
   if (istty_in && istty_out) {
     if (fold_constrained) {
@@ -764,9 +819,10 @@ process_input(FILE            *input_stream,
     /* construct the sequence ID */
     set_next_id(&rec_id, opt->id_control);
 
-    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+    record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
     record->number          = opt->next_record_number;
+    record->length          = strlen(rec_sequence);
     record->sequence        = rec_sequence;
     record->SEQ_ID          = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
     record->id              = rec_id;
@@ -779,6 +835,14 @@ process_input(FILE            *input_stream,
     if (opt->output_queue)
       vrna_ostream_request(opt->output_queue, opt->next_record_number++);
 
+    if (pending) {
+      vrna_heap_insert(pending, (void *)record);
+      if (vrna_heap_size(pending) < RECORD_LOOKAHEAD)
+        continue;
+
+      record = (struct record_data *)vrna_heap_pop(pending);
+    }
+
     RUN_IN_PARALLEL(process_record, record);
 
     if (opt->shape || (opt->constraint_file && (!opt->constraint_batch))) {
@@ -798,18 +862,65 @@ process_input(FILE            *input_stream,
     }
   } while (1);
 
+  if (pending) {
+    while ((record = (struct record_data *)vrna_heap_pop(pending)))
+      RUN_IN_PARALLEL(process_record, record);
+
+    vrna_heap_free(pending);
+  }
+
   return ret;
 }
 
 
+/* order records by decreasing sequence length, then by input order */
+static int
+cmp_record_length(const void  *a,
+                  const void  *b,
+                  void        *data)
+{
+  const struct record_data  *r1 = (const struct record_data *)a;
+  const struct record_data  *r2 = (const struct record_data *)b;
+
+  if (r1->length > r2->length)
+    return -1;
+
+  if (r1->length < r2->length)
+    return 1;
+
+  if (r1->number < r2->number)
+    return -1;
+
+  if (r1->number > r2->number)
+    return 1;
+
+  return 0;
+}
+
+
+static void
+free_worker_fc(void *fc)
+{
+  vrna_fold_compound_free((vrna_fold_compound_t *)fc);
+}
+
+
+/* approximate memory of the MFE matrices, dominated by c, fML, and fM1 */
+static size_t
+mfe_mx_size(unsigned int length)
+{
+  return 3 * sizeof(int) * ((size_t)length * (length + 1) / 2);
+}
+
+
 static void
 process_record(struct record_data *record)
 {
   unsigned int          length;
   struct options        *opt;
   char                  *rec_sequence, *mfe_structure;
-  double                min_en, energy;
-  vrna_fold_compound_t  *vc;
+  double                min_en, energy, pf_scale;
+  vrna_fold_compound_t  *vc, **fc_slot;
   struct output_stream  *o_stream;
 
   opt = record->options;
@@ -825,7 +936,13 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(rec_sequence);
 
-  vc = vrna_fold_compound(rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
+  /* re-use the DP matrices of the last record this worker processed */
+  fc_slot = (vrna_fold_compound_t **)worker_storage();
+  vc      = vrna_fold_compound_recycle(*fc_slot,
+                                       rec_sequence,
+                                       &(opt->md),
+                                       VRNA_OPTION_DEFAULT);
+  *fc_slot = vc;
 
   length = vc->length;
 
@@ -927,7 +1044,9 @@ process_record(struct record_data *record)
     }
   }
 
-  if (length > 2000)
+  if ((opt->pf) &&
+      (vc->matrices) &&
+      (mfe_mx_size(vc->matrices->length) > MFE_MX_KEEP_MAX_SIZE))
     vrna_mx_mfe_free(vc);
 
   if (opt->pf) {
@@ -944,7 +1063,14 @@ process_record(struct record_data *record)
     if (length > 2000)
       vrna_message_info(stderr, "scaling factor %f", vc->exp_params->pf_scale);
 
-    energy = (double)vrna_pf(vc, pf_struc);
+    pf_scale  = vc->exp_params->pf_scale;
+    energy    = (double)vrna_pf(vc, pf_struc);
+
+    if ((opt->verbose) && (vc->exp_params->pf_scale != pf_scale))
+      vrna_message_info(stderr,
+                        "adjusted scaling factor from %g to %g",
+                        pf_scale,
+                        vc->exp_params->pf_scale);
 
     /* in case we abort because of floating point errors */
     if (length > 1600)
@@ -1064,8 +1190,7 @@ process_record(struct record_data *record)
     ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
   }
 
-  /* clean up */
-  vrna_fold_compound_free(vc);
+  /* clean up, the fold compound stays with this worker for the next record */
   free(record->id);
   free(record->SEQ_ID);
   free(record->sequence);
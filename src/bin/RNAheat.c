@@ -235,6 +235,10 @@ main(int  argc,
       opt.mpoints = 100;
   }
 
+  /* number of threads for temperature parallel computations */
+  if (args_info.numThreads_given)
+    opt.md.threads = args_info.numThreads_arg;
+
   if (args_info.jobs_given) {
 #if VRNA_WITH_PTHREADS
     int thread_max = max_user_threads();
@@ -28,6 +28,7 @@
 #include "ViennaRNA/constraints/SHAPE.h"
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/io/utils.h"
+#include "ViennaRNA/io/lunp_bin.h"
 #include "ViennaRNA/commands.h"
 #include "RNAplfold_cmdl.h"
 #include "gengetopt_helper.h"
@@ -81,6 +82,7 @@ typedef struct {
   int       simply_putout;
   int       openenergies;
   double    **pup;
+  vrna_lunp_writer_t  lunp;
   int       ulength;
   int       n;
   double    kT;
@@ -145,13 +147,14 @@ main(int  argc,
   unsigned int                rec_type, read_opt;
   int                         length, istty, winsize, pairdist, tempwin, temppair, tempunpaired,
                               noconv, i, plexoutput, simply_putout, openenergies, binaries,
-                              filename_full, with_shapes, verbose;
+                              lunp_binary, filename_full, with_shapes, verbose, ret;
   float                       cutoff;
   vrna_exp_param_t            *pf_parameters;
   vrna_md_t                   md;
   vrna_cmd_t                  commands;
   dataset_id                  id_control;
 
+  ret           = EXIT_SUCCESS;
   pUfp          = NULL;
   dangles       = 2;
   cutoff        = 0.01;
@@ -160,6 +163,7 @@ main(int  argc,
   unpaired      = 0;
   simply_putout = plexoutput = openenergies = noconv = 0;
   binaries      = 0;
+  lunp_binary   = 0;
   tempwin       = temppair = tempunpaired = 0;
   structure     = ParamFile = ns_bases = NULL;
   rec_type      = read_opt = 0;
@@ -192,6 +196,10 @@ main(int  argc,
 
   ggo_get_md_part(args_info, md);
 
+  /* number of threads */
+  if (args_info.numThreads_given)
+    md.threads = args_info.numThreads_arg;
+
   /* temperature */
   if (args_info.temp_given)
     md.temperature = temperature = args_info.temp_arg;
@@ -269,6 +277,10 @@ main(int  argc,
   if (args_info.binaries_given)
     binaries = 1;
 
+  /* turn on binary unpaired probability output */
+  if (args_info.lunp_binary_given)
+    lunp_binary = 1;
+
   /* check for errorneous parameter options */
   if ((pairdist < 0) || (cutoff < 0.) || (unpaired < 0) || (winsize < 0)) {
     RNAplfold_cmdline_parser_print_help();
@@ -317,7 +329,7 @@ main(int  argc,
     commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   /* check parameter options again and reset to reasonable values if needed */
-  if (openenergies && !unpaired)
+  if ((openenergies || lunp_binary) && !unpaired)
     unpaired = 31;
 
   if (pairdist == 0)
@@ -445,7 +457,8 @@ main(int  argc,
 
     if (length > 0) {
       /* construct output file names */
-      char *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
+      char *fname1, *fname2, *fname3, *fname4, *fname5, *ffname, *tmp_string;
+      int  text_up;
 
       if (!SEQ_ID)
         SEQ_ID = strdup("plfold");
@@ -461,6 +474,10 @@ main(int  argc,
                 vrna_strdup_printf("%s%sopenen",
                                    SEQ_ID,
                                    filename_delim);
+      fname5  = vrna_strdup_printf("%s%slunp%sbin",
+                                   SEQ_ID,
+                                   filename_delim,
+                                   filename_delim);
       ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, filename_delim);
 
       /* sanitize filenames */
@@ -476,6 +493,9 @@ main(int  argc,
       tmp_string  = vrna_filename_sanitize(fname4, filename_delim);
       free(fname4);
       fname4      = tmp_string;
+      tmp_string  = vrna_filename_sanitize(fname5, filename_delim);
+      free(fname5);
+      fname5      = tmp_string;
       tmp_string  = vrna_filename_sanitize(ffname, filename_delim);
       free(ffname);
       ffname = tmp_string;
@@ -514,22 +534,36 @@ main(int  argc,
       data.ulength        = unpaired;
       data.n              = length;
       data.kT             = pf_parameters->kT;
+      data.pup            = NULL;
+      data.pUfp           = NULL;
+      data.lunp           = NULL;
+
+      /* the binary file replaces the _lunp text file, but not the opening energies */
+      text_up = (openenergies || !lunp_binary) ? 1 : 0;
 
       if (unpaired > 0) {
+        if (lunp_binary) {
+          data.lunp = vrna_lunp_writer_open(fname5, length, unpaired);
+          if (!data.lunp) {
+            vrna_message_warning("Failed to open binary output file %s! "
+                                 "Aborting now...",
+                                 fname5);
+            ret = EXIT_FAILURE;
+            goto rnaplfold_exit;
+          }
+        }
+
         if (simply_putout) {
-          data.pup  = NULL;
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          prepare_up_file(&data);
-        } else {
+          if (text_up) {
+            data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
+            prepare_up_file(&data);
+          }
+        } else if ((text_up) || (plexoutput)) {
           /* if we don't print on-the-fly we store unpaired probabilities for later */
           data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
           data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
           data.pup[0][0]  = unpaired;
-          data.pUfp       = NULL;
         }
-      } else {
-        data.pup  = NULL;
-        data.pUfp = NULL;
       }
 
       /* prepare option flags */
@@ -544,6 +578,15 @@ main(int  argc,
       /* perform recursions */
       int r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
 
+      /* the writer only reports failed writes upon closing the file */
+      if ((data.lunp) && (!vrna_lunp_writer_close(data.lunp))) {
+        vrna_message_warning("Failed to write unpaired probabilities to binary file %s! "
+                             "Aborting now...",
+                             fname5);
+        ret = EXIT_FAILURE;
+        goto rnaplfold_exit;
+      }
+
       if (!r) {
         vrna_message_warning("Something bad happened while processing the input! "
                              "Aborting now...");
@@ -555,7 +598,7 @@ main(int  argc,
         PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
 
         /* print unpaired probabilities */
-        if (unpaired > 0) {
+        if (data.pup) {
           if (plexoutput) {
             pUfp = fopen(fname3, "w");
             putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
@@ -563,28 +606,29 @@ main(int  argc,
           }
 
           /* print unpaired probabilities to file */
-
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          if (binaries) {
-            print_pu_bin(fc, &data, unpaired);
-          } else {
-            prepare_up_file(&data);
-            if (openenergies) {
-              for (i = 1; i <= length; i++)
-                print_up_open(data.pUfp,
-                              i,
-                              data.pup[i],
-                              (i > unpaired) ? unpaired : i,
-                              unpaired,
-                              data.kT / 1000.);
+          if (text_up) {
+            data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
+            if (binaries) {
+              print_pu_bin(fc, &data, unpaired);
             } else {
-              for (i = 1; i <= length; i++)
-                print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
+              prepare_up_file(&data);
+              if (openenergies) {
+                for (i = 1; i <= length; i++)
+                  print_up_open(data.pUfp,
+                                i,
+                                data.pup[i],
+                                (i > unpaired) ? unpaired : i,
+                                unpaired,
+                                data.kT / 1000.);
+              } else {
+                for (i = 1; i <= length; i++)
+                  print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
+              }
             }
-          }
 
-          fclose(data.pUfp);
-          data.pUfp = NULL;
+            fclose(data.pUfp);
+            data.pUfp = NULL;
+          }
 
           for (i = 0; i <= length; i++)
             free(data.pup[i]);
@@ -610,6 +654,7 @@ main(int  argc,
       free(fname2);
       free(fname3);
       free(fname4);
+      free(fname5);
       free(ffname);
     }
 
@@ -643,7 +688,7 @@ rnaplfold_exit:
 
   free_id_data(id_control);
 
-  return EXIT_SUCCESS;
+  return ret;
 }
 
 
@@ -763,7 +808,10 @@ plfold_callback(FLT_OR_DBL    *pr,
 
   /* limit output to full unpaired probabilities */
   if ((type & VRNA_PROBS_WINDOW_UP) && ((type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP)) {
-    if (!d->simply_putout) {
+    if (d->lunp)
+      vrna_lunp_writer_cb(pr, pr_size, i, max, type, (void *)d->lunp);
+
+    if (d->pup) {
       /* store unpaired probabilities in an array */
 
       /* first allocate some memory */
@@ -774,7 +822,7 @@ plfold_callback(FLT_OR_DBL    *pr,
         d->pup[i][cnt] = pr[cnt];
       for (cnt = pr_size + 1; cnt <= max; cnt++)
         d->pup[i][cnt] = 0.;
-    } else {
+    } else if (d->pUfp) {
       /* print unpaired probabilities to output file handle */
       if (d->openenergies)
         print_up_open(d->pUfp, i, pr, pr_size, max, d->kT / 1000.);
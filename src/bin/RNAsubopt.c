@@ -49,11 +49,38 @@ struct nr_en_data {
 };
 
 
+struct sorted_data {
+  FILE                  *output;
+  vrna_fold_compound_t  *fc;
+  int                   delta;
+  int                   header;   /* header line still to be printed */
+};
+
+
 PRIVATE void
 print_samples(const char  *structure,
               void        *data);
 
 
+PRIVATE void
+print_subopt(const char *structure,
+             float      energy,
+             void       *data);
+
+
+PRIVATE void
+print_subopt_sorted(const char  *structure,
+                    float       energy,
+                    void        *data);
+
+
+PRIVATE void
+print_subopt_header(FILE                  *output,
+                    vrna_fold_compound_t  *fc,
+                    float                 min_en,
+                    int                   delta);
+
+
 PRIVATE void
 print_samples_en(const char *structure,
                  void       *data);
@@ -72,7 +99,10 @@ main(int  argc,
   unsigned int                        rec_type, read_opt;
   int                                 i, length, cl, istty, delta, n_back, noconv, dos, zuker,
                                       with_shapes, verbose, enforceConstraints, st_back_en, batch,
-                                      tofile, filename_full, canonicalBPonly, nonRedundant;
+                                      tofile, filename_full, canonicalBPonly, nonRedundant,
+                                      with_seed;
+  long                                seed;
+  size_t                              max_memory;
   double                              deltap;
   vrna_md_t                           md;
   dataset_id                          id_control;
@@ -95,6 +125,9 @@ main(int  argc,
   canonicalBPonly = 0;
   commands        = NULL;
   nonRedundant    = 0;
+  with_seed       = 0;
+  seed            = 0;
+  max_memory      = 0;
 
   set_model_details(&md);
 
@@ -160,8 +193,20 @@ main(int  argc,
     subopt_sorted = VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC;
     if (args_info.en_only_given)
       subopt_sorted = VRNA_SORT_BY_ENERGY_ASC;
+
+    /* memory budget for sorting */
+    if (args_info.max_memory_given) {
+      if (args_info.max_memory_arg > 0)
+        max_memory = (size_t)args_info.max_memory_arg * 1024 * 1024;
+      else
+        vrna_message_warning("Memory limit must be positive, sorting in memory instead");
+    }
   }
 
+  /* number of threads for parallel enumeration and sampling */
+  if (args_info.numThreads_given)
+    md.threads = args_info.numThreads_arg;
+
   /* stochastic backtracking */
   if (args_info.stochBT_given) {
     n_back = args_info.stochBT_arg;
@@ -242,6 +287,12 @@ main(int  argc,
   if (args_info.nonRedundant_given)
     nonRedundant = 1;
 
+  /* reproducible stochastic backtracking */
+  if (args_info.seed_given) {
+    with_seed = 1;
+    seed      = args_info.seed_arg;
+  }
+
   if (args_info.commands_given)
     commands = vrna_file_commands_read(args_info.commands_arg,
                                        VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
@@ -454,6 +505,9 @@ main(int  argc,
       ens_en  = vrna_pf(vc, structure);
       kT      = vc->exp_params->kT / 1000.;
 
+      if (with_seed)
+        vrna_pbacktrack_set_seed(vc, (unsigned long long)seed);
+
       if (st_back_en) {
         struct nr_en_data dat;
         dat.output  = output;
@@ -483,7 +537,31 @@ main(int  argc,
         free(head);
       }
 
-      vrna_subopt(vc, delta, subopt_sorted, output);
+      if (max_memory > 0) {
+        /*
+         *  sorted output with bounded memory, print structures as they come. The
+         *  first structure is the MFE structure, so the header is printed along with
+         *  it, unless re-evaluated energies require the MFE of the actual model
+         */
+        struct sorted_data dat;
+
+        dat.output  = output;
+        dat.fc      = vc;
+        dat.delta   = delta;
+        dat.header  = 1;
+
+        if ((logML != 0) || (md.dangles == 1) || (md.dangles == 3)) {
+          print_subopt_header(output,
+                              vc,
+                              (vc->strands > 1) ? vrna_mfe_dimer(vc, NULL) : vrna_mfe(vc, NULL),
+                              delta);
+          dat.header = 0;
+        }
+
+        vrna_subopt_sorted_cb(vc, delta, subopt_sorted, max_memory, &print_subopt_sorted, (void *)&dat);
+      } else {
+        vrna_subopt(vc, delta, subopt_sorted, output);
+      }
 
       if (dos) {
         int i;
@@ -588,6 +666,55 @@ print_samples(const char  *structure,
 }
 
 
+PRIVATE void
+print_subopt(const char *structure,
+             float      energy,
+             void       *data)
+{
+  if (structure) {
+    char *e_string = vrna_strdup_printf(" %6.2f", energy);
+    print_structure((FILE *)data, structure, e_string);
+    free(e_string);
+  }
+}
+
+
+PRIVATE void
+print_subopt_sorted(const char  *structure,
+                    float       energy,
+                    void        *data)
+{
+  struct sorted_data *d = (struct sorted_data *)data;
+
+  if (d->header) {
+    /* no structure at all within the constraints, so we need to ask for the MFE */
+    if (!structure)
+      energy = (d->fc->strands > 1) ? vrna_mfe_dimer(d->fc, NULL) : vrna_mfe(d->fc, NULL);
+
+    print_subopt_header(d->output, d->fc, energy, d->delta);
+    d->header = 0;
+  }
+
+  print_subopt(structure, energy, (void *)d->output);
+}
+
+
+PRIVATE void
+print_subopt_header(FILE                  *output,
+                    vrna_fold_compound_t  *fc,
+                    float                 min_en,
+                    int                   delta)
+{
+  char *SeQ, *energies;
+
+  SeQ       = vrna_cut_point_insert(fc->sequence, fc->cutpoint);
+  energies  = vrna_strdup_printf(" %6.2f %6.2f", min_en, (float)delta / 100.);
+  print_structure(output, SeQ, energies);
+  free(SeQ);
+  free(energies);
+}
+
+
 PRIVATE void
 print_samples_en(const char *structure,
                  void       *data)
@@ -7,6 +7,10 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -18,6 +22,29 @@
 #include <string.h>
 #include <errno.h>
 
+#if VRNA_WITH_PTHREADS
+#include <pthread.h>
+#endif
+
+/*
+ *  Per-worker storage slots. Each thread that calls worker_storage() receives
+ *  its own slot. All slots are kept in a list such that worker_storage_free()
+ *  can release the data once all workers are done.
+ */
+struct worker_slot {
+  void                *data;
+  struct worker_slot  *next;
+};
+
+static struct worker_slot *worker_slots = NULL;
+static void (*worker_slot_free)(void *) = NULL;
+
+#if VRNA_WITH_PTHREADS
+static pthread_key_t    worker_slot_key;
+static pthread_mutex_t  worker_slot_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int              worker_slot_key_init = 0;
+#endif
+
 
 int
 num_proc_cores(int  *num_cores,
@@ -134,3 +161,82 @@ max_user_threads(void)
 
   return threadm;
 }
+
+
+void
+worker_storage_init(void (*free_data)(void *))
+{
+  worker_slot_free = free_data;
+
+#if VRNA_WITH_PTHREADS
+  if (!worker_slot_key_init) {
+    pthread_key_create(&worker_slot_key, NULL);
+    worker_slot_key_init = 1;
+  }
+
+#endif
+}
+
+
+void **
+worker_storage(void)
+{
+  struct worker_slot *slot;
+
+#if VRNA_WITH_PTHREADS
+  if (worker_slot_key_init) {
+    slot = (struct worker_slot *)pthread_getspecific(worker_slot_key);
+    if (slot)
+      return &(slot->data);
+  }
+
+#else
+  if (worker_slots)
+    return &(worker_slots->data);
+
+#endif
+
+  slot = (struct worker_slot *)calloc(1, sizeof(struct worker_slot));
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&worker_slot_mutex);
+#endif
+
+  slot->next    = worker_slots;
+  worker_slots  = slot;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&worker_slot_mutex);
+
+  if (worker_slot_key_init)
+    pthread_setspecific(worker_slot_key, slot);
+
+#endif
+
+  return &(slot->data);
+}
+
+
+void
+worker_storage_free(void)
+{
+  struct worker_slot *slot, *next;
+
+  for (slot = worker_slots; slot; slot = next) {
+    next = slot->next;
+    if ((slot->data) && (worker_slot_free))
+      worker_slot_free(slot->data);
+
+    free(slot);
+  }
+
+  worker_slots = NULL;
+
+#if VRNA_WITH_PTHREADS
+  if (worker_slot_key_init) {
+    pthread_key_delete(worker_slot_key);
+    worker_slot_key_init = 0;
+  }
+
+#endif
+}
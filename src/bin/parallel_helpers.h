@@ -6,6 +6,16 @@
 #include <pthread.h>
 #include "thpool.h"
 
+/*
+ *  Number of pending jobs per worker thread the input reader may queue
+ *  before it blocks and waits for a worker to take the next job. This
+ *  keeps all workers busy while limiting the memory occupied by input
+ *  records (and buffered output) that wait for processing.
+ */
+#ifndef VRNA_JOB_QUEUE_DEPTH
+#define VRNA_JOB_QUEUE_DEPTH 4
+#endif
+
 pthread_mutex_t output_mutex;
 pthread_mutex_t output_file_mutex;
 unsigned int    max_threads;
@@ -47,7 +57,8 @@ threadpool      worker_pool;
     if (max_threads > 1) { \
       pthread_mutex_init(&output_mutex, NULL); \
       pthread_mutex_init(&output_file_mutex, NULL); \
-      worker_pool = thpool_init(max_threads); \
+      worker_pool = thpool_init_bounded(max_threads, \
+                                        max_threads * VRNA_JOB_QUEUE_DEPTH); \
     } \
 }
 
@@ -66,10 +77,8 @@ threadpool      worker_pool;
 }
 
 #define WAIT_FOR_FREE_SLOT(a) { \
-    if (max_threads > 1) { \
-      while (thpool_num_threads_working(worker_pool) == (a)) \
-        sleep(1); \
-    } \
+    if (max_threads > 1) \
+      thpool_wait_for_free_slot(worker_pool); \
 }
 
 #else
@@ -93,4 +102,24 @@ int
 max_user_threads(void);
 
 
+/*
+ *  Per-worker storage, e.g. to keep a fold compound alive between
+ *  consecutive jobs processed by the same worker thread. worker_storage()
+ *  returns the address of a pointer that is private to the calling thread
+ *  and initially NULL. Once all workers are done, worker_storage_free()
+ *  releases every non-NULL pointer by means of the function passed to
+ *  worker_storage_init().
+ */
+void
+worker_storage_init(void (*free_data)(void *));
+
+
+void **
+worker_storage(void);
+
+
+void
+worker_storage_free(void);
+
+
 #endif
@@ -0,0 +1,34 @@
+#! /bin/bash
+
+#
+# This file has tests for threadpools with a bounded job queue
+#
+
+. funcs.sh
+
+
+# ---------------------------- Tests -----------------------------------
+
+
+function test_bounded_queue { #threads #max_jobs
+	echo "Will test bounded job queue ($1 threads, at most $2 pending)"
+	compile src/bounded_queue.c
+	output=$(./test $1 $2 | tail -n 1; exit ${PIPESTATUS[0]})
+
+	if (( $? != 0 )); then
+		err "Bounded job queue failed: $output" "$output"
+		exit 1
+	fi
+
+	if [ "$output" != "done $(( $1 + $2 + 1 ))" ]; then
+		err "Expected $(( $1 + $2 + 1 )) jobs done but got $output" "$output"
+		exit 1
+	fi
+}
+
+
+# Run tests
+test_bounded_queue 1 1
+test_bounded_queue 1 4
+test_bounded_queue 4 16
+test_bounded_queue 8 8
@@ -14,5 +14,6 @@
 . heap_stack_garbage.sh
 . memleaks.sh
 . wait.sh
+. bounded_queue.sh
 
 echo "No errors"
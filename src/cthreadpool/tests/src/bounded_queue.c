@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include "../../thpool.h"
+
+
+/*
+ * This program takes 2 arguments: number of threads,
+ *                                 maximum number of pending jobs
+ *
+ * All jobs block on a gate that is opened by the main thread, so the
+ * state of the threadpool is known at every point:
+ *
+ *  1. one job per thread is added and the program waits until all of
+ *     them run, i.e. the job queue is empty and all threads are busy
+ *  2. another max_jobs jobs are added, which must not block
+ *  3. a producer thread adds one more job, which must block since the
+ *     queue is full
+ *  4. a single job is allowed to finish, which frees a slot and must
+ *     unblock the producer
+ *  5. the gate is opened for all remaining jobs
+ *
+ * The program prints the number of jobs done and exits non-zero if any
+ * of the above does not hold. An alarm aborts the program if it hangs.
+ *
+ * */
+
+
+pthread_mutex_t mutex   = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  changed = PTHREAD_COND_INITIALIZER;
+int             started = 0;
+int             done    = 0;
+int             permits = 0;
+int             added   = 0;
+
+
+void gated_job(void* arg){
+	pthread_mutex_lock(&mutex);
+	started++;
+	pthread_cond_broadcast(&changed);
+
+	while (permits == 0)
+		pthread_cond_wait(&changed, &mutex);
+
+	if (permits > 0)
+		permits--;
+	done++;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void* producer(void* thpool){
+	thpool_add_work((threadpool)thpool, gated_job, NULL);
+
+	pthread_mutex_lock(&mutex);
+	added = 1;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+
+	return NULL;
+}
+
+
+void fail(const char* msg){
+	printf("%s\n", msg);
+	exit(1);
+}
+
+
+int main(int argc, char *argv[]){
+
+	char* p;
+	if (argc != 3){
+		puts("This testfile needs excactly two arguments");
+		exit(1);
+	}
+	int num_threads = strtol(argv[1], &p, 10);
+	int max_jobs    = strtol(argv[2], &p, 10);
+
+	if ((num_threads < 1) || (max_jobs < 1))
+		fail("Need at least one thread and one job slot");
+
+	/* abort instead of hanging if the queue blocks when it must not */
+	alarm(20);
+
+	threadpool thpool = thpool_init_bounded(num_threads, max_jobs);
+
+	int n;
+	for (n=0; n<num_threads; n++)
+		thpool_add_work(thpool, gated_job, NULL);
+
+	pthread_mutex_lock(&mutex);
+	while (started < num_threads)
+		pthread_cond_wait(&changed, &mutex);
+	pthread_mutex_unlock(&mutex);
+
+	/* all threads are busy, so these jobs stay in the queue */
+	for (n=0; n<max_jobs; n++)
+		thpool_add_work(thpool, gated_job, NULL);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, producer, thpool);
+
+	/* the queue is full, so the producer must still be blocked */
+	struct timespec timeout;
+	clock_gettime(CLOCK_REALTIME, &timeout);
+	timeout.tv_nsec += 200000000;
+	if (timeout.tv_nsec >= 1000000000){
+		timeout.tv_sec  += 1;
+		timeout.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&mutex);
+	int ret = 0;
+	while ((!added) && (ret != ETIMEDOUT))
+		ret = pthread_cond_timedwait(&changed, &mutex, &timeout);
+
+	if (added)
+		fail("Job was added to a full queue");
+
+	if (started != num_threads)
+		fail("Queued job started while all jobs were blocked");
+
+	/* let a single job finish, which frees a slot in the queue */
+	permits = 1;
+	pthread_cond_broadcast(&changed);
+
+	while (!added)
+		pthread_cond_wait(&changed, &mutex);
+
+	/* open the gate for all remaining jobs */
+	permits = -1;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+
+	pthread_join(thread, NULL);
+	thpool_wait(thpool);
+
+	printf("done %d\n", done);
+
+	thpool_destroy(thpool);
+
+	return 0;
+}
@@ -81,7 +81,9 @@ typedef struct jobqueue{
 	job  *front;                         /* pointer to front of queue */
 	job  *rear;                          /* pointer to rear  of queue */
 	bsem *has_jobs;                      /* flag as binary semaphore  */
+	pthread_cond_t has_space;            /* signal to blocked pushers */
 	int   len;                           /* number of jobs in queue   */
+	int   max_len;                       /* queue capacity, 0 = none  */
 } jobqueue;
 
 
@@ -116,7 +118,7 @@ static int  thread_init(thpool_* thpool_p, struct thread** thread_p, int id);
 static void* thread_do(struct thread* thread_p);
 static void  thread_destroy(struct thread* thread_p);
 
-static int   jobqueue_init(jobqueue* jobqueue_p);
+static int   jobqueue_init(jobqueue* jobqueue_p, int max_len);
 static void  jobqueue_clear(jobqueue* jobqueue_p);
 static void  jobqueue_push(jobqueue* jobqueue_p, struct job* newjob_p);
 static struct job* jobqueue_pull(jobqueue* jobqueue_p);
@@ -137,6 +139,12 @@ static void  bsem_wait(struct bsem *bsem_p);
 
 /* Initialise thread pool */
 struct thpool_* thpool_init(int num_threads){
+	return thpool_init_bounded(num_threads, 0);
+}
+
+
+/* Initialise thread pool with a bounded job queue */
+struct thpool_* thpool_init_bounded(int num_threads, int max_jobs){
 
 	threads_on_hold   = 0;
 	threads_keepalive = 1;
@@ -158,7 +166,10 @@ struct thpool_* thpool_init(int num_threads){
 	thpool_p->num_jobs_done = 0;
 
 	/* Initialise the job queue */
-	if (jobqueue_init(&thpool_p->jobqueue) == -1){
+	if (max_jobs < 0){
+		max_jobs = 0;
+	}
+	if (jobqueue_init(&thpool_p->jobqueue, max_jobs) == -1){
 		err("thpool_init(): Could not allocate memory for job queue\n");
 		free(thpool_p);
 		return NULL;
@@ -226,6 +237,18 @@ void thpool_wait(thpool_* thpool_p){
 }
 
 
+/* Wait until the job queue has room for another job */
+void thpool_wait_for_free_slot(thpool_* thpool_p){
+	jobqueue* jobqueue_p = &thpool_p->jobqueue;
+
+	pthread_mutex_lock(&jobqueue_p->rwmutex);
+	while (jobqueue_p->max_len && jobqueue_p->len >= jobqueue_p->max_len) {
+		pthread_cond_wait(&jobqueue_p->has_space, &jobqueue_p->rwmutex);
+	}
+	pthread_mutex_unlock(&jobqueue_p->rwmutex);
+}
+
+
 /* Destroy the threadpool */
 void thpool_destroy(thpool_* thpool_p){
 	/* No need to destory if it's NULL */
@@ -392,8 +415,9 @@ static void thread_destroy (thread* thread_p){
 
 
 /* Initialize queue */
-static int jobqueue_init(jobqueue* jobqueue_p){
+static int jobqueue_init(jobqueue* jobqueue_p, int max_len){
 	jobqueue_p->len = 0;
+	jobqueue_p->max_len = max_len;
 	jobqueue_p->front = NULL;
 	jobqueue_p->rear  = NULL;
 
@@ -403,6 +427,7 @@ static int jobqueue_init(jobqueue* jobqueue_p){
 	}
 
 	pthread_mutex_init(&(jobqueue_p->rwmutex), NULL);
+	pthread_cond_init(&(jobqueue_p->has_space), NULL);
 	bsem_init(jobqueue_p->has_jobs, 0);
 
 	return 0;
@@ -424,11 +449,14 @@ static void jobqueue_clear(jobqueue* jobqueue_p){
 }
 
 
-/* Add (allocated) job to queue
+/* Add (allocated) job to queue, blocks while a bounded queue is full
  */
 static void jobqueue_push(jobqueue* jobqueue_p, struct job* newjob){
 
 	pthread_mutex_lock(&jobqueue_p->rwmutex);
+	while (jobqueue_p->max_len && jobqueue_p->len >= jobqueue_p->max_len) {
+		pthread_cond_wait(&jobqueue_p->has_space, &jobqueue_p->rwmutex);
+	}
 	newjob->prev = NULL;
 
 	switch(jobqueue_p->len){
@@ -478,6 +506,11 @@ static struct job* jobqueue_pull(jobqueue* jobqueue_p){
 
 	}
 
+	/* wake up a producer waiting for a free slot */
+	if (job_p && jobqueue_p->max_len) {
+		pthread_cond_broadcast(&jobqueue_p->has_space);
+	}
+
 	pthread_mutex_unlock(&jobqueue_p->rwmutex);
 	return job_p;
 }
@@ -486,6 +519,7 @@ static struct job* jobqueue_pull(jobqueue* jobqueue_p){
 /* Free all queue resources back to the system */
 static void jobqueue_destroy(jobqueue* jobqueue_p){
 	jobqueue_clear(jobqueue_p);
+	pthread_cond_destroy(&jobqueue_p->has_space);
 	free(jobqueue_p->has_jobs);
 }
 
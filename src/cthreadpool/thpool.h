@@ -37,6 +37,30 @@ typedef struct thpool_* threadpool;
 threadpool thpool_init(int num_threads);
 
 
+/**
+ * @brief  Initialize threadpool with a bounded job queue
+ *
+ * Same as thpool_init() but the job queue holds at most max_jobs jobs
+ * that are waiting for execution. Once the queue is full, thpool_add_work()
+ * blocks until a worker thread takes the next job from the queue. This
+ * keeps a producer that is faster than the workers from accumulating an
+ * arbitrary number of pending jobs (and their data) in memory.
+ *
+ * @example
+ *
+ *    ..
+ *    threadpool thpool;
+ *    thpool = thpool_init_bounded(4, 16);   //4 threads, at most 16 pending jobs
+ *    ..
+ *
+ * @param  num_threads   number of threads to be created in the threadpool
+ * @param  max_jobs      maximum number of pending jobs, 0 for an unbounded queue
+ * @return threadpool    created threadpool on success,
+ *                       NULL on error
+ */
+threadpool thpool_init_bounded(int num_threads, int max_jobs);
+
+
 /**
  * @brief Add work to the job queue
  *
@@ -59,6 +83,9 @@ threadpool thpool_init(int num_threads);
  *       ..
  *    }
  *
+ * If the threadpool was initialized with thpool_init_bounded() and the
+ * job queue is full, this function blocks until a slot becomes available.
+ *
  * @param  threadpool    threadpool to which the work will be added
  * @param  function_p    pointer to function to add as work
  * @param  arg_p         pointer to an argument
@@ -67,6 +94,28 @@ threadpool thpool_init(int num_threads);
 int thpool_add_work(threadpool, void (*function_p)(void*), void* arg_p);
 
 
+/**
+ * @brief Wait until the job queue accepts another job
+ *
+ * Blocks the calling thread until the (bounded) job queue has room for at
+ * least one more job, i.e. until the next call to thpool_add_work() will
+ * not block (unless other threads add work concurrently). Returns
+ * immediately for threadpools with an unbounded job queue.
+ *
+ * @example
+ *
+ *    while (read_input(&data)) {
+ *       thpool_wait_for_free_slot(thpool);
+ *       ..                                  // prepare job data
+ *       thpool_add_work(thpool, (void*)process, (void*)data);
+ *    }
+ *
+ * @param threadpool     the threadpool to wait for
+ * @return nothing
+ */
+void thpool_wait_for_free_slot(threadpool);
+
+
 /**
  * @brief Wait for all queued jobs to finish
  *
@@ -0,0 +1,57 @@
+echo "Testing Kinfold (structure store for the neighbourhood cache):"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+# Kinfold is an optional sub-package
+if ! command -v Kinfold > /dev/null ; then
+  echo "...skipping, Kinfold not available"
+  exit 77
+fi
+
+SEQUENCE="GGGAAUUAUUGUCCGCGACAAUCUGGCGUUCCAUUAGAUACG"
+SEED="123=456=789"
+
+# as long as the store is not full, interned cache entries must not change
+# the trajectories
+testline "Trajectories (--cacheStore)"
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --log kinfold_cache0 > kinfold_cache0.out
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --cacheStore=100000 --log kinfold_cache1 > kinfold_cache1.out
+diff=$(${DIFF} kinfold_cache0.out kinfold_cache1.out; ${DIFF} -I Date -I Output -I Cache kinfold_cache0.log kinfold_cache1.log)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# A full store empties the cache, and cache misses alter the trajectories
+# of a simulation that started from a filled cache. Still, the results must
+# be reproducible and complete
+testline "Reproducibility (small --cacheStore)"
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --cacheStore=20 --log kinfold_cache2 > kinfold_cache2.out
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --cacheStore=20 --log kinfold_cache3 > kinfold_cache3.out
+diff=$(${DIFF} kinfold_cache2.out kinfold_cache3.out; ${DIFF} -I Date -I Output kinfold_cache2.log kinfold_cache3.log)
+if [ $(grep -c "^(" kinfold_cache2.log) -ne 4 ] ; then diff="${diff}missing trajectories"; fi
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+testline "Reproducibility (--cacheStore, --grow)"
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 2 --time 1000 --grow 10 --cacheStore=1000 --log kinfold_grow1 > kinfold_grow1.out
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 2 --time 1000 --grow 10 --cacheStore=1000 --log kinfold_grow2 > kinfold_grow2.out
+diff=$(${DIFF} kinfold_grow1.out kinfold_grow2.out; ${DIFF} -I Date -I Output kinfold_grow1.log kinfold_grow2.log)
+if [ $(grep -c "^(" kinfold_grow1.log) -ne 2 ] ; then diff="${diff}missing trajectories"; fi
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm kinfold_cache0.out kinfold_cache1.out kinfold_cache2.out kinfold_cache3.out
+rm kinfold_cache0.log kinfold_cache1.log kinfold_cache2.log kinfold_cache3.log
+rm kinfold_grow1.out kinfold_grow2.out kinfold_grow1.log kinfold_grow2.log
+
+exit ${RETURN}
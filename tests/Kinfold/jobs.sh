@@ -0,0 +1,59 @@
+echo "Testing Kinfold (parallel trajectories):"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+# Kinfold is an optional sub-package
+if ! command -v Kinfold > /dev/null ; then
+  echo "...skipping, Kinfold not available"
+  exit 77
+fi
+
+SEQUENCE="GGGAAUUAUUGUCCGCGACAAUCUGGCGUUCCAUUAGAUACG"
+SEED="123=456=789"
+
+# trajectories must not depend on the number of threads
+testline "Trajectories (--jobs=1 vs. --jobs=4)"
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 8 --time 1000 --jobs=1 --log kinfold_jobs1 > kinfold_jobs1.out
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 8 --time 1000 --jobs=4 --log kinfold_jobs4 > kinfold_jobs4.out
+diff=$(${DIFF} kinfold_jobs1.out kinfold_jobs4.out; ${DIFF} -I Date -I Output -I Parallel kinfold_jobs1.log kinfold_jobs4.log)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# each trajectory is reproduced by the seed written to the log file
+testline "Trajectory seeds in log file"
+diff=""
+grep "^(" kinfold_jobs4.log | while read line
+do
+  seed=$(echo "${line}" | sed 's/^( *\([0-9]*\) *\([0-9]*\) *\([0-9]*\)).*$/\1=\2=\3/')
+  rm -f kinfold_seed.log # Kinfold appends to existing log files
+  echo ${SEQUENCE} | Kinfold --seed ${seed} --num 1 --time 1000 --log kinfold_seed > /dev/null
+  ${DIFF} <(echo "${line}") <(grep "^(" kinfold_seed.log)
+done > kinfold_seed.diff
+diff=$(cat kinfold_seed.diff)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# without --jobs, a seeded simulation is reproducible as well
+testline "Seeded simulation (no --jobs)"
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --log kinfold_serial1 > kinfold_serial1.out
+echo ${SEQUENCE} | Kinfold --seed ${SEED} --num 4 --time 1000 --log kinfold_serial2 > kinfold_serial2.out
+diff=$(${DIFF} kinfold_serial1.out kinfold_serial2.out; ${DIFF} -I Date -I Output kinfold_serial1.log kinfold_serial2.log)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm kinfold_jobs1.out kinfold_jobs4.out kinfold_jobs1.log kinfold_jobs4.log
+rm kinfold_seed.log kinfold_seed.diff
+rm kinfold_serial1.out kinfold_serial2.out kinfold_serial1.log kinfold_serial2.log
+
+exit ${RETURN}
@@ -0,0 +1,45 @@
+echo "Testing RNAdos:"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+# The reference densities of states were computed with the hash table
+# based implementation that preceded the energy banded counting
+SEQUENCE="GGGAAUUAUUGUCCGCGACAAUCUGGCGUUCCA"
+
+testline "Density of states (default)"
+RNAdos -s ${SEQUENCE} -e 5 > rnados.dos
+diff=$(${DIFF} ${RNADOS_RESULTSDIR}/rnados.e5.gold rnados.dos)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+testline "Density of states (-d0)"
+RNAdos -s ${SEQUENCE} -e 5 -d 0 > rnados.dos
+diff=$(${DIFF} ${RNADOS_RESULTSDIR}/rnados.e5.d0.gold rnados.dos)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+testline "Density of states (-T 25)"
+RNAdos -s ${SEQUENCE} -e 8 -T 25 > rnados.dos
+diff=$(${DIFF} ${RNADOS_RESULTSDIR}/rnados.e8.T25.gold rnados.dos)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+testline "Density of states (parallel)"
+RNAdos -s ${SEQUENCE} -e 8 -T 25 -j 4 > rnados.dos
+diff=$(${DIFF} ${RNADOS_RESULTSDIR}/rnados.e8.T25.gold rnados.dos)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm rnados.dos
+
+exit ${RETURN}
@@ -0,0 +1,55 @@
+echo "Testing RNAsubopt (stochastic backtracking):"
+
+RETURN=0
+
+function failed {
+    RETURN=1
+    echo " [ NOT OK ]"
+}
+
+function passed {
+    echo " [ OK ]"
+}
+
+function testline {
+  echo -en "...testing $1:\t\t"
+}
+
+SEQUENCE="GGGAAUUAUUGUCCGCGACAAUCUGGCGUUCCAUUAGAUACG"
+
+# repeated runs with the same seed must draw identical samples
+testline "Seeded sampling (repeated)"
+echo ${SEQUENCE} | RNAsubopt -p 100 --seed 4711 > rnasubopt_seed1.out
+echo ${SEQUENCE} | RNAsubopt -p 100 --seed 4711 > rnasubopt_seed2.out
+diff=$(${DIFF} rnasubopt_seed1.out rnasubopt_seed2.out)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# samples must not depend on the number of threads
+testline "Seeded sampling (-j1 vs. -j4)"
+echo ${SEQUENCE} | RNAsubopt -p 100 --seed 4711 -j1 > rnasubopt_seed1.out
+echo ${SEQUENCE} | RNAsubopt -p 100 --seed 4711 -j4 > rnasubopt_seed2.out
+diff=$(${DIFF} rnasubopt_seed1.out rnasubopt_seed2.out)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# energies and probabilities are printed along with the same samples
+testline "Seeded sampling (--stochBT_en)"
+echo ${SEQUENCE} | RNAsubopt --stochBT_en 100 --seed 4711 > rnasubopt_seed2.out
+diff=$(${DIFF} <(cut -d ' ' -f 1 rnasubopt_seed1.out) <(cut -d ' ' -f 1 rnasubopt_seed2.out))
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# a different seed yields different samples
+testline "Seeded sampling (different seeds)"
+echo ${SEQUENCE} | RNAsubopt -p 100 --seed 4712 > rnasubopt_seed2.out
+if ${DIFF} rnasubopt_seed1.out rnasubopt_seed2.out > /dev/null ; then failed; else passed; fi
+
+# non-redundant samples are reproducible as well
+testline "Seeded non-redundant sampling"
+echo ${SEQUENCE} | RNAsubopt -p 100 -N --seed 4711 > rnasubopt_seed1.out
+echo ${SEQUENCE} | RNAsubopt -p 100 -N --seed 4711 -j4 > rnasubopt_seed2.out
+diff=$(${DIFF} rnasubopt_seed1.out rnasubopt_seed2.out)
+if [ "x${diff}" != "x" ] ; then failed; echo -e "$diff"; else passed; fi
+
+# clean up
+rm rnasubopt_seed1.out rnasubopt_seed2.out
+
+exit ${RETURN}
@@ -0,0 +1,348 @@
+/*
+ *  Micro-benchmark for vrna_hash_table_t
+ *
+ *  Compares the open-addressing hash table of RNAlib against the
+ *  fixed-size table of per-bucket entry lists it replaced (ViennaRNA
+ *  <= 2.4.17, reproduced below). Keys are random dot-bracket strings
+ *  of length 100 that are hashed and compared with the default
+ *  callbacks vrna_ht_db_hash_func() and vrna_ht_db_comp().
+ *
+ *  For each table, the benchmark
+ *  - inserts N entries,
+ *  - performs N look-ups with 50% hits,
+ *  - removes N/2 entries, and
+ *  - performs another N look-ups
+ *
+ *  and reports the CPU time of each step in seconds. For the current
+ *  table, the time of vrna_ht_insert_bulk() is reported as well.
+ *
+ *  Usage: hash_table [N]   (default: N = 1000000)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/datastructures/hash_tables.h>
+
+#define KEY_LENGTH  100
+
+
+/*
+ #################################
+ # Previous hash table           #
+ #################################
+ */
+
+typedef struct {
+  unsigned long length;
+  unsigned long allocated_length;
+  void          **hash_entries;
+} chained_list_t;
+
+
+typedef struct {
+  unsigned long                     Hash_size;
+  chained_list_t                    **Hash_table;
+  vrna_callback_ht_compare_entries  *Compare_function;
+  vrna_callback_ht_hash_function    *Hash_function;
+} chained_table_t;
+
+
+static chained_table_t *
+chained_init(unsigned int hash_bits)
+{
+  chained_table_t *ht = (chained_table_t *)vrna_alloc(sizeof(chained_table_t));
+
+  ht->Hash_size         = (((unsigned long)1 << hash_bits) - 1);
+  ht->Hash_table        = (chained_list_t **)vrna_alloc(sizeof(chained_list_t *) *
+                                                        (ht->Hash_size + 1));
+  ht->Compare_function  = &vrna_ht_db_comp;
+  ht->Hash_function     = &vrna_ht_db_hash_func;
+
+  return ht;
+}
+
+
+static void *
+chained_get(chained_table_t *ht,
+            void            *x)
+{
+  unsigned int    hashval;
+  unsigned long   i;
+  chained_list_t  *entries;
+
+  hashval = ht->Hash_function(x, ht->Hash_size);
+  entries = ht->Hash_table[hashval];
+
+  if (entries)
+    for (i = 0; i < entries->length; i++)
+      if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
+        return entries->hash_entries[i];
+
+  return NULL;
+}
+
+
+static int
+chained_insert(chained_table_t  *ht,
+               void             *x)
+{
+  unsigned int    hashval;
+  unsigned long   i;
+  chained_list_t  *entries;
+
+  hashval = ht->Hash_function(x, ht->Hash_size);
+  entries = ht->Hash_table[hashval];
+
+  if (entries) {
+    for (i = 0; i < entries->length; i++)
+      if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
+        return 0;
+
+    if (entries->length >= entries->allocated_length) {
+      entries->allocated_length += 100;
+      entries->hash_entries     = vrna_realloc(entries->hash_entries,
+                                               sizeof(void *) * entries->allocated_length);
+    }
+
+    entries->hash_entries[entries->length++] = x;
+  } else {
+    entries                   = (chained_list_t *)vrna_alloc(sizeof(chained_list_t));
+    entries->allocated_length = 2;
+    entries->hash_entries     = vrna_alloc(sizeof(void *) * entries->allocated_length);
+    entries->hash_entries[0]  = x;
+    entries->length           = 1;
+    ht->Hash_table[hashval]   = entries;
+  }
+
+  return 0;
+}
+
+
+static void
+chained_remove(chained_table_t  *ht,
+               void             *x)
+{
+  unsigned int    hashval;
+  unsigned long   i;
+  chained_list_t  *entries;
+
+  hashval = ht->Hash_function(x, ht->Hash_size);
+  entries = ht->Hash_table[hashval];
+
+  if (entries) {
+    for (i = 0; i < entries->length; i++) {
+      if (ht->Compare_function(x, entries->hash_entries[i]) == 0) {
+        memmove(entries->hash_entries + i,
+                entries->hash_entries + i + 1,
+                sizeof(void *) * (entries->length - i - 1));
+        entries->length--;
+        return;
+      }
+    }
+  }
+}
+
+
+static void
+chained_free(chained_table_t *ht)
+{
+  unsigned long i;
+
+  for (i = 0; i <= ht->Hash_size; i++) {
+    if (ht->Hash_table[i]) {
+      free(ht->Hash_table[i]->hash_entries);
+      free(ht->Hash_table[i]);
+    }
+  }
+
+  free(ht->Hash_table);
+  free(ht);
+}
+
+
+/*
+ #################################
+ # Benchmark                     #
+ #################################
+ */
+
+/* entries are owned by the benchmark, so the tables must not free them */
+static int
+free_nothing(void *x)
+{
+  return 0;
+}
+
+
+static unsigned long long
+rng_next(unsigned long long *state)
+{
+  unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+
+static vrna_ht_entry_db_t *
+random_entries(unsigned long num)
+{
+  unsigned long       i, j;
+  unsigned long long  state = 1;
+  vrna_ht_entry_db_t  *entries;
+
+  entries = (vrna_ht_entry_db_t *)vrna_alloc(sizeof(vrna_ht_entry_db_t) * num);
+
+  for (i = 0; i < num; i++) {
+    entries[i].structure = (char *)vrna_alloc(sizeof(char) * (KEY_LENGTH + 1));
+    for (j = 0; j < KEY_LENGTH; j++)
+      entries[i].structure[j] = "(.)"[rng_next(&state) % 3];
+    entries[i].energy = (float)i;
+  }
+
+  return entries;
+}
+
+
+static double
+seconds_since(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+/* half of all look-ups hit, the other half asks for entries num..2num-1 */
+#define LOOKUPS(get, ht, e, num, hits) \
+  { \
+    unsigned long _i; \
+    for (_i = 0; _i < (num); _i++) \
+      if (get((ht), (_i & 1) ? &((e)[(num) + _i]) : &((e)[_i]))) \
+        (hits)++; \
+  }
+
+
+static void
+bench_chained(vrna_ht_entry_db_t  *e,
+              unsigned long       num,
+              unsigned int        bits)
+{
+  unsigned long   i, hits;
+  clock_t         start;
+  double          t_ins, t_get, t_rem, t_get2;
+  chained_table_t *ht;
+
+  hits  = 0;
+  ht    = chained_init(bits);
+
+  start = clock();
+  for (i = 0; i < num; i++)
+    chained_insert(ht, &(e[i]));
+  t_ins = seconds_since(start);
+
+  start = clock();
+  LOOKUPS(chained_get, ht, e, num, hits);
+  t_get = seconds_since(start);
+
+  start = clock();
+  for (i = 0; i < num; i += 2)
+    chained_remove(ht, &(e[i]));
+  t_rem = seconds_since(start);
+
+  start = clock();
+  LOOKUPS(chained_get, ht, e, num, hits);
+  t_get2 = seconds_since(start);
+
+  printf("  old 2^%-2u: %6.2f insert %6.2f get %6.2f remove %6.2f get  (%lu hits)\n",
+         bits, t_ins, t_get, t_rem, t_get2, hits);
+
+  chained_free(ht);
+}
+
+
+static void
+bench_current(vrna_ht_entry_db_t  *e,
+              unsigned long       num,
+              unsigned int        bits)
+{
+  unsigned long     i, hits;
+  clock_t           start;
+  double            t_ins, t_get, t_rem, t_get2, t_bulk;
+  void              **ptrs;
+  vrna_hash_table_t ht;
+
+  hits  = 0;
+  ht    = vrna_ht_init(bits, &vrna_ht_db_comp, &vrna_ht_db_hash_func, &free_nothing);
+
+  start = clock();
+  for (i = 0; i < num; i++)
+    vrna_ht_insert(ht, &(e[i]));
+  t_ins = seconds_since(start);
+
+  start = clock();
+  LOOKUPS(vrna_ht_get, ht, e, num, hits);
+  t_get = seconds_since(start);
+
+  start = clock();
+  for (i = 0; i < num; i += 2)
+    vrna_ht_remove(ht, &(e[i]));
+  t_rem = seconds_since(start);
+
+  start = clock();
+  LOOKUPS(vrna_ht_get, ht, e, num, hits);
+  t_get2 = seconds_since(start);
+
+  vrna_ht_free(ht);
+
+  ptrs = (void **)vrna_alloc(sizeof(void *) * num);
+  for (i = 0; i < num; i++)
+    ptrs[i] = &(e[i]);
+
+  ht    = vrna_ht_init(bits, &vrna_ht_db_comp, &vrna_ht_db_hash_func, &free_nothing);
+  start = clock();
+  vrna_ht_insert_bulk(ht, ptrs, num);
+  t_bulk = seconds_since(start);
+
+  printf("  new 2^%-2u: %6.2f insert %6.2f get %6.2f remove %6.2f get  (%lu hits, bulk %.2f)\n",
+         bits, t_ins, t_get, t_rem, t_get2, hits, t_bulk);
+
+  vrna_ht_free(ht);
+  free(ptrs);
+}
+
+
+int
+main(int  argc,
+     char *argv[])
+{
+  unsigned long       i, num;
+  vrna_ht_entry_db_t  *entries;
+
+  num = 1000000;
+
+  if (argc > 1)
+    num = strtoul(argv[1], NULL, 10);
+
+  if (num == 0) {
+    fprintf(stderr, "usage: %s [N]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  /* entries 0..N-1 are inserted, entries N..2N-1 serve as misses */
+  entries = random_entries(2 * num);
+
+  printf("N=%lu\n", num);
+  bench_chained(entries, num, 16);
+  bench_chained(entries, num, 22);
+  bench_current(entries, num, 10);
+
+  for (i = 0; i < 2 * num; i++)
+    free(entries[i].structure);
+  free(entries);
+
+  return EXIT_SUCCESS;
+}
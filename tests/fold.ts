@@ -1,5 +1,12 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <string.h>     /* strcmp, memcpy */
+#include <math.h>       /* fabs */
+
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+#include <malloc.h>     /* mallinfo2 */
+#define WITH_MALLINFO2
+#endif
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
@@ -7,7 +14,279 @@
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/dp_matrices.h>
 #include <ViennaRNA/part_func.h>
+#include <ViennaRNA/constraints/soft.h>
+#include <ViennaRNA/subopt.h>
+#include <ViennaRNA/heat_capacity.h>
+#include <ViennaRNA/part_func_window.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
+
+#ifdef _OPENMP
+/*
+ *  Most parallel code paths are limited to the number of processors reported
+ *  by the OpenMP runtime. Pretend to have several of them, such that these
+ *  paths are tested on single-core machines as well
+ */
+int
+omp_get_num_procs(void)
+{
+  return 8;
+}
+
+
+#endif
+
+struct subopt_sorted_dat {
+  int   num;
+  int   unsorted;
+  float last_energy;
+};
+
+
+static void
+subopt_sorted_cb(const char *structure,
+                 float      energy,
+                 void       *data)
+{
+  struct subopt_sorted_dat *d = (struct subopt_sorted_dat *)data;
+
+  if (structure) {
+    if ((d->num > 0) && (energy < d->last_energy))
+      d->unsorted++;
+
+    d->last_energy = energy;
+    d->num++;
+  }
+}
+
+
+struct subopt_list {
+  vrna_subopt_solution_t  *sol;
+  int                     n;
+  int                     size;
+};
+
+
+static void
+subopt_list_cb(const char *structure,
+               float      energy,
+               void       *data)
+{
+  struct subopt_list *l = (struct subopt_list *)data;
+
+  if (structure) {
+    if (l->n == l->size) {
+      l->size = (l->size) ? 2 * l->size : 64;
+      l->sol  = (vrna_subopt_solution_t *)vrna_realloc(l->sol,
+                                                       sizeof(vrna_subopt_solution_t) * l->size);
+    }
+
+    l->sol[l->n].structure  = strdup(structure);
+    l->sol[l->n].energy     = energy;
+    l->n++;
+  }
+}
+
+
+static void
+subopt_list_free(struct subopt_list *l)
+{
+  int i;
+
+  for (i = 0; i < l->n; i++)
+    free(l->sol[i].structure);
+
+  free(l->sol);
+  l->sol  = NULL;
+  l->n    = l->size = 0;
+}
+
+
+/* order by energy first, and lexicographically within the same energy */
+static int
+subopt_list_cmp(const void  *a,
+                const void  *b)
+{
+  const vrna_subopt_solution_t  *x  = (const vrna_subopt_solution_t *)a;
+  const vrna_subopt_solution_t  *y  = (const vrna_subopt_solution_t *)b;
+
+  if (x->energy != y->energy)
+    return (x->energy < y->energy) ? -1 : 1;
+
+  return strcmp(x->structure, y->structure);
+}
+
+
+#ifdef WITH_MALLINFO2
+/* heap memory in use while structures are passed to the callback */
+struct subopt_memory {
+  size_t  base;
+  size_t  peak;
+  int     num;
+};
+
+
+static void
+subopt_memory_cb(const char *structure,
+                 float      energy,
+                 void       *data)
+{
+  struct subopt_memory  *m  = (struct subopt_memory *)data;
+  struct mallinfo2      mi  = mallinfo2();
+
+  /* the DP matrices are filled before the first structure arrives */
+  if (m->num == 0)
+    m->base = m->peak = mi.uordblks;
+
+  if (mi.uordblks > m->peak)
+    m->peak = mi.uordblks;
+
+  if (structure)
+    m->num++;
+}
+
+
+#endif
+
+
+struct subopt_hash {
+  unsigned long long  hash;
+  int                 num;
+};
+
+
+/* FNV-1a hash over all structures and energies in the order of the callback calls */
+static void
+subopt_hash_cb(const char *structure,
+               float      energy,
+               void       *data)
+{
+  struct subopt_hash  *h = (struct subopt_hash *)data;
+  const char          *c;
+
+  if (structure) {
+    for (c = structure; *c; c++) {
+      h->hash ^= (unsigned char)*c;
+      h->hash *= 1099511628211ULL;
+    }
+
+    h->hash ^= (unsigned long long)(unsigned int)lroundf(energy * 100);
+    h->hash *= 1099511628211ULL;
+    h->num++;
+  }
+}
+
+
+static void
+random_sequence(char          *sequence,
+                int           length,
+                unsigned int  *state)
+{
+  int i;
+
+  for (i = 0; i < length; i++) {
+    *state      = *state * 1103515245u + 12345u;
+    sequence[i] = "ACGU"[(*state >> 16) & 3];
+  }
+  sequence[length] = '\0';
+}
+
+
+/*
+ *  compare MFE, PF, and base pair probabilities of a (re-used) fold
+ *  compound vc with those of a newly created one
+ */
+static int
+compare_with_fresh_fc(vrna_fold_compound_t  *vc,
+                      const char            *sequence,
+                      vrna_md_t             *md)
+{
+  vrna_fold_compound_t  *vc_ref;
+  char                  *structure, *structure_ref;
+  double                mfe, mfe_ref, en, en_ref;
+  int                   i, j, n, ret;
+
+  vc_ref        = vrna_fold_compound(sequence, md, VRNA_OPTION_DEFAULT);
+  n             = (int)vc_ref->length;
+  structure     = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  structure_ref = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  mfe     = (double)vrna_mfe(vc, structure);
+  mfe_ref = (double)vrna_mfe(vc_ref, structure_ref);
+  vrna_exp_params_rescale(vc, &mfe);
+  vrna_exp_params_rescale(vc_ref, &mfe_ref);
+  en      = (double)vrna_pf(vc, NULL);
+  en_ref  = (double)vrna_pf(vc_ref, NULL);
+
+  ret = ((int)vc->length == n) &&
+        (mfe == mfe_ref) &&
+        (strcmp(structure, structure_ref) == 0) &&
+        (en == en_ref);
+
+  for (i = 1; (ret) && (i < n); i++)
+    for (j = i + 1; j <= n; j++)
+      if (vc->exp_matrices->probs[vc->iindx[i] - j] !=
+          vc_ref->exp_matrices->probs[vc_ref->iindx[i] - j]) {
+        ret = 0;
+        break;
+      }
+
+  free(structure);
+  free(structure_ref);
+  vrna_fold_compound_free(vc_ref);
+
+  return ret;
+}
+
+
+struct window_digest {
+  int                 num;
+  unsigned long long  hash;
+};
+
+
+static void
+window_digest_bytes(struct window_digest  *d,
+                    const void            *p,
+                    size_t                n)
+{
+  const unsigned char *c = (const unsigned char *)p;
+
+  /* FNV-1a */
+  while (n--) {
+    d->hash ^= *c++;
+    d->hash *= 1099511628211ULL;
+  }
+}
+
+
+static void
+window_digest_cb(FLT_OR_DBL   *pr,
+                 int          pr_size,
+                 int          i,
+                 int          max,
+                 unsigned int type,
+                 void         *data)
+{
+  struct window_digest *d = (struct window_digest *)data;
+
+  window_digest_bytes(d, &type, sizeof(type));
+  window_digest_bytes(d, &i, sizeof(int));
+  window_digest_bytes(d, &pr_size, sizeof(int));
+  window_digest_bytes(d, &max, sizeof(int));
+
+  if (type & VRNA_PROBS_WINDOW_UP)
+    window_digest_bytes(d, (double *)pr + 1, sizeof(double) * pr_size);
+  else if (type & VRNA_PROBS_WINDOW_PF)
+    window_digest_bytes(d, (double *)pr + i, sizeof(double) * (pr_size - i + 1));
+  else if (type & VRNA_PROBS_WINDOW_BPP)
+    window_digest_bytes(d, pr + i + 1, sizeof(FLT_OR_DBL) * (pr_size - i));
+
+  d->num++;
+}
+
 
 #suite  MFE_Prediction
 
@@ -24,8 +303,632 @@
   free(structure);
 }
 
+#tcase  Parallel_Fill
+
+#test test_mfe_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const int             length = sizeof(sequence) - 1;
+  char                  structure_serial[length + 1];
+  char                  structure_parallel[length + 1];
+  float                 en_serial, en_parallel;
+  int                   noLP;
+
+  for (noLP = 0; noLP <= 1; noLP++) {
+    vrna_md_set_default(&md);
+    md.noLP     = noLP;
+    md.uniq_ML  = 1;
+
+    vc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    en_serial = vrna_mfe(vc, structure_serial);
+    vrna_fold_compound_free(vc);
+
+    md.threads  = 4;
+    vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    en_parallel = vrna_mfe(vc, structure_parallel);
+    vrna_fold_compound_free(vc);
+
+    ck_assert(en_serial == en_parallel);
+    ck_assert_str_eq(structure_serial, structure_parallel);
+  }
+}
+
+#test test_mfe_threads_many_tiles
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc_serial, *vc_parallel;
+  /* 11 tiles per row, the last one incomplete */
+  const int             length = 700;
+  char                  sequence[length + 1];
+  char                  structure_serial[length + 1];
+  char                  structure_parallel[length + 1];
+  float                 en_serial, en_parallel;
+  unsigned int          r = 12345;
+  int                   i, j, ij, *indx, noLP;
+
+  for (i = 0; i < length; i++) {
+    r           = r * 1103515245u + 12345u;
+    sequence[i] = "ACGU"[(r >> 16) & 3];
+  }
+  sequence[length] = '\0';
+
+  /* serial and parallel fill yield identical matrices, also with the cc arrays of noLP */
+  for (noLP = 0; noLP <= 1; noLP++) {
+    vrna_md_set_default(&md);
+    md.noLP     = noLP;
+    md.threads  = 1;
+    vc_serial   = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    en_serial   = vrna_mfe(vc_serial, structure_serial);
+
+    md.threads  = 4;
+    vc_parallel = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    en_parallel = vrna_mfe(vc_parallel, structure_parallel);
+
+    ck_assert(en_serial == en_parallel);
+    ck_assert_str_eq(structure_serial, structure_parallel);
+
+    indx = vc_serial->jindx;
+    for (j = 1; j <= length; j++)
+      for (i = 1; i < j; i++) {
+        ij = indx[j] + i;
+        ck_assert_int_eq(vc_serial->matrices->c[ij], vc_parallel->matrices->c[ij]);
+        ck_assert_int_eq(vc_serial->matrices->fML[ij], vc_parallel->matrices->fML[ij]);
+      }
+
+    vrna_fold_compound_free(vc_serial);
+    vrna_fold_compound_free(vc_parallel);
+  }
+}
+
+#tcase  Fold_Compound_Recycling
+
+#test test_fold_compound_recycle
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  char                  sequence[301];
+  const int             lengths[] = {
+    300, 80, 250
+  };
+  unsigned int          state = 4711;
+  int                   gquad, k;
+
+  for (gquad = 0; gquad <= 1; gquad++) {
+    vrna_md_set_default(&md);
+    md.gquad  = gquad;
+    vc        = NULL;
+
+    /* long -> short -> long, the matrices of the first sequence are re-used */
+    for (k = 0; k < 3; k++) {
+      random_sequence(sequence, lengths[k], &state);
+      vc = vrna_fold_compound_recycle(vc, sequence, &md, VRNA_OPTION_DEFAULT);
+      ck_assert(vc != NULL);
+      ck_assert(compare_with_fresh_fc(vc, sequence, &md));
+    }
+
+    vrna_fold_compound_free(vc);
+  }
+}
+
+#test test_mx_arena_reuse
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  char                  sequence[301];
+  const int             lengths[] = {
+    300, 80, 250, 40, 120
+  };
+  unsigned int          state = 815;
+  int                   k;
+
+  vc = NULL;
+
+  /*
+   *  change the model details along the way such that the matrices handed
+   *  over are re-carved (with a different layout) from the previous arena
+   */
+  for (k = 0; k < 5; k++) {
+    vrna_md_set_default(&md);
+    switch (k) {
+      case 1:
+        md.gquad = 1;
+        break;
+      case 2:
+        md.uniq_ML = 1;
+        break;
+      case 3:
+        md.circ = 1;
+        break;
+      default:
+        break;
+    }
+
+    random_sequence(sequence, lengths[k], &state);
+    vc = vrna_fold_compound_recycle(vc, sequence, &md, VRNA_OPTION_DEFAULT);
+    ck_assert(compare_with_fresh_fc(vc, sequence, &md));
+
+    /* explicitly re-add the matrices on a fold compound that has been used already */
+    ck_assert(vrna_mx_add(vc, VRNA_MX_DEFAULT, VRNA_OPTION_MFE | VRNA_OPTION_PF));
+    ck_assert(compare_with_fresh_fc(vc, sequence, &md));
+  }
+
+  vrna_fold_compound_free(vc);
+}
+
+#tcase  Batch_Folding
+
+#test test_fold_batch
+{
+  vrna_md_t                 md;
+  vrna_fold_compound_t      *vc;
+  vrna_fold_batch_result_t  *results;
+  /* mixed lengths, an empty sequence, and a dimer */
+  const char                *sequences[] = {
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU",
+    "GGGGAAAACCCC",
+    "",
+    "CGCAGGGAUACCCGCG",
+    "ACGU",
+    "GGGAGGGAGGGAGGGAUUUAGCGCUAGCGCAUCGAUCGUAGCUAGCUAGC",
+    "GGGGAAAACCCC&GGGGUUUUCCCC",
+    "GGGCUAUUAGCUCAGUUGGUUAGAGCGCACCCCUGAUAAGGGUGAGGUCGCUGAUUCGAAUUCAGCAUAGCCCA"
+  };
+  const size_t              num = sizeof(sequences) / sizeof(sequences[0]);
+  char                      *structure;
+  double                    mfe, ens;
+  size_t                    i;
+  int                       threads;
+
+  ck_assert(vrna_fold_batch(sequences, 0, NULL, VRNA_FOLD_BATCH_PF) == NULL);
+  ck_assert(vrna_fold_batch(NULL, num, NULL, VRNA_FOLD_BATCH_PF) == NULL);
+
+  for (threads = 1; threads <= 4; threads += 3) {
+    vrna_md_set_default(&md);
+    md.threads  = threads;
+    results     = vrna_fold_batch(sequences, num, &md, VRNA_FOLD_BATCH_PF);
+
+    ck_assert(results != NULL);
+
+    md.threads      = 1;
+    md.compute_bpp  = 0;
+
+    for (i = 0; i < num; i++) {
+      if (sequences[i][0] == '\0') {
+        ck_assert(results[i].structure == NULL);
+        continue;
+      }
+
+      vc        = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_DEFAULT);
+      structure = (char *)vrna_alloc(sizeof(char) * (vc->length + 1));
+      mfe       = (vc->strands > 1) ? vrna_mfe_dimer(vc, structure) : vrna_mfe(vc, structure);
+      vrna_exp_params_rescale(vc, &mfe);
+      ens = vrna_pf(vc, NULL);
+
+      ck_assert(results[i].structure != NULL);
+      ck_assert_str_eq(results[i].structure, structure);
+      ck_assert(results[i].mfe == (float)mfe);
+      ck_assert(results[i].ensemble_energy == (float)ens);
+
+      free(structure);
+      vrna_fold_compound_free(vc);
+    }
+
+    vrna_fold_batch_free(results, num);
+  }
+}
+
 #suite  Partition_Function
 
+#tcase  Parallel_Fill_PF
+
+#test test_pf_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const int             length = sizeof(sequence) - 1;
+  FLT_OR_DBL            *bpp_serial, *bpp_parallel;
+  double                en_serial, en_parallel;
+  int                   i, j, *iindx;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML  = 1;
+  vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  en_serial   = vrna_pf(vc, NULL);
+  iindx       = vrna_idx_row_wise(length);
+  bpp_serial  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (iindx[1] + 1));
+  memcpy(bpp_serial, vc->exp_matrices->probs, sizeof(FLT_OR_DBL) * (iindx[1] + 1));
+  vrna_fold_compound_free(vc);
+
+  md.threads    = 4;
+  vc            = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  en_parallel   = vrna_pf(vc, NULL);
+  bpp_parallel  = vc->exp_matrices->probs;
+
+  ck_assert(en_serial == en_parallel);
+
+  for (i = 1; i < length; i++)
+    for (j = i + 1; j <= length; j++)
+      ck_assert(bpp_serial[iindx[i] - j] == bpp_parallel[iindx[i] - j]);
+
+  vrna_fold_compound_free(vc);
+  free(bpp_serial);
+  free(iindx);
+}
+
+#tcase  Sliding_Window
+
+#test test_probs_window_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  struct window_digest  serial, parallel;
+  char                  *sequence;
+  int                   i, k, t, n = 12000, ulength[] = {
+    40, 10, 0
+  }, threads[] = {
+    3, 8, 0
+  };
+  unsigned int          options[] = {
+    VRNA_PROBS_WINDOW_UP | VRNA_PROBS_WINDOW_UP_SPLIT | VRNA_PROBS_WINDOW_PF,
+    VRNA_PROBS_WINDOW_BPP | VRNA_PROBS_WINDOW_UP | VRNA_PROBS_WINDOW_UP_SPLIT |
+    VRNA_PROBS_WINDOW_PF
+  };
+
+  /*
+   *  long enough to be split into several blocks, also with uneven block sizes.
+   *  Note, that the number of threads is limited to omp_get_num_procs(), which
+   *  is overridden above to test the parallel code path on any machine
+   */
+  sequence = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  srand(7);
+  for (i = 0; i < n; i++)
+    sequence[i] = "ACGU"[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 50;
+  md.max_bp_span  = 37;
+
+  for (k = 0; ulength[k]; k++) {
+    md.threads  = 1;
+    serial.num  = 0;
+    serial.hash = 14695981039346656037ULL;
+    vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW | VRNA_OPTION_PF);
+    ck_assert_int_eq(vrna_probs_window(vc, ulength[k], options[k], &window_digest_cb, &serial), 1);
+    vrna_fold_compound_free(vc);
+
+    for (t = 0; threads[t]; t++) {
+      md.threads    = threads[t];
+      parallel.num  = 0;
+      parallel.hash = 14695981039346656037ULL;
+      vc            = vrna_fold_compound(sequence, &md, VRNA_OPTION_WINDOW | VRNA_OPTION_PF);
+      ck_assert_int_eq(vrna_probs_window(vc, ulength[k], options[k], &window_digest_cb, &parallel),
+                       1);
+      vrna_fold_compound_free(vc);
+
+      ck_assert_int_eq(serial.num, parallel.num);
+      ck_assert(serial.hash == parallel.hash);
+    }
+  }
+
+  free(sequence);
+}
+
+#tcase  Vectorized_Decompositions
+
+#test test_pf_simd_kernels
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const int             length = sizeof(sequence) - 1;
+  FLT_OR_DBL            *bpp_scalar;
+  double                en_scalar, en_simd;
+  int                   i, j, *iindx;
+
+  /*
+   *  The vectorized sums of products only change the summation order,
+   *  so results must agree with the scalar code up to rounding errors.
+   *  The tolerances also hold for single precision (USE_FLOAT_PF) builds
+   */
+  vrna_md_set_default(&md);
+  iindx = vrna_idx_row_wise(length);
+
+  vrna_fun_dispatch_disable();
+  vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  en_scalar   = vrna_pf(vc, NULL);
+  bpp_scalar  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (iindx[1] + 1));
+  memcpy(bpp_scalar, vc->exp_matrices->probs, sizeof(FLT_OR_DBL) * (iindx[1] + 1));
+  vrna_fold_compound_free(vc);
+
+  vrna_fun_dispatch_enable();
+  vc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  en_simd = vrna_pf(vc, NULL);
+
+  ck_assert(fabs(en_scalar - en_simd) <= 1e-4 * fabs(en_scalar));
+  for (i = 1; i < length; i++)
+    for (j = i + 1; j <= length; j++)
+      ck_assert(fabs(bpp_scalar[iindx[i] - j] - vc->exp_matrices->probs[iindx[i] - j]) < 1e-5);
+
+  vrna_fold_compound_free(vc);
+  free(bpp_scalar);
+  free(iindx);
+}
+
+#tcase  Temperature
+
+#test test_set_temperature
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc, *vc_ref;
+  const char            sequence[] =
+    "GGGGAGGGGAGGGGAGGGGCGCGAUAUAGCGCUAGCUAGCUAGCAUCGAUCGAUCGUAGCUAGCUAGCUAGCAUCGACUGAUCG";
+  const int             length = sizeof(sequence) - 1;
+  char                  structure[length + 1], structure_ref[length + 1];
+  double                T, en, en_ref;
+  int                   gquad;
+
+  for (gquad = 0; gquad < 2; gquad++) {
+    vrna_md_set_default(&md);
+    md.gquad  = gquad;
+    vc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    vrna_sc_add_up(vc, 10, -1.5, VRNA_OPTION_DEFAULT);
+    vrna_sc_add_bp(vc, 20, 40, -0.7, VRNA_OPTION_DEFAULT);
+
+    (void)vrna_mfe(vc, NULL);
+    (void)vrna_pf(vc, NULL);
+
+    for (T = 0.; T <= 100.; T += 20.) {
+      ck_assert_int_eq(vrna_fold_compound_set_temperature(vc, T), 1);
+
+      md.temperature  = T;
+      vc_ref          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+      vrna_sc_add_up(vc_ref, 10, -1.5, VRNA_OPTION_DEFAULT);
+      vrna_sc_add_bp(vc_ref, 20, 40, -0.7, VRNA_OPTION_DEFAULT);
+
+      ck_assert(vrna_mfe(vc, structure) == vrna_mfe(vc_ref, structure_ref));
+      ck_assert_str_eq(structure, structure_ref);
+
+      en      = vrna_pf(vc, NULL);
+      en_ref  = vrna_pf(vc_ref, NULL);
+      ck_assert(fabs(en - en_ref) < 1e-6);
+
+      vrna_fold_compound_free(vc_ref);
+    }
+
+    vrna_fold_compound_free(vc);
+  }
+}
+
+#test test_set_temperature_comparative
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc, *vc_ref;
+  const char            *alignment[] = {
+    "GGGGAAAACCCCAGCUAGCUAGCUGAUCGAUCGUAGCGGGGAAAACCCC",
+    "GGGGAAA-CCCCAGCUAGCU-GCUGAUCGAUCGUAGCGGGGAAAACCCC",
+    NULL
+  };
+  unsigned int          s, i;
+  double                en, en_ref;
+
+  vrna_md_set_default(&md);
+  vc = vrna_fold_compound_comparative(alignment, &md, VRNA_OPTION_DEFAULT);
+
+  ck_assert_int_eq(vrna_fold_compound_set_temperature(vc, 25.), 1);
+
+  /* Boltzmann weighted stacking pseudo-energies follow the temperature */
+  vrna_sc_init(vc);
+  for (s = 0; s < vc->n_seq; s++) {
+    vc->scs[s]->energy_stack = (int *)vrna_alloc(sizeof(int) * (vc->a2s[s][vc->length] + 1));
+    for (i = 1; i <= vc->a2s[s][vc->length]; i++)
+      vc->scs[s]->energy_stack[i] = (int)(i % 7) * 10 - 30;
+  }
+
+  (void)vrna_pf(vc, NULL);
+  ck_assert_int_eq(vrna_fold_compound_set_temperature(vc, 50.), 1);
+
+  md.temperature  = 50.;
+  vc_ref          = vrna_fold_compound_comparative(alignment, &md, VRNA_OPTION_DEFAULT);
+  vrna_sc_init(vc_ref);
+  for (s = 0; s < vc_ref->n_seq; s++) {
+    vc_ref->scs[s]->energy_stack = (int *)vrna_alloc(sizeof(int) * (vc_ref->a2s[s][vc_ref->length] + 1));
+    for (i = 1; i <= vc_ref->a2s[s][vc_ref->length]; i++)
+      vc_ref->scs[s]->energy_stack[i] = (int)(i % 7) * 10 - 30;
+  }
+
+  (void)vrna_mfe(vc, NULL);
+  (void)vrna_mfe(vc_ref, NULL);
+  en      = vrna_pf(vc, NULL);
+  en_ref  = vrna_pf(vc_ref, NULL);
+  ck_assert(fabs(en - en_ref) < 1e-6);
+
+  vrna_fold_compound_free(vc_ref);
+
+  /* Boltzmann factors for unpaired positions can not be re-computed */
+  vc->scs[0]->exp_energy_up = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (vc->length + 2));
+  ck_assert_int_eq(vrna_sc_rescale(vc), 0);
+  ck_assert_int_eq(vrna_fold_compound_set_temperature(vc, 37.), 0);
+  ck_assert(vc->params->temperature == 50.);
+  ck_assert(vc->exp_params->temperature == 50.);
+
+  vrna_fold_compound_free(vc);
+}
+
+#test test_heat_capacity_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_heat_capacity_t  *hc_serial, *hc_parallel;
+  const char            sequence[] =
+    "GGGGAGGGGAGGGGAGGGGCGCGAUAUAGCGCUAGCUAGCUAGCAUCGAUCGAUCGUAGCUAGCUAGCUAGCAUCGACUGAUCG";
+  int                   i, k, threads[] = {
+    2, 3, 4, 8, 0
+  };
+  unsigned int          m;
+
+  for (m = 1; m <= 3; m += 2) {
+    vrna_md_set_default(&md);
+    vc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    hc_serial = vrna_heat_capacity(vc, 0., 100., 1., m);
+    vrna_fold_compound_free(vc);
+
+    for (i = 0; threads[i]; i++) {
+      md.threads  = threads[i];
+      vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+      hc_parallel = vrna_heat_capacity(vc, 0., 100., 1., m);
+
+      /* the original temperature must be restored */
+      ck_assert(vc->params->model_details.temperature == md.temperature);
+
+      for (k = 0; hc_serial[k].temperature >= -K0; k++) {
+        ck_assert(hc_parallel[k].temperature == hc_serial[k].temperature);
+        ck_assert(hc_parallel[k].heat_capacity == hc_serial[k].heat_capacity);
+      }
+      ck_assert(hc_parallel[k].temperature < -K0);
+
+      free(hc_parallel);
+      vrna_fold_compound_free(vc);
+    }
+
+    free(hc_serial);
+  }
+}
+
+#tcase  PF_Scale_Adjustment
+
+#test test_pf_scale_adjustment
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_exp_param_t      *params;
+  vrna_dimer_pf_t       X, X_ref;
+  /* a long GC helix overflows without scaling */
+  const int             length = 400;
+  char                  sequence[length + 1], dimer[2 * 60 + 2];
+  FLT_OR_DBL            *bpp_ref;
+  double                mfe, en, en_ref, scale_ref;
+  /* overflow, underflow with Q > 0, underflow with Q == 0 */
+  double                pf_scales[3] = {
+    1., 2., 1e100
+  };
+  int                   i, j, k, size, *iindx;
+
+  for (i = 0; i < length; i++)
+    sequence[i] = (i % 2) ? 'C' : 'G';
+  sequence[length] = '\0';
+
+  vrna_md_set_default(&md);
+
+  vc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  mfe = (double)vrna_mfe(vc, NULL);
+  vrna_exp_params_rescale(vc, &mfe);
+  en_ref    = (double)vrna_pf(vc, NULL);
+  scale_ref = vc->exp_params->pf_scale;
+  iindx     = vrna_idx_row_wise(length);
+  size      = iindx[1] + 1;
+  bpp_ref   = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+  memcpy(bpp_ref, vc->exp_matrices->probs, sizeof(FLT_OR_DBL) * size);
+  vrna_fold_compound_free(vc);
+
+  pf_scales[1] = 2. * scale_ref;
+
+  for (k = 0; k < 3; k++) {
+    vc                = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    params            = vrna_exp_params(&md);
+    params->pf_scale  = pf_scales[k];
+    vrna_exp_params_subst(vc, params);
+    free(params);
+
+    en = (double)vrna_pf(vc, NULL);
+
+    ck_assert(vc->exp_params->pf_scale != pf_scales[k]);
+    ck_assert(fabs(en - en_ref) < 1e-6 * fabs(en_ref));
+    for (i = 1; i < length; i++)
+      for (j = i + 1; j <= length; j++)
+        ck_assert(fabs(vc->exp_matrices->probs[iindx[i] - j] - bpp_ref[iindx[i] - j]) < 1e-8);
+
+    vrna_fold_compound_free(vc);
+  }
+
+  free(bpp_ref);
+  free(iindx);
+
+  /* the same for dimers */
+  for (i = 0; i < 60; i++)
+    dimer[i] = dimer[i + 61] = (i % 2) ? 'C' : 'G';
+  dimer[60]         = '&';
+  dimer[2 * 60 + 1] = '\0';
+
+  vc  = vrna_fold_compound(dimer, &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+  mfe = (double)vrna_mfe_dimer(vc, NULL);
+  vrna_exp_params_rescale(vc, &mfe);
+  X_ref   = vrna_pf_dimer(vc, NULL);
+  size    = vc->iindx[1] + 1;
+  bpp_ref = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+  memcpy(bpp_ref, vc->exp_matrices->probs, sizeof(FLT_OR_DBL) * size);
+  vrna_fold_compound_free(vc);
+
+  vc                = vrna_fold_compound(dimer, &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+  params            = vrna_exp_params(&md);
+  params->pf_scale  = 1e100;
+  vrna_exp_params_subst(vc, params);
+  free(params);
+
+  X = vrna_pf_dimer(vc, NULL);
+
+  ck_assert(fabs(X.FAB - X_ref.FAB) < 1e-6 * fabs(X_ref.FAB));
+  ck_assert(fabs(X.F0AB - X_ref.F0AB) < 1e-6 * fabs(X_ref.F0AB));
+  ck_assert(fabs(X.FA - X_ref.FA) < 1e-6 * fabs(X_ref.FA));
+  ck_assert(fabs(X.FB - X_ref.FB) < 1e-6 * fabs(X_ref.FB));
+  for (i = 1; i < 2 * 60; i++)
+    for (j = i + 1; j <= 2 * 60; j++)
+      ck_assert(fabs(vc->exp_matrices->probs[vc->iindx[i] - j] - bpp_ref[vc->iindx[i] - j]) < 1e-8);
+
+  vrna_fold_compound_free(vc);
+  free(bpp_ref);
+}
+
+#test test_pf_scale_adjustment_below_one
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  /*
+   *  enforced, unfavorable hairpins leave a single structure with positive
+   *  free energy, whose Boltzmann factor underflows for pf_scale >= 1
+   */
+  const int             units = 150;
+  char                  sequence[6 * units + 1], structure[6 * units + 1];
+  double                mfe, en;
+  int                   i;
+
+  for (i = 0; i < units; i++) {
+    memcpy(sequence + 6 * i, "ACCCCU", 6);
+    memcpy(structure + 6 * i, "(....)", 6);
+  }
+  sequence[6 * units] = structure[6 * units] = '\0';
+
+  vrna_md_set_default(&md);
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+  vrna_hc_add_from_db(vc, structure, VRNA_CONSTRAINT_DB_DEFAULT | VRNA_CONSTRAINT_DB_ENFORCE_BP);
+  mfe = (double)vrna_mfe(vc, NULL);
+  ck_assert(mfe > 500.);
+
+  vrna_exp_params_rescale(vc, &mfe);
+  en = (double)vrna_pf(vc, NULL);
+
+  ck_assert(vc->exp_params->pf_scale < 1.);
+  ck_assert(fabs(en - mfe) < 1e-3 * mfe);
+
+  vrna_fold_compound_free(vc);
+}
+
 #tcase Stochastic_Backtracking
 
 #test test_sample_structure
@@ -55,6 +958,598 @@
   vrna_fold_compound_free(vc);
 }
 
+#test test_sample_seed
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const int             threads[] = {
+    1, 2, 4, 1
+  };
+  char                  **samples[4], **global[2], **other;
+  int                   t, k, r, equal;
+
+  for (t = 0; t < 4; t++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML      = 1;
+    md.compute_bpp  = 0;
+    md.threads      = threads[t];
+
+    vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+    vrna_pf(vc, NULL);
+
+    /* the same seed yields the same samples, regardless of the number of threads */
+    vrna_pbacktrack_set_seed(vc, 4711);
+    samples[t] = vrna_pbacktrack_num(vc, 40, VRNA_PBACKTRACK_DEFAULT);
+    for (k = 0; k < 40; k++)
+      ck_assert_str_eq(samples[t][k], samples[0][k]);
+
+    /* a different seed yields different samples */
+    if (t == 0) {
+      vrna_pbacktrack_set_seed(vc, 4712);
+      other = vrna_pbacktrack_num(vc, 40, VRNA_PBACKTRACK_DEFAULT);
+      equal = 1;
+      for (k = 0; k < 40; k++)
+        if (strcmp(other[k], samples[0][k]))
+          equal = 0;
+
+      ck_assert(!equal);
+
+      for (k = 0; other[k]; k++)
+        free(other[k]);
+      free(other);
+    }
+
+    /* without seed, samples are drawn from the global random number generator again */
+    if (t == 3) {
+      vrna_pbacktrack_unset_seed(vc);
+      for (r = 0; r < 2; r++) {
+        xsubi[0]  = 1;
+        xsubi[1]  = 2;
+        xsubi[2]  = 3;
+        global[r] = vrna_pbacktrack_num(vc, 40, VRNA_PBACKTRACK_DEFAULT);
+        vrna_pbacktrack_set_seed(vc, 4711);
+        vrna_pbacktrack_unset_seed(vc);
+      }
+
+      equal = 1;
+      for (k = 0; k < 40; k++) {
+        ck_assert_str_eq(global[0][k], global[1][k]);
+        if (strcmp(global[0][k], samples[0][k]))
+          equal = 0;
+      }
+
+      ck_assert(!equal);
+
+      for (r = 0; r < 2; r++) {
+        for (k = 0; global[r][k]; k++)
+          free(global[r][k]);
+        free(global[r]);
+      }
+    }
+
+    vrna_fold_compound_free(vc);
+  }
+
+  for (t = 0; t < 4; t++) {
+    for (k = 0; samples[t][k]; k++)
+      free(samples[t][k]);
+    free(samples[t]);
+  }
+}
+
+#test test_sample_seed_threads
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  unsigned int          options[] = {
+    VRNA_PBACKTRACK_DEFAULT, VRNA_PBACKTRACK_NON_REDUNDANT
+  };
+  char                  **ref, **samples;
+  int                   o, t, k;
+
+  /*
+   *  in default mode, seeded samples must not depend on the number
+   *  of threads, both for ordinary and non-redundant sampling
+   */
+  for (o = 0; o < 2; o++) {
+    ref = NULL;
+
+    for (t = 1; t <= 8; t++) {
+      vrna_md_set_default(&md);
+      md.uniq_ML      = 1;
+      md.compute_bpp  = 0;
+      md.threads      = t;
+
+      vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+      vrna_pf(vc, NULL);
+
+      vrna_pbacktrack_set_seed(vc, 1234);
+      samples = vrna_pbacktrack_num(vc, 77, options[o]);
+
+      for (k = 0; k < 77; k++)
+        ck_assert_str_eq(samples[k], (ref) ? ref[k] : samples[k]);
+      ck_assert(samples[77] == NULL);
+
+      vrna_fold_compound_free(vc);
+
+      if (ref) {
+        for (k = 0; samples[k]; k++)
+          free(samples[k]);
+        free(samples);
+      } else {
+        ref = samples;
+      }
+    }
+
+    for (k = 0; ref[k]; k++)
+      free(ref[k]);
+    free(ref);
+  }
+}
+
+#test test_sample_nonredundant_resume
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_pbacktrack_mem_t nr_mem;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  const int             threads[] = {
+    1, 2, 4, 2
+  };
+  char                  **samples[4][2];
+  int                   t, r, i, k, l, m;
+
+  for (t = 0; t < 4; t++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML      = 1;
+    md.compute_bpp  = 0;
+    md.threads      = threads[t];
+
+    vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+    vrna_pf(vc, NULL);
+    vrna_pbacktrack_set_seed(vc, 42);
+
+    /* two rounds of non-redundant sampling must not yield any structure twice */
+    nr_mem = NULL;
+    for (r = 0; r < 2; r++) {
+      samples[t][r] = vrna_pbacktrack_resume(vc, 50, &nr_mem, VRNA_PBACKTRACK_NON_REDUNDANT);
+      for (i = 0; i < 50; i++)
+        ck_assert_int_eq(strlen(samples[t][r][i]), sizeof(sequence) - 1);
+      ck_assert(samples[t][r][50] == NULL);
+    }
+
+    for (k = 0; k < 100; k++)
+      for (l = k + 1; l < 100; l++)
+        ck_assert(strcmp(samples[t][k / 50][k % 50], samples[t][l / 50][l % 50]) != 0);
+
+    /* the same seed yields the same samples, regardless of the number of threads */
+    for (k = 0; k < 100; k++)
+      ck_assert_str_eq(samples[t][k / 50][k % 50], samples[0][k / 50][k % 50]);
+
+    vrna_pbacktrack_mem_free(nr_mem);
+    vrna_fold_compound_free(vc);
+  }
+
+  for (t = 0; t < 4; t++)
+    for (r = 0; r < 2; r++) {
+      for (m = 0; samples[t][r][m]; m++)
+        free(samples[t][r][m]);
+      free(samples[t][r]);
+    }
+}
+
+#test test_sample_nonredundant_concurrent
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_pbacktrack_mem_t nr_mem;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **samples[2];
+  int                   r, i, k, l, m;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+  md.threads      = 4;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+
+  vrna_pf(vc, NULL);
+  vrna_pbacktrack_set_seed(vc, 42);
+
+  /*
+   *  the sample set now depends on the timing of the threads, but two rounds of
+   *  concurrent non-redundant sampling still must not yield any structure twice
+   */
+  nr_mem = NULL;
+  for (r = 0; r < 2; r++) {
+    samples[r] = vrna_pbacktrack_resume(vc,
+                                        50,
+                                        &nr_mem,
+                                        VRNA_PBACKTRACK_NON_REDUNDANT |
+                                        VRNA_PBACKTRACK_NR_CONCURRENT);
+    for (i = 0; i < 50; i++)
+      ck_assert_int_eq(strlen(samples[r][i]), sizeof(sequence) - 1);
+    ck_assert(samples[r][50] == NULL);
+  }
+
+  for (k = 0; k < 100; k++)
+    for (l = k + 1; l < 100; l++)
+      ck_assert(strcmp(samples[k / 50][k % 50], samples[l / 50][l % 50]) != 0);
+
+  for (r = 0; r < 2; r++) {
+    for (m = 0; samples[r][m]; m++)
+      free(samples[r][m]);
+    free(samples[r]);
+  }
+
+  vrna_pbacktrack_mem_free(nr_mem);
+  vrna_fold_compound_free(vc);
+}
+
+#suite  Suboptimal_Structures
+
+#tcase  Sorted_Enumeration
+
+#test test_subopt_sorted_cb
+{
+  vrna_md_t                 md;
+  vrna_fold_compound_t      *vc;
+  vrna_subopt_solution_t    *sol, *s;
+  struct subopt_sorted_dat  d_unsorted, d_sorted;
+  const char                sequence[] =
+    "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU";
+  int                       n;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML = 1;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+  d_unsorted.num      = d_sorted.num = 0;
+  d_unsorted.unsorted = d_sorted.unsorted = 0;
+
+  vrna_subopt_cb(vc, 500, &subopt_sorted_cb, (void *)&d_unsorted);
+  vrna_subopt_sorted_cb(vc, 500, VRNA_SORT_BY_ENERGY_ASC, 0, &subopt_sorted_cb, (void *)&d_sorted);
+
+  /* same number of structures, but in ascending order of free energy */
+  ck_assert_int_gt(d_unsorted.num, 0);
+  ck_assert_int_gt(d_unsorted.unsorted, 0);
+  ck_assert_int_eq(d_sorted.num, d_unsorted.num);
+  ck_assert_int_eq(d_sorted.unsorted, 0);
+
+  sol = vrna_subopt(vc, 500, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, NULL);
+  for (n = 0, s = sol; s->structure; s++, n++) {
+    if (n > 0) {
+      ck_assert(s->energy >= (s - 1)->energy);
+      if (s->energy == (s - 1)->energy)
+        ck_assert(strcmp((s - 1)->structure, s->structure) < 0);
+    }
+  }
+
+  ck_assert_int_eq(n, d_sorted.num);
+
+  for (s = sol; s->structure; s++)
+    free(s->structure);
+  free(sol);
+
+  vrna_fold_compound_free(vc);
+}
+
+
+#test test_subopt_best_first
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  struct subopt_list    ref, bf;
+  const char            sequence[] =
+    "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU";
+  /*
+   *  a large budget, a tiny one that forces many energy windows, and
+   *  one that doesn't even fit a single structure, so every energy level
+   *  is streamed in several passes
+   */
+  const size_t          budgets[] = {
+    (size_t)256 * 1024 * 1024, 4096, 1
+  };
+  int                   noLP, b, n;
+
+  memset(&ref, 0, sizeof(struct subopt_list));
+  memset(&bf, 0, sizeof(struct subopt_list));
+
+  /*
+   *  noLP falls back to collecting and sorting all structures (with a warning),
+   *  and the memory budget takes precedence over parallel enumeration
+   */
+  for (noLP = 0; noLP <= 1; noLP++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML  = 1;
+    md.noLP     = noLP;
+    md.threads  = 2;
+    vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+    vrna_subopt_sorted_cb(vc, 500, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, 0, &subopt_list_cb, (void *)&ref);
+    ck_assert_int_gt(ref.n, 0);
+
+    for (b = 0; b < 3; b++) {
+      vrna_subopt_sorted_cb(vc,
+                            500,
+                            VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                            budgets[b],
+                            &subopt_list_cb,
+                            (void *)&bf);
+
+      ck_assert_int_eq(bf.n, ref.n);
+      for (n = 0; n < ref.n; n++) {
+        ck_assert_str_eq(bf.sol[n].structure, ref.sol[n].structure);
+        ck_assert(bf.sol[n].energy == ref.sol[n].energy);
+      }
+
+      subopt_list_free(&bf);
+    }
+
+    subopt_list_free(&ref);
+    vrna_fold_compound_free(vc);
+  }
+}
+
+
+#test test_subopt_streamed_levels
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  struct subopt_list    ref, bf;
+  int                   dos_ref[MAXDOS + 1], dos[MAXDOS + 1];
+  int                   k, n;
+  /*
+   *  with these budgets, energy levels are streamed after some of their
+   *  structures have been passed to the callback already
+   */
+  const struct {
+    const char  *sequence;
+    size_t      budget;
+  }                     ref_data[] = {
+    { "CUUUAGAUUGGCAUAGGGGUGUUCGGUGUGAAGUUGCUCAGUGGGGAAAGUG", 5122 },
+    { "UAUGGCCACUGAUCGGUGCCGGCAGGAGAGAUGUCAAUACG", 1012 },
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGG&CUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGC", 4096 }
+  };
+
+  memset(&ref, 0, sizeof(struct subopt_list));
+  memset(&bf, 0, sizeof(struct subopt_list));
+
+  for (k = 0; k < sizeof(ref_data) / sizeof(ref_data[0]); k++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML  = 1;
+    vc          = vrna_fold_compound(ref_data[k].sequence, &md, VRNA_OPTION_DEFAULT);
+
+    memcpy(dos_ref, density_of_states, sizeof(dos_ref));
+    vrna_subopt_sorted_cb(vc, 400, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, 0, &subopt_list_cb, (void *)&ref);
+    for (n = 0; n <= MAXDOS; n++)
+      dos_ref[n] = density_of_states[n] - dos_ref[n];
+
+    /* every structure is passed to the callback (and counted) exactly once */
+    memcpy(dos, density_of_states, sizeof(dos));
+    vrna_subopt_sorted_cb(vc, 400, VRNA_SORT_BY_ENERGY_ASC, ref_data[k].budget, &subopt_list_cb, (void *)&bf);
+    for (n = 0; n <= MAXDOS; n++)
+      ck_assert_int_eq(density_of_states[n] - dos[n], dos_ref[n]);
+
+    ck_assert_int_eq(bf.n, ref.n);
+    for (n = 1; n < bf.n; n++)
+      ck_assert(bf.sol[n - 1].energy <= bf.sol[n].energy);
+
+    qsort(bf.sol, bf.n, sizeof(vrna_subopt_solution_t), &subopt_list_cmp);
+    for (n = 0; n < ref.n; n++) {
+      ck_assert_str_eq(bf.sol[n].structure, ref.sol[n].structure);
+      ck_assert(bf.sol[n].energy == ref.sol[n].energy);
+    }
+
+    subopt_list_free(&bf);
+
+    /* same for lexicographic order, where structures of a level are buffered */
+    memcpy(dos, density_of_states, sizeof(dos));
+    vrna_subopt_sorted_cb(vc,
+                          400,
+                          VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                          ref_data[k].budget / 4,
+                          &subopt_list_cb,
+                          (void *)&bf);
+    for (n = 0; n <= MAXDOS; n++)
+      ck_assert_int_eq(density_of_states[n] - dos[n], dos_ref[n]);
+
+    ck_assert_int_eq(bf.n, ref.n);
+    for (n = 0; n < ref.n; n++) {
+      ck_assert_str_eq(bf.sol[n].structure, ref.sol[n].structure);
+      ck_assert(bf.sol[n].energy == ref.sol[n].energy);
+    }
+
+    subopt_list_free(&bf);
+    subopt_list_free(&ref);
+    vrna_fold_compound_free(vc);
+  }
+}
+
+
+#test test_subopt_memory_budget
+{
+#ifdef WITH_MALLINFO2
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  struct subopt_memory  m, m_budget;
+  const char            sequence[] =
+    "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU";
+  const size_t          budget = 128 * 1024;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML  = 1;
+  vc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+  memset(&m, 0, sizeof(struct subopt_memory));
+  memset(&m_budget, 0, sizeof(struct subopt_memory));
+
+  /* an effectively unlimited budget */
+  vrna_subopt_sorted_cb(vc,
+                        1000,
+                        VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                        (size_t)1024 * 1024 * 1024,
+                        &subopt_memory_cb,
+                        (void *)&m);
+
+  vrna_subopt_sorted_cb(vc,
+                        1000,
+                        VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                        budget,
+                        &subopt_memory_cb,
+                        (void *)&m_budget);
+
+  ck_assert_int_gt(m_budget.num, 0);
+  ck_assert_int_eq(m_budget.num, m.num);
+
+  /* the enumeration needs more than the budget, but stays close to it if asked to */
+  ck_assert(m.peak - m.base > 2 * budget);
+  ck_assert(m_budget.peak - m_budget.base < 2 * budget);
+
+  vrna_fold_compound_free(vc);
+#endif
+}
+
+
+#test test_subopt_reference_output
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  struct subopt_hash    h, h_sorted;
+  int                   k;
+  /*
+   *  reference values were obtained with the previous implementation
+   *  that allocated every state, interval, and structure separately
+   */
+  const struct {
+    const char          *sequence;
+    int                 noLP;
+    int                 gquad;
+    int                 circ;
+    int                 dangles;
+    int                 num;
+    unsigned long long  hash;
+    unsigned long long  hash_sorted;
+  }                     ref[] = {
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU",
+      0, 0, 0, 2, 4280, 0xd9e84a1f3c6a384cULL, 0x34c4415516c14744ULL },
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU",
+      1, 0, 0, 2, 2298, 0x5d3fb695c93aa20bULL, 0x78b0a708071c3073ULL },
+    { "GGGAGGGAGGGAGGGAUUUAGCGCUAGCGCAUCGAUCGUAGCUAGCUAGCGGGUUGGGUUGGGUUGGG",
+      0, 1, 0, 2, 1052, 0xae4abfa1ac42acf0ULL, 0xe9ac020d69a111d0ULL },
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGC",
+      0, 0, 1, 2, 8227, 0x2f6d84d674a2bdf3ULL, 0x079bd39ff458bacfULL },
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGG&CUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGC",
+      0, 0, 0, 2, 26381, 0xeae034e096fcfac9ULL, 0x7e8e2113ec3c4a05ULL },
+    { "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU",
+      0, 0, 0, 1, 4280, 0x5fb76b4c467303feULL, 0xa6d4a98bd1c284f6ULL }
+  };
+
+  for (k = 0; k < sizeof(ref) / sizeof(ref[0]); k++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML  = 1;
+    md.noLP     = ref[k].noLP;
+    md.gquad    = ref[k].gquad;
+    md.circ     = ref[k].circ;
+    md.dangles  = ref[k].dangles;
+
+    vc = vrna_fold_compound(ref[k].sequence, &md, VRNA_OPTION_DEFAULT);
+
+    h.hash  = h_sorted.hash = 14695981039346656037ULL;
+    h.num   = h_sorted.num = 0;
+
+    /* same structures in the same order as before */
+    vrna_subopt_cb(vc, 800, &subopt_hash_cb, (void *)&h);
+    vrna_subopt_sorted_cb(vc,
+                          800,
+                          VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC,
+                          0,
+                          &subopt_hash_cb,
+                          (void *)&h_sorted);
+
+    ck_assert_int_eq(h.num, ref[k].num);
+    ck_assert_int_eq(h_sorted.num, ref[k].num);
+    ck_assert(h.hash == ref[k].hash);
+    ck_assert(h_sorted.hash == ref[k].hash_sorted);
+
+    vrna_fold_compound_free(vc);
+  }
+}
+
+
+#test test_subopt_parallel
+{
+  vrna_md_t               md;
+  vrna_fold_compound_t    *vc, *vc_parallel;
+  vrna_subopt_solution_t  *sol, *sol_parallel;
+  struct subopt_list      l, l_parallel;
+  const char              *sequences[] = {
+    "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGGCUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGCGCGAUACGCAUCGAUCGGCAU",
+    "GGGAGGGAGGGAGGGAUUUAGCGCUAGCGCAUCGAUCGUAGCUAGCUAGCGGGUUGGGUUGGGUUGGG",
+    "GGGGAAAACCCCAUCCGAUGCUAGCUAGCUAGG&CUAGCUAGGGAUCGAUCGAUCGGGCUAUUAUAGC"
+  };
+  int                     k, n;
+
+  memset(&l, 0, sizeof(struct subopt_list));
+  memset(&l_parallel, 0, sizeof(struct subopt_list));
+
+  for (k = 0; k < 3; k++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML  = 1;
+    md.gquad    = (k == 1) ? 1 : 0;
+    vc          = vrna_fold_compound(sequences[k], &md, VRNA_OPTION_DEFAULT);
+    md.threads  = 4;
+    vc_parallel = vrna_fold_compound(sequences[k], &md, VRNA_OPTION_DEFAULT);
+
+    /* unsorted output contains the same structures, regardless of the number of threads */
+    vrna_subopt_cb(vc, 600, &subopt_list_cb, (void *)&l);
+    vrna_subopt_cb(vc_parallel, 600, &subopt_list_cb, (void *)&l_parallel);
+
+    ck_assert_int_gt(l.n, 0);
+    ck_assert_int_eq(l_parallel.n, l.n);
+
+    qsort(l.sol, l.n, sizeof(vrna_subopt_solution_t), &subopt_list_cmp);
+    qsort(l_parallel.sol, l_parallel.n, sizeof(vrna_subopt_solution_t), &subopt_list_cmp);
+
+    for (n = 0; n < l.n; n++) {
+      ck_assert_str_eq(l_parallel.sol[n].structure, l.sol[n].structure);
+      ck_assert(l_parallel.sol[n].energy == l.sol[n].energy);
+    }
+
+    /* sorted output is identical */
+    sol           = vrna_subopt(vc, 600, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, NULL);
+    sol_parallel  = vrna_subopt(vc_parallel, 600, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, NULL);
+
+    for (n = 0; sol[n].structure; n++) {
+      ck_assert(sol_parallel[n].structure != NULL);
+      ck_assert_str_eq(sol_parallel[n].structure, sol[n].structure);
+      ck_assert(sol_parallel[n].energy == sol[n].energy);
+      free(sol[n].structure);
+      free(sol_parallel[n].structure);
+    }
+
+    ck_assert(sol_parallel[n].structure == NULL);
+    ck_assert_int_eq(n, l.n);
+
+    free(sol);
+    free(sol_parallel);
+    subopt_list_free(&l);
+    subopt_list_free(&l_parallel);
+
+    vrna_fold_compound_free(vc);
+    vrna_fold_compound_free(vc_parallel);
+  }
+}
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -77,3 +77,60 @@ free_dummy(void *x)
   //vrna_ht_clear(ht);
   vrna_ht_free(ht);
 }
+
+
+static unsigned
+hash_function_value(void          *hash_entry,
+                    unsigned long hashtable_size)
+{
+  return *((unsigned int *)hash_entry) % hashtable_size;
+}
+
+
+#test test_vrna_hash_table_growth
+{
+  unsigned int      i, n = 10000;
+  unsigned int      *values = malloc(sizeof(unsigned int) * n);
+  void              **entries = malloc(sizeof(void *) * n);
+  vrna_hash_table_t ht        = vrna_ht_init(2,
+                                             hash_comparison_test,
+                                             hash_function_value,
+                                             free_dummy);
+
+  for (i = 0; i < n; i++) {
+    values[i]   = 7 * i;
+    entries[i]  = (void *)(values + i);
+  }
+
+  /* single insertions beyond the initial size */
+  for (i = 0; i < n / 2; i++)
+    ck_assert_int_eq(vrna_ht_insert(ht, entries[i]), 0);
+
+  ck_assert_int_eq(vrna_ht_insert(ht, entries[0]), 1);
+  ck_assert_int_eq(vrna_ht_count(ht), n / 2);
+  ck_assert(vrna_ht_size(ht) >= n / 2);
+
+  /* bulk insertion skips entries that are already present */
+  ck_assert_int_eq(vrna_ht_insert_bulk(ht, entries, n), n - n / 2);
+  ck_assert_int_eq(vrna_ht_count(ht), n);
+
+  for (i = 0; i < n; i++)
+    ck_assert_ptr_eq(vrna_ht_get(ht, entries[i]), entries[i]);
+
+  /* remove every second entry */
+  for (i = 0; i < n; i += 2)
+    vrna_ht_remove(ht, entries[i]);
+
+  ck_assert_int_eq(vrna_ht_count(ht), n / 2);
+
+  for (i = 0; i < n; i++) {
+    if (i % 2)
+      ck_assert_ptr_eq(vrna_ht_get(ht, entries[i]), entries[i]);
+    else
+      ck_assert_ptr_eq(vrna_ht_get(ht, entries[i]), NULL);
+  }
+
+  vrna_ht_free(ht);
+  free(entries);
+  free(values);
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/part_func_window.h>
+#include <ViennaRNA/io/lunp_bin.h>
+
+#define LUNP_TEST_FILE  "lunp_bin_test.bin"
+
+typedef struct {
+  double              **pup;
+  vrna_lunp_writer_t  writer;
+} lunp_test_data;
+
+
+static void
+lunp_test_cb(FLT_OR_DBL   *pr,
+             int          pr_size,
+             int          i,
+             int          max,
+             unsigned int type,
+             void         *data)
+{
+  int             u;
+  lunp_test_data  *d = (lunp_test_data *)data;
+
+  vrna_lunp_writer_cb(pr, pr_size, i, max, type, (void *)d->writer);
+
+  if ((type & VRNA_PROBS_WINDOW_UP) &&
+      ((type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP)) {
+    d->pup[i] = (double *)vrna_alloc(sizeof(double) * (max + 1));
+    for (u = 1; u <= max; u++)
+      d->pup[i][u] = (u <= pr_size) ? ((double *)pr)[u] : NAN;
+  }
+}
+
+
+#suite Binary Unpaired Probability Files
+
+#test test_vrna_lunp
+{
+  char                  *seq;
+  int                   i, u, n, ulength;
+  unsigned int          first, last;
+  float                 p;
+  const float           *chunk;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_lunp_t           lunp;
+  lunp_test_data        data;
+
+  n       = VRNA_LUNP_CHUNK_SIZE + 500;
+  ulength = 12;
+  seq     = vrna_alloc(sizeof(char) * (n + 1));
+
+  srand(13);
+  for (i = 0; i < n; i++)
+    seq[i] = "ACGU"[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 80;
+  md.max_bp_span  = 60;
+
+  fc          = vrna_fold_compound(seq, &md, VRNA_OPTION_WINDOW);
+  data.pup    = (double **)vrna_alloc(sizeof(double *) * (n + 1));
+  data.writer = vrna_lunp_writer_open(LUNP_TEST_FILE, n, ulength);
+
+  ck_assert(data.writer != NULL);
+  ck_assert_int_ne(vrna_probs_window(fc, ulength, VRNA_PROBS_WINDOW_UP, &lunp_test_cb, &data), 0);
+  ck_assert_int_eq(vrna_lunp_writer_close(data.writer), 1);
+
+  lunp = vrna_lunp_open(LUNP_TEST_FILE);
+
+  ck_assert(lunp != NULL);
+  ck_assert_int_eq(vrna_lunp_length(lunp), n);
+  ck_assert_int_eq(vrna_lunp_ulength(lunp), ulength);
+
+  /* all values are single precision copies of the reported probabilities */
+  for (i = 1; i <= n; i++)
+    for (u = 1; u <= ulength; u++) {
+      p = vrna_lunp_get(lunp, i, u);
+      if (u > i)
+        ck_assert(isnan(p));
+      else
+        ck_assert(p == (float)data.pup[i][u]);
+    }
+
+  chunk = vrna_lunp_chunk(lunp, n, 3, &first, &last);
+  ck_assert(chunk != NULL);
+  ck_assert_int_eq(first, VRNA_LUNP_CHUNK_SIZE + 1);
+  ck_assert_int_eq(last, n);
+  ck_assert(chunk[n - first] == vrna_lunp_get(lunp, n, 3));
+
+  ck_assert(isnan(vrna_lunp_get(lunp, 0, 1)));
+  ck_assert(isnan(vrna_lunp_get(lunp, n + 1, 1)));
+  ck_assert(isnan(vrna_lunp_get(lunp, 1, ulength + 1)));
+
+  vrna_lunp_close(lunp);
+
+  /* use the writer as callback directly */
+  data.writer = vrna_lunp_writer_open(LUNP_TEST_FILE, n, ulength);
+  ck_assert_int_ne(vrna_probs_window(fc,
+                                     ulength,
+                                     VRNA_PROBS_WINDOW_UP | VRNA_PROBS_WINDOW_BPP,
+                                     &vrna_lunp_writer_cb,
+                                     (void *)data.writer), 0);
+  ck_assert_int_eq(vrna_lunp_writer_close(data.writer), 1);
+
+  lunp = vrna_lunp_open(LUNP_TEST_FILE);
+  ck_assert(lunp != NULL);
+  ck_assert(vrna_lunp_get(lunp, 2000, 5) == (float)data.pup[2000][5]);
+  vrna_lunp_close(lunp);
+
+  remove(LUNP_TEST_FILE);
+
+  /* not a binary unpaired probability file */
+  ck_assert(vrna_lunp_open("lunp_bin.ts") == NULL);
+
+  for (i = 0; i <= n; i++)
+    free(data.pup[i]);
+
+  free(data.pup);
+  vrna_fold_compound_free(fc);
+  free(seq);
+}
@@ -1,6 +1,6 @@
 use strict;
 use warnings;
-use Test::More tests => 32;
+use Test::More tests => 35;
 
 use RNA;
 
@@ -234,3 +234,23 @@ ok($failure == 0);
 # check for uniqueness, i.e. no duplicates
 @sss = uniq(@ss);
 ok(scalar(@ss) == scalar(@sss));
+
+
+print "test_pbacktrack_seed\n";
+my ($ss1, $ss2, $ss3);
+
+# same seed, same samples
+$fc->pbacktrack_set_seed(42);
+$ss1 = $fc->pbacktrack(50);
+$fc->pbacktrack_set_seed(42);
+$ss2 = [@{$fc->pbacktrack(25)}, @{$fc->pbacktrack(25)}];
+is_deeply($ss2, $ss1);
+
+$fc->pbacktrack_set_seed(43);
+$ss3 = $fc->pbacktrack(50);
+ok(join("\n", @{$ss3}) ne join("\n", @{$ss1}));
+
+# back to the global random number generator
+$fc->pbacktrack_unset_seed();
+$s = $fc->pbacktrack(50);
+ok(scalar(@{$s}) == 50);
@@ -156,6 +156,25 @@ class GeneralTests(unittest.TestCase):
         sss = list(set(ss))
         self.assertEqual(len(ss), len(sss))
 
+    def test_pbacktrack_seed(self):
+        print "test_pbacktrack_seed"
+        fc = prepare_fc()
+
+        # same seed, same samples
+        fc.pbacktrack_set_seed(42)
+        ss1 = fc.pbacktrack(50)
+        fc.pbacktrack_set_seed(42)
+        ss2 = fc.pbacktrack(25) + fc.pbacktrack(25)
+        self.assertEqual(ss1, ss2)
+
+        fc.pbacktrack_set_seed(43)
+        ss3 = fc.pbacktrack(50)
+        self.assertNotEqual(ss1, ss3)
+
+        # back to the global random number generator
+        fc.pbacktrack_unset_seed()
+        ss4 = fc.pbacktrack(50)
+        self.assertEqual(len(ss4), 50)
 
 if __name__ == '__main__':
     unittest.main();
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/utils/structures.h>
+#include <ViennaRNA/datastructures/structure_store.h>
+
+
+#suite Structure Store
+
+#test test_vrna_struct_store
+{
+  const char          *structures[] = {
+    "((((....))))..........",
+    "......................",
+    "(((....)))..((....))..",
+    "((((....))))..........",
+    "..((((....))))........",
+    NULL
+  };
+  unsigned int        i, ids[5];
+  char                *s;
+  short               *pt;
+  vrna_struct_store_t store = vrna_struct_store_init(22, 0);
+
+  ck_assert(store != NULL);
+
+  for (i = 0; structures[i]; i++)
+    ids[i] = vrna_struct_store_insert(store, structures[i]);
+
+  /* IDs are consecutive, and duplicates retrieve the ID of the first insertion */
+  ck_assert_int_eq(ids[0], 0);
+  ck_assert_int_eq(ids[1], 1);
+  ck_assert_int_eq(ids[2], 2);
+  ck_assert_int_eq(ids[3], 0);
+  ck_assert_int_eq(ids[4], 3);
+  ck_assert_int_eq(vrna_struct_store_size(store), 4);
+
+  for (i = 0; structures[i]; i++) {
+    s = vrna_struct_store_get(store, ids[i]);
+    ck_assert_str_eq(s, structures[i]);
+    free(s);
+
+    /* pair tables map onto the same IDs */
+    pt = vrna_ptable(structures[i]);
+    ck_assert_int_eq(vrna_struct_store_find_pt(store, pt), ids[i]);
+    free(pt);
+  }
+
+  pt = vrna_struct_store_get_pt(store, ids[2]);
+  ck_assert_int_eq(pt[1], 10);
+  ck_assert_int_eq(pt[13], 20);
+  ck_assert_int_eq(vrna_struct_store_insert_pt(store, pt), ids[2]);
+  free(pt);
+
+  ck_assert_int_eq(vrna_struct_store_find(store, ".((....))............."), VRNA_STRUCT_STORE_NONE);
+  ck_assert_int_eq(vrna_struct_store_find(store, "((((....))))"), VRNA_STRUCT_STORE_NONE);
+  ck_assert_ptr_eq(vrna_struct_store_get(store, 4), NULL);
+
+  vrna_struct_store_free(store);
+}
+
+
+#test test_vrna_struct_store_many
+{
+  unsigned int        i, j, n = 200000, length = 47;
+  char                *s, *r;
+  vrna_struct_store_t store = vrna_struct_store_init(length, 0);
+
+  s = (char *)vrna_alloc(sizeof(char) * (length + 1));
+
+  /* all structures with up to three hairpins of the form (((...))) */
+  for (i = 0; i < n; i++) {
+    memset(s, '.', length);
+    for (j = 0; j < 3; j++) {
+      unsigned int p = (i >> (6 * j)) % 64;
+      if ((p < 38) && ((j == 0) || (p > 9 * j + 8))) {
+        memcpy(s + p, "(((...)))", 9);
+      }
+    }
+    ck_assert_int_ne(vrna_struct_store_insert(store, s), VRNA_STRUCT_STORE_NONE);
+  }
+
+  for (i = 0; i < vrna_struct_store_size(store); i++) {
+    r = vrna_struct_store_get(store, i);
+    ck_assert_int_eq(vrna_struct_store_find(store, r), i);
+    free(r);
+  }
+
+  free(s);
+  vrna_struct_store_free(store);
+}
+
+
+#test test_vrna_struct_store_concurrent_find
+{
+  unsigned int        lengths[] = {
+    60, 1000
+  };
+  unsigned int        i, k, h, n = 2000;
+  int                 j, errors;
+  char                **s;
+  vrna_struct_store_t store;
+
+  /* short structures are packed on the stack, long ones on the heap */
+  for (k = 0; k < 2; k++) {
+    store = vrna_struct_store_init(lengths[k], n);
+    s     = (char **)vrna_alloc(sizeof(char *) * n);
+
+    for (i = 0; i < n; i++) {
+      s[i] = (char *)vrna_alloc(sizeof(char) * (lengths[k] + 1));
+      memset(s[i], '.', lengths[k]);
+      /* a single base pair (a, b) with 4 <= b - a < length / 2 */
+      h                                   = lengths[k] / 2;
+      s[i][i % h]                         = '(';
+      s[i][i % h + 4 + (i / h) % (h - 4)] = ')';
+      vrna_struct_store_insert(store, s[i]);
+    }
+
+    errors = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(4) reduction(+:errors)
+#endif
+    for (j = 0; j < (int)n; j++) {
+      unsigned int  id  = vrna_struct_store_find(store, s[j]);
+      char          *r  = vrna_struct_store_get(store, id);
+
+      if ((id == VRNA_STRUCT_STORE_NONE) ||
+          (strcmp(r, s[j]) != 0))
+        errors++;
+
+      free(r);
+    }
+
+    ck_assert_int_eq(errors, 0);
+
+    for (i = 0; i < n; i++)
+      free(s[i]);
+    free(s);
+    vrna_struct_store_free(store);
+  }
+}
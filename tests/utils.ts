@@ -1,11 +1,89 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
 
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/utils/strings.h>
+#include <ViennaRNA/utils/cpu.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
 #include <ViennaRNA/alphabet.h>
 #include <ViennaRNA/mfe.h>
+#include <ViennaRNA/part_func.h>
+#include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/params/default.h>
+#include <ViennaRNA/params/io.h>
+
+/* SIMD kernels are not part of the public API, so we declare them here */
+#if VRNA_WITH_SIMD_SSE41
+int vrna_fun_zip_add_min_sse41(const int *, const int *, int);
+int vrna_fun_zip_add_min_idx_sse41(const int *, const int *, int, int *);
+int vrna_fun_zip_add_min_masked_sse41(const int *, const int *, const unsigned char *, int);
+#endif
+
+#if VRNA_WITH_SIMD_AVX2
+int vrna_fun_zip_add_min_avx2(const int *, const int *, int);
+int vrna_fun_zip_add_min_idx_avx2(const int *, const int *, int, int *);
+int vrna_fun_zip_add_min_masked_avx2(const int *, const int *, const unsigned char *, int);
+FLT_OR_DBL vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+FLT_OR_DBL vrna_fun_zip_mult_sum_rev_avx2(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+#endif
+
+#if VRNA_WITH_SIMD_AVX512
+int vrna_fun_zip_add_min_avx512(const int *, const int *, int);
+int vrna_fun_zip_add_min_idx_avx512(const int *, const int *, int, int *);
+int vrna_fun_zip_add_min_masked_avx512(const int *, const int *, const unsigned char *, int);
+FLT_OR_DBL vrna_fun_zip_mult_sum_avx512(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+FLT_OR_DBL vrna_fun_zip_mult_sum_rev_avx512(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+#endif
+
+/* largest array size and start offset tested, covers all remainders of 4, 8, and 16 lanes */
+#define ZIP_MAX_COUNT   70
+#define ZIP_MAX_OFFSET  3
+
+struct zip_kernels {
+  const char    *name;
+  unsigned int  cpu_feature;
+  int (*add_min)(const int *, const int *, int);
+  int (*add_min_idx)(const int *, const int *, int, int *);
+  int (*add_min_masked)(const int *, const int *, const unsigned char *, int);
+  FLT_OR_DBL (*mult_sum)(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+  FLT_OR_DBL (*mult_sum_rev)(const FLT_OR_DBL *, const FLT_OR_DBL *, int);
+};
+
+static struct zip_kernels zip_kernel_list[] = {
+#if VRNA_WITH_SIMD_SSE41
+  { "SSE4.1", VRNA_CPU_SIMD_SSE41,
+    vrna_fun_zip_add_min_sse41, vrna_fun_zip_add_min_idx_sse41, vrna_fun_zip_add_min_masked_sse41,
+    NULL, NULL },
+#endif
+#if VRNA_WITH_SIMD_AVX2
+  { "AVX2", VRNA_CPU_SIMD_AVX2,
+    vrna_fun_zip_add_min_avx2, vrna_fun_zip_add_min_idx_avx2, vrna_fun_zip_add_min_masked_avx2,
+    vrna_fun_zip_mult_sum_avx2, vrna_fun_zip_mult_sum_rev_avx2 },
+#endif
+#if VRNA_WITH_SIMD_AVX512
+  { "AVX-512", VRNA_CPU_SIMD_AVX512F,
+    vrna_fun_zip_add_min_avx512, vrna_fun_zip_add_min_idx_avx512, vrna_fun_zip_add_min_masked_avx512,
+    vrna_fun_zip_mult_sum_avx512, vrna_fun_zip_mult_sum_rev_avx512 },
+#endif
+  { NULL, 0, NULL, NULL, NULL, NULL, NULL }
+};
+
+
+static unsigned int
+lcg_next(unsigned int *state)
+{
+  *state = *state * 1103515245u + 12345u;
+  return (*state >> 8) & 0xFFFFFFu;
+}
+
 
 static int
 compare_str(const void  *a,
@@ -164,6 +242,159 @@ compare_str(const void  *a,
 //@TODO: details.nonstandards
 //@TODO: details.energyset = [1, 2, 3]
 
+#tcase Parameter_Cache
+
+#test test_params_cache_hit
+{
+  vrna_md_t         md;
+  vrna_param_t      *p1, *p2;
+  vrna_exp_param_t  *e1, *e2;
+
+  vrna_md_set_default(&md);
+  vrna_params_cache_clear();
+
+  p1  = vrna_params(&md);
+  e1  = vrna_exp_params(&md);
+
+  /*
+   *  alter the global parameters without clearing the cache, such
+   *  that a cache hit still returns the previous tables
+   */
+  ML_BASE37 += 100;
+  ML_BASEdH += 100;
+
+  md.noLP = 1;
+  p2      = vrna_params(&md);
+  e2      = vrna_exp_params(&md);
+
+#if VRNA_WITH_PTHREADS
+  ck_assert_int_eq(p2->MLbase, p1->MLbase);
+  ck_assert(e2->expMLbase == e1->expMLbase);
+#endif
+
+  /* model details that do not affect the tables are taken from the request */
+  ck_assert_int_eq(p2->model_details.noLP, 1);
+  ck_assert_int_eq(e2->model_details.noLP, 1);
+  ck_assert(p2 != p1);
+  ck_assert(e2 != e1);
+
+  ML_BASE37 -= 100;
+  ML_BASEdH -= 100;
+  vrna_params_cache_clear();
+
+  free(p1);
+  free(p2);
+  free(e1);
+  free(e2);
+}
+
+#test test_params_cache_miss
+{
+  vrna_md_t         md;
+  vrna_param_t      *p1, *p2, *p_ref;
+  vrna_exp_param_t  *e1, *e2, *e3, *e_ref;
+
+  vrna_md_set_default(&md);
+  vrna_params_cache_clear();
+
+  p1  = vrna_params(&md);
+  e1  = vrna_exp_params(&md);
+
+  ML_BASE37 += 100;
+  ML_BASEdH += 100;
+
+  /* a different temperature must not be served from the cache */
+  md.temperature = 50.;
+  p2  = vrna_params(&md);
+  e2  = vrna_exp_params(&md);
+
+  vrna_params_cache_clear();
+  p_ref = vrna_params(&md);
+  e_ref = vrna_exp_params(&md);
+
+  ck_assert_int_eq(p2->MLbase, p_ref->MLbase);
+  ck_assert(e2->expMLbase == e_ref->expMLbase);
+  ck_assert_int_ne(p2->MLbase, p1->MLbase);
+
+  free(e_ref);
+
+  /* neither must a different scaling of the thermodynamic temperature */
+  md.temperature  = 37.;
+  md.betaScale    = 1.5;
+  e3              = vrna_exp_params(&md);
+
+  vrna_params_cache_clear();
+  e_ref = vrna_exp_params(&md);
+
+  ck_assert(e3->expMLbase == e_ref->expMLbase);
+  ck_assert(e3->expMLbase != e1->expMLbase);
+  ck_assert(e3->kT == e_ref->kT);
+
+  ML_BASE37 -= 100;
+  ML_BASEdH -= 100;
+  vrna_params_cache_clear();
+
+  free(p1);
+  free(p2);
+  free(p_ref);
+  free(e1);
+  free(e2);
+  free(e3);
+  free(e_ref);
+}
+
+#test test_params_cache_clear_on_load
+{
+  char          fname[] = "params_cache_XXXXXX";
+  int           fd, ml_base, ret;
+  vrna_md_t     md;
+  vrna_param_t  *p;
+
+  vrna_md_set_default(&md);
+  vrna_params_cache_clear();
+
+  /* store the current parameter set to re-load it later */
+  fd = mkstemp(fname);
+  ck_assert_int_ge(fd, 0);
+  close(fd);
+  ck_assert_int_ne(vrna_params_save(fname, VRNA_PARAMETER_FORMAT_DEFAULT), 0);
+
+  p       = vrna_params(&md);
+  ml_base = p->MLbase;
+  free(p);
+
+  /* populate the cache with altered parameters */
+  ML_BASE37 += 100;
+  ML_BASEdH += 100;
+  vrna_params_cache_clear();
+  p = vrna_params(&md);
+  ck_assert_int_eq(p->MLbase, ml_base + 100);
+  free(p);
+
+  /* loading a parameter file must invalidate the cached tables */
+  ret = vrna_params_load(fname, VRNA_PARAMETER_FORMAT_DEFAULT);
+  remove(fname);
+  ck_assert_int_ne(ret, 0);
+
+  p = vrna_params(&md);
+  ck_assert_int_eq(p->MLbase, ml_base);
+  free(p);
+
+  /* the same holds for parameters loaded from a string */
+  ML_BASE37 += 100;
+  ML_BASEdH += 100;
+  vrna_params_cache_clear();
+  p = vrna_params(&md);
+  ck_assert_int_eq(p->MLbase, ml_base + 100);
+  free(p);
+
+  ck_assert_int_ne(vrna_params_load_RNA_Turner2004(), 0);
+
+  p = vrna_params(&md);
+  ck_assert_int_eq(p->MLbase, ml_base);
+  free(p);
+}
+
 #tcase Structure_Utils
 
 #test test_get_ptypes
@@ -302,3 +533,76 @@ compare_str(const void  *a,
 //@TODO: extend alphabeth
 //@TODO: details.noLP = 1
 //@TODO: idx_type = 1
+
+#tcase Higher_Order_Functions
+
+#test test_zip_kernels_simd
+{
+  /*
+   *  Compare all SIMD kernels supported by the CPU against the scalar
+   *  implementations for all sizes up to ZIP_MAX_COUNT and unaligned
+   *  start positions. The integer kernels must be exact. The sums of
+   *  products only differ in the summation order. Since all products
+   *  are positive, the error of either sum is bounded by
+   *  count * epsilon * sum, so we accept twice this bound
+   */
+  int                 e1[ZIP_MAX_COUNT + ZIP_MAX_OFFSET], e2[ZIP_MAX_COUNT + ZIP_MAX_OFFSET];
+  unsigned char       mask[ZIP_MAX_COUNT + ZIP_MAX_OFFSET];
+  FLT_OR_DBL          q1[ZIP_MAX_COUNT + ZIP_MAX_OFFSET], q2[ZIP_MAX_COUNT + ZIP_MAX_OFFSET];
+  FLT_OR_DBL          ref, res, eps, tol;
+  unsigned int        features, rng = 42;
+  int                 i, k, n, off, round, ref_min, ref_idx, idx;
+  struct zip_kernels  *kernel;
+
+  features  = vrna_cpu_simd_capabilities();
+  eps       = (vrna_pf_float_precision()) ? FLT_EPSILON : DBL_EPSILON;
+
+  for (round = 0; round < 10; round++) {
+    for (i = 0; i < ZIP_MAX_COUNT + ZIP_MAX_OFFSET; i++) {
+      e1[i]   = (lcg_next(&rng) % 8) ? (int)(lcg_next(&rng) % 2000) - 1000 : INF;
+      e2[i]   = (lcg_next(&rng) % 8) ? (int)(lcg_next(&rng) % 2000) - 1000 : INF;
+      mask[i] = (unsigned char)(lcg_next(&rng) % 3 != 0);
+      q1[i]   = (FLT_OR_DBL)exp((double)(lcg_next(&rng) % 2000) / 100. - 10.);
+      q2[i]   = (FLT_OR_DBL)exp((double)(lcg_next(&rng) % 2000) / 100. - 10.);
+    }
+
+    for (off = 0; off <= ZIP_MAX_OFFSET; off++)
+      for (n = 0; n + off <= ZIP_MAX_COUNT + ZIP_MAX_OFFSET && n <= ZIP_MAX_COUNT; n++) {
+        for (k = 0; zip_kernel_list[k].name; k++) {
+          kernel = &(zip_kernel_list[k]);
+          if (!(features & kernel->cpu_feature))
+            continue;
+
+          vrna_fun_dispatch_disable();
+
+          ck_assert_int_eq(kernel->add_min(e1 + off, e2 + off, n),
+                           vrna_fun_zip_add_min(e1 + off, e2 + off, n));
+
+          ref_min = vrna_fun_zip_add_min_idx(e1 + off, e2 + off, n, &ref_idx);
+          ck_assert_int_eq(kernel->add_min_idx(e1 + off, e2 + off, n, &idx), ref_min);
+          ck_assert_int_eq(idx, ref_idx);
+
+          ck_assert_int_eq(kernel->add_min_masked(e1 + off, e2 + off, mask + off, n),
+                           vrna_fun_zip_add_min_masked(e1 + off, e2 + off, mask + off, n));
+
+          if (kernel->mult_sum) {
+            ref = vrna_fun_zip_mult_sum(q1 + off, q2 + off, n);
+            res = kernel->mult_sum(q1 + off, q2 + off, n);
+            tol = 2. * n * eps * ref;
+            ck_assert_msg(fabs(res - ref) <= tol,
+                          "%s mult_sum (n = %d, offset = %d): %g vs. %g",
+                          kernel->name, n, off, res, ref);
+
+            ref = vrna_fun_zip_mult_sum_rev(q1 + off, q2 + off, n);
+            res = kernel->mult_sum_rev(q1 + off, q2 + off, n);
+            tol = 2. * n * eps * ref;
+            ck_assert_msg(fabs(res - ref) <= tol,
+                          "%s mult_sum_rev (n = %d, offset = %d): %g vs. %g",
+                          kernel->name, n, off, res, ref);
+          }
+
+          vrna_fun_dispatch_enable();
+        }
+      }
+  }
+}
@@ -1,6 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <ViennaRNA/landscape/walk.h>
+#include <ViennaRNA/landscape/findpath.h>
+#include <ViennaRNA/eval.h>
+#include <ViennaRNA/params/constants.h>
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/data_structures.h>
@@ -48,3 +52,159 @@
   free(resultMoves);
   free(resultStructure);
 }
+
+
+#test Findpath_Saddle_Batch
+{
+  const char            *sequence     = "GGGGAAAACCCCAUUUGGGAAAACCCAUUUU";
+  const char            *structures[] = {
+    "((((....))))...................",
+    "................(((....))).....",
+    "((((....)))).....(((....)))....",
+    NULL
+  };
+  unsigned int          pairs[]       = {
+    0, 2, 2, 1
+  };
+  unsigned int          a, b, n = 3;
+  int                   *M, *U;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+  md.threads  = 2;
+  fc          = vrna_fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+  /* all pairs */
+  M = vrna_path_findpath_saddle_batch(fc, structures, NULL, 0, 10, INT_MAX - 1, VRNA_PATH_BATCH_DEFAULT);
+  ck_assert(M != NULL);
+
+  for (a = 0; a < n; a++) {
+    short *pt = vrna_ptable(structures[a]);
+    ck_assert_int_eq(M[a * n + a], vrna_eval_structure_pt(fc, pt));
+    free(pt);
+
+    for (b = a + 1; b < n; b++) {
+      ck_assert_int_eq(M[a * n + b], vrna_path_findpath_saddle(fc, structures[a], structures[b], 10));
+      ck_assert_int_eq(M[a * n + b], M[b * n + a]);
+    }
+  }
+
+  /* selected pairs with indirect upper bounds */
+  U = vrna_path_findpath_saddle_batch(fc, structures, pairs, 2, 10, INT_MAX - 1, VRNA_PATH_BATCH_INDIRECT_UB);
+  ck_assert(U != NULL);
+  ck_assert_int_eq(U[0 * n + 1], INF);
+  ck_assert_int_eq(U[0 * n + 2], M[0 * n + 2]);
+  ck_assert_int_le(U[1 * n + 2], M[1 * n + 2]);
+
+  free(M);
+  free(U);
+  vrna_fold_compound_free(fc);
+}
+
+
+#test Findpath_Reference
+{
+  /*
+   *  reference values were obtained with the previous implementation that
+   *  removed duplicate intermediates and selected the best ones via qsort().
+   *  The path hash combines all structures and energies (FNV-1a), such that
+   *  any change in the beam cut, including the order of equal energy
+   *  intermediates, is detected. The second sequence consists of two
+   *  identical hairpins and therefore produces many ties.
+   */
+  const int             widths[] = {
+    1, 2, 5, 10, 50
+  };
+  const struct {
+    const char          *sequence;
+    const char          *s1;
+    const char          *s2;
+    int                 saddle[5];
+    unsigned long long  hash[5];
+  }                     ref[] = {
+    { "GGGGAAAACCCCAUUUGGGAAAACCCAUUUU",
+      "((((....))))...................",
+      "................(((....))).....",
+      { -60, -70, -70, -70, -70 },
+      { 0x59a8d3cbafd1cc33ULL, 0x06266c758fbeb353ULL, 0x06266c758fbeb353ULL,
+        0x06266c758fbeb353ULL, 0x06266c758fbeb353ULL } },
+    { "GGGGAAAACCCCGGGGAAAACCCC",
+      "((((....))))((((....))))",
+      "((((((((....))))....))))",
+      { 460, 460, 460, 460, 460 },
+      { 0x80080e85fd194cdfULL, 0x80080e85fd194cdfULL, 0x80080e85fd194cdfULL,
+        0x80080e85fd194cdfULL, 0x80080e85fd194cdfULL } },
+    { "AUGCAGUGGCUCCACAUUACGAUUGCCACCACCAGUGUGGUUGACAACCG",
+      ".....(((....)))....((.((((.(((((....))))).).))).))",
+      "((((.(((((((........))..))))).....))))((((...)))).",
+      { 400, 0, -140, -140, -140 },
+      { 0xdc4302f9fc22a0b0ULL, 0xac53b593b18f1d98ULL, 0x7d601a4baec19c40ULL,
+        0x7d601a4baec19c40ULL, 0x7d601a4baec19c40ULL } },
+    { "CACUGAUCCGUCAUCUCACCGAGUUUGCUUGACGAAGGCUGAACCGACAUGACCGGCCGUGUUGAUGGGGCAAACGUACC",
+      "...((..((((((......((.((((((((.....)))).))))))(((((......)))))))))))..))........",
+      ".(((((....)))((.....))((((((((.((((.(((((............)))))...))).).))))))))))...",
+      { 1080, 430, -122, -122, -122 },
+      { 0xd58a4622c0e163ebULL, 0x6babab7da938f79bULL, 0xbac15aa3d847deaaULL,
+        0x829bf6442ef64957ULL, 0x829bf6442ef64957ULL } },
+    { "GAACCGAAAUGUGCCACGAGCUGCUCUCAGGUUGACCCCCUUAUUUAAAGUUGGGCUACUGAGUUGAGCCUCGGCGAACUGGGACAGUCU",
+      ".....((..(((.(((((((((...(((((...(.(((.(((.....)))..))))..)))))...)).))))......))).))).)).",
+      ".((((.....((((.....)).)).....))))(((.(((.........((((((((.(......))))).)))).....)))...))).",
+      { 600, 440, 100, 100, -530 },
+      { 0x7ec80ca09eb555d2ULL, 0x17f629e8ffe6a4faULL, 0x9a986259d11f6b54ULL,
+        0x9a986259d11f6b54ULL, 0xb85513ae0654be61ULL } },
+    { "AUGAAAGAGAUGGAUAAAACAGGAUACGCAAGCAUCUCAUCAUCACUCACGGUUUUCAGGCUUGCAAUAUCGUACAUGUUGUGCGGUGGGACGACGUACG",
+      "......................((((.((((((........(((......)))......))))))..))))((((..(((((.(....).))))))))).",
+      ".((((((((((((((......(....)......))).)))).)).........))))).((((((..(((((((((...))))))))).).))).))...",
+      { -170, -170, -250, -420, -440 },
+      { 0x479c0f0830f36f14ULL, 0x479c0f0830f36f14ULL, 0x513113b487329d3eULL,
+        0x464719c88888ff53ULL, 0x7d4e873f107d59e7ULL } }
+  };
+  unsigned int          k, w;
+  int                   n, saddle, en;
+  unsigned long long    hash;
+  const char            *c;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_path_t           *path, *p;
+
+  vrna_md_set_default(&md);
+
+  for (k = 0; k < sizeof(ref) / sizeof(ref[0]); k++) {
+    fc = vrna_fold_compound(ref[k].sequence, &md, VRNA_OPTION_EVAL_ONLY);
+
+    for (w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+      ck_assert_int_eq(vrna_path_findpath_saddle(fc, ref[k].s1, ref[k].s2, widths[w]),
+                       ref[k].saddle[w]);
+
+      path = vrna_path_findpath(fc, ref[k].s1, ref[k].s2, widths[w]);
+      ck_assert(path != NULL);
+
+      hash    = 14695981039346656037ULL;
+      saddle  = INT_MIN;
+      for (n = 0, p = path; p->s; p++, n++) {
+        en = (int)(p->en * 100. + ((p->en < 0) ? -0.5 : 0.5));
+        for (c = p->s; *c; c++) {
+          hash  ^= (unsigned char)*c;
+          hash  *= 1099511628211ULL;
+        }
+        hash    ^= (unsigned long long)(long long)en;
+        hash    *= 1099511628211ULL;
+        saddle  = (en > saddle) ? en : saddle;
+      }
+
+      ck_assert_str_eq(path[0].s, ref[k].s1);
+      ck_assert_str_eq(path[n - 1].s, ref[k].s2);
+      ck_assert_int_eq(n, vrna_bp_distance(ref[k].s1, ref[k].s2) + 1);
+      ck_assert_int_eq(saddle, ref[k].saddle[w]);
+      ck_assert_msg(hash == ref[k].hash[w],
+                    "path %u for width %d differs from reference",
+                    k,
+                    widths[w]);
+
+      vrna_path_free(path);
+    }
+
+    vrna_fold_compound_free(fc);
+  }
+}